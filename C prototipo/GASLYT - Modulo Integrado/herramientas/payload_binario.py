@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+"""
+Codificador/decodificador del formato binario de los mensajes GASLYT.
+
+Implementa el mismo esquema que lib/CodificadorBinario (MessagePack con
+identificadores enteros para los campos conocidos y la clave 0 con la
+versión del esquema en el objeto raíz). Solo usa la biblioteca estándar.
+
+Un mismo topic puede traer ambos formatos: la cola persistente reenvía cada
+mensaje en el formato vigente al encolarlo, aunque formato_payload haya
+cambiado después. El primer byte los distingue: '{' (0x7b) o '[' (0x5b) en
+JSON; un mapa (0x80-0x8f, 0xde) o un arreglo (0x90-0x9f, 0xdc) en
+MessagePack. decodificar_payload() aplica esa regla.
+
+Uso:
+    python3 payload_binario.py decodificar mensaje.bin
+    python3 payload_binario.py codificar lectura.json > mensaje.bin
+    python3 payload_binario.py comparar lectura.json [--repeticiones N]
+"""
+import argparse
+import json
+import struct
+import sys
+import time
+
+VERSION_ESQUEMA = 1
+CLAVE_VERSION = 0
+
+# Esquema v1: índice = identificador de campo. Debe coincidir con el firmware.
+CAMPOS_ESQUEMA = [
+    None, "timestamp", "fecha", "concentracion", "unidad", "umbral", "alarma",
+    "idDispositivo", "rssi", "arranque", "secuencia", "canales", "tipo", "gas",
+    "ratio", "valida", "estadisticas", "media", "desviacion", "ewma", "minimo",
+    "maximo", "muestras", "tendencia", "tiempoHastaUmbral", "sensor",
+    "severidad", "accion", "mac", "version", "pinSensorGas", "canalesSensor",
+    "pin", "pinLED", "pinBuzzer", "pinExtractor", "extractorAlambrico",
+    "intervaloMedicion", "umbralAlarma", "modoAWS", "brokerMQTT", "puertoMQTT",
+    "estadoFabrica", "uptime", "ip", "estadoWifi", "estadoMQTT", "estadoAlarma",
+    "ultimaLectura", "r0", "muestreoAdaptativo", "intervaloMuestreo",
+    "colaPendientes", "colaDescartados", "estado", "progreso", "canal",
+    "lecturasSuprimidas", "lecturasPublicadas", "saturada",
+]
+ID_CAMPOS = {nombre: i for i, nombre in enumerate(CAMPOS_ESQUEMA) if nombre}
+
+
+class ErrorFormato(ValueError):
+    pass
+
+
+# ---------------------------------------------------------------------------
+# Decodificación
+# ---------------------------------------------------------------------------
+
+class _Lector:
+    def __init__(self, datos):
+        self.datos = datos
+        self.posicion = 0
+
+    def leer(self, cantidad):
+        if self.posicion + cantidad > len(self.datos):
+            raise ErrorFormato("mensaje truncado en el byte %d" % self.posicion)
+        fragmento = self.datos[self.posicion:self.posicion + cantidad]
+        self.posicion += cantidad
+        return fragmento
+
+    def desempaquetar(self, formato):
+        return struct.unpack(formato, self.leer(struct.calcsize(formato)))[0]
+
+    def valor(self):
+        b = self.leer(1)[0]
+        if b <= 0x7f:
+            return b
+        if b >= 0xe0:
+            return b - 0x100
+        if 0x80 <= b <= 0x8f:
+            return self.mapa(b & 0x0f)
+        if 0x90 <= b <= 0x9f:
+            return self.arreglo(b & 0x0f)
+        if 0xa0 <= b <= 0xbf:
+            return self.texto(b & 0x1f)
+        simples = {0xc0: None, 0xc2: False, 0xc3: True}
+        if b in simples:
+            return simples[b]
+        formatos = {0xca: ">f", 0xcb: ">d", 0xcc: ">B", 0xcd: ">H", 0xce: ">I",
+                    0xcf: ">Q", 0xd0: ">b", 0xd1: ">h", 0xd2: ">i", 0xd3: ">q"}
+        if b in formatos:
+            return self.desempaquetar(formatos[b])
+        if b == 0xd9:
+            return self.texto(self.desempaquetar(">B"))
+        if b == 0xda:
+            return self.texto(self.desempaquetar(">H"))
+        if b == 0xdc:
+            return self.arreglo(self.desempaquetar(">H"))
+        if b == 0xde:
+            return self.mapa(self.desempaquetar(">H"))
+        raise ErrorFormato("tipo 0x%02x no soportado en el byte %d" % (b, self.posicion - 1))
+
+    def texto(self, longitud):
+        return self.leer(longitud).decode("utf-8")
+
+    def arreglo(self, cantidad):
+        return [self.valor() for _ in range(cantidad)]
+
+    def mapa(self, cantidad):
+        resultado = {}
+        for _ in range(cantidad):
+            clave = self.valor()
+            resultado[clave] = self.valor()
+        return resultado
+
+
+def _restaurar_nombres(valor, raiz):
+    if isinstance(valor, list):
+        return [_restaurar_nombres(v, raiz) for v in valor]
+    if not isinstance(valor, dict):
+        return valor
+    if raiz:
+        version = valor.pop(CLAVE_VERSION, None)
+        if version != VERSION_ESQUEMA:
+            raise ErrorFormato("versión de esquema %r no soportada" % version)
+    resultado = {}
+    for clave, contenido in valor.items():
+        if isinstance(clave, int):
+            if clave >= len(CAMPOS_ESQUEMA) or not CAMPOS_ESQUEMA[clave]:
+                raise ErrorFormato("campo %d desconocido" % clave)
+            clave = CAMPOS_ESQUEMA[clave]
+        resultado[clave] = _restaurar_nombres(contenido, False)
+    return resultado
+
+
+def decodificar(datos):
+    """Mensaje binario (o lote de mensajes) -> objeto con nombres de campo."""
+    lector = _Lector(bytes(datos))
+    valor = lector.valor()
+    if lector.posicion != len(lector.datos):
+        raise ErrorFormato("%d bytes sobrantes" % (len(lector.datos) - lector.posicion))
+    # Un lote es un arreglo de mensajes raíz
+    if isinstance(valor, list):
+        return [_restaurar_nombres(v, True) for v in valor]
+    return _restaurar_nombres(valor, True)
+
+
+def es_json(datos):
+    """Regla del primer byte: True para JSON, False para MessagePack."""
+    if not datos:
+        raise ErrorFormato("mensaje vacío")
+    primero = datos[0]
+    if primero in (0x7B, 0x5B):
+        return True
+    if 0x80 <= primero <= 0x9F or primero in (0xDC, 0xDE):
+        return False
+    raise ErrorFormato("primer byte 0x%02x: ni JSON ni MessagePack" % primero)
+
+
+def decodificar_payload(datos):
+    """Payload tal como llega del broker, en cualquiera de los dos formatos."""
+    datos = bytes(datos)
+    if es_json(datos):
+        return json.loads(datos.decode("utf-8"))
+    return decodificar(datos)
+
+
+# ---------------------------------------------------------------------------
+# Codificación (igual que el firmware)
+# ---------------------------------------------------------------------------
+
+def _entero(n):
+    if 0 <= n <= 0x7f:
+        return struct.pack(">B", n)
+    if -32 <= n < 0:
+        return struct.pack(">b", n)
+    for limite, prefijo, formato in ((0xff, 0xcc, ">B"), (0xffff, 0xcd, ">H"), (0xffffffff, 0xce, ">I")):
+        if 0 <= n <= limite:
+            return bytes([prefijo]) + struct.pack(formato, n)
+    for limite, prefijo, formato in ((-128, 0xd0, ">b"), (-32768, 0xd1, ">h"), (-2147483648, 0xd2, ">i")):
+        if limite <= n < 0:
+            return bytes([prefijo]) + struct.pack(formato, n)
+    return (b"\xd3" + struct.pack(">q", n)) if n < 0 else (b"\xcf" + struct.pack(">Q", n))
+
+
+def _texto(s):
+    datos = s.encode("utf-8")
+    if len(datos) <= 31:
+        return bytes([0xa0 | len(datos)]) + datos
+    if len(datos) <= 0xff:
+        return b"\xd9" + struct.pack(">B", len(datos)) + datos
+    return b"\xda" + struct.pack(">H", len(datos)) + datos
+
+
+def _cabecera(cantidad, corto, largo):
+    return bytes([corto | cantidad]) if cantidad <= 15 else bytes([largo]) + struct.pack(">H", cantidad)
+
+
+def _valor(v, raiz=False):
+    if v is None:
+        return b"\xc0"
+    if isinstance(v, bool):
+        return b"\xc3" if v else b"\xc2"
+    if isinstance(v, int):
+        return _entero(v)
+    if isinstance(v, float):
+        return b"\xca" + struct.pack(">f", v)
+    if isinstance(v, str):
+        return _texto(v)
+    if isinstance(v, list):
+        return _cabecera(len(v), 0x90, 0xdc) + b"".join(_valor(e) for e in v)
+    if isinstance(v, dict):
+        partes = [_cabecera(len(v) + (1 if raiz else 0), 0x80, 0xde)]
+        if raiz:
+            partes.append(_entero(CLAVE_VERSION) + _entero(VERSION_ESQUEMA))
+        for clave, contenido in v.items():
+            partes.append(_entero(ID_CAMPOS[clave]) if clave in ID_CAMPOS else _texto(clave))
+            partes.append(_valor(contenido))
+        return b"".join(partes)
+    raise TypeError("tipo %s no soportado" % type(v).__name__)
+
+
+def codificar(mensaje):
+    """Objeto (o lista de objetos para un lote) -> bytes."""
+    if isinstance(mensaje, list):
+        # Los lotes usan siempre array16, como el firmware
+        return b"\xdc" + struct.pack(">H", len(mensaje)) + b"".join(_valor(m, True) for m in mensaje)
+    return _valor(mensaje, True)
+
+
+# ---------------------------------------------------------------------------
+# Línea de comandos
+# ---------------------------------------------------------------------------
+
+def _comparar(mensaje, repeticiones):
+    texto = json.dumps(mensaje, separators=(",", ":"), ensure_ascii=False).encode("utf-8")
+    binario = codificar(mensaje)
+
+    inicio = time.perf_counter()
+    for _ in range(repeticiones):
+        json.loads(texto)
+    tiempo_json = (time.perf_counter() - inicio) / repeticiones
+
+    inicio = time.perf_counter()
+    for _ in range(repeticiones):
+        decodificar(binario)
+    tiempo_binario = (time.perf_counter() - inicio) / repeticiones
+
+    print("JSON:    %5d bytes, decodificación %.1f us" % (len(texto), tiempo_json * 1e6))
+    print("Binario: %5d bytes, decodificación %.1f us" % (len(binario), tiempo_binario * 1e6))
+    print("Reducción de tamaño: %.0f%%" % (100.0 * (1 - len(binario) / len(texto))))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="comando", required=True)
+    p = sub.add_parser("decodificar", help="payload (binario o JSON) -> JSON")
+    p.add_argument("archivo")
+    p = sub.add_parser("codificar", help="JSON -> binario (stdout)")
+    p.add_argument("archivo")
+    p = sub.add_parser("comparar", help="tamaño y tiempo de decodificación frente a JSON")
+    p.add_argument("archivo")
+    p.add_argument("--repeticiones", type=int, default=1000)
+    args = parser.parse_args()
+
+    if args.comando == "decodificar":
+        with open(args.archivo, "rb") as f:
+            print(json.dumps(decodificar_payload(f.read()), indent=2, ensure_ascii=False))
+    elif args.comando == "codificar":
+        with open(args.archivo, encoding="utf-8") as f:
+            sys.stdout.buffer.write(codificar(json.load(f)))
+    else:
+        with open(args.archivo, encoding="utf-8") as f:
+            _comparar(json.load(f), args.repeticiones)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""
+Decodificador del registro de vuelo de GASLYT.
+
+Después de un reinicio el firmware sube por MQTT, en /{ID}/vuelo, lo que
+RegistroVuelo guardó en flash desde la subida anterior: advertencias,
+errores y transiciones de estado, y una entrada por arranque con el motivo
+del reinicio. Cada mensaje es un fragmento binario:
+
+    cabecera: versión (1), arranque (uint32 LE), índice (uint16 LE), último (1)
+    entradas: tipo, longitud, Fletcher-16 (uint16 LE), datos
+
+    0x1N texto (N = nivel): marca ms (uint32), longitud componente, componente, mensaje
+    0x2N token (N = nivel): marca ms (uint32), identificador (uint32) y argumentos
+    0x30 arranque: número (uint32), motivo del reinicio (esp_reset_reason_t)
+    0x40 subida: no aparece en los fragmentos
+
+Las entradas tokenizadas (firmware con -DLOG_TOKENIZADO=1) se reconstruyen
+con la tabla de tokens_log.py, que tiene que corresponder al firmware que
+las generó. Solo usa la biblioteca estándar.
+
+Uso:
+    mosquitto_sub -t '/ESP32-GASLYT-A1B2C3/vuelo' -C 1 > fragmento_0.bin
+    python3 registro_vuelo.py fragmento_*.bin [--tabla tokens_log.json]
+"""
+import argparse
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import tokens_log  # noqa: E402
+
+VERSION_FRAGMENTO = 1
+ENTRADA_TEXTO = 0x10
+ENTRADA_TOKEN = 0x20
+ENTRADA_ARRANQUE = 0x30
+ENTRADA_SUBIDA = 0x40
+NIVELES = {2: "WARN ", 3: "ERROR", 4: "TRANS"}
+MOTIVOS = ["UNKNOWN", "POWERON", "EXT", "SW", "PANIC", "INT_WDT", "TASK_WDT", "WDT",
+           "DEEPSLEEP", "BROWNOUT", "SDIO"]
+
+
+class ErrorFragmento(ValueError):
+    pass
+
+
+def calcular_suma(datos):
+    """Fletcher-16, igual que RegistroVuelo::calcularSuma."""
+    suma1 = suma2 = 0
+    for byte in datos:
+        suma1 = (suma1 + byte) % 255
+        suma2 = (suma2 + suma1) % 255
+    return (suma2 << 8) | suma1
+
+
+def leer_fragmento(datos):
+    """-> (arranque, indice, ultimo, [(tipo, datos)])"""
+    if len(datos) < 8 or datos[0] != VERSION_FRAGMENTO:
+        raise ErrorFragmento("cabecera inválida o versión desconocida")
+    arranque, indice, ultimo = struct.unpack_from("<IHB", datos, 1)
+    entradas = []
+    posicion = 8
+    while posicion < len(datos):
+        if posicion + 4 > len(datos):
+            raise ErrorFragmento("entrada cortada en el byte %d" % posicion)
+        tipo, longitud, suma = struct.unpack_from("<BBH", datos, posicion)
+        cuerpo = datos[posicion + 4:posicion + 4 + longitud]
+        if len(cuerpo) != longitud or calcular_suma(cuerpo) != suma:
+            raise ErrorFragmento("entrada dañada en el byte %d" % posicion)
+        entradas.append((tipo, cuerpo))
+        posicion += 4 + longitud
+    return arranque, indice, bool(ultimo), entradas
+
+
+def formatear_entrada(tipo, datos, tabla):
+    if tipo == ENTRADA_ARRANQUE:
+        numero, motivo = struct.unpack_from("<IB", datos)
+        nombre = MOTIVOS[motivo] if motivo < len(MOTIVOS) else str(motivo)
+        return "===== Arranque %d (reinicio: %s) =====" % (numero, nombre)
+    if tipo == ENTRADA_SUBIDA:
+        return None
+
+    clase, nivel = tipo & 0xF0, tipo & 0x0F
+    marca = struct.unpack_from("<I", datos)[0]
+    prefijo = "[%d.%03ds] [%s] " % (marca // 1000, marca % 1000, NIVELES.get(nivel, "?????"))
+    if clase == ENTRADA_TEXTO:
+        largo = datos[4]
+        componente = datos[5:5 + largo].decode("utf-8", "replace")
+        mensaje = datos[5 + largo:].decode("utf-8", "replace")
+        return prefijo + "[%s] %s" % (componente, mensaje)
+    if clase == ENTRADA_TOKEN:
+        token = struct.unpack_from("<I", datos, 4)[0]
+        entrada = tabla.get(token) if tabla else None
+        if entrada is None:
+            return prefijo + "token 0x%08x (%s)" % (token, datos[8:].hex() or "sin argumentos")
+        return prefijo + "[%s] %s" % (entrada["componente"], tokens_log.formatear(entrada["formato"], datos[8:]))
+    return "[?????] entrada de tipo 0x%02x: %s" % (tipo, datos.hex())
+
+
+def main():
+    raiz = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("fragmentos", nargs="+", help="un archivo por mensaje MQTT")
+    parser.add_argument("--tabla", default=os.path.join(raiz, tokens_log.ARCHIVO_TABLA),
+                        help="tabla de tokens (solo para firmware con LOG_TOKENIZADO)")
+    args = parser.parse_args()
+
+    tabla = tokens_log.cargar_tabla(args.tabla) if os.path.exists(args.tabla) else None
+
+    fragmentos = []
+    for ruta in args.fragmentos:
+        with open(ruta, "rb") as f:
+            try:
+                fragmentos.append(leer_fragmento(f.read()))
+            except ErrorFragmento as error:
+                sys.stderr.write("%s: %s\n" % (ruta, error))
+
+    # Una subida por arranque, en el orden de los índices
+    fragmentos.sort(key=lambda fragmento: (fragmento[0], fragmento[1]))
+    subida = None
+    esperado = 0
+    for arranque, indice, ultimo, entradas in fragmentos:
+        if arranque != subida:
+            print("##### Subida del arranque %d #####" % arranque)
+            subida, esperado = arranque, 0
+        if indice < esperado:
+            continue                            # Repetido (QoS 1 puede entregar dos veces)
+        if indice > esperado:
+            print("[?????] faltan los fragmentos %d a %d" % (esperado, indice - 1))
+        esperado = indice + 1
+        for tipo, datos in entradas:
+            linea = formatear_entrada(tipo, datos, tabla)
+            if linea is not None:
+                print(linea)
+        if ultimo:
+            print("##### Fin de la subida del arranque %d #####" % arranque)
+
+
+if __name__ == "__main__":
+    main()
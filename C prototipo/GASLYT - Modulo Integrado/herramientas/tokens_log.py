@@ -0,0 +1,332 @@
+#!/usr/bin/env python3
+"""
+Tabla de tokens y decodificador del log tokenizado de GASLYT.
+
+Con -DLOG_TOKENIZADO=1 las macros LOG_*F del firmware no envían el texto:
+escriben una trama con el identificador del formato (FNV-1a de
+"<D|I|W|E|T>|<componente>|<formato>", el mismo cálculo que
+SistemaLogging::calcularToken) y los argumentos en binario. Este script
+busca las llamadas LOG_*F en src/ e include/, arma la tabla
+identificador -> (nivel, componente, formato) y reconstruye el texto.
+
+Trama: 0x1E, longitud (1 byte), identificador (uint32 LE), marca en ms
+(varint) y argumentos según el formato: enteros (%d %u %x %c ...) varint
+zigzag, flotantes (%f %e %g) float32 LE, textos (%s) longitud varint +
+bytes. Todo lo que no es trama (líneas de texto) pasa sin cambios.
+
+Como extra_scripts de PlatformIO genera tokens_log.json en cada
+compilación y la detiene si dos formatos distintos comparten identificador.
+Solo usa la biblioteca estándar.
+
+Uso:
+    python3 tokens_log.py generar [--salida tokens_log.json]
+    pio device monitor --raw | python3 tokens_log.py decodificar
+    python3 tokens_log.py decodificar captura.bin [--tabla tokens_log.json] [--resumen]
+"""
+import argparse
+import codecs
+import json
+import os
+import re
+import struct
+import sys
+
+INICIO_TRAMA = 0x1E
+NIVELES = {"DEBUG": "D", "INFO": "I", "WARNING": "W", "ERROR": "E", "TRANSICION": "T"}
+ETIQUETAS = {"DEBUG": "DEBUG", "INFO": "INFO ", "WARNING": "WARN ", "ERROR": "ERROR", "TRANSICION": "TRANS"}
+CARPETAS = ("src", "include")
+ARCHIVO_TABLA = "tokens_log.json"
+
+LLAMADA = re.compile(
+    rb'LOG_(DEBUG|INFO|WARNING|ERROR|TRANSICION)F\(\s*"([A-Z_]+)"\s*,\s*((?:"(?:[^"\\\n]|\\.)*"\s*)+)[,)]')
+LITERAL = re.compile(rb'"((?:[^"\\\n]|\\.)*)"')
+CONVERSION = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d*))?(hh|h|ll|l|z|j|t|L)?([diouxXcsfFeEgGp%])")
+ESCAPES = {b"n": b"\n", b"t": b"\t", b"r": b"\r", b"\\": b"\\", b'"': b'"', b"'": b"'", b"?": b"?"}
+
+
+class ErrorTabla(ValueError):
+    pass
+
+
+# ---------------------------------------------------------------------------
+# Tabla de tokens
+# ---------------------------------------------------------------------------
+
+def calcular_token(nivel, componente, formato):
+    """Mismo hash que SistemaLogging::calcularToken (bytes UTF-8 del fuente)."""
+    valor = 2166136261
+    for byte in NIVELES[nivel].encode() + b"|" + componente + b"|" + formato:
+        valor = ((valor ^ byte) * 16777619) & 0xFFFFFFFF
+    return valor
+
+
+def _literal_c(texto):
+    # Escapes de C dentro de un literal: el resto son bytes UTF-8 tal cual
+    salida = bytearray()
+    i = 0
+    while i < len(texto):
+        if texto[i:i + 1] != b"\\":
+            salida += texto[i:i + 1]
+            i += 1
+            continue
+        siguiente = texto[i + 1:i + 2]
+        if siguiente == b"x":
+            digitos = re.match(rb"[0-9a-fA-F]+", texto[i + 2:]).group(0)
+            salida.append(int(digitos, 16) & 0xFF)
+            i += 2 + len(digitos)
+        elif siguiente and siguiente in b"01234567":
+            digitos = re.match(rb"[0-7]{1,3}", texto[i + 1:]).group(0)
+            salida.append(int(digitos, 8) & 0xFF)
+            i += 1 + len(digitos)
+        else:
+            salida += ESCAPES.get(siguiente, siguiente)
+            i += 2
+    return bytes(salida)
+
+
+def generar_tabla(raiz):
+    tokens = {}
+    for carpeta in CARPETAS:
+        for directorio, _, archivos in os.walk(os.path.join(raiz, carpeta)):
+            for nombre in sorted(archivos):
+                if not nombre.endswith((".cpp", ".h")):
+                    continue
+                ruta = os.path.join(directorio, nombre)
+                with open(ruta, "rb") as f:
+                    fuente = f.read()
+                for llamada in LLAMADA.finditer(fuente):
+                    nivel = llamada.group(1).decode()
+                    componente = llamada.group(2)
+                    formato = b"".join(_literal_c(m.group(1)) for m in LITERAL.finditer(llamada.group(3)))
+                    if re.search(rb"%[-+ #0]*\*|%[-+ #0]*\d*\.\*", formato):
+                        raise ErrorTabla("%s: ancho o precisión '*' no soportados" % ruta)
+
+                    token = calcular_token(nivel, componente, formato)
+                    linea = fuente.count(b"\n", 0, llamada.start()) + 1
+                    origen = "%s:%d" % (os.path.relpath(ruta, raiz).replace(os.sep, "/"), linea)
+                    entrada = {
+                        "nivel": nivel,
+                        "componente": componente.decode(),
+                        "formato": formato.decode("utf-8", "replace"),
+                        "origen": [origen],
+                    }
+
+                    clave = "0x%08x" % token
+                    anterior = tokens.get(clave)
+                    if anterior is None:
+                        tokens[clave] = entrada
+                    elif (anterior["nivel"], anterior["componente"], anterior["formato"]) == \
+                            (entrada["nivel"], entrada["componente"], entrada["formato"]):
+                        anterior["origen"].append(origen)      # Mismo mensaje en otro lugar
+                    else:
+                        raise ErrorTabla("colisión de token %s entre %s y %s: cambiar el texto de uno"
+                                         % (clave, anterior["origen"][0], origen))
+    return {"version": 1, "tokens": dict(sorted(tokens.items()))}
+
+
+def guardar_tabla(tabla, ruta):
+    with open(ruta, "w", encoding="utf-8") as f:
+        json.dump(tabla, f, indent=2, ensure_ascii=False)
+        f.write("\n")
+
+
+def cargar_tabla(ruta):
+    with open(ruta, encoding="utf-8") as f:
+        return {int(clave, 16): entrada for clave, entrada in json.load(f)["tokens"].items()}
+
+
+# ---------------------------------------------------------------------------
+# Decodificación
+# ---------------------------------------------------------------------------
+
+class _Lector:
+    def __init__(self, datos):
+        self.datos = datos
+        self.posicion = 0
+
+    def varint(self):
+        valor = 0
+        desplazamiento = 0
+        while True:
+            if self.posicion >= len(self.datos):
+                raise IndexError
+            byte = self.datos[self.posicion]
+            self.posicion += 1
+            valor |= (byte & 0x7F) << desplazamiento
+            desplazamiento += 7
+            if not byte & 0x80:
+                return valor
+
+    def entero(self):
+        valor = self.varint()
+        return (valor >> 1) ^ -(valor & 1)
+
+    def flotante(self):
+        if self.posicion + 4 > len(self.datos):
+            raise IndexError
+        valor = struct.unpack_from("<f", self.datos, self.posicion)[0]
+        self.posicion += 4
+        return valor
+
+    def texto(self):
+        longitud = self.varint()
+        valor = self.datos[self.posicion:self.posicion + longitud]
+        self.posicion += longitud
+        return valor.decode("utf-8", "replace")
+
+
+def formatear(formato, argumentos):
+    """Aplica el formato printf con los argumentos de la trama; los que no entraron quedan como <?>."""
+    lector = _Lector(argumentos)
+    completo = True
+
+    def reemplazar(conversion):
+        nonlocal completo
+        banderas, ancho, precision, _, tipo = conversion.groups()
+        if tipo == "%":
+            return "%"
+        try:
+            if tipo in "fFeEgG":
+                valor = lector.flotante()
+            elif tipo == "s":
+                valor = lector.texto()
+            else:
+                valor = lector.entero()
+        except IndexError:
+            completo = False
+            return "<?>"
+        if tipo == "p":
+            return "0x%x" % (valor & 0xFFFFFFFF)
+        if tipo in "ouxX" and valor < 0:
+            valor &= 0xFFFFFFFF                 # Como lo imprime printf en 32 bits
+        especificacion = "%" + banderas + ancho + ("." + precision if precision is not None else "") + tipo
+        return especificacion.replace("u", "d") % valor
+
+    texto = CONVERSION.sub(reemplazar, formato)
+    return texto if completo else texto + " [truncado]"
+
+
+def decodificar_trama(tabla, trama):
+    """trama: identificador + marca + argumentos (sin inicio ni longitud)."""
+    token = struct.unpack_from("<I", trama)[0]
+    lector = _Lector(trama)
+    lector.posicion = 4
+    marca = lector.varint()
+    prefijo = "[%d.%03ds] " % (marca // 1000, marca % 1000)
+
+    entrada = tabla.get(token)
+    if entrada is None:
+        return prefijo + "[?????] token 0x%08x desconocido (%d bytes): ¿tabla desactualizada?" % (token, len(trama))
+    return prefijo + "[%s] [%s] %s" % (ETIQUETAS[entrada["nivel"]], entrada["componente"],
+                                        formatear(entrada["formato"], trama[lector.posicion:]))
+
+
+class Decodificador:
+    """Separa tramas y texto de un flujo que puede llegar en pedazos."""
+
+    def __init__(self, tabla, salida):
+        self.tabla = tabla
+        self.salida = salida
+        self.pendiente = b""
+        self.texto = codecs.getincrementaldecoder("utf-8")("replace")   # Caracteres partidos entre lecturas
+        self.tramas = 0
+        self.bytes_tramas = 0
+        self.bytes_texto_equivalente = 0
+
+    def procesar(self, datos):
+        self.pendiente += datos
+        while self.pendiente:
+            inicio = self.pendiente.find(bytes([INICIO_TRAMA]))
+            if inicio != 0:
+                # Texto hasta la próxima trama (o todo, si no hay)
+                texto = self.pendiente if inicio < 0 else self.pendiente[:inicio]
+                self.salida.write(self.texto.decode(texto))
+                self.salida.flush()
+                self.pendiente = b"" if inicio < 0 else self.pendiente[inicio:]
+                continue
+            if len(self.pendiente) < 2 or len(self.pendiente) < 2 + self.pendiente[1]:
+                break                               # Trama incompleta: esperar más datos
+            longitud = self.pendiente[1]
+            trama = self.pendiente[2:2 + longitud]
+            self.pendiente = self.pendiente[2 + longitud:]
+            try:
+                linea = decodificar_trama(self.tabla, trama)
+            except (IndexError, struct.error):
+                linea = "[?????] trama inválida: %s" % trama.hex()
+            self.salida.write(linea + "\n")
+            self.salida.flush()
+            self.tramas += 1
+            self.bytes_tramas += 2 + longitud
+            self.bytes_texto_equivalente += len(linea.encode("utf-8")) + 2   # println agrega \r\n
+
+    def resumen(self):
+        if self.tramas == 0:
+            return "Sin tramas tokenizadas"
+        return "%d trama(s): %d bytes tokenizados frente a %d en texto (%.1fx menos)" % (
+            self.tramas, self.bytes_tramas, self.bytes_texto_equivalente,
+            self.bytes_texto_equivalente / self.bytes_tramas)
+
+
+# ---------------------------------------------------------------------------
+# PlatformIO y línea de comandos
+# ---------------------------------------------------------------------------
+
+def _script_platformio(env):
+    raiz = env.subst("$PROJECT_DIR")
+    try:
+        tabla = generar_tabla(raiz)
+    except ErrorTabla as error:
+        sys.stderr.write("tokens_log: %s\n" % error)
+        env.Exit(1)
+    guardar_tabla(tabla, os.path.join(raiz, ARCHIVO_TABLA))
+    print("tokens_log: %d formato(s) en %s" % (len(tabla["tokens"]), ARCHIVO_TABLA))
+
+
+def main():
+    raiz = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="comando", required=True)
+    p = sub.add_parser("generar", help="fuentes -> tabla de tokens")
+    p.add_argument("--salida", default=os.path.join(raiz, ARCHIVO_TABLA))
+    p = sub.add_parser("decodificar", help="salida serie (archivo o stdin) -> texto")
+    p.add_argument("archivo", nargs="?")
+    p.add_argument("--tabla", default=os.path.join(raiz, ARCHIVO_TABLA))
+    p.add_argument("--resumen", action="store_true", help="bytes tokenizados frente al texto equivalente")
+    args = parser.parse_args()
+
+    if args.comando == "generar":
+        try:
+            tabla = generar_tabla(raiz)
+        except ErrorTabla as error:
+            sys.exit("Error: %s" % error)
+        guardar_tabla(tabla, args.salida)
+        print("%d formato(s) en %s" % (len(tabla["tokens"]), args.salida))
+        return
+
+    decodificador = Decodificador(cargar_tabla(args.tabla), sys.stdout)
+    entrada = open(args.archivo, "rb") if args.archivo else sys.stdin.buffer
+    try:
+        while True:
+            # os.read devuelve lo disponible: sirve para seguir el puerto en vivo
+            datos = os.read(entrada.fileno(), 4096)
+            if not datos:
+                break
+            decodificador.procesar(datos)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if args.archivo:
+            entrada.close()
+    if args.resumen:
+        sys.stderr.write(decodificador.resumen() + "\n")
+
+
+try:
+    Import("env")  # noqa: F821 - definido por PlatformIO al usarlo en extra_scripts
+except NameError:
+    env = None
+
+if env is not None:
+    _script_platformio(env)
+elif __name__ == "__main__":
+    main()
@@ -0,0 +1,55 @@
+#ifndef ADQUISICIONADC_H
+#define ADQUISICIONADC_H
+
+#include <Arduino.h>
+
+// Etapa de adquisición continua del ADC.
+// Una tarea de FreeRTOS muestrea los canales a frecuencia fija, guarda las
+// muestras en un buffer circular y cada FACTOR_DECIMACION muestras publica el
+// promedio de la ventana completa. El lazo principal solo lee ese valor.
+class AdquisicionADC {
+public:
+    static const int MAX_CANALES = 4;
+    static const int TAMANO_BUFFER = 256;           // Potencia de 2
+    static const int FACTOR_DECIMACION = 256;       // Muestras por valor decimado
+    static const uint32_t PERIODO_MUESTREO_MS = 1;  // 1 kHz por canal
+
+private:
+    struct Canal {
+        int pin;
+        uint16_t buffer[TAMANO_BUFFER];  // Muestras en mV
+        uint16_t indiceEscritura;
+        uint32_t sumaVentana;
+        uint16_t muestrasEnVentana;
+        volatile float promedioMilivoltios;
+        volatile uint32_t valoresDecimados;
+    } canales[MAX_CANALES];
+
+    int cantidadCanales;
+    uint16_t contadorDecimacion;
+    TaskHandle_t tarea;
+    volatile bool activa;
+
+    static void tareaAdquisicion(void* parametro);
+    void tomarMuestras();
+
+public:
+    AdquisicionADC();
+    ~AdquisicionADC();
+
+    // Configuración
+    int agregarCanal(int pin);
+    bool iniciar();
+    void detener();
+
+    // Lectura O(1) del último valor decimado
+    float obtenerMilivoltios(int canal) const;
+    uint32_t obtenerValoresDecimados(int canal) const;
+    bool hayDatos(int canal) const;
+
+    // Estado
+    bool estaActiva() const;
+    int obtenerCantidadCanales() const;
+};
+
+#endif
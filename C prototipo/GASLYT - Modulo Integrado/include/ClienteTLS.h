@@ -0,0 +1,106 @@
+#ifndef CLIENTETLS_H
+#define CLIENTETLS_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/x509_crt.h>
+#include <mbedtls/pk.h>
+#include "SesionTLS.h"
+#include "ReanudacionTLS.h"
+
+// Cliente TLS sobre mbedTLS con reanudación de sesión, para el broker con
+// TLS (AWS IoT Core). WiFiClientSecure hace un handshake completo en cada
+// conexión y no permite cargar una sesión antes del handshake; este cliente
+// guarda la sesión (ID de sesión o ticket, RFC 5077) al conectar y la
+// ofrece en la reconexión siguiente al mismo host, evitando el intercambio
+// de claves y la verificación de certificados. La sesión también se guarda
+// en memoria RTC, así sobrevive al sueño profundo. Si el servidor no la
+// acepta se hace un handshake completo y se guarda la nueva.
+//
+// Los certificados y la clave se guardan como punteros (igual que
+// WiFiClientSecure): deben seguir vigentes mientras se use el cliente.
+class ClienteTLS : public Client {
+public:
+    static const unsigned long TIMEOUT_CONEXION_MS = 5000;     // TCP
+    static const unsigned long TIMEOUT_HANDSHAKE_MS = 10000;
+    static const unsigned long TIMEOUT_ESCRITURA_MS = 5000;
+    static const size_t TAMANO_SESION_RTC = ReanudacionTLS::TAMANO_COPIA;
+
+private:
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config configuracion;
+    mbedtls_ctr_drbg_context generador;
+    mbedtls_entropy_context entropia;
+    mbedtls_x509_crt certificadoRaiz;
+    mbedtls_x509_crt certificadoPropio;
+    mbedtls_pk_context clavePropia;
+    mbedtls_net_context red;
+
+    const char* certificadoCA;
+    const char* certificado;
+    const char* clavePrivada;
+    bool inseguro;
+
+    bool conectado;
+    int bytePeek;                       // -1 = vacío
+
+    // Sesión para reanudar (lib/ReanudacionTLS)
+    ReanudacionTLS reanudacion;
+
+    // Instrumentación
+    EstadisticasHandshake estadisticas;
+    unsigned long ultimoHandshakeMs;
+    unsigned long ultimaConexionTCPMs;
+    bool ultimoReanudado;
+
+    void liberar();
+    bool abrirSocket(const char* host, uint16_t puerto, unsigned long timeoutMs);
+    bool configurarTLS(const char* host);
+    bool hacerHandshake(bool& reanudado);
+    void guardarSesion(const char* host, uint16_t puerto);
+    void descartarSesion();
+    void restaurarSesionRTC();
+
+public:
+    ClienteTLS();
+    ~ClienteTLS();
+
+    // Credenciales (PEM)
+    void establecerCA(const char* ca);
+    void establecerCertificado(const char* cert);
+    void establecerClavePrivada(const char* clave);
+    void establecerInseguro(bool sinVerificar);     // Solo desarrollo
+
+    // Client
+    int connect(IPAddress ip, uint16_t puerto) override;
+    int connect(const char* host, uint16_t puerto) override;
+    int connect(IPAddress ip, uint16_t puerto, int32_t timeout);
+    int connect(const char* host, uint16_t puerto, int32_t timeout);
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t* datos, size_t longitud) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* destino, size_t longitud) override;
+    int peek() override;
+    void flush() override;
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override;
+
+    // Instrumentación
+    bool tieneSesion() const;
+    bool fueReanudada() const;                      // Último handshake
+    unsigned long obtenerUltimoHandshakeMs() const;
+    uint32_t obtenerHandshakesCompletos() const;
+    uint32_t obtenerHandshakesReanudados() const;
+    uint32_t obtenerPromedioCompletoMs() const;
+    uint32_t obtenerPromedioReanudadoMs() const;
+    uint32_t obtenerAceleracionCentesimas() const;  // Completo / reanudado, 0 sin datos
+    void imprimirEstadisticas() const;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef COLAPERSISTENTE_H
+#define COLAPERSISTENTE_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+// Cola de mensajes salientes en flash para los cortes de WiFi/MQTT.
+// Usa la partición "spiffs" como buffer circular de sectores de 4 KB. Cada
+// sector empieza con un número de sector creciente y guarda registros de
+// largo variable (cabecera + mensaje serializado, JSON o binario). Consumir un registro solo
+// baja bits de su byte de estado, sin borrar; el sector se borra recién al
+// reutilizarlo. Si la cola se llena se descarta el sector más antiguo.
+//
+// Al arrancar se recorre la partición para reconstruir la cola y se abre un
+// sector nuevo, así un registro a medio escribir antes de un corte de
+// energía nunca queda en la zona de escritura.
+class ColaPersistente {
+public:
+    enum TipoMensaje {
+        MENSAJE_LECTURA = 1,
+        MENSAJE_ALARMA = 2
+    };
+
+    // Formato del mensaje guardado, el vigente al encolarlo. Los registros
+    // escritos antes de guardarlo leen FORMATO_DESCONOCIDO: el primer byte
+    // lo distingue ('{' o '[' en JSON, mapa o arreglo en MessagePack)
+    enum FormatoRegistro {
+        FORMATO_DESCONOCIDO = 0,
+        FORMATO_JSON = 1,
+        FORMATO_MSGPACK = 2
+    };
+
+    static const uint32_t TAMANO_SECTOR = 4096;
+    static const uint16_t TAMANO_MAXIMO_MENSAJE = 2048;
+
+private:
+    struct CabeceraSector {
+        uint32_t marca;
+        uint32_t numero;        // Crece con cada sector abierto
+    };
+
+    struct CabeceraRegistro {
+        uint16_t marca;
+        uint16_t longitud;      // Bytes del mensaje
+        uint8_t tipo;           // Bits 0-3: TipoMensaje, 4-7: FormatoRegistro
+        uint8_t estado;
+        uint16_t suma;          // Fletcher-16 del mensaje
+    };
+
+    static const uint32_t MARCA_SECTOR = 0x50434C47;   // "GLCP"
+    static const uint16_t MARCA_REGISTRO = 0x5147;
+    static const uint8_t ESTADO_PENDIENTE = 0xFE;
+    static const uint8_t ESTADO_CONSUMIDO = 0x00;
+    static const uint8_t MASCARA_TIPO = 0x0F;
+    static const uint8_t DESPLAZAMIENTO_FORMATO = 4;
+
+    const esp_partition_t* particion;
+    uint16_t cantidadSectores;
+    bool inicializada;
+
+    // Escritura
+    uint16_t sectorEscritura;
+    uint32_t posicionEscritura;
+    uint32_t numeroSectorEscritura;
+
+    // Lectura: próximo registro a revisar
+    uint16_t sectorLectura;
+    uint32_t posicionLectura;
+
+    uint32_t pendientes;
+    uint32_t descartados;
+
+    // Último registro entregado por obtenerSiguiente()
+    uint8_t tipoActual;
+    uint8_t formatoActual;
+    uint32_t direccionActual;
+    uint16_t longitudActual;
+    bool hayActual;
+    uint8_t mensajeActual[TAMANO_MAXIMO_MENSAJE];
+
+    static uint32_t alinear(uint32_t tamano);
+    static uint16_t calcularSuma(const uint8_t* datos, size_t longitud);
+
+    bool leerCabeceraSector(uint16_t sector, CabeceraSector& cabecera) const;
+    bool leerRegistro(uint32_t direccion, CabeceraRegistro& cabecera) const;
+    uint32_t contarPendientes(uint16_t sector) const;
+    bool abrirSector(uint16_t sector, uint32_t numero);
+    bool marcarConsumido(uint32_t direccion);
+
+public:
+    ColaPersistente();
+
+    // Inicialización (recorre la partición)
+    bool inicializar();
+
+    // Encolar un mensaje serializado
+    bool encolar(TipoMensaje tipo, FormatoRegistro formato, const uint8_t* mensaje, size_t longitud);
+
+    // Drenaje en orden: obtener el más antiguo y confirmarlo recién cuando el
+    // transporte informa su entrega. El identificador (su dirección en la
+    // partición, nunca 0) sirve para reconocer esa confirmación; 0 si no hay
+    // mensaje entregado o si se perdió al llenarse la cola
+    bool obtenerSiguiente(TipoMensaje& tipo, FormatoRegistro& formato, const uint8_t*& mensaje, size_t& longitud);
+    uint32_t obtenerIdentificadorActual() const;
+    bool confirmarEnvio();
+
+    // Estado
+    bool estaInicializada() const;
+    bool hayPendientes() const;
+    uint32_t obtenerPendientes() const;
+    uint32_t obtenerDescartados() const;
+    uint32_t obtenerCapacidadBytes() const;
+    void imprimirEstado() const;
+};
+
+#endif
@@ -3,11 +3,22 @@
 
 #include <Preferences.h>
 #include <ArduinoJson.h>
+#include "PerfilesSensor.h"
 
 class ConfigManager {
+public:
+    static const int MAX_CANALES_SENSOR = 4;
+    
+    // Canal de sensor de gas (pin ADC + tipo de sensor MQ)
+    struct CanalSensor {
+        int8_t pin;
+        uint8_t tipo;
+    };
+    
 private:
     Preferences preferences;
     bool configuracionCargada;
+    uint32_t contadorArranques; // Numeración de mensajes entre reinicios
     
     // Configuraciones del sistema
     struct ConfiguracionSistema {
@@ -23,8 +34,29 @@ private:
         int pinSensorGas;
         int pinLED;
         int pinBuzzer;
+        int cantidadCanales;
+        CanalSensor canales[MAX_CANALES_SENSOR];
+        float alfaEWMA; // Suavizado de las estadísticas (0-1]
+        bool muestreoAdaptativo;
+        int intervaloMinimo; // 1-60 segundos
+        int intervaloMaximo; // 10-600 segundos
+        int horizontePrediccion; // 0-3600 segundos, 0 = sin alerta predictiva
+        int tamanoLote; // Lecturas por publicación (1-20), 1 = sin lotes
+        int tiempoLote; // Espera máxima de un lote (1-600 segundos)
+        String formatoPayload; // "json" o "msgpack"
+        int ventanaQoS; // Mensajes QoS 1 sin PUBACK (1-16)
+        bool publicacionExcepcion; // Banda muerta en lecturas
+        float bandaAbsoluta; // ppm
+        float bandaRelativa; // % del último valor publicado
+        int intervaloLatido; // Segundos: publicar aunque no haya cambios
+        bool topicsCortos; // Topics de salida abreviados
+        float r0Canales[MAX_CANALES_SENSOR];         // kΩ, 0 = sin calibrar
+        float r0ReferenciaCanales[MAX_CANALES_SENSOR]; // R0 de la última calibración
     } configuracion;
     
+    void establecerCanalesPorDefecto();
+    void reiniciarR0Canales();
+    
 public:
     ConfigManager();
     ~ConfigManager();
@@ -34,13 +66,14 @@ public:
     bool cargarConfiguracion();
     bool guardarConfiguracion();
     void resetearConfiguracion();
+    uint32_t registrarArranque();
     
     // Getters
-    String obtenerIdDispositivo() const;
+    const String& obtenerIdDispositivo() const;
     int obtenerIntervaloMedicion() const;
     float obtenerUmbralAlarma() const;
     bool esModoAWS() const;
-    String obtenerBrokerMQTT() const;
+    const String& obtenerBrokerMQTT() const;
     int obtenerPuertoMQTT() const;
     bool usarWebSocket() const;
     bool esExtractorAlambrico() const;
@@ -48,6 +81,25 @@ public:
     int obtenerPinSensorGas() const;
     int obtenerPinLED() const;
     int obtenerPinBuzzer() const;
+    int obtenerCantidadCanales() const;
+    CanalSensor obtenerCanal(int indice) const;
+    float obtenerAlfaEWMA() const;
+    bool esMuestreoAdaptativo() const;
+    int obtenerIntervaloMinimo() const;
+    int obtenerIntervaloMaximo() const;
+    int obtenerHorizontePrediccion() const;
+    int obtenerTamanoLote() const;
+    int obtenerTiempoLote() const;
+    const String& obtenerFormatoPayload() const;
+    int obtenerVentanaQoS() const;
+    bool esPublicacionExcepcion() const;
+    float obtenerBandaAbsoluta() const;
+    float obtenerBandaRelativa() const;
+    int obtenerIntervaloLatido() const;
+    bool esTopicsCortos() const;
+    float obtenerR0Canal(int indice) const;
+    float obtenerR0ReferenciaCanal(int indice) const;
+    uint32_t obtenerContadorArranques() const;
     
     // Setters
     void establecerIntervaloMedicion(int intervalo);
@@ -58,6 +110,22 @@ public:
     void establecerUsarWebSocket(bool usar);
     void establecerExtractorAlambrico(bool alambrico);
     void establecerPinExtractor(int pin);
+    bool establecerCanales(const CanalSensor* canales, int cantidad);
+    void establecerAlfaEWMA(float alfa);
+    void establecerMuestreoAdaptativo(bool adaptativo);
+    void establecerIntervaloMinimo(int intervalo);
+    void establecerIntervaloMaximo(int intervalo);
+    void establecerHorizontePrediccion(int horizonte);
+    void establecerTamanoLote(int tamano);
+    void establecerTiempoLote(int tiempo);
+    void establecerFormatoPayload(const String& formato);
+    void establecerVentanaQoS(int ventana);
+    void establecerPublicacionExcepcion(bool activa);
+    void establecerBandaAbsoluta(float banda);
+    void establecerBandaRelativa(float banda);
+    void establecerIntervaloLatido(int intervalo);
+    void establecerTopicsCortos(bool activos);
+    bool establecerR0Canales(const float* r0, const float* referencias, int cantidad);
     
     // Utilidades
     String generarIdDispositivo();
@@ -4,31 +4,38 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include "ConfigManager.h"
-#include "GasSensor.h"
+#include "GasSensorArray.h"
 #include "SistemaAlarmas.h"
 #include "SistemaLogging.h"
+#include "MQTTManager.h"
 
 class ConfiguracionRemota {
 private:
     ConfigManager* configManager;
-    GasSensor* sensorGas;
+    GasSensorArray* sensoresGas;
     SistemaAlarmas* sistemaAlarmas;
     SistemaLogging* logger;
+    MQTTManager* mqttManager;           // Para las confirmaciones; se asigna en registrarManejadores()
     
     String topicConfiguracion;
+    String topicConfirmacion;
     bool configuracionRecibida;
     unsigned long ultimaConfiguracion;
     
     // Callback para notificar cambios
     void (*callbackConfiguracionCambiada)(const String& parametro, const String& valor);
     
+    static void manejarMensaje(void* contexto, const char* topic, const uint8_t* payload, size_t longitud);
+    
 public:
     ConfiguracionRemota();
     ~ConfiguracionRemota();
     
     // Métodos principales
-    bool inicializar(ConfigManager* config, GasSensor* sensor, SistemaAlarmas* alarmas, SistemaLogging* log);
+    bool inicializar(ConfigManager* config, GasSensorArray* sensores, SistemaAlarmas* alarmas, SistemaLogging* log);
     void procesarMensajeConfiguracion(const String& payload);
+    void procesarMensajeConfiguracion(const uint8_t* payload, size_t longitud);
+    bool registrarManejadores(MQTTManager* mqtt);  // Topic propio y de la flota
     void establecerTopicConfiguracion(const String& topic);
     void establecerCallback(void (*callback)(const String&, const String&));
     
@@ -41,6 +48,22 @@ public:
     bool procesarExtractorAlambrico(bool alambrico);
     bool procesarPinExtractor(int pin);
     bool procesarNivelLogging(const String& nivel);
+    bool procesarCanalesSensor(const JsonArray& canales);
+    bool procesarAlfaEWMA(float alfa);
+    bool procesarCalibracionSensor(int canal);
+    bool procesarMuestreoAdaptativo(bool adaptativo);
+    bool procesarIntervaloMinimo(int intervalo);
+    bool procesarIntervaloMaximo(int intervalo);
+    bool procesarHorizontePrediccion(int horizonte);
+    bool procesarTamanoLote(int tamano);
+    bool procesarTiempoLote(int tiempo);
+    bool procesarFormatoPayload(const String& formato);
+    bool procesarVentanaQoS(int ventana);
+    bool procesarPublicacionExcepcion(bool activa);
+    bool procesarBandaAbsoluta(float banda);
+    bool procesarBandaRelativa(float banda);
+    bool procesarIntervaloLatido(int intervalo);
+    bool procesarTopicsCortos(bool activos);
     bool procesarConfiguracionCompleta(const JsonObject& config);
     
     // Validación de configuraciones
@@ -49,6 +72,17 @@ public:
     bool validarPuertoMQTT(int puerto);
     bool validarPinExtractor(int pin);
     bool validarNivelLogging(const String& nivel);
+    bool validarAlfaEWMA(float alfa);
+    bool validarIntervaloMinimo(int intervalo);
+    bool validarIntervaloMaximo(int intervalo);
+    bool validarHorizontePrediccion(int horizonte);
+    bool validarTamanoLote(int tamano);
+    bool validarTiempoLote(int tiempo);
+    bool validarFormatoPayload(const String& formato);
+    bool validarVentanaQoS(int ventana);
+    bool validarBandaAbsoluta(float banda);
+    bool validarBandaRelativa(float banda);
+    bool validarIntervaloLatido(int intervalo);
     
     // Respuesta a configuraciones
     void enviarConfirmacionConfiguracion(const String& parametro, bool exito, const String& mensaje = "");
@@ -62,7 +96,7 @@ public:
     
     // Getters
     ConfigManager* obtenerConfigManager() const;
-    GasSensor* obtenerSensorGas() const;
+    GasSensorArray* obtenerSensoresGas() const;
     SistemaAlarmas* obtenerSistemaAlarmas() const;
     SistemaLogging* obtenerLogger() const;
 };
@@ -0,0 +1,131 @@
+#ifndef CURVASGAS_H
+#define CURVASGAS_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Conversión Rs/R0 -> ppm por tabla generada en compilación.
+// La curva de los sensores MQ es ppm = a * ratio^b. Separando el ratio en
+// mantisa y exponente binario (ratio = m * 2^e, m en [1,2)) queda
+// ppm = (a * 2^(e*b)) * m^b: el primer factor sale de una tabla por exponente
+// y el segundo de una tabla de 65 puntos sobre [1,2] con interpolación lineal.
+// No se llama a pow() en tiempo de ejecución.
+//
+// Error relativo máximo frente a a*pow(ratio, b) en ratio [0.01, 100]:
+// 0.06% (MQ-5, la curva más pronunciada); el resto de curvas queda por debajo
+// de 0.04%. Fuera de [2^-8, 2^9) el ratio se satura al extremo de la tabla.
+// test/test_curvas_gas comprueba estas cotas (pio test -e native).
+//
+// Requiere C++14 (constexpr con bucles). Sin dependencias de Arduino para
+// poder usarse también en el nodo Nano.
+namespace CurvasGas {
+
+const int BITS_MANTISA = 6;
+const int PUNTOS_MANTISA = (1 << BITS_MANTISA) + 1;
+const int EXPONENTE_MIN = -8;
+const int EXPONENTE_MAX = 8;
+const int PUNTOS_EXPONENTE = EXPONENTE_MAX - EXPONENTE_MIN + 1;
+
+// Matemática constexpr (solo se evalúa al compilar)
+constexpr double LN2 = 0.69314718055994530942;
+
+constexpr double lnReducido(double x) {
+    // ln(x) = 2 * atanh((x-1)/(x+1)), converge rápido para x en [1,2)
+    double y = (x - 1.0) / (x + 1.0);
+    double y2 = y * y;
+    double termino = y;
+    double suma = 0.0;
+    for (int n = 1; n < 60; n += 2) {
+        suma += termino / n;
+        termino *= y2;
+    }
+    return 2.0 * suma;
+}
+
+constexpr double ln(double x) {
+    int k = 0;
+    while (x >= 2.0) { x /= 2.0; k++; }
+    while (x < 1.0) { x *= 2.0; k--; }
+    return k * LN2 + lnReducido(x);
+}
+
+constexpr double exponencial(double x) {
+    // x = k*ln2 + r, |r| <= ln2/2
+    int k = (int)(x / LN2 + (x >= 0 ? 0.5 : -0.5));
+    double r = x - k * LN2;
+    double termino = 1.0;
+    double suma = 1.0;
+    for (int n = 1; n < 30; n++) {
+        termino *= r / n;
+        suma += termino;
+    }
+    while (k > 0) { suma *= 2.0; k--; }
+    while (k < 0) { suma /= 2.0; k++; }
+    return suma;
+}
+
+constexpr double potencia(double base, double exponente) {
+    return exponencial(exponente * ln(base));
+}
+
+struct TablaCurva {
+    float a;
+    float b;
+    float mantisa[PUNTOS_MANTISA];    // m^b para m = 1 + i/64
+    float escala[PUNTOS_EXPONENTE];   // a * 2^(e*b)
+};
+
+constexpr TablaCurva generarTabla(double a, double b) {
+    TablaCurva tabla{};
+    tabla.a = (float)a;
+    tabla.b = (float)b;
+    for (int i = 0; i < PUNTOS_MANTISA; i++) {
+        tabla.mantisa[i] = (float)potencia(1.0 + (double)i / (PUNTOS_MANTISA - 1), b);
+    }
+    for (int e = EXPONENTE_MIN; e <= EXPONENTE_MAX; e++) {
+        tabla.escala[e - EXPONENTE_MIN] = (float)(a * potencia(2.0, e * b));
+    }
+    return tabla;
+}
+
+// Evaluación en tiempo de ejecución: sin pow(), sin divisiones
+inline float evaluar(const TablaCurva& tabla, float ratio) {
+    const uint32_t MASCARA_FRACCION = (1UL << (23 - BITS_MANTISA)) - 1;
+
+    if (!(ratio > 0.0f)) {
+        return tabla.escala[0] * tabla.mantisa[0];
+    }
+
+    uint32_t bits;
+    memcpy(&bits, &ratio, sizeof(bits));
+    int exponente = (int)((bits >> 23) & 0xFF) - 127;
+
+    if (exponente < EXPONENTE_MIN) {
+        return tabla.escala[0] * tabla.mantisa[0];
+    }
+    if (exponente > EXPONENTE_MAX) {
+        return tabla.escala[PUNTOS_EXPONENTE - 1] * tabla.mantisa[PUNTOS_MANTISA - 1];
+    }
+
+    uint32_t mantisa = bits & 0x7FFFFFUL;
+    uint16_t indice = (uint16_t)(mantisa >> (23 - BITS_MANTISA));
+    float fraccion = (float)(mantisa & MASCARA_FRACCION) * (1.0f / (MASCARA_FRACCION + 1));
+
+    float m = tabla.mantisa[indice] + (tabla.mantisa[indice + 1] - tabla.mantisa[indice]) * fraccion;
+    return tabla.escala[exponente - EXPONENTE_MIN] * m;
+}
+
+// Curvas de los sensores soportados por GasSensor
+constexpr TablaCurva MQ2 = generarTabla(987.99, -2.162);
+constexpr TablaCurva MQ3 = generarTabla(0.39, -1.504);
+constexpr TablaCurva MQ4 = generarTabla(1012.7, -2.786);
+constexpr TablaCurva MQ5 = generarTabla(1163.8, -3.874);
+constexpr TablaCurva MQ6 = generarTabla(2127.2, -2.526);
+constexpr TablaCurva MQ7 = generarTabla(99.042, -1.518);
+constexpr TablaCurva MQ8 = generarTabla(976.97, -0.688);
+constexpr TablaCurva MQ9 = generarTabla(599.65, -2.244);
+constexpr TablaCurva MQ135 = generarTabla(110.47, -2.862);
+
+}
+
+#endif
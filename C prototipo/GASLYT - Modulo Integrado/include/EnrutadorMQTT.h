@@ -0,0 +1,47 @@
+#ifndef ENRUTADORMQTT_H
+#define ENRUTADORMQTT_H
+
+#include <Arduino.h>
+
+// Tabla de rutas para mensajes MQTT entrantes. Cada ruta asocia un filtro
+// (admite los comodines '+' y '#' de MQTT) con un manejador que recibe el
+// buffer del transporte tal cual, sin copias intermedias. Un mensaje se
+// entrega a todas las rutas cuyo filtro coincide, como hace el broker con
+// suscripciones superpuestas.
+class EnrutadorMQTT {
+public:
+    typedef void (*Manejador)(void* contexto, const char* topic, const uint8_t* payload, size_t longitud);
+
+    static const int MAXIMO_RUTAS = 12;
+    static const int LONGITUD_MAXIMA_FILTRO = 128;
+
+private:
+    struct Ruta {
+        char filtro[LONGITUD_MAXIMA_FILTRO];
+        uint8_t longitudLiteral;        // Prefijo sin comodines: descarte rápido con memcmp
+        Manejador manejador;
+        void* contexto;
+    };
+
+    Ruta rutas[MAXIMO_RUTAS];
+    int cantidadRutas;
+
+    static bool coincide(const char* filtro, const char* topic);
+
+public:
+    EnrutadorMQTT();
+
+    // false si la tabla está llena o el filtro no es válido
+    bool registrar(const char* filtro, Manejador manejador, void* contexto);
+    static bool esFiltroValido(const char* filtro);
+
+    // Devuelve la cantidad de manejadores que recibieron el mensaje
+    int despachar(const char* topic, const uint8_t* payload, size_t longitud) const;
+
+    // Filtros distintos para suscribirse (varias rutas pueden compartir uno)
+    int obtenerCantidadRutas() const;
+    const char* obtenerFiltro(int indice) const;
+    bool esFiltroRepetido(int indice) const;
+};
+
+#endif
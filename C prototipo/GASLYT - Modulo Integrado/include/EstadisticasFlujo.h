@@ -0,0 +1,58 @@
+#ifndef ESTADISTICASFLUJO_H
+#define ESTADISTICASFLUJO_H
+
+#include <stdint.h>
+
+// Estadísticas incrementales de una señal en memoria constante.
+// - Media y varianza acumuladas con el algoritmo de Welford (estable
+//   numéricamente, sin guardar muestras).
+// - Media móvil exponencial (EWMA) con factor alfa configurable.
+// - Mínimo/máximo de ventana por bloques: se guardan el bloque en curso y el
+//   anterior, de modo que el resultado cubre entre N y 2N muestras recientes.
+class EstadisticasFlujo {
+public:
+    static const uint16_t MUESTRAS_POR_BLOQUE = 32;
+    static const float ALFA_POR_DEFECTO;
+
+private:
+    // Welford
+    uint32_t cantidad;
+    float media;
+    float m2;
+
+    // EWMA
+    float alfa;
+    float ewma;
+
+    // Mínimo/máximo por bloques
+    uint16_t muestrasBloque;
+    float minimoBloque;
+    float maximoBloque;
+    float minimoAnterior;
+    float maximoAnterior;
+    bool hayBloqueAnterior;
+
+    float ultimoValor;
+
+public:
+    EstadisticasFlujo();
+
+    void agregar(float valor);
+    void reiniciar();
+
+    // Configuración
+    void establecerAlfa(float nuevoAlfa);
+    float obtenerAlfa() const;
+
+    // Resultados
+    uint32_t obtenerCantidad() const;
+    float obtenerMedia() const;
+    float obtenerVarianza() const;
+    float obtenerDesviacion() const;
+    float obtenerEWMA() const;
+    float obtenerMinimo() const;
+    float obtenerMaximo() const;
+    float obtenerUltimoValor() const;
+};
+
+#endif
@@ -2,51 +2,55 @@
 #define GASSENSOR_H
 
 #include <Arduino.h>
-#include <MQUnifiedsensor.h>
+#include "GasSensorArray.h"
 
+// Sensor MQ individual: un GasSensorArray de un solo canal.
 class GasSensor {
 private:
-    MQUnifiedsensor* sensor;
+    GasSensorArray sensores;
+    int canal;
     int pinSensor;
-    String tipoSensor;
-    float umbralAlarma;
     float ultimaLectura;
     unsigned long ultimaMedicion;
-    bool alarmaActiva;
     
     // Configuración del sensor
     struct ConfiguracionSensor {
-        String tipo;
-        float voltaje;
         int pin;
-        String unidad;
-        float ratioAireLimpio;
+        UnidadConcentracion unidad;
     } config;
     
 public:
-    GasSensor(int pin, const String& tipo = "MQ-2");
+    GasSensor(int pin, TipoSensorMQ tipo = SENSOR_MQ2);
     ~GasSensor();
     
     // Métodos principales
     bool inicializar();
     float leerConcentracion();
     bool verificarUmbral();
-    void calibrar();
+    bool calibrar();
+    bool actualizarCalibracion();
     
     // Configuración
     void establecerUmbral(float umbral);
-    void establecerTipoSensor(const String& tipo);
+    void establecerTipoSensor(TipoSensorMQ tipo);
+    bool establecerTipoSensor(const String& tipo);
     void establecerRatioAireLimpio(float ratio);
     
     // Estado
     float obtenerUltimaLectura() const;
     bool esAlarmaActiva() const;
+    bool estaCalibrando() const;
+    int obtenerProgresoCalibracion() const;
     unsigned long obtenerTiempoUltimaMedicion() const;
     String obtenerTipoSensor() const;
+    TipoSensorMQ obtenerTipo() const;
+    const PerfilSensor& obtenerPerfil() const;
+    const EstadisticasFlujo& obtenerEstadisticas() const;
     
     // Utilidades
     void imprimirLectura() const;
     bool esLecturaValida(float lectura) const;
+    float convertirUnidades(float lectura, UnidadConcentracion unidadDestino) const;
     float convertirUnidades(float lectura, const String& unidadDestino) const;
 };
 
@@ -0,0 +1,158 @@
+#ifndef GASSENSORARRAY_H
+#define GASSENSORARRAY_H
+
+#include <Arduino.h>
+#include "AdquisicionADC.h"
+#include "PerfilesSensor.h"
+#include "EstadisticasFlujo.h"
+#include "PrediccionTendencia.h"
+
+// Conjunto de sensores MQ en una misma placa.
+// Los datos de cada etapa se guardan como estructura de arreglos (un arreglo
+// por magnitud, indexado por canal) para convertir todos los canales en un
+// único lazo sobre memoria contigua.
+class GasSensorArray {
+public:
+    static const int MAX_CANALES = AdquisicionADC::MAX_CANALES;
+
+    // Calibración en aire limpio, avanzada desde loop() sin bloquear
+    enum EstadoCalibracion {
+        CALIBRACION_INACTIVA,
+        CALIBRACION_ESTABILIZANDO,
+        CALIBRACION_MUESTREANDO,
+        CALIBRACION_COMPLETADA,
+        CALIBRACION_FALLIDA
+    };
+
+    static const unsigned long TIEMPO_ESTABILIZACION_MS = 5000;
+    static const unsigned long PERIODO_MUESTRA_CALIBRACION_MS = 1000;
+    static const int MUESTRAS_CALIBRACION = 15;
+
+    // Seguimiento de línea base: compensa la deriva lenta de R0
+    static const unsigned long VENTANA_LINEA_BASE_MS = 24UL * 60 * 60 * 1000;
+    static const uint16_t MUESTRAS_MINIMAS_LINEA_BASE = 100;
+
+private:
+    AdquisicionADC adquisicion;
+    int cantidadCanales;
+    bool inicializado;
+    unsigned long ultimaMedicion;
+
+    // Configuración por canal
+    int pines[MAX_CANALES];
+    TipoSensorMQ tipos[MAX_CANALES];
+    const PerfilSensor* perfiles[MAX_CANALES];
+    float ratiosAireLimpio[MAX_CANALES];
+    float r0[MAX_CANALES];              // kΩ
+    float umbrales[MAX_CANALES];        // ppm
+
+    // Datos por canal, una etapa por arreglo
+    float milivoltios[MAX_CANALES];
+    float rs[MAX_CANALES];              // kΩ
+    float ratios[MAX_CANALES];          // Rs/R0
+    float ppm[MAX_CANALES];
+    bool lecturasValidas[MAX_CANALES];
+    bool lecturasSaturadas[MAX_CANALES];   // ppm recortada a rangoMaximo
+    bool alarmas[MAX_CANALES];
+
+    // Estadísticas incrementales de la concentración por canal
+    EstadisticasFlujo estadisticas[MAX_CANALES];
+
+    // Tendencia reciente de la concentración por canal
+    PrediccionTendencia tendencias[MAX_CANALES];
+
+    // Calibración en curso
+    EstadoCalibracion estadoCalibracion;
+    int canalCalibracion;                   // -1 = todos los canales
+    unsigned long inicioCalibracion;
+    unsigned long ultimaMuestraCalibracion;
+    int muestrasCalibracion;
+    EstadisticasFlujo rsCalibracion[MAX_CANALES];
+
+    // Línea base: techo de Rs por ventana (en aire limpio Rs es máximo)
+    bool seguimientoLineaBase;
+    unsigned long inicioVentanaLineaBase;
+    float r0Referencia[MAX_CANALES];    // R0 de la última calibración, kΩ
+    float rsMaximoVentana[MAX_CANALES]; // kΩ
+    uint16_t muestrasLineaBase[MAX_CANALES];
+
+    static const float VOLTAJE_ALIMENTACION;
+    static const float RESISTENCIA_CARGA;   // RL en kΩ
+    static const float R0_POR_DEFECTO;      // kΩ, hasta calibrar
+    static const float DISPERSION_MAXIMA_CALIBRACION; // Desviación/media de Rs admitida
+    static const float GANANCIA_LINEA_BASE;           // Fracción del error corregida por ventana
+    static const float PASO_MAXIMO_LINEA_BASE;        // Cambio relativo máximo de R0 por ventana
+    static const float DESVIO_MAXIMO_LINEA_BASE;      // Desvío relativo máximo frente a la referencia
+
+    bool esCanalValido(int canal) const;
+    bool esCanalEnCalibracion(int canal) const;
+    void actualizarMilivoltios();
+    void convertirCanales();
+    void finalizarCalibracion();
+    void reiniciarVentanaLineaBase();
+
+public:
+    GasSensorArray();
+    ~GasSensorArray();
+
+    // Métodos principales
+    int agregarCanal(int pin, TipoSensorMQ tipo);
+    bool inicializar();
+    bool leerConcentraciones();
+    bool verificarUmbral() const;
+
+    // Configuración
+    void establecerUmbral(float umbral);
+    void establecerUmbral(int canal, float umbral);
+    void establecerTipoSensor(int canal, TipoSensorMQ tipo);
+    void establecerRatioAireLimpio(int canal, float ratio);
+    void establecerR0(int canal, float valor);
+    bool calibrarR0(int canal);
+    void establecerAlfaEWMA(float alfa);
+    void reiniciarEstadisticas();
+
+    // Calibración no bloqueante
+    bool iniciarCalibracion(int canal = -1);
+    bool actualizarCalibracion();
+    void cancelarCalibracion();
+    bool estaCalibrando() const;
+    EstadoCalibracion obtenerEstadoCalibracion() const;
+    const char* obtenerNombreEstadoCalibracion() const;
+    int obtenerProgresoCalibracion() const;
+    int obtenerCanalCalibracion() const;
+
+    // Seguimiento de línea base (llamar tras leerConcentraciones)
+    bool actualizarLineaBase();
+    void establecerSeguimientoLineaBase(bool activo);
+    void establecerR0Referencia(int canal, float valor);
+    float obtenerR0Referencia(int canal) const;
+
+    // Estado por canal
+    int obtenerCantidadCanales() const;
+    float obtenerConcentracion(int canal) const;
+    float obtenerMilivoltios(int canal) const;
+    float obtenerRs(int canal) const;
+    float obtenerRatio(int canal) const;
+    float obtenerR0(int canal) const;
+    float obtenerUmbral(int canal) const;
+    bool esLecturaValida(int canal) const;
+    bool esLecturaSaturada(int canal) const;
+    bool esAlarmaActiva(int canal) const;
+    int obtenerPin(int canal) const;
+    TipoSensorMQ obtenerTipo(int canal) const;
+    const PerfilSensor& obtenerPerfil(int canal) const;
+    const EstadisticasFlujo& obtenerEstadisticas(int canal) const;
+    const PrediccionTendencia& obtenerTendencia(int canal) const;
+    float obtenerTiempoHastaUmbral(int canal) const;
+
+    // Estado global
+    int obtenerCanalCritico() const;
+    int obtenerCanalPrediccion(float horizonte) const;
+    unsigned long obtenerTiempoUltimaMedicion() const;
+
+    // Utilidades
+    float convertirUnidades(int canal, float lectura, UnidadConcentracion unidadDestino) const;
+    void imprimirLecturas() const;
+};
+
+#endif
@@ -37,6 +37,11 @@ private:
     void (*callbackActualizacionCompletada)(const String& tipo, bool exito);
     void (*callbackErrorActualizacion)(const String& error);
     
+    // Manejadores registrados en MQTTManager
+    static void manejarComando(void* contexto, const char* topic, const uint8_t* payload, size_t longitud);
+    static void manejarMensaje(void* contexto, const char* topic, const uint8_t* payload, size_t longitud);
+    bool registrarManejadores();
+    
 public:
     GestorActualizaciones();
     ~GestorActualizaciones();
@@ -49,6 +54,7 @@ public:
     void verificarActualizacionesPeriodicas();
     bool procesarComandoActualizacion(const JsonObject& comando);
     void procesarMensajeMQTT(const String& topic, const String& payload);
+    void procesarMensajeMQTT(const char* topic, const uint8_t* payload, size_t longitud);
     
     // Actualizaciones de certificados
     bool actualizarCertificadosRemoto(const JsonObject& datos);
@@ -2,15 +2,54 @@
 #define MQTTMANAGER_H
 
 #include <WiFi.h>
-#include <PubSubClient.h>
 #include <ArduinoJson.h>
-#include <WiFiClientSecure.h>
+#include "ClienteTLS.h"
 #include <time.h>
+#include "CodificadorBinario.h"
+#include "PayloadMQTT.h"
+#include "TransporteMQTT.h"
+#include "EnrutadorMQTT.h"
+#include "PlanificadorSalida.h"
 
 class MQTTManager {
+public:
+    static const int TAMANO_MAXIMO_LOTE = 8192;     // Bytes por publicación de lote
+    static const int TAMANO_MAXIMO_PAYLOAD = 2048;  // Bytes por mensaje individual
+    
+    enum FormatoPayload {
+        FORMATO_JSON,
+        FORMATO_MSGPACK                 // Ver CodificadorBinario
+    };
+    
+    enum EstadoConexion {
+        CONEXION_INACTIVA,              // Sin reconexión automática (antes de conectar() o tras desconectar())
+        CONEXION_ESPERANDO,             // Esperando el próximo intento
+        CONEXION_CONECTANDO,            // Intento en curso (transporte asíncrono)
+        CONEXION_ACTIVA
+    };
+    
+    // Resultado de publicar: aceptar un mensaje no es haberlo enviado
+    enum ResultadoPublicacion {
+        PUBLICACION_RECHAZADA,          // No entró en la cola de salida (el llamador decide)
+        PUBLICACION_ENCOLADA,           // En la cola de salida o en el lote, esperando al transporte
+        PUBLICACION_ENVIADA             // Entregada al transporte (en QoS 1 falta el PUBACK)
+    };
+    
+    // QoS por tipo de mensaje (se limita al máximo del transporte)
+    static const uint8_t QOS_LECTURAS = 1;
+    static const uint8_t QOS_ALARMAS = 1;
+    static const uint8_t QOS_METADATA = 1;
+    static const uint8_t QOS_CALIBRACION = 0;
+    static const uint8_t QOS_EVENTOS = 1;       // Confirmaciones y estado de actualizaciones
+    static const uint8_t QOS_REGISTRO_VUELO = 1;
+    
+    // Reconexión: espera exponencial con tope y jitter
+    static const unsigned long ESPERA_RECONEXION_BASE_MS = 1000;
+    static const unsigned long ESPERA_RECONEXION_MAXIMA_MS = 120000;
+    
 private:
-    PubSubClient* clienteMQTT;
-    WiFiClientSecure* clienteSeguro;
+    TransporteMQTT* transporte;
+    ClienteTLS* clienteSeguro;
     WiFiClient* clienteNormal;
     
     String idDispositivo;
@@ -20,6 +59,14 @@ private:
     bool usarWebSocket;
     bool conectado;
     
+    // Máquina de conexión (avanza en procesarMensajes())
+    EstadoConexion estadoConexion;
+    int intentosConexion;               // Fallidos consecutivos
+    unsigned long inicioEspera;
+    unsigned long esperaReconexionMs;
+    uint32_t desconexiones;
+    uint8_t ventanaQoS;
+    
     // Configuración AWS IoT Core
     String certificadoAWS;
     String clavePrivadaAWS;
@@ -37,11 +84,46 @@ private:
     String topicAlarmas;
     String topicMetadata;
     String topicConfiguracion;
+    String topicCalibracion;
+    String topicVuelo;                  // Fragmentos del registro de vuelo
+    
+    // Topics cortos: los brokers MQTT 3.1.1 no admiten alias de topic (MQTT 5),
+    // así que el ahorro se logra con un esquema abreviado para los topics de salida
+    bool topicsCortos;
+    uint8_t ahorroTopics[4];            // Bytes menos por mensaje: lecturas, alarmas, metadata, calibración
+    uint32_t bytesAhorradosTopics;
     
-    // Callbacks
-    void (*callbackMensaje)(String, String);
-    void (*callbackConfiguracion)(String);
-    void (*callbackActualizaciones)(String);
+    // Formato de los payloads publicados
+    FormatoPayload formato;
+    uint8_t bufferPayload[TAMANO_MAXIMO_PAYLOAD];
+    
+    // Lotes de lecturas: N lecturas o T ms, lo que ocurra primero
+    int tamanoLote;                     // 1 = sin lotes
+    unsigned long tiempoMaximoLoteMs;
+    uint8_t bufferLote[TAMANO_MAXIMO_LOTE]; // Arreglo sin cerrar (JSON) o sin cabecera (MessagePack)
+    size_t longitudLote;
+    FormatoPayload formatoLote;
+    int lecturasEnLote;
+    unsigned long inicioLote;
+    
+    bool intentarConexion();
+    void programarReintento();
+    void registrarConexion();
+    void registrarDesconexion();
+    // Salida por prioridad: alarmas antes que telemetría y metadata en espera
+    PlanificadorSalida planificador;
+    TransporteMQTT::CallbackEntrega callbackEntrega;
+    ResultadoPublicacion publicarDatos(const String& topic, const uint8_t* datos, size_t longitud, uint8_t qos,
+                                       bool retener, PlanificadorSalida::Prioridad prioridad, uint32_t identificador = 0);
+    void despacharSalida();    // Informa los descartados por intentos
+    void imprimirPublicacion(const char* descripcion, const String& topic, size_t longitud) const;
+    void construirTopics();
+    size_t obtenerAhorroTopic(const String& topic) const;
+    
+    // Mensajes entrantes: rutas registradas por los módulos
+    EnrutadorMQTT enrutador;
+    static MQTTManager* instancia;      // Para el callback estático del transporte
+    bool suscribirFiltro(const char* filtro);
     
 public:
     MQTTManager();
@@ -49,10 +131,10 @@ public:
     
     // Métodos principales
     bool inicializar();
-    bool conectar();
+    bool conectar();                    // Un intento; si falla sigue procesarMensajes()
     void desconectar();
     bool verificarConexion();
-    void procesarMensajes();
+    void procesarMensajes();            // Llamar en cada loop(): mensajes y reconexión sin bloquear
     
     // Configuración
     void configurarAWS(const String& endpoint, const String& certificado, 
@@ -62,19 +144,58 @@ public:
     void establecerModoSSL(bool usar);
     void establecerModoWebSocket(bool usar);
     
-    // Publicación
-    bool publicarLectura(const JsonObject& datos);
-    bool publicarAlarma(const JsonObject& datos);
+    // Publicación. Lecturas y alarmas informan si el mensaje salió o espera;
+    // el resto devuelve true si se aceptó
+    ResultadoPublicacion publicarLectura(const JsonObject& datos);
+    ResultadoPublicacion publicarAlarma(const JsonObject& datos);
     bool publicarMetadata(const JsonObject& datos);
+    bool publicarCalibracion(const JsonObject& datos);
+    bool publicarEvento(const String& topic, const JsonObject& datos, PlanificadorSalida::Prioridad prioridad);
+    
+    // Publicación de mensajes ya serializados (cola persistente). El
+    // identificador (distinto de 0) vuelve por el callback de entrega cuando
+    // el transporte envía el mensaje (QoS 0) o recibe su PUBACK (QoS 1), o
+    // con entregado = false si la cola de salida lo descarta
+    ResultadoPublicacion publicarLecturaSerializada(const uint8_t* payload, size_t longitud, uint32_t identificador);
+    ResultadoPublicacion publicarAlarmaSerializada(const uint8_t* payload, size_t longitud, uint32_t identificador);
+    ResultadoPublicacion publicarRegistroVuelo(const uint8_t* fragmento, size_t longitud, uint32_t identificador); // Ver RegistroVuelo
+    void establecerCallbackEntrega(TransporteMQTT::CallbackEntrega callback);
+    
+    // Formato de payload: serializar() devuelve los bytes escritos, 0 si no entra
+    void establecerFormato(FormatoPayload nuevoFormato);
+    FormatoPayload obtenerFormato() const;
+    size_t serializar(const JsonObject& datos, uint8_t* destino, size_t capacidad) const;
+    
+    // QoS 1: mensajes publicados sin PUBACK que admite el transporte asíncrono
+    void configurarVentanaQoS(int tamano);
+    uint8_t obtenerEnVuelo() const;
+    
+    // Cola de salida por prioridad
+    int obtenerMensajesEnEspera() const;
+    uint32_t obtenerMensajesDescartados() const;
+    
+    // Lotes de lecturas
+    void configurarLotes(int tamano, unsigned long tiempoMaximoMs);
+    bool vaciarLote();
+    void procesarLote();
+    int obtenerLecturasEnLote() const;
     
     // Configuración de topics
     void establecerIdDispositivo(const String& id);
-    void establecerCallback(void (*callback)(String, String));
-    void establecerCallbackConfiguracion(void (*callback)(String));
-    void establecerCallbackActualizaciones(void (*callback)(String));
+    void establecerTopicsCortos(bool activos);  // "g/{id corto}/l" en lugar de "/{id}/lecturas"
+    bool usaTopicsCortos() const;
+    uint32_t obtenerBytesAhorradosTopics() const;
+    
+    // Mensajes entrantes: el manejador recibe el buffer del transporte sin
+    // copiar, válido solo durante la llamada (el transporte lo reutiliza con
+    // el mensaje siguiente). El filtro admite comodines MQTT ('+', '#'); si
+    // ya hay conexión se suscribe en el momento
+    bool registrarManejador(const String& filtro, EnrutadorMQTT::Manejador manejador, void* contexto);
     
     // Estado
     bool estaConectado() const;
+    EstadoConexion obtenerEstadoConexion() const;
+    uint32_t obtenerDesconexiones() const;
     String obtenerIdDispositivo() const;
     String obtenerBroker() const;
     int obtenerPuerto() const;
@@ -86,8 +207,6 @@ public:
     
     // Callbacks MQTT
     static void callbackMensajeRecibido(char* topic, byte* payload, unsigned int length);
-    void procesarMensajeConfiguracion(const String& payload);
-    void procesarMensajeActualizaciones(const String& payload);
 };
 
 #endif
@@ -0,0 +1,48 @@
+#ifndef MUESTREOADAPTATIVO_H
+#define MUESTREOADAPTATIVO_H
+
+#include <Arduino.h>
+
+// Intervalo de medición adaptativo.
+// La urgencia (0-1) sale del nivel de la señal respecto del umbral y de su
+// variación entre mediciones. Con urgencia alta el intervalo baja de
+// inmediato hacia el mínimo; con la señal plana se alarga de a poco hasta
+// el máximo. Desactivado, se usa el intervalo fijo configurado.
+class MuestreoAdaptativo {
+public:
+    static const float NIVEL_REPOSO;          // Fracción del umbral sin urgencia
+    static const float NIVEL_URGENTE;         // Fracción del umbral con urgencia máxima
+    static const float VARIACION_URGENTE;     // Cambio de fracción por medición con urgencia máxima
+    static const float FACTOR_RETROCESO;      // Crecimiento del intervalo por medición en calma
+
+private:
+    bool activo;
+    unsigned long intervaloFijoMs;
+    unsigned long intervaloMinimoMs;
+    unsigned long intervaloMaximoMs;
+    unsigned long intervaloActualMs;
+
+    float nivelAnterior;
+    bool hayNivelAnterior;
+    float urgencia;
+
+    unsigned long limitarIntervalo(unsigned long intervalo) const;
+
+public:
+    MuestreoAdaptativo();
+
+    // Configuración (segundos)
+    void configurar(int intervaloFijo, int intervaloMinimo, int intervaloMaximo, bool adaptativo);
+
+    // nivel = concentración / umbral del canal más comprometido
+    unsigned long actualizar(float nivel);
+    void reiniciar();
+
+    // Estado
+    bool estaActivo() const;
+    unsigned long obtenerIntervaloMs() const;
+    float obtenerUrgencia() const;
+    void imprimirEstado() const;
+};
+
+#endif
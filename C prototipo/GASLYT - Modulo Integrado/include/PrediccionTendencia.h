@@ -0,0 +1,42 @@
+#ifndef PREDICCIONTENDENCIA_H
+#define PREDICCIONTENDENCIA_H
+
+#include <stdint.h>
+
+// Tendencia de una señal por mínimos cuadrados sobre las últimas lecturas.
+// Guarda (tiempo, valor) en un buffer circular, ajusta una recta y proyecta
+// cuánto falta para que la recta cruce un umbral. Los tiempos son los de
+// cada lectura, por lo que admite intervalos de medición variables.
+class PrediccionTendencia {
+public:
+    static const int TAMANO_VENTANA = 16;
+    static const int MUESTRAS_MINIMAS = 4;
+    static const float SIN_CRUCE;   // Tiempo devuelto si la tendencia no llega al umbral
+
+private:
+    unsigned long tiempos[TAMANO_VENTANA];  // ms
+    float valores[TAMANO_VENTANA];
+    int indice;
+    int cantidad;
+
+    // Resultado del último ajuste
+    float pendiente;        // unidades por segundo
+    float valorAjustado;    // valor de la recta en la última lectura
+
+    void ajustar();
+
+public:
+    PrediccionTendencia();
+
+    void agregar(unsigned long tiempoMs, float valor);
+    void reiniciar();
+
+    // Resultados
+    bool hayTendencia() const;
+    float obtenerPendiente() const;
+    float obtenerValorAjustado() const;
+    float obtenerTiempoHastaUmbral(float umbral) const;  // segundos
+    int obtenerCantidad() const;
+};
+
+#endif
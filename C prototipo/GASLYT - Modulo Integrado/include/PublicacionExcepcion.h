@@ -0,0 +1,60 @@
+#ifndef PUBLICACIONEXCEPCION_H
+#define PUBLICACIONEXCEPCION_H
+
+#include <Arduino.h>
+
+// Publicación por excepción (banda muerta) de las lecturas.
+// Una lectura se publica si algún canal se movió más que la banda desde el
+// último valor publicado, si cambió el estado de alarma de algún canal, si
+// hay una alarma activa o si venció el latido. Si no, se suprime y se
+// cuenta. La banda es la mayor entre la absoluta (ppm) y la relativa (%
+// del último valor publicado): la absoluta evita publicar ruido cerca de
+// cero. Desactivada, se publican todas las lecturas.
+class PublicacionExcepcion {
+public:
+    static const int MAX_CANALES = 4;
+
+    enum Motivo {
+        MOTIVO_SUPRIMIDA,
+        MOTIVO_DESACTIVADA,
+        MOTIVO_PRIMERA,
+        MOTIVO_VARIACION,
+        MOTIVO_ALARMA,
+        MOTIVO_LATIDO
+    };
+
+private:
+    bool activo;
+    float bandaAbsoluta;
+    float bandaRelativa;                // Fracción (0.05 = 5 %)
+    unsigned long latidoMs;
+
+    // Referencia: último valor publicado por canal
+    float publicadas[MAX_CANALES];
+    bool alarmasPublicadas[MAX_CANALES];
+    int cantidadCanales;
+    bool hayReferencia;
+    unsigned long ultimaPublicacion;
+
+    uint32_t suprimidas;
+    uint32_t publicadasTotal;
+
+public:
+    PublicacionExcepcion();
+
+    // bandaRelativa en %, latido en segundos
+    void configurar(bool activar, float bandaAbsoluta, float bandaRelativa, int latido);
+
+    // Decide sobre una lectura completa; si se publica, pasa a ser la referencia
+    Motivo evaluar(const float* concentraciones, const bool* alarmas, int cantidad, unsigned long ahora);
+    void reiniciar();                   // La próxima lectura se publica
+
+    // Estado
+    bool estaActivo() const;
+    uint32_t obtenerSuprimidas() const;
+    uint32_t obtenerPublicadas() const;
+    static const char* obtenerNombreMotivo(Motivo motivo);
+    void imprimirEstado() const;
+};
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef REGISTROVUELO_H
+#define REGISTROVUELO_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Registro de vuelo: las advertencias, errores y transiciones de estado de
+// SistemaLogging se guardan en binario en la partición "vuelo" para
+// revisarlas después de un reinicio. Es un buffer circular de sectores de
+// 4 KB (como ColaPersistente) con entradas de largo variable que no cruzan
+// sectores; solo se agrega, y cada sector se borra recién al reutilizarlo.
+//
+// Las entradas se juntan en una página de 256 bytes en memoria RTC y se
+// escriben de a una página: cada byte se programa una sola vez y la flash
+// no se toca con cada mensaje. La memoria RTC sobrevive a pánicos, watchdog
+// y reinicios por software, así la página pendiente se recupera al arrancar;
+// solo se pierde ante un corte de energía.
+//
+// Al arrancar se agrega una entrada con el número de arranque y el motivo
+// del reinicio, y lo que no se subió todavía queda pendiente para subirlo
+// por MQTT en fragmentos. Al terminar se agrega una marca de subida.
+class RegistroVuelo {
+public:
+    enum TipoEntrada {
+        ENTRADA_TEXTO = 0x10,           // | nivel: marca ms, componente, mensaje
+        ENTRADA_TOKEN = 0x20,           // | nivel: marca ms, identificador y argumentos (LOG_TOKENIZADO)
+        ENTRADA_ARRANQUE = 0x30,        // Número de arranque y motivo del reinicio
+        ENTRADA_SUBIDA = 0x40           // Lo anterior a la posición indicada ya se subió
+    };
+
+    static const uint32_t TAMANO_SECTOR = 4096;
+    static const uint16_t TAMANO_PAGINA = 256;
+    static const uint16_t TAMANO_FRAGMENTO = 1024;      // Por mensaje MQTT, con la cabecera
+    static const uint8_t VERSION_FRAGMENTO = 1;
+    static const unsigned long PERIODO_VOLCADO_MS = 60000;  // Página pendiente más antigua que esto: a flash
+
+private:
+    struct CabeceraSector {
+        uint32_t marca;
+        uint32_t numero;                // Crece con cada sector abierto
+    };
+
+    struct CabeceraEntrada {
+        uint8_t tipo;                   // 0xFF = flash borrada: fin de las entradas
+        uint8_t longitud;               // Bytes de datos después de la cabecera
+        uint16_t suma;                  // Fletcher-16 de los datos
+    };
+
+    static const uint32_t MARCA_SECTOR = 0x56524C47;   // "GLRV"
+    static const size_t CABECERA_FRAGMENTO = 8;         // Versión, arranque, índice, último
+
+    const esp_partition_t* particion;
+    uint16_t cantidadSectores;
+    bool inicializado;
+    SemaphoreHandle_t cerrojo;          // La tarea de logging escribe, loop() sube
+    uint32_t arranque;
+
+    // Escritura (la página pendiente va a continuación de posicionEscritura)
+    uint16_t sectorEscritura;
+    uint32_t posicionEscritura;
+    uint32_t numeroSectorEscritura;
+    unsigned long inicioPagina;
+
+    // Subida: desde la última marca hasta el fin fijado al arrancar
+    bool subidaPendiente;
+    uint16_t sectorSubida;
+    uint32_t posicionSubida;
+    uint16_t sectorFinSubida;
+    uint32_t posicionFinSubida;
+    uint32_t numeroFinSubida;
+    uint16_t indiceFragmento;
+
+    // Último fragmento entregado por obtenerFragmento()
+    bool hayFragmento;
+    bool fragmentoFinal;
+    size_t longitudFragmento;
+    uint16_t sectorSiguiente;
+    uint32_t posicionSiguiente;
+    uint8_t fragmento[TAMANO_FRAGMENTO];
+
+    // Estadísticas
+    uint32_t entradas;
+    uint32_t bytesEntradas;
+    uint32_t escrituras;
+    uint32_t borrados;
+    uint32_t descartadas;               // Dañadas o pisadas antes de subirlas
+
+    static uint16_t calcularSuma(const uint8_t* datos, size_t longitud);
+    static bool esReinicioAnomalo(int motivo);
+
+    bool buscarExtremos(uint16_t& antiguo, uint16_t& reciente, uint32_t& numeroReciente) const;
+    bool leerCabeceraSector(uint16_t sector, CabeceraSector& cabecera) const;
+    bool leerEntrada(uint16_t sector, uint32_t posicion, CabeceraEntrada& cabecera) const;
+    bool estaBorrado(uint16_t sector, uint32_t posicion) const;
+    bool abrirSector(uint16_t sector, uint32_t numero);
+    bool agregarEntrada(uint8_t tipo, const uint8_t* datos, size_t longitud);
+    bool volcarPagina();
+    void recuperarPagina();
+    bool esFinSubida(uint16_t sector, uint32_t posicion) const;
+    bool ubicarEntrada(uint16_t& sector, uint32_t& posicion, CabeceraEntrada& cabecera) const;
+
+public:
+    RegistroVuelo();
+    ~RegistroVuelo();
+
+    // Inicialización (recorre la partición y recupera la página pendiente)
+    bool inicializar(uint32_t numeroArranque);
+
+    // Entradas (desde SistemaLogging)
+    bool agregarTexto(uint8_t nivel, uint32_t marcaMs, const char* componente, const char* mensaje);
+    bool agregarToken(uint8_t nivel, uint32_t marcaMs, const uint8_t* datos, size_t longitud);
+    bool volcar();                      // Escribir la página pendiente
+    void procesar();                    // Llamar en loop(): vuelca la página si es vieja
+
+    // Subida en orden: obtener un fragmento y confirmarlo tras publicarlo
+    bool haySubidaPendiente() const;
+    bool obtenerFragmento(const uint8_t*& datos, size_t& longitud);
+    bool confirmarFragmento();
+
+    // Estado
+    bool estaInicializado() const;
+    uint32_t obtenerCapacidadBytes() const;
+    uint32_t obtenerEscrituras() const;
+    uint32_t obtenerBorrados() const;
+    void imprimirEstado() const;
+};
+
+#endif
@@ -5,12 +5,7 @@
 #include <Adafruit_NeoPixel.h>
 
 class SistemaAlarmas {
-private:
-    Adafruit_NeoPixel* ledRGB;
-    int pinBuzzer;
-    int pinExtractor;
-    bool extractorAlambrico;
-    
+public:
     // Estados del sistema
     enum EstadoSistema {
         NORMAL,
@@ -18,7 +13,15 @@ private:
         ALARMA,
         SIN_WIFI,
         ERROR_SENSOR
-    } estadoActual;
+    };
+    
+private:
+    Adafruit_NeoPixel* ledRGB;
+    int pinBuzzer;
+    int pinExtractor;
+    bool extractorAlambrico;
+    
+    EstadoSistema estadoActual;
     
     // Configuración de colores
     struct ColorRGB {
@@ -92,6 +95,7 @@ public:
     EstadoSistema obtenerEstadoActual() const;
     bool esAlarmaActiva() const;
     bool esExtractorActivo() const;
+    static const char* obtenerNombreEstado(EstadoSistema estado);
     
     // Utilidades
     void imprimirEstado() const;
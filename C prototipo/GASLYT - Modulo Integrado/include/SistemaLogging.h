@@ -4,27 +4,170 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <time.h>
+#include <atomic>
+#include <type_traits>
+#include <freertos/semphr.h>
 
+class RegistroVuelo;
+
+// Nivel mínimo compilado (0 = DEBUG, 1 = INFO, 2 = WARNING, 3 = ERROR). Las
+// macros LOG_* por debajo de este nivel no generan código ni evalúan el mensaje
+#ifndef NIVEL_LOG_MINIMO
+#define NIVEL_LOG_MINIMO 0
+#endif
+
+// Modo tokenizado: las macros LOG_*F no guardan ni escriben el formato, solo
+// un identificador de 32 bits (hash del nivel, componente y formato, calculado
+// al compilar) y los argumentos en binario. herramientas/tokens_log.py arma la
+// tabla de identificadores desde las fuentes y reconstruye el texto en la PC
+#ifndef LOG_TOKENIZADO
+#define LOG_TOKENIZADO 0
+#endif
+
+// Las llamadas de log no escriben en Serial: copian el mensaje en un
+// registro de tamaño fijo dentro de un buffer circular sin bloqueos
+// (cola acotada de Vyukov, varios productores y un consumidor). Una tarea de
+// baja prioridad arma la línea (hora, color, nivel, componente) y la
+// escribe. Si el buffer está lleno el registro se descarta y se cuenta;
+// los mensajes más largos que LONGITUD_MENSAJE se truncan.
+//
+// Sin la tarea (antes de inicializar() o si no se pudo crear) cada productor
+// escribe en el momento, tomando cerrojoSalida para que haya un solo consumidor.
+//
+// Con un RegistroVuelo asociado, la tarea de salida copia además las
+// advertencias, errores y transiciones a flash para revisarlos tras un reinicio.
 class SistemaLogging {
-private:
+public:
+    static const int CAPACIDAD_REGISTROS = 64;      // Potencia de 2
+    static const int LONGITUD_MENSAJE = 120;
+    static const int LONGITUD_COMPONENTE = 15;
+    static const uint32_t PERIODO_SALIDA_MS = 10;   // Espera de la tarea de salida con el buffer vacío
+    
     enum NivelLog {
         DEBUG = 0,
         INFO = 1,
         WARNING = 2,
-        ERROR = 3
+        ERROR = 3,
+        TRANSICION = 4          // Cambio de estado: siempre activo, va al registro de vuelo
+    };
+    
+    // Componentes con nivel propio: la tabla se indexa sin recorrer nombres
+    enum Componente {
+        COMP_SISTEMA,
+        COMP_SENSOR,
+        COMP_WIFI,
+        COMP_MQTT,
+        COMP_ALARMAS,
+        COMP_CONFIG,
+        COMP_ENERGIA,
+        COMP_CONFIG_REMOTA,
+        COMP_ACTUALIZACIONES,
+        CANTIDAD_COMPONENTES
     };
+    static const uint8_t NIVEL_GLOBAL = 0xFF;       // El componente usa el nivel general
+    
+    // Trama tokenizada: INICIO_TRAMA, longitud, identificador (4 bytes LE),
+    // marca en ms (varint) y argumentos (enteros varint zigzag, flotantes
+    // float32 LE, textos longitud varint + bytes). 0x1E no aparece en texto
+    static const uint8_t INICIO_TRAMA = 0x1E;
     
+    // FNV-1a de "<D|I|W|E|T>|<componente>|<formato>"; igual que tokens_log.py
+    static constexpr uint32_t calcularToken(int nivel, const char* componente, const char* formato) {
+        uint32_t hash = 2166136261u;
+        hash = (hash ^ (uint8_t)"DIWET"[nivel <= TRANSICION ? nivel : 0]) * 16777619u;
+        hash = (hash ^ (uint8_t)'|') * 16777619u;
+        for (const char* c = componente; *c; c++) {
+            hash = (hash ^ (uint8_t)*c) * 16777619u;
+        }
+        hash = (hash ^ (uint8_t)'|') * 16777619u;
+        for (const char* c = formato; *c; c++) {
+            hash = (hash ^ (uint8_t)*c) * 16777619u;
+        }
+        return hash;
+    }
+
+private:
     NivelLog nivelActual;
+    uint8_t nivelesComponente[CANTIDAD_COMPONENTES];
     bool habilitado;
     bool incluirTimestamp;
     bool incluirNivel;
     bool incluirComponente;
     
+    struct Registro {
+        uint32_t marcaMs;
+        uint32_t hora;                              // Epoch; 0 = sin hora válida
+        uint8_t nivel;                              // NIVEL_SEPARADOR: línea sin prefijo
+        uint8_t longitudToken;                      // Bytes de mensaje en registros tokenizados
+        char componente[LONGITUD_COMPONENTE + 1];
+        char mensaje[LONGITUD_MENSAJE];
+    };
+    
+    struct Celda {
+        std::atomic<uint32_t> secuencia;            // Turno de la celda (productor o consumidor)
+        Registro registro;
+    };
+    
+    static const uint8_t NIVEL_SEPARADOR = 0xFF;
+    static const uint8_t BANDERA_TOKEN = 0x80;      // En nivel: mensaje = identificador + argumentos
+    
+    // Argumentos de un registro tokenizado; al no entrar uno, se cortan los siguientes
+    struct EscritorToken {
+        uint8_t* datos;
+        uint8_t longitud;
+        bool truncado;
+        
+        void agregarVarint(uint64_t valor);
+        void agregarEntero(int64_t valor);
+        void agregarFlotante(float valor);
+        void agregarTexto(const char* texto);
+        
+        template <typename T>
+        void agregar(const T& valor) {
+            using Tipo = std::decay_t<T>;
+            if constexpr (std::is_floating_point_v<Tipo>) {
+                agregarFlotante((float)valor);
+            } else if constexpr (std::is_integral_v<Tipo> || std::is_enum_v<Tipo>) {
+                agregarEntero((int64_t)valor);
+            } else if constexpr (std::is_same_v<Tipo, String>) {
+                agregarTexto(valor.c_str());
+            } else {
+                agregarTexto(valor);
+            }
+        }
+    };
+    
+    Celda celdas[CAPACIDAD_REGISTROS];
+    std::atomic<uint32_t> cabeza;                   // Próxima posición a reservar
+    std::atomic<uint32_t> cola;                     // Próxima a escribir (un solo consumidor)
+    TaskHandle_t tareaSalida;
+    SemaphoreHandle_t cerrojoSalida;                // Sin tarea de salida, consume un productor por vez
+    RegistroVuelo* registroVuelo;
+    
+    // Estadísticas
+    std::atomic<uint32_t> descartados;
+    std::atomic<uint32_t> truncados;
+    uint32_t descartadosInformados;
+    std::atomic<uint32_t> ocupacionMaxima;
+    
+    Registro* reservar(uint32_t& posicion);
+    void confirmar(uint32_t posicion);
+    void encolar(uint8_t nivel, const char* componente, const char* mensaje);
+    void encolarFormato(uint8_t nivel, const char* componente, const char* formato, va_list argumentos);
+    Registro* reservarToken(NivelLog nivel, uint32_t token, uint32_t& posicion, EscritorToken& escritor);
+    void confirmarToken(uint32_t posicion, Registro* registro, const EscritorToken& escritor);
+    static bool interpretarNiveles(const String& especificacion, NivelLog& global, bool& hayGlobal, uint8_t* niveles);
+    bool escribirSiguiente();
+    void escribirPendientes();
+    void escribirRegistro(const Registro& registro);
+    static void tareaEscritura(void* parametro);
+    
     // Colores para terminal (ANSI)
     static const String COLOR_DEBUG;
     static const String COLOR_INFO;
     static const String COLOR_WARNING;
     static const String COLOR_ERROR;
+    static const String COLOR_TRANSICION;
     static const String COLOR_RESET;
     
     // Componentes del sistema
@@ -45,6 +188,7 @@ public:
     void establecerNivel(NivelLog nivel);
     void habilitarLogging(bool habilitar);
     void configurarFormato(bool timestamp, bool nivel, bool componente);
+    void establecerRegistroVuelo(RegistroVuelo* registro);     // nullptr = sin registro de vuelo
     
     // Métodos de logging
     void debug(const String& componente, const String& mensaje);
@@ -58,6 +202,37 @@ public:
     void warningf(const String& componente, const String& formato, ...);
     void errorf(const String& componente, const String& formato, ...);
     
+    // Filtro: nivel general y excepciones por componente
+    bool estaActivo(NivelLog nivel, const char* componente) const;
+    void establecerNivelComponente(int indice, uint8_t nivel);   // NIVEL_GLOBAL = usar el general
+    uint8_t obtenerNivelComponente(int indice) const;
+    static int obtenerIndiceComponente(const char* nombre);     // -1 si no tiene nivel propio
+    static const char* obtenerNombreComponente(int indice);
+    static bool interpretarNivel(const String& texto, NivelLog& nivel);
+    
+    // "INFO,MQTT=DEBUG,SENSOR=WARNING": nivel general y excepciones. Los
+    // componentes no nombrados vuelven al general. Nada cambia si hay errores
+    bool aplicarNiveles(const String& especificacion);
+    static bool esEspecificacionValida(const String& especificacion);
+    
+    // Registro sin filtrar, para las macros (ya filtraron)
+    void registrar(NivelLog nivel, const char* componente, const String& mensaje);
+    void registrar(NivelLog nivel, const char* componente, const char* mensaje);
+    void registrarf(NivelLog nivel, const char* componente, const char* formato, ...)
+        __attribute__((format(printf, 4, 5)));
+    
+    // Registro tokenizado (LOG_TOKENIZADO): identificador y argumentos sin formatear
+    template <typename... Argumentos>
+    void registrarToken(NivelLog nivel, uint32_t token, const Argumentos&... argumentos) {
+        uint32_t posicion;
+        EscritorToken escritor;
+        Registro* registro = reservarToken(nivel, token, posicion, escritor);
+        if (registro) {
+            (escritor.agregar(argumentos), ...);
+            confirmarToken(posicion, registro, escritor);
+        }
+    }
+    
     // Métodos de logging de estado
     void logEstadoSistema();
     void logEstadoSensor();
@@ -72,6 +247,7 @@ public:
     String obtenerNivelString(NivelLog nivel) const;
     String obtenerColorNivel(NivelLog nivel) const;
     void imprimirSeparador(const String& titulo = "");
+    void vaciar(unsigned long timeoutMs = 500);     // Esperar la salida pendiente y el registro de vuelo (antes de reiniciar o dormir)
     
     // Getters
     NivelLog obtenerNivelActual() const;
@@ -79,19 +255,14 @@ public:
     bool incluyeTimestamp() const;
     bool incluyeNivel() const;
     bool incluyeComponente() const;
+    
+    // Buffer de registros
+    uint32_t obtenerRegistrosDescartados() const;
+    uint32_t obtenerRegistrosTruncados() const;
+    uint32_t obtenerOcupacionMaxima() const;
+    int obtenerRegistrosPendientes() const;
 };
 
-// Macros para facilitar el uso
-#define LOG_DEBUG(componente, mensaje) SistemaLogging::getInstance().debug(componente, mensaje)
-#define LOG_INFO(componente, mensaje) SistemaLogging::getInstance().info(componente, mensaje)
-#define LOG_WARNING(componente, mensaje) SistemaLogging::getInstance().warning(componente, mensaje)
-#define LOG_ERROR(componente, mensaje) SistemaLogging::getInstance().error(componente, mensaje)
-
-#define LOG_DEBUGF(componente, formato, ...) SistemaLogging::getInstance().debugf(componente, formato, __VA_ARGS__)
-#define LOG_INFOF(componente, formato, ...) SistemaLogging::getInstance().infof(componente, formato, __VA_ARGS__)
-#define LOG_WARNINGF(componente, formato, ...) SistemaLogging::getInstance().warningf(componente, formato, __VA_ARGS__)
-#define LOG_ERRORF(componente, formato, ...) SistemaLogging::getInstance().errorf(componente, formato, __VA_ARGS__)
-
 // Singleton para acceso global
 class SistemaLoggingSingleton {
 private:
@@ -103,4 +274,57 @@ public:
     static void destruir();
 };
 
+// Macros para facilitar el uso. A diferencia de logger->info(...), el
+// mensaje se arma solo si el nivel está activo; por debajo de
+// NIVEL_LOG_MINIMO la llamada desaparece al compilar. Las LOG_*F aceptan
+// solo un literal como formato (puede no llevar argumentos): así
+// tokens_log.py las encuentra y, con LOG_TOKENIZADO, el texto no se compila
+#define LOG_REGISTRAR(nivel, componente, mensaje) \
+    do { \
+        if ((nivel) >= NIVEL_LOG_MINIMO && SistemaLoggingSingleton::getInstance().estaActivo((nivel), (componente))) { \
+            SistemaLoggingSingleton::getInstance().registrar((nivel), (componente), (mensaje)); \
+        } \
+    } while (0)
+
+#if LOG_TOKENIZADO
+#define LOG_REGISTRARF(nivel, componente, formato, ...) \
+    do { \
+        if ((nivel) >= NIVEL_LOG_MINIMO && SistemaLoggingSingleton::getInstance().estaActivo((nivel), (componente))) { \
+            constexpr uint32_t tokenLog_ = SistemaLogging::calcularToken((nivel), (componente), (formato)); \
+            SistemaLoggingSingleton::getInstance().registrarToken((nivel), tokenLog_, ##__VA_ARGS__); \
+        } \
+    } while (0)
+#else
+#define LOG_REGISTRARF(nivel, componente, formato, ...) \
+    do { \
+        if ((nivel) >= NIVEL_LOG_MINIMO && SistemaLoggingSingleton::getInstance().estaActivo((nivel), (componente))) { \
+            SistemaLoggingSingleton::getInstance().registrarf((nivel), (componente), (formato), ##__VA_ARGS__); \
+        } \
+    } while (0)
+#endif
+
+#define LOG_DEBUG(componente, mensaje) LOG_REGISTRAR(SistemaLogging::DEBUG, componente, mensaje)
+#define LOG_INFO(componente, mensaje) LOG_REGISTRAR(SistemaLogging::INFO, componente, mensaje)
+#define LOG_WARNING(componente, mensaje) LOG_REGISTRAR(SistemaLogging::WARNING, componente, mensaje)
+#define LOG_ERROR(componente, mensaje) LOG_REGISTRAR(SistemaLogging::ERROR, componente, mensaje)
+#define LOG_TRANSICION(componente, mensaje) LOG_REGISTRAR(SistemaLogging::TRANSICION, componente, mensaje)
+
+#define LOG_DEBUGF(componente, formato, ...) LOG_REGISTRARF(SistemaLogging::DEBUG, componente, formato, ##__VA_ARGS__)
+#define LOG_INFOF(componente, formato, ...) LOG_REGISTRARF(SistemaLogging::INFO, componente, formato, ##__VA_ARGS__)
+#define LOG_WARNINGF(componente, formato, ...) LOG_REGISTRARF(SistemaLogging::WARNING, componente, formato, ##__VA_ARGS__)
+#define LOG_ERRORF(componente, formato, ...) LOG_REGISTRARF(SistemaLogging::ERROR, componente, formato, ##__VA_ARGS__)
+#define LOG_TRANSICIONF(componente, formato, ...) LOG_REGISTRARF(SistemaLogging::TRANSICION, componente, formato, ##__VA_ARGS__)
+
+// Igual que las macros, para mensajes que se arman en varios pasos:
+//   logDiferido<SistemaLogging::DEBUG>("SENSOR", [&] { return "Rs: " + String(rs, 2); });
+template <int Nivel, typename Generador>
+inline void logDiferido(const char* componente, Generador&& generador) {
+    if constexpr (Nivel >= NIVEL_LOG_MINIMO) {
+        SistemaLogging& logging = SistemaLoggingSingleton::getInstance();
+        if (logging.estaActivo((SistemaLogging::NivelLog)Nivel, componente)) {
+            logging.registrar((SistemaLogging::NivelLog)Nivel, componente, generador());
+        }
+    }
+}
+
 #endif
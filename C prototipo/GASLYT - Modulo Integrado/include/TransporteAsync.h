@@ -0,0 +1,115 @@
+#ifndef TRANSPORTEASYNC_H
+#define TRANSPORTEASYNC_H
+
+#if TRANSPORTE_ASYNC_MQTT
+
+#include <AsyncMqttClient.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "TransporteMQTT.h"
+#include "VentanaQoS.h"
+
+// Transporte sobre AsyncMqttClient: conexión y publicación no bloqueantes,
+// con QoS 1 real. Cada mensaje QoS 1 ocupa un lugar de la VentanaQoS
+// (lib/ClienteMQTT) hasta recibir su PUBACK; con la ventana llena publicar()
+// devuelve false. Al reconectar, los que siguen sin confirmar se reenvían
+// con DUP y el mismo identificador de paquete (MQTT 3.1.1, 4.4).
+//
+// Los callbacks de AsyncMqttClient corren en la tarea de AsyncTCP: solo
+// dejan eventos en una cola de FreeRTOS que procesar() atiende en loop().
+// Los mensajes entrantes se copian a un anillo (8 mensajes, 8 KB) que
+// procesar() vacía entero: al conectar llegan seguidos los retenidos de
+// todas las suscripciones. Con el anillo lleno la tarea de AsyncTCP espera
+// hasta 250 ms a que loop() libere lugar, sin leer más paquetes; solo
+// después se descarta el mensaje (entrantesDescartados).
+// AsyncTCP no implementa TLS en el core de ESP32, por eso este transporte
+// se usa solo con brokers sin SSL (modo DEV).
+class TransporteAsync : public TransporteMQTT {
+public:
+    static const unsigned long TIEMPO_MAXIMO_PUBACK_MS = 30000; // Sin PUBACK: reconectar y reenviar
+    static const unsigned long TIEMPO_MAXIMO_CONEXION_MS = 10000;
+    static const size_t TAMANO_MENSAJE_ENTRANTE = 2048;
+    static const uint8_t MAXIMO_ENTRANTES = 8;
+    static const size_t TAMANO_MEMORIA_ENTRADA = 8192;          // Topic + '\0' + payload + '\0' por mensaje
+    static const unsigned long ESPERA_MAXIMA_ENTRADA_MS = 250;
+
+private:
+    enum TipoEvento {
+        EVENTO_CONECTADO,
+        EVENTO_DESCONECTADO,
+        EVENTO_PUBACK
+    };
+
+    struct Evento {
+        uint8_t tipo;
+        uint8_t dato;               // Sesión presente o motivo de desconexión
+        uint16_t idPaquete;
+    };
+
+    struct Entrante {
+        uint32_t inicio;            // Posición en memoriaEntrada
+        uint16_t longitudTopic;
+        uint32_t longitud;
+    };
+
+    AsyncMqttClient cliente;
+    QueueHandle_t eventos;
+    char host[128];
+    char idCliente[64];
+    uint16_t puerto;
+    bool conectando;
+    bool conectado;
+    unsigned long inicioConexion;
+    int ultimoMotivo;
+    CallbackMensaje callbackMensaje;
+
+    VentanaQoS ventana;
+    uint32_t entrantesDescartados;
+
+    // Mensajes entrantes: FIFO sobre un anillo de bytes. La tarea de AsyncTCP
+    // agrega al final y loop() quita del principio; primeroEntrante y
+    // cantidadEntrantes se cambian con el cerrojo
+    portMUX_TYPE cerrojoEntrada = portMUX_INITIALIZER_UNLOCKED;
+    Entrante entrantes[MAXIMO_ENTRANTES];
+    uint8_t primeroEntrante;
+    uint8_t cantidadEntrantes;
+    uint8_t memoriaEntrada[TAMANO_MEMORIA_ENTRADA];
+    uint32_t finEntrada;            // Solo lo usa la tarea de AsyncTCP
+    Entrante armado;                // Mensaje que llega en fragmentos
+    bool descartandoEntrada;        // Fragmentos de un mensaje que no entró
+
+    void reenviarPendientes(bool sesionPresente);
+    void recibirMensaje(const char* topic, const char* payload, size_t longitud, size_t indice, size_t total);
+    bool reservarEntrada(size_t longitud, uint32_t& inicio);
+    void atenderEntrantes();
+
+public:
+    TransporteAsync();
+    ~TransporteAsync() override;
+
+    const char* obtenerNombre() const override;
+
+    void configurarServidor(const char* host, uint16_t puerto) override;
+    bool conectar(const char* idCliente) override;
+    bool estaConectando() const override;
+    bool estaConectado() override;
+    void desconectar() override;
+    int obtenerEstado() override;
+
+    bool suscribir(const char* topic, uint8_t qos) override;
+    bool publicar(const char* topic, const uint8_t* datos, size_t longitud, uint8_t qos, bool retener,
+                  uint32_t identificador) override;
+    bool puedePublicar(const char* topic, size_t longitud, uint8_t qos) override;
+    void establecerCallback(CallbackMensaje callback) override;
+
+    void procesar() override;
+
+    uint8_t obtenerQoSMaximo() const override;
+    void configurarVentana(uint8_t tamano) override;
+    uint8_t obtenerEnVuelo() const override;
+    void imprimirEstado() const override;
+};
+
+#endif
+
+#endif
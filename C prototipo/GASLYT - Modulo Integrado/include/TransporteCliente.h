@@ -0,0 +1,86 @@
+#ifndef TRANSPORTECLIENTE_H
+#define TRANSPORTECLIENTE_H
+
+#include <Client.h>
+#include <atomic>
+#include "TransporteMQTT.h"
+#include "SesionMQTT.h"
+
+// Transporte sobre cualquier Client de Arduino (ClienteTLS o WiFiClient)
+// con el cliente MQTT de lib/ClienteMQTT: QoS 1 con ventana de mensajes en
+// vuelo también sobre TLS. El CONNACK, los PUBACK y los mensajes entrantes
+// se atienden en procesar() sin esperar. Reserva un buffer de entrada y
+// otro de salida de tamanoBuffer bytes cada uno, más los 16 KB de copias
+// de la ventana.
+//
+// Abrir la red bloquea (con ClienteTLS: DNS, hasta 5 s de TCP y hasta 10 s
+// de handshake), así que red.connect() corre en una tarea propia y
+// conectar() vuelve enseguida; procesar() toma el resultado, envía el
+// CONNECT y espera el CONNACK. Mientras la tarea trabaja, loop() no toca
+// la red.
+class TransporteCliente : public TransporteMQTT, private CanalMQTT {
+public:
+    static const uint32_t PILA_TAREA_CONEXION = 8192;  // Handshake de mbedTLS, como loop()
+
+private:
+    enum Apertura {
+        APERTURA_INACTIVA,
+        APERTURA_EN_CURSO,
+        APERTURA_LISTA,
+        APERTURA_FALLIDA
+    };
+
+    Client& red;
+    uint8_t* bufferEntrada;
+    uint8_t* bufferSalida;
+    SesionMQTT sesion;
+    char host[128];
+    uint16_t puerto;
+    bool redAbierta;
+    CallbackMensaje callbackMensaje;
+
+    // Apertura de la red en tareaConexion: loop() pasa a EN_CURSO y la
+    // tarea a LISTA o FALLIDA; cancelada si se desconectó mientras tanto
+    TaskHandle_t tareaConexion;
+    std::atomic<uint8_t> apertura;
+    bool aperturaCancelada;
+    char idCliente[64];
+
+    static void tareaApertura(void* parametro);
+    void atenderApertura();
+
+    // CanalMQTT sobre la red
+    size_t escribir(const uint8_t* datos, size_t longitud) override;
+    int leer(uint8_t* destino, size_t capacidad) override;
+
+    static void alRecibir(void* contexto, char* topic, uint8_t* datos, unsigned int longitud);
+    static void alEntregar(void* contexto, uint32_t identificador);
+
+public:
+    TransporteCliente(Client& red, uint16_t tamanoBuffer);
+    ~TransporteCliente() override;
+
+    const char* obtenerNombre() const override;
+
+    void configurarServidor(const char* host, uint16_t puerto) override;
+    bool conectar(const char* idCliente) override;
+    bool estaConectando() const override;
+    bool estaConectado() override;
+    void desconectar() override;
+    int obtenerEstado() override;
+
+    bool suscribir(const char* topic, uint8_t qos) override;
+    bool publicar(const char* topic, const uint8_t* datos, size_t longitud, uint8_t qos, bool retener,
+                  uint32_t identificador) override;
+    bool puedePublicar(const char* topic, size_t longitud, uint8_t qos) override;
+    void establecerCallback(CallbackMensaje callback) override;
+
+    void procesar() override;
+
+    uint8_t obtenerQoSMaximo() const override;
+    void configurarVentana(uint8_t tamano) override;
+    uint8_t obtenerEnVuelo() const override;
+    void imprimirEstado() const override;
+};
+
+#endif
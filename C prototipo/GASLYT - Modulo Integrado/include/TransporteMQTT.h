@@ -0,0 +1,60 @@
+#ifndef TRANSPORTEMQTT_H
+#define TRANSPORTEMQTT_H
+
+#include <Arduino.h>
+#include "DestinoSalida.h"
+
+// Interfaz del cliente MQTT usado por MQTTManager. Implementaciones, las dos
+// con QoS 1 y ventana de mensajes en vuelo:
+// - TransporteCliente: lib/ClienteMQTT sobre ClienteTLS o WiFiClient
+// - TransporteAsync: AsyncMqttClient, no bloqueante (sin TLS; requiere
+//   TRANSPORTE_ASYNC_MQTT)
+// CallbackEntrega viene de DestinoSalida, la parte que usa PlanificadorSalida.
+class TransporteMQTT : public DestinoSalida {
+public:
+    typedef void (*CallbackMensaje)(char* topic, uint8_t* payload, unsigned int longitud);
+
+protected:
+    CallbackEntrega callbackEntrega = nullptr;
+
+    void informarEntrega(uint32_t identificador, bool entregado) {
+        if (identificador != 0 && callbackEntrega) {
+            callbackEntrega(identificador, entregado);
+        }
+    }
+
+public:
+    virtual ~TransporteMQTT() {}
+
+    virtual const char* obtenerNombre() const = 0;
+
+    // Conexión. conectar() devuelve true si quedó conectado en la llamada;
+    // un transporte asíncrono devuelve false y sigue en estaConectando()
+    virtual void configurarServidor(const char* host, uint16_t puerto) = 0;
+    virtual bool conectar(const char* idCliente) = 0;
+    virtual bool estaConectando() const = 0;
+    virtual bool estaConectado() = 0;
+    virtual void desconectar() = 0;
+    virtual int obtenerEstado() = 0;            // Código de error del último intento
+
+    // Mensajes. publicar() devuelve false si no se pudo enviar o si la
+    // ventana de QoS 1 está llena (el llamador decide si encolar). Con
+    // identificador distinto de 0 la entrega se informa a CallbackEntrega
+    virtual bool suscribir(const char* topic, uint8_t qos) = 0;
+    virtual bool publicar(const char* topic, const uint8_t* datos, size_t longitud, uint8_t qos, bool retener,
+                          uint32_t identificador) = 0;
+    virtual bool puedePublicar(const char* topic, size_t longitud, uint8_t qos) { return true; }
+    virtual void establecerCallback(CallbackMensaje callback) = 0;
+    void establecerCallbackEntrega(CallbackEntrega callback) { callbackEntrega = callback; }
+
+    // Atender eventos; llamar en cada loop()
+    virtual void procesar() = 0;
+
+    // QoS 1
+    virtual uint8_t obtenerQoSMaximo() const = 0;
+    virtual void configurarVentana(uint8_t tamano) {}
+    virtual uint8_t obtenerEnVuelo() const { return 0; }
+    virtual void imprimirEstado() const {}
+};
+
+#endif
@@ -57,6 +57,7 @@ public:
     // NTP
     bool sincronizarHora();
     String obtenerHoraActual() const;
+    size_t obtenerHoraActual(char* destino, size_t capacidad) const;   // Sin memoria dinámica
     unsigned long obtenerTimestamp() const;
     
     // Utilidades
@@ -0,0 +1,279 @@
+#include "PaquetesMQTT.h"
+#include <string.h>
+
+namespace PaquetesMQTT {
+
+static size_t bytesLongitud(uint32_t longitudRestante) {
+    if (longitudRestante < 128UL) {
+        return 1;
+    }
+    if (longitudRestante < 16384UL) {
+        return 2;
+    }
+    return longitudRestante < 2097152UL ? 3 : 4;
+}
+
+// Cabecera fija: tipo y banderas, y la longitud restante en base 128
+static size_t escribirCabecera(uint8_t* destino, uint8_t primerByte, uint32_t longitudRestante) {
+    size_t pos = 0;
+    destino[pos++] = primerByte;
+    do {
+        uint8_t byte = longitudRestante % 128;
+        longitudRestante /= 128;
+        if (longitudRestante > 0) {
+            byte |= 0x80;
+        }
+        destino[pos++] = byte;
+    } while (longitudRestante > 0);
+    return pos;
+}
+
+static size_t escribirCadena(uint8_t* destino, const char* cadena, size_t longitud) {
+    destino[0] = (uint8_t)(longitud >> 8);
+    destino[1] = (uint8_t)(longitud & 0xFF);
+    memcpy(destino + 2, cadena, longitud);
+    return 2 + longitud;
+}
+
+static size_t escribirId(uint8_t* destino, uint16_t idPaquete) {
+    destino[0] = (uint8_t)(idPaquete >> 8);
+    destino[1] = (uint8_t)(idPaquete & 0xFF);
+    return 2;
+}
+
+static size_t longitudTotal(size_t longitudRestante) {
+    if (longitudRestante > LONGITUD_RESTANTE_MAXIMA) {
+        return 0;
+    }
+    return 1 + bytesLongitud(longitudRestante) + longitudRestante;
+}
+
+size_t longitudPublish(size_t longitudTopic, size_t longitudDatos, uint8_t qos) {
+    return longitudTotal(2 + longitudTopic + (qos > 0 ? 2 : 0) + longitudDatos);
+}
+
+size_t codificarConnect(uint8_t* destino, size_t capacidad, const char* idCliente, uint16_t keepAliveS,
+                        bool sesionLimpia) {
+    size_t longitudId = idCliente ? strlen(idCliente) : 0;
+    size_t restante = 10 + 2 + longitudId;
+    size_t total = longitudTotal(restante);
+    if (!destino || longitudId > 0xFFFF || total == 0 || total > capacidad) {
+        return 0;
+    }
+
+    size_t pos = escribirCabecera(destino, CONNECT << 4, restante);
+    pos += escribirCadena(destino + pos, "MQTT", 4);
+    destino[pos++] = 4;                             // Nivel de protocolo: 3.1.1
+    destino[pos++] = sesionLimpia ? 0x02 : 0x00;    // Sin will, usuario ni clave
+    pos += escribirId(destino + pos, keepAliveS);
+    pos += escribirCadena(destino + pos, idCliente, longitudId);
+    return pos;
+}
+
+size_t codificarPublish(uint8_t* destino, size_t capacidad, const char* topic, const uint8_t* datos,
+                        size_t longitud, uint8_t qos, bool retener, bool duplicado, uint16_t idPaquete) {
+    size_t longitudTopic = topic ? strlen(topic) : 0;
+    size_t total = longitudPublish(longitudTopic, longitud, qos);
+    if (!destino || longitudTopic == 0 || longitudTopic > 0xFFFF || qos > 1 || (longitud > 0 && !datos) ||
+        total == 0 || total > capacidad) {
+        return 0;
+    }
+
+    uint8_t primerByte = (PUBLISH << 4) | (qos << 1);
+    if (retener) {
+        primerByte |= 0x01;
+    }
+    if (duplicado && qos > 0) {
+        primerByte |= 0x08;
+    }
+
+    size_t pos = escribirCabecera(destino, primerByte, 2 + longitudTopic + (qos > 0 ? 2 : 0) + longitud);
+    pos += escribirCadena(destino + pos, topic, longitudTopic);
+    if (qos > 0) {
+        pos += escribirId(destino + pos, idPaquete);
+    }
+    if (longitud > 0) {
+        memcpy(destino + pos, datos, longitud);
+        pos += longitud;
+    }
+    return pos;
+}
+
+size_t codificarSubscribe(uint8_t* destino, size_t capacidad, uint16_t idPaquete, const char* filtro, uint8_t qos) {
+    size_t longitudFiltro = filtro ? strlen(filtro) : 0;
+    size_t restante = 2 + 2 + longitudFiltro + 1;
+    size_t total = longitudTotal(restante);
+    if (!destino || longitudFiltro == 0 || longitudFiltro > 0xFFFF || total > capacidad) {
+        return 0;
+    }
+
+    // Las banderas de SUBSCRIBE son fijas (0010)
+    size_t pos = escribirCabecera(destino, (SUBSCRIBE << 4) | 0x02, restante);
+    pos += escribirId(destino + pos, idPaquete);
+    pos += escribirCadena(destino + pos, filtro, longitudFiltro);
+    destino[pos++] = qos > 1 ? 1 : qos;
+    return pos;
+}
+
+size_t codificarPuback(uint8_t* destino, size_t capacidad, uint16_t idPaquete) {
+    if (!destino || capacidad < 4) {
+        return 0;
+    }
+    size_t pos = escribirCabecera(destino, PUBACK << 4, 2);
+    return pos + escribirId(destino + pos, idPaquete);
+}
+
+size_t codificarPingreq(uint8_t* destino, size_t capacidad) {
+    if (!destino || capacidad < 2) {
+        return 0;
+    }
+    return escribirCabecera(destino, PINGREQ << 4, 0);
+}
+
+size_t codificarDisconnect(uint8_t* destino, size_t capacidad) {
+    if (!destino || capacidad < 2) {
+        return 0;
+    }
+    return escribirCabecera(destino, DISCONNECT << 4, 0);
+}
+
+Lector::Lector(uint8_t* buffer, size_t capacidad) : buffer(buffer), capacidad(buffer ? capacidad : 0) {
+    reiniciar();
+}
+
+void Lector::reiniciar() {
+    primerByte = 0;
+    longitudRestante = 0;
+    multiplicador = 1;
+    bytesLongitud = 0;
+    recibidos = 0;
+    leyendoLongitud = false;
+    enCabecera = true;
+}
+
+size_t Lector::agregar(const uint8_t* datos, size_t longitud, Resultado& resultado) {
+    resultado = INCOMPLETO;
+    size_t usados = 0;
+
+    while (usados < longitud) {
+        if (enCabecera) {
+            primerByte = datos[usados++];
+            enCabecera = false;
+            leyendoLongitud = true;
+            longitudRestante = 0;
+            multiplicador = 1;
+            bytesLongitud = 0;
+            recibidos = 0;
+            continue;
+        }
+
+        if (leyendoLongitud) {
+            uint8_t byte = datos[usados++];
+            longitudRestante += (uint32_t)(byte & 0x7F) * multiplicador;
+            multiplicador *= 128;
+            bytesLongitud++;
+            if (byte & 0x80) {
+                if (bytesLongitud == 4) {
+                    // Un quinto byte de longitud no existe en MQTT
+                    reiniciar();
+                    resultado = ERROR_FORMATO;
+                    return usados;
+                }
+                continue;
+            }
+            leyendoLongitud = false;
+        } else {
+            // Cuerpo: se copia de una vez todo lo que haya de este paquete
+            size_t copiar = longitudRestante - recibidos;
+            if (copiar > longitud - usados) {
+                copiar = longitud - usados;
+            }
+            if (longitudRestante < capacidad) {
+                memcpy(buffer + recibidos, datos + usados, copiar);
+            }
+            recibidos += copiar;
+            usados += copiar;
+        }
+
+        if (!leyendoLongitud && recibidos == longitudRestante) {
+            // El siguiente byte ya es de otro paquete
+            enCabecera = true;
+            if (longitudRestante < capacidad) {
+                buffer[longitudRestante] = '\0';
+                resultado = COMPLETO;
+            } else {
+                resultado = DESCARTADO;
+            }
+            return usados;
+        }
+    }
+    return usados;
+}
+
+uint8_t Lector::obtenerTipo() const {
+    return primerByte >> 4;
+}
+
+uint8_t Lector::obtenerBanderas() const {
+    return primerByte & 0x0F;
+}
+
+uint8_t* Lector::obtenerCuerpo() const {
+    return buffer;
+}
+
+size_t Lector::obtenerLongitud() const {
+    return longitudRestante;
+}
+
+bool leerConnack(const uint8_t* cuerpo, size_t longitud, bool& sesionPresente, uint8_t& codigo) {
+    if (!cuerpo || longitud != 2) {
+        return false;
+    }
+    sesionPresente = (cuerpo[0] & 0x01) != 0;
+    codigo = cuerpo[1];
+    return true;
+}
+
+bool leerIdPaquete(const uint8_t* cuerpo, size_t longitud, uint16_t& idPaquete) {
+    if (!cuerpo || longitud < 2) {
+        return false;
+    }
+    idPaquete = ((uint16_t)cuerpo[0] << 8) | cuerpo[1];
+    return true;
+}
+
+bool leerPublish(uint8_t banderas, uint8_t* cuerpo, size_t longitud, Publicacion& publicacion) {
+    uint8_t qos = (banderas >> 1) & 0x03;
+    if (!cuerpo || longitud < 2 || qos > 1) {
+        return false;
+    }
+
+    size_t longitudTopic = ((size_t)cuerpo[0] << 8) | cuerpo[1];
+    size_t pos = 2 + longitudTopic;
+    uint16_t idPaquete = 0;
+    if (qos > 0) {
+        if (pos + 2 > longitud) {
+            return false;
+        }
+        idPaquete = ((uint16_t)cuerpo[pos] << 8) | cuerpo[pos + 1];
+        pos += 2;
+    }
+    if (pos > longitud) {
+        return false;
+    }
+
+    memmove(cuerpo, cuerpo + 2, longitudTopic);
+    cuerpo[longitudTopic] = '\0';
+
+    publicacion.topic = (char*)cuerpo;
+    publicacion.datos = cuerpo + pos;
+    publicacion.longitud = longitud - pos;
+    publicacion.qos = qos;
+    publicacion.retener = (banderas & 0x01) != 0;
+    publicacion.duplicado = (banderas & 0x08) != 0;
+    publicacion.idPaquete = idPaquete;
+    return true;
+}
+
+}
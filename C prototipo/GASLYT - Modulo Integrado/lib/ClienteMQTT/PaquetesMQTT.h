@@ -0,0 +1,98 @@
+#ifndef PAQUETESMQTT_H
+#define PAQUETESMQTT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Paquetes de MQTT 3.1.1 que usa SesionMQTT: se escriben en buffers del
+// llamador y se leen de a trozos, sin memoria dinámica ni Arduino.
+namespace PaquetesMQTT {
+
+enum Tipo {
+    CONNECT = 1,
+    CONNACK = 2,
+    PUBLISH = 3,
+    PUBACK = 4,
+    SUBSCRIBE = 8,
+    SUBACK = 9,
+    PINGREQ = 12,
+    PINGRESP = 13,
+    DISCONNECT = 14
+};
+
+const uint32_t LONGITUD_RESTANTE_MAXIMA = 268435455UL;  // 4 bytes de longitud variable
+
+// Tamaño total del PUBLISH, con cabecera fija e identificador si es QoS 1
+size_t longitudPublish(size_t longitudTopic, size_t longitudDatos, uint8_t qos);
+
+// Devuelven los bytes escritos en destino; 0 si no entra en capacidad
+size_t codificarConnect(uint8_t* destino, size_t capacidad, const char* idCliente, uint16_t keepAliveS,
+                        bool sesionLimpia);
+size_t codificarPublish(uint8_t* destino, size_t capacidad, const char* topic, const uint8_t* datos,
+                        size_t longitud, uint8_t qos, bool retener, bool duplicado, uint16_t idPaquete);
+size_t codificarSubscribe(uint8_t* destino, size_t capacidad, uint16_t idPaquete, const char* filtro, uint8_t qos);
+size_t codificarPuback(uint8_t* destino, size_t capacidad, uint16_t idPaquete);
+size_t codificarPingreq(uint8_t* destino, size_t capacidad);
+size_t codificarDisconnect(uint8_t* destino, size_t capacidad);
+
+// Arma un paquete entrante con los bytes que van llegando, en trozos de
+// cualquier tamaño. El cuerpo (todo lo que sigue a la cabecera fija) queda
+// en el buffer del llamador seguido de un '\0'; un paquete que no entra se
+// consume sin guardarlo y se informa DESCARTADO.
+class Lector {
+public:
+    enum Resultado {
+        INCOMPLETO,
+        COMPLETO,
+        DESCARTADO,
+        ERROR_FORMATO
+    };
+
+private:
+    uint8_t* buffer;
+    size_t capacidad;
+    uint8_t primerByte;
+    uint32_t longitudRestante;
+    uint32_t multiplicador;
+    uint8_t bytesLongitud;
+    uint32_t recibidos;
+    bool leyendoLongitud;
+    bool enCabecera;
+
+public:
+    Lector(uint8_t* buffer, size_t capacidad);
+
+    void reiniciar();
+
+    // Consume hasta completar un paquete y devuelve los bytes usados; el
+    // resto se pasa en la llamada siguiente. Con COMPLETO el cuerpo es
+    // válido hasta la próxima llamada
+    size_t agregar(const uint8_t* datos, size_t longitud, Resultado& resultado);
+
+    uint8_t obtenerTipo() const;
+    uint8_t obtenerBanderas() const;
+    uint8_t* obtenerCuerpo() const;
+    size_t obtenerLongitud() const;
+};
+
+// Lectura del cuerpo de los paquetes recibidos
+bool leerConnack(const uint8_t* cuerpo, size_t longitud, bool& sesionPresente, uint8_t& codigo);
+bool leerIdPaquete(const uint8_t* cuerpo, size_t longitud, uint16_t& idPaquete);   // PUBACK y SUBACK
+
+struct Publicacion {
+    char* topic;
+    uint8_t* datos;
+    size_t longitud;
+    uint8_t qos;
+    bool retener;
+    bool duplicado;
+    uint16_t idPaquete;
+};
+
+// Deja el topic terminado en '\0' moviéndolo dos bytes atrás dentro del
+// cuerpo (como PubSubClient); los datos quedan donde estaban
+bool leerPublish(uint8_t banderas, uint8_t* cuerpo, size_t longitud, Publicacion& publicacion);
+
+}
+
+#endif
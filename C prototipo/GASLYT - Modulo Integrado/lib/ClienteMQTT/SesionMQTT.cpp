@@ -0,0 +1,291 @@
+#include "SesionMQTT.h"
+#include <string.h>
+
+SesionMQTT::SesionMQTT(uint8_t* bufferEntrada, size_t tamanoEntrada, uint8_t* bufferSalida, size_t tamanoSalida) :
+    canal(nullptr), bufferSalida(bufferSalida), tamanoSalida(bufferSalida ? tamanoSalida : 0),
+    lector(bufferEntrada, tamanoEntrada), estado(DESCONECTADA), codigo(ESTADO_DESCONECTADO), ultimoId(0),
+    inicioConexion(0), ultimoEnvio(0), inicioPing(0), esperandoPing(false), entrantesDescartados(0),
+    callbackMensaje(nullptr), callbackEntrega(nullptr), contexto(nullptr) {
+}
+
+void SesionMQTT::establecerCallbacks(CallbackMensaje mensaje, CallbackEntrega entrega, void* nuevoContexto) {
+    callbackMensaje = mensaje;
+    callbackEntrega = entrega;
+    contexto = nuevoContexto;
+}
+
+bool SesionMQTT::iniciar(CanalMQTT& nuevoCanal, const char* idCliente, unsigned long ahora) {
+    canal = &nuevoCanal;
+    lector.reiniciar();
+    esperandoPing = false;
+
+    // Sesión persistente: el broker conserva suscripciones y espera los reenvíos
+    size_t longitud = PaquetesMQTT::codificarConnect(bufferSalida, tamanoSalida, idCliente, KEEP_ALIVE_S, false);
+    if (longitud == 0) {
+        cerrar(ESTADO_CONEXION_FALLIDA);
+        return false;
+    }
+
+    estado = ESPERANDO_CONNACK;
+    inicioConexion = ahora;
+    return enviar(bufferSalida, longitud, ahora);
+}
+
+void SesionMQTT::procesar(unsigned long ahora) {
+    if (estado == DESCONECTADA) {
+        return;
+    }
+
+    uint8_t trozo[256];
+    size_t leidosTotal = 0;
+    while (leidosTotal < MAXIMO_LECTURA_POR_PROCESO) {
+        int leidos = canal->leer(trozo, sizeof(trozo));
+        if (leidos < 0) {
+            cerrar(ESTADO_CONEXION_PERDIDA);
+            return;
+        }
+        if (leidos == 0) {
+            break;
+        }
+        leidosTotal += leidos;
+
+        size_t usados = 0;
+        while (usados < (size_t)leidos) {
+            PaquetesMQTT::Lector::Resultado resultado;
+            usados += lector.agregar(trozo + usados, leidos - usados, resultado);
+            if (resultado == PaquetesMQTT::Lector::COMPLETO) {
+                atenderPaquete(ahora);
+                if (estado == DESCONECTADA) {
+                    return;
+                }
+            } else if (resultado == PaquetesMQTT::Lector::DESCARTADO) {
+                // Más grande que el buffer de entrada
+                entrantesDescartados++;
+            } else if (resultado == PaquetesMQTT::Lector::ERROR_FORMATO) {
+                cerrar(ESTADO_CONEXION_PERDIDA);
+                return;
+            }
+        }
+    }
+
+    if (estado == ESPERANDO_CONNACK) {
+        if (ahora - inicioConexion >= TIEMPO_MAXIMO_CONNACK_MS) {
+            cerrar(ESTADO_TIMEOUT_CONEXION);
+        }
+        return;
+    }
+
+    // PUBACK demorado: la conexión se da por perdida y se reenvía al reconectar
+    if (ventana.estaVencida(ahora, TIEMPO_MAXIMO_PUBACK_MS)) {
+        cerrar(ESTADO_CONEXION_PERDIDA);
+        return;
+    }
+
+    // Keep alive: PINGREQ tras KEEP_ALIVE_S sin enviar nada; sin PINGRESP
+    // en otro tanto, la conexión se da por perdida
+    const unsigned long keepAliveMs = KEEP_ALIVE_S * 1000UL;
+    if (esperandoPing) {
+        if (ahora - inicioPing >= keepAliveMs) {
+            cerrar(ESTADO_CONEXION_PERDIDA);
+        }
+    } else if (ahora - ultimoEnvio >= keepAliveMs) {
+        uint8_t ping[2];
+        size_t longitud = PaquetesMQTT::codificarPingreq(ping, sizeof(ping));
+        if (enviar(ping, longitud, ahora)) {
+            esperandoPing = true;
+            inicioPing = ahora;
+        }
+    }
+}
+
+bool SesionMQTT::publicar(const char* topic, const uint8_t* datos, size_t longitud, uint8_t qos, bool retener,
+                          uint32_t identificador, unsigned long ahora) {
+    if (estado != CONECTADA || !topic) {
+        return false;
+    }
+    if (qos > 1) {
+        qos = 1;
+    }
+
+    // QoS 1: hace falta lugar en la ventana y memoria para la copia
+    if (qos == 1 && !ventana.hayLugar(strlen(topic), longitud)) {
+        ventana.registrarRechazo();
+        return false;
+    }
+
+    uint16_t idPaquete = qos == 1 ? siguienteId() : 0;
+    size_t total = PaquetesMQTT::codificarPublish(bufferSalida, tamanoSalida, topic, datos, longitud, qos, retener,
+                                                  false, idPaquete);
+    if (total == 0 || !enviar(bufferSalida, total, ahora)) {
+        return false;
+    }
+
+    if (qos == 0) {
+        // Escrito en el canal es entregado
+        if (identificador != 0 && callbackEntrega) {
+            callbackEntrega(contexto, identificador);
+        }
+        return true;
+    }
+
+    ventana.agregar(idPaquete, identificador, topic, datos, longitud, retener, ahora);
+    return true;
+}
+
+bool SesionMQTT::puedePublicar(const char* topic, size_t longitud, uint8_t qos) const {
+    if (estado != CONECTADA || !topic) {
+        return false;
+    }
+    size_t longitudTopic = strlen(topic);
+    size_t total = PaquetesMQTT::longitudPublish(longitudTopic, longitud, qos > 0 ? 1 : 0);
+    if (total == 0 || total > tamanoSalida) {
+        return false;
+    }
+    return qos == 0 || ventana.hayLugar(longitudTopic, longitud);
+}
+
+bool SesionMQTT::suscribir(const char* filtro, uint8_t qos, unsigned long ahora) {
+    if (estado != CONECTADA) {
+        return false;
+    }
+    // El SUBACK no se espera: si el broker rechaza, el filtro queda sin mensajes
+    size_t total = PaquetesMQTT::codificarSubscribe(bufferSalida, tamanoSalida, siguienteId(), filtro, qos);
+    return total > 0 && enviar(bufferSalida, total, ahora);
+}
+
+void SesionMQTT::terminar() {
+    if (estado != DESCONECTADA) {
+        uint8_t disconnect[2];
+        size_t longitud = PaquetesMQTT::codificarDisconnect(disconnect, sizeof(disconnect));
+        canal->escribir(disconnect, longitud);
+    }
+    cerrar(ESTADO_DESCONECTADO);
+}
+
+void SesionMQTT::perderConexion(int motivo) {
+    cerrar(motivo);
+}
+
+SesionMQTT::Estado SesionMQTT::obtenerEstado() const {
+    return estado;
+}
+
+int SesionMQTT::obtenerCodigo() const {
+    return codigo;
+}
+
+bool SesionMQTT::configurarVentana(uint8_t tamano) {
+    return ventana.configurar(tamano);
+}
+
+const VentanaQoS& SesionMQTT::obtenerVentana() const {
+    return ventana;
+}
+
+uint32_t SesionMQTT::obtenerEntrantesDescartados() const {
+    return entrantesDescartados;
+}
+
+bool SesionMQTT::enviar(const uint8_t* datos, size_t longitud, unsigned long ahora) {
+    if (!canal || canal->escribir(datos, longitud) != longitud) {
+        cerrar(ESTADO_CONEXION_PERDIDA);
+        return false;
+    }
+    ultimoEnvio = ahora;
+    return true;
+}
+
+uint16_t SesionMQTT::siguienteId() {
+    // 0 no es un identificador válido; se saltean los que siguen en vuelo
+    do {
+        ultimoId++;
+    } while (ultimoId == 0 || ventana.estaEnVuelo(ultimoId));
+    return ultimoId;
+}
+
+void SesionMQTT::atenderPaquete(unsigned long ahora) {
+    uint8_t* cuerpo = lector.obtenerCuerpo();
+    size_t longitud = lector.obtenerLongitud();
+
+    switch (lector.obtenerTipo()) {
+        case PaquetesMQTT::CONNACK: {
+            bool sesionPresente;
+            uint8_t codigoConnack;
+            if (estado != ESPERANDO_CONNACK ||
+                !PaquetesMQTT::leerConnack(cuerpo, longitud, sesionPresente, codigoConnack)) {
+                cerrar(ESTADO_CONEXION_PERDIDA);
+                return;
+            }
+            if (codigoConnack != 0) {
+                cerrar(codigoConnack);
+                return;
+            }
+            estado = CONECTADA;
+            codigo = ESTADO_CONECTADO;
+            reenviarPendientes(sesionPresente, ahora);
+            break;
+        }
+
+        case PaquetesMQTT::PUBACK: {
+            uint16_t idPaquete;
+            uint32_t identificador;
+            if (PaquetesMQTT::leerIdPaquete(cuerpo, longitud, idPaquete) &&
+                ventana.confirmar(idPaquete, identificador) && identificador != 0 && callbackEntrega) {
+                callbackEntrega(contexto, identificador);
+            }
+            break;
+        }
+
+        case PaquetesMQTT::PUBLISH: {
+            PaquetesMQTT::Publicacion publicacion;
+            if (!PaquetesMQTT::leerPublish(lector.obtenerBanderas(), cuerpo, longitud, publicacion)) {
+                cerrar(ESTADO_CONEXION_PERDIDA);
+                return;
+            }
+            if (callbackMensaje) {
+                callbackMensaje(contexto, publicacion.topic, publicacion.datos, publicacion.longitud);
+            }
+            // PUBACK después de atenderlo: si se corta antes, el broker lo repite
+            if (publicacion.qos == 1 && estado != DESCONECTADA) {
+                uint8_t puback[4];
+                size_t longitudPuback = PaquetesMQTT::codificarPuback(puback, sizeof(puback), publicacion.idPaquete);
+                enviar(puback, longitudPuback, ahora);
+            }
+            break;
+        }
+
+        case PaquetesMQTT::PINGRESP:
+            esperandoPing = false;
+            break;
+
+        default:
+            // SUBACK y cualquier otro: nada que hacer
+            break;
+    }
+}
+
+void SesionMQTT::reenviarPendientes(bool sesionPresente, unsigned long ahora) {
+    for (uint8_t i = 0; i < ventana.obtenerCantidad(); i++) {
+        VentanaQoS::Pendiente pendiente;
+        if (!ventana.obtenerPendiente(i, pendiente)) {
+            continue;
+        }
+
+        // Con sesión se repite el identificador y se marca DUP; sin sesión es un envío nuevo
+        uint16_t idPaquete = sesionPresente ? pendiente.idPaquete : siguienteId();
+        size_t total = PaquetesMQTT::codificarPublish(bufferSalida, tamanoSalida, pendiente.topic, pendiente.datos,
+                                                      pendiente.longitud, 1, pendiente.retener, sesionPresente,
+                                                      idPaquete);
+        if (total == 0 || !enviar(bufferSalida, total, ahora)) {
+            return;
+        }
+        ventana.registrarReenvio(i, idPaquete, ahora);
+    }
+}
+
+void SesionMQTT::cerrar(int motivo) {
+    estado = DESCONECTADA;
+    codigo = motivo;
+    esperandoPing = false;
+    lector.reiniciar();
+}
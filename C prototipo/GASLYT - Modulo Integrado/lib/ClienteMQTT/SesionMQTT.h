@@ -0,0 +1,115 @@
+#ifndef SESIONMQTT_H
+#define SESIONMQTT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "PaquetesMQTT.h"
+#include "VentanaQoS.h"
+
+// Canal ya conectado (TCP o TLS) por el que viaja la sesión
+class CanalMQTT {
+public:
+    virtual ~CanalMQTT() {}
+
+    // Devuelve los bytes escritos; menos que longitud es un error
+    virtual size_t escribir(const uint8_t* datos, size_t longitud) = 0;
+
+    // Lo que haya disponible sin esperar: > 0 bytes leídos, 0 si no hay
+    // nada, < 0 si la conexión se cerró
+    virtual int leer(uint8_t* destino, size_t capacidad) = 0;
+};
+
+// Protocolo MQTT 3.1.1 del lado del cliente con QoS 0 y 1, sobre cualquier
+// CanalMQTT. Los mensajes QoS 1 quedan en una VentanaQoS hasta su PUBACK;
+// la sesión es persistente (cleanSession = 0) y al reconectar se reenvían
+// con DUP y el mismo identificador si el broker conservó la sesión, o como
+// envíos nuevos si no. Un PUBACK que tarda TIEMPO_MAXIMO_PUBACK_MS cierra
+// la sesión para reconectar y reenviar. No lee el reloj: el tiempo llega
+// en cada llamada (millis() en el equipo), así test/test_cliente_mqtt la
+// prueba en el PC (pio test -e native).
+class SesionMQTT {
+public:
+    enum Estado {
+        DESCONECTADA,
+        ESPERANDO_CONNACK,
+        CONECTADA
+    };
+
+    // Motivo del último cierre, con los valores de state() de PubSubClient;
+    // de 1 a 5 es el código de rechazo del CONNACK
+    static const int ESTADO_TIMEOUT_CONEXION = -4;
+    static const int ESTADO_CONEXION_PERDIDA = -3;
+    static const int ESTADO_CONEXION_FALLIDA = -2;
+    static const int ESTADO_DESCONECTADO = -1;
+    static const int ESTADO_CONECTADO = 0;
+
+    static const uint16_t KEEP_ALIVE_S = 15;
+    static const unsigned long TIEMPO_MAXIMO_CONNACK_MS = 10000;
+    static const unsigned long TIEMPO_MAXIMO_PUBACK_MS = 30000;
+    static const size_t MAXIMO_LECTURA_POR_PROCESO = 16384;    // Para no acaparar loop()
+
+    typedef void (*CallbackMensaje)(void* contexto, char* topic, uint8_t* datos, unsigned int longitud);
+    typedef void (*CallbackEntrega)(void* contexto, uint32_t identificador);
+
+private:
+    CanalMQTT* canal;
+    uint8_t* bufferSalida;
+    size_t tamanoSalida;
+    PaquetesMQTT::Lector lector;
+    VentanaQoS ventana;
+
+    Estado estado;
+    int codigo;
+    uint16_t ultimoId;
+    unsigned long inicioConexion;
+    unsigned long ultimoEnvio;
+    unsigned long inicioPing;
+    bool esperandoPing;
+    uint32_t entrantesDescartados;
+
+    CallbackMensaje callbackMensaje;
+    CallbackEntrega callbackEntrega;
+    void* contexto;
+
+    bool enviar(const uint8_t* datos, size_t longitud, unsigned long ahora);
+    uint16_t siguienteId();
+    void atenderPaquete(unsigned long ahora);
+    void reenviarPendientes(bool sesionPresente, unsigned long ahora);
+    void cerrar(int motivo);
+
+public:
+    // Buffers del llamador: el de entrada limita el paquete más grande que
+    // se puede recibir y el de salida el PUBLISH más grande
+    SesionMQTT(uint8_t* bufferEntrada, size_t tamanoEntrada, uint8_t* bufferSalida, size_t tamanoSalida);
+
+    // El topic y los datos de un mensaje recibido valen durante la llamada.
+    // La entrega se informa al escribir un QoS 0 o al recibir el PUBACK
+    void establecerCallbacks(CallbackMensaje mensaje, CallbackEntrega entrega, void* contexto);
+
+    // Con el canal ya conectado: envía CONNECT; el CONNACK llega en procesar()
+    bool iniciar(CanalMQTT& canal, const char* idCliente, unsigned long ahora);
+
+    // Leer lo disponible, atender los paquetes y vencer plazos
+    void procesar(unsigned long ahora);
+
+    // false si no está conectada, el paquete no entra en el buffer de salida
+    // o, con QoS 1, la ventana está llena
+    bool publicar(const char* topic, const uint8_t* datos, size_t longitud, uint8_t qos, bool retener,
+                  uint32_t identificador, unsigned long ahora);
+    bool puedePublicar(const char* topic, size_t longitud, uint8_t qos) const;
+    bool suscribir(const char* filtro, uint8_t qos, unsigned long ahora);
+
+    // Cierre ordenado (DISCONNECT). Los mensajes sin confirmar se conservan
+    void terminar();
+
+    // El canal se cortó o no se pudo abrir
+    void perderConexion(int motivo = ESTADO_CONEXION_PERDIDA);
+
+    Estado obtenerEstado() const;
+    int obtenerCodigo() const;
+    bool configurarVentana(uint8_t tamano);
+    const VentanaQoS& obtenerVentana() const;
+    uint32_t obtenerEntrantesDescartados() const;
+};
+
+#endif
@@ -0,0 +1,186 @@
+#include "VentanaQoS.h"
+#include <string.h>
+
+VentanaQoS::VentanaQoS() :
+    tamano(4), primero(0), cantidad(0), memoriaInicio(0), memoriaFin(0), confirmados(0), reenviados(0),
+    rechazados(0) {
+}
+
+bool VentanaQoS::configurar(uint8_t nuevoTamano) {
+    if (nuevoTamano < 1 || nuevoTamano > TAMANO_MAXIMO) {
+        return false;
+    }
+    tamano = nuevoTamano;
+    return true;
+}
+
+uint8_t VentanaQoS::obtenerTamano() const {
+    return tamano;
+}
+
+uint8_t VentanaQoS::obtenerCantidad() const {
+    return cantidad;
+}
+
+bool VentanaQoS::hayLugar(size_t longitudTopic, size_t longitudDatos) const {
+    uint32_t inicio;
+    return cantidad < tamano && reservarMemoria(longitudTopic + 1 + longitudDatos, inicio);
+}
+
+bool VentanaQoS::agregar(uint16_t idPaquete, uint32_t identificador, const char* topic, const uint8_t* datos,
+                         size_t longitud, bool retener, unsigned long ahora) {
+    size_t longitudTopic = topic ? strlen(topic) : 0;
+    uint32_t inicio;
+    if (!topic || cantidad >= tamano || !reservarMemoria(longitudTopic + 1 + longitud, inicio)) {
+        rechazados++;
+        return false;
+    }
+
+    memcpy(memoria + inicio, topic, longitudTopic + 1);
+    if (longitud > 0) {
+        memcpy(memoria + inicio + longitudTopic + 1, datos, longitud);
+    }
+    if (cantidad == 0) {
+        memoriaInicio = inicio;
+    }
+    memoriaFin = inicio + longitudTopic + 1 + longitud;
+
+    EnVuelo& nueva = entrada(cantidad);
+    nueva.idPaquete = idPaquete;
+    nueva.identificador = identificador;
+    nueva.inicio = inicio;
+    nueva.longitudTopic = longitudTopic;
+    nueva.longitudDatos = longitud;
+    nueva.retener = retener;
+    nueva.confirmado = false;
+    nueva.enviado = ahora;
+    cantidad++;
+    return true;
+}
+
+void VentanaQoS::registrarRechazo() {
+    rechazados++;
+}
+
+bool VentanaQoS::confirmar(uint16_t idPaquete, uint32_t& identificador) {
+    for (uint8_t i = 0; i < cantidad; i++) {
+        EnVuelo& enVuelo = entrada(i);
+        if (!enVuelo.confirmado && enVuelo.idPaquete == idPaquete) {
+            enVuelo.confirmado = true;
+            identificador = enVuelo.identificador;
+            confirmados++;
+            liberarConfirmados();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VentanaQoS::estaEnVuelo(uint16_t idPaquete) const {
+    for (uint8_t i = 0; i < cantidad; i++) {
+        const EnVuelo& enVuelo = entrada(i);
+        if (!enVuelo.confirmado && enVuelo.idPaquete == idPaquete) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VentanaQoS::estaVencida(unsigned long ahora, unsigned long plazoMs) const {
+    // El primero nunca está confirmado: liberarConfirmados() lo habría quitado
+    return cantidad > 0 && ahora - entrada(0).enviado >= plazoMs;
+}
+
+uint16_t VentanaQoS::obtenerIdMasAntiguo() const {
+    return cantidad > 0 ? entrada(0).idPaquete : 0;
+}
+
+bool VentanaQoS::obtenerPendiente(uint8_t posicion, Pendiente& pendiente) const {
+    if (posicion >= cantidad || entrada(posicion).confirmado) {
+        return false;
+    }
+
+    const EnVuelo& enVuelo = entrada(posicion);
+    pendiente.topic = (const char*)(memoria + enVuelo.inicio);
+    pendiente.datos = memoria + enVuelo.inicio + enVuelo.longitudTopic + 1;
+    pendiente.longitud = enVuelo.longitudDatos;
+    pendiente.retener = enVuelo.retener;
+    pendiente.idPaquete = enVuelo.idPaquete;
+    return true;
+}
+
+void VentanaQoS::registrarReenvio(uint8_t posicion, uint16_t idPaquete, unsigned long ahora) {
+    if (posicion >= cantidad) {
+        return;
+    }
+    EnVuelo& enVuelo = entrada(posicion);
+    enVuelo.idPaquete = idPaquete;
+    enVuelo.enviado = ahora;
+    reenviados++;
+}
+
+uint32_t VentanaQoS::obtenerConfirmados() const {
+    return confirmados;
+}
+
+uint32_t VentanaQoS::obtenerReenviados() const {
+    return reenviados;
+}
+
+uint32_t VentanaQoS::obtenerRechazados() const {
+    return rechazados;
+}
+
+bool VentanaQoS::reservarMemoria(size_t longitud, uint32_t& inicio) const {
+    if (longitud > TAMANO_MEMORIA) {
+        return false;
+    }
+
+    if (cantidad == 0) {
+        inicio = 0;
+        return true;
+    }
+
+    if (memoriaFin > memoriaInicio) {
+        // Sin vuelta: después del último o, si no entra, al principio
+        if (memoriaFin + longitud <= TAMANO_MEMORIA) {
+            inicio = memoriaFin;
+            return true;
+        }
+        if (longitud < memoriaInicio) {
+            inicio = 0;
+            return true;
+        }
+        return false;
+    }
+
+    // Con vuelta: solo el hueco hasta el más antiguo
+    if (memoriaFin + longitud < memoriaInicio) {
+        inicio = memoriaFin;
+        return true;
+    }
+    return false;
+}
+
+void VentanaQoS::liberarConfirmados() {
+    // Se libera en orden: un PUBACK adelantado espera al de los anteriores
+    while (cantidad > 0 && entrada(0).confirmado) {
+        primero = (primero + 1) % TAMANO_MAXIMO;
+        cantidad--;
+    }
+
+    if (cantidad == 0) {
+        memoriaInicio = 0;
+        memoriaFin = 0;
+    } else {
+        memoriaInicio = entrada(0).inicio;
+    }
+}
+
+VentanaQoS::EnVuelo& VentanaQoS::entrada(uint8_t posicion) {
+    return ventana[(primero + posicion) % TAMANO_MAXIMO];
+}
+
+const VentanaQoS::EnVuelo& VentanaQoS::entrada(uint8_t posicion) const {
+    return ventana[(primero + posicion) % TAMANO_MAXIMO];
+}
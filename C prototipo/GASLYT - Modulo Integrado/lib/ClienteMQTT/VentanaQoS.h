@@ -0,0 +1,91 @@
+#ifndef VENTANAQOS_H
+#define VENTANAQOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Mensajes QoS 1 publicados y todavía sin PUBACK. Cada uno ocupa un lugar
+// de la ventana y guarda una copia (topic + '\0' + datos) en un anillo de
+// TAMANO_MEMORIA bytes para reenviarla al reconectar. Los PUBACK pueden
+// llegar en cualquier orden; los lugares se liberan en orden de envío.
+// La usan SesionMQTT y TransporteAsync; sin Arduino ni memoria dinámica.
+class VentanaQoS {
+public:
+    static const uint8_t TAMANO_MAXIMO = 16;
+    static const size_t TAMANO_MEMORIA = 16384;
+
+    // Mensaje sin confirmar, para reenviarlo
+    struct Pendiente {
+        const char* topic;
+        const uint8_t* datos;
+        size_t longitud;
+        bool retener;
+        uint16_t idPaquete;
+    };
+
+private:
+    struct EnVuelo {
+        uint16_t idPaquete;
+        uint32_t identificador;     // Del llamador, se devuelve con el PUBACK
+        uint32_t inicio;            // Posición en memoria
+        uint16_t longitudTopic;
+        uint32_t longitudDatos;
+        bool retener;
+        bool confirmado;
+        unsigned long enviado;
+    };
+
+    EnVuelo ventana[TAMANO_MAXIMO];
+    uint8_t tamano;
+    uint8_t primero;
+    uint8_t cantidad;
+    uint8_t memoria[TAMANO_MEMORIA];
+    uint32_t memoriaInicio;         // Copia del más antiguo
+    uint32_t memoriaFin;            // Fin de la copia del más nuevo
+
+    uint32_t confirmados;
+    uint32_t reenviados;
+    uint32_t rechazados;            // Ventana llena o sin memoria
+
+    bool reservarMemoria(size_t longitud, uint32_t& inicio) const;
+    void liberarConfirmados();
+    EnVuelo& entrada(uint8_t posicion);
+    const EnVuelo& entrada(uint8_t posicion) const;
+
+public:
+    VentanaQoS();
+
+    // De 1 a TAMANO_MAXIMO; al achicarla, los que ya están en vuelo siguen
+    // hasta su PUBACK
+    bool configurar(uint8_t nuevoTamano);
+    uint8_t obtenerTamano() const;
+    uint8_t obtenerCantidad() const;
+
+    // Lugar y memoria para un mensaje más, sin reservarlos
+    bool hayLugar(size_t longitudTopic, size_t longitudDatos) const;
+
+    // Copia el mensaje ya enviado; false (y cuenta un rechazo) si no entra
+    bool agregar(uint16_t idPaquete, uint32_t identificador, const char* topic, const uint8_t* datos,
+                 size_t longitud, bool retener, unsigned long ahora);
+    void registrarRechazo();
+
+    // PUBACK: true si el paquete estaba en vuelo, con el identificador del
+    // llamador. Un PUBACK repetido o desconocido devuelve false
+    bool confirmar(uint16_t idPaquete, uint32_t& identificador);
+    bool estaEnVuelo(uint16_t idPaquete) const;
+
+    // El más antiguo sin PUBACK lleva plazoMs o más desde su envío
+    bool estaVencida(unsigned long ahora, unsigned long plazoMs) const;
+    uint16_t obtenerIdMasAntiguo() const;
+
+    // Reenvío al reconectar, en orden de envío: posiciones 0 a
+    // obtenerCantidad() - 1; false si esa posición ya está confirmada
+    bool obtenerPendiente(uint8_t posicion, Pendiente& pendiente) const;
+    void registrarReenvio(uint8_t posicion, uint16_t idPaquete, unsigned long ahora);
+
+    uint32_t obtenerConfirmados() const;
+    uint32_t obtenerReenviados() const;
+    uint32_t obtenerRechazados() const;
+};
+
+#endif
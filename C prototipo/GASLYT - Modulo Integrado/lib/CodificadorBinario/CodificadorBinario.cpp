@@ -0,0 +1,234 @@
+#include "CodificadorBinario.h"
+#include <string.h>
+
+// Esquema v1: identificadores de campo. Agregar solo al final.
+static const char* const CAMPOS_ESQUEMA[] = {
+    nullptr,                // 0: versión del esquema
+    "timestamp",            // 1
+    "fecha",                // 2
+    "concentracion",        // 3
+    "unidad",               // 4
+    "umbral",               // 5
+    "alarma",               // 6
+    "idDispositivo",        // 7
+    "rssi",                 // 8
+    "arranque",             // 9
+    "secuencia",            // 10
+    "canales",              // 11
+    "tipo",                 // 12
+    "gas",                  // 13
+    "ratio",                // 14
+    "valida",               // 15
+    "estadisticas",         // 16
+    "media",                // 17
+    "desviacion",           // 18
+    "ewma",                 // 19
+    "minimo",               // 20
+    "maximo",               // 21
+    "muestras",             // 22
+    "tendencia",            // 23
+    "tiempoHastaUmbral",    // 24
+    "sensor",               // 25
+    "severidad",            // 26
+    "accion",               // 27
+    "mac",                  // 28
+    "version",              // 29
+    "pinSensorGas",         // 30
+    "canalesSensor",        // 31
+    "pin",                  // 32
+    "pinLED",               // 33
+    "pinBuzzer",            // 34
+    "pinExtractor",         // 35
+    "extractorAlambrico",   // 36
+    "intervaloMedicion",    // 37
+    "umbralAlarma",         // 38
+    "modoAWS",              // 39
+    "brokerMQTT",           // 40
+    "puertoMQTT",           // 41
+    "estadoFabrica",        // 42
+    "uptime",               // 43
+    "ip",                   // 44
+    "estadoWifi",           // 45
+    "estadoMQTT",           // 46
+    "estadoAlarma",         // 47
+    "ultimaLectura",        // 48
+    "r0",                   // 49
+    "muestreoAdaptativo",   // 50
+    "intervaloMuestreo",    // 51
+    "colaPendientes",       // 52
+    "colaDescartados",      // 53
+    "estado",               // 54
+    "progreso",             // 55
+    "canal",                // 56
+    "lecturasSuprimidas",   // 57
+    "lecturasPublicadas",   // 58
+    "saturada"              // 59
+};
+
+static const int CANTIDAD_CAMPOS = sizeof(CAMPOS_ESQUEMA) / sizeof(CAMPOS_ESQUEMA[0]);
+
+size_t CodificadorBinario::codificar(JsonVariantConst datos, uint8_t* destino, size_t capacidad) {
+    if (!destino || capacidad == 0) {
+        return 0;
+    }
+
+    Escritor escritor = {destino, capacidad, 0, false};
+    escribirValor(escritor, datos, true);
+    return escritor.desbordado ? 0 : escritor.posicion;
+}
+
+size_t CodificadorBinario::codificarCabeceraArreglo(uint16_t cantidad, uint8_t* destino, size_t capacidad) {
+    if (!destino || capacidad < TAMANO_CABECERA_ARREGLO) {
+        return 0;
+    }
+
+    // Siempre array16 para poder reservar el espacio antes de conocer la cantidad
+    destino[0] = 0xdc;
+    destino[1] = cantidad >> 8;
+    destino[2] = cantidad & 0xFF;
+    return TAMANO_CABECERA_ARREGLO;
+}
+
+int CodificadorBinario::obtenerIdCampo(const char* nombre) {
+    if (!nombre) {
+        return -1;
+    }
+    for (int i = 1; i < CANTIDAD_CAMPOS; i++) {
+        if (strcmp(CAMPOS_ESQUEMA[i], nombre) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char* CodificadorBinario::obtenerNombreCampo(int id) {
+    return id > 0 && id < CANTIDAD_CAMPOS ? CAMPOS_ESQUEMA[id] : nullptr;
+}
+
+void CodificadorBinario::escribirValor(Escritor& escritor, JsonVariantConst valor, bool raiz) {
+    if (valor.isNull()) {
+        escritor.escribir(0xc0);
+    } else if (valor.is<bool>()) {
+        escritor.escribir(valor.as<bool>() ? 0xc3 : 0xc2);
+    } else if (valor.is<long>()) {
+        escritor.escribirEntero(valor.as<long>());
+    } else if (valor.is<unsigned long>()) {
+        escritor.escribirEntero(valor.as<unsigned long>());
+    } else if (valor.is<float>()) {
+        escritor.escribirFlotante(valor.as<float>());
+    } else if (valor.is<const char*>()) {
+        escritor.escribirTexto(valor.as<const char*>());
+    } else if (valor.is<JsonObjectConst>()) {
+        JsonObjectConst objeto = valor.as<JsonObjectConst>();
+        escritor.escribirCabeceraMapa(objeto.size() + (raiz ? 1 : 0));
+        if (raiz) {
+            escritor.escribirEntero(CLAVE_VERSION);
+            escritor.escribirEntero(VERSION_ESQUEMA);
+        }
+        for (JsonPairConst par : objeto) {
+            int id = obtenerIdCampo(par.key().c_str());
+            if (id > 0) {
+                escritor.escribirEntero(id);
+            } else {
+                escritor.escribirTexto(par.key().c_str());
+            }
+            escribirValor(escritor, par.value(), false);
+        }
+    } else if (valor.is<JsonArrayConst>()) {
+        JsonArrayConst arreglo = valor.as<JsonArrayConst>();
+        escritor.escribirCabeceraArreglo(arreglo.size());
+        for (JsonVariantConst elemento : arreglo) {
+            escribirValor(escritor, elemento, false);
+        }
+    } else {
+        escritor.escribir(0xc0);
+    }
+}
+
+void CodificadorBinario::Escritor::escribir(uint8_t byte) {
+    escribir(&byte, 1);
+}
+
+void CodificadorBinario::Escritor::escribir(const void* datos, size_t longitud) {
+    if (longitud == 0) {
+        return;
+    }
+    if (desbordado || posicion + longitud > capacidad) {
+        desbordado = true;
+        return;
+    }
+    memcpy(destino + posicion, datos, longitud);
+    posicion += longitud;
+}
+
+void CodificadorBinario::Escritor::escribirEntero(int64_t valor) {
+    // Formato más corto que represente el valor
+    if (valor >= 0 && valor <= 0x7F) {
+        escribir((uint8_t)valor);
+    } else if (valor < 0 && valor >= -32) {
+        escribir((uint8_t)(0xe0 | (valor & 0x1F)));
+    } else if (valor >= 0 && valor <= 0xFF) {
+        uint8_t bytes[] = {0xcc, (uint8_t)valor};
+        escribir(bytes, sizeof(bytes));
+    } else if (valor >= 0 && valor <= 0xFFFF) {
+        uint8_t bytes[] = {0xcd, (uint8_t)(valor >> 8), (uint8_t)valor};
+        escribir(bytes, sizeof(bytes));
+    } else if (valor >= 0 && valor <= 0xFFFFFFFFLL) {
+        uint8_t bytes[] = {0xce, (uint8_t)(valor >> 24), (uint8_t)(valor >> 16), (uint8_t)(valor >> 8), (uint8_t)valor};
+        escribir(bytes, sizeof(bytes));
+    } else if (valor >= -128 && valor < 0) {
+        uint8_t bytes[] = {0xd0, (uint8_t)valor};
+        escribir(bytes, sizeof(bytes));
+    } else if (valor >= -32768 && valor < 0) {
+        uint8_t bytes[] = {0xd1, (uint8_t)(valor >> 8), (uint8_t)valor};
+        escribir(bytes, sizeof(bytes));
+    } else if (valor >= -2147483648LL && valor < 0) {
+        uint8_t bytes[] = {0xd2, (uint8_t)(valor >> 24), (uint8_t)(valor >> 16), (uint8_t)(valor >> 8), (uint8_t)valor};
+        escribir(bytes, sizeof(bytes));
+    } else {
+        uint8_t bytes[9] = {(uint8_t)(valor < 0 ? 0xd3 : 0xcf)};
+        for (int i = 0; i < 8; i++) {
+            bytes[1 + i] = (uint8_t)(valor >> (56 - 8 * i));
+        }
+        escribir(bytes, sizeof(bytes));
+    }
+}
+
+void CodificadorBinario::Escritor::escribirFlotante(float valor) {
+    uint32_t bits;
+    memcpy(&bits, &valor, sizeof(bits));
+    uint8_t bytes[] = {0xca, (uint8_t)(bits >> 24), (uint8_t)(bits >> 16), (uint8_t)(bits >> 8), (uint8_t)bits};
+    escribir(bytes, sizeof(bytes));
+}
+
+void CodificadorBinario::Escritor::escribirTexto(const char* texto) {
+    size_t longitud = texto ? strlen(texto) : 0;
+    if (longitud <= 31) {
+        escribir((uint8_t)(0xa0 | longitud));
+    } else if (longitud <= 0xFF) {
+        uint8_t bytes[] = {0xd9, (uint8_t)longitud};
+        escribir(bytes, sizeof(bytes));
+    } else {
+        uint8_t bytes[] = {0xda, (uint8_t)(longitud >> 8), (uint8_t)longitud};
+        escribir(bytes, sizeof(bytes));
+    }
+    escribir(texto, longitud);
+}
+
+void CodificadorBinario::Escritor::escribirCabeceraMapa(size_t cantidad) {
+    if (cantidad <= 15) {
+        escribir((uint8_t)(0x80 | cantidad));
+    } else {
+        uint8_t bytes[] = {0xde, (uint8_t)(cantidad >> 8), (uint8_t)cantidad};
+        escribir(bytes, sizeof(bytes));
+    }
+}
+
+void CodificadorBinario::Escritor::escribirCabeceraArreglo(size_t cantidad) {
+    if (cantidad <= 15) {
+        escribir((uint8_t)(0x90 | cantidad));
+    } else {
+        uint8_t bytes[] = {0xdc, (uint8_t)(cantidad >> 8), (uint8_t)cantidad};
+        escribir(bytes, sizeof(bytes));
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef CODIFICADORBINARIO_H
+#define CODIFICADORBINARIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// Codificación binaria compacta de los mensajes MQTT (MessagePack).
+// Los nombres de campo conocidos se reemplazan por identificadores enteros
+// de la tabla del esquema; los desconocidos se escriben como texto. El
+// objeto raíz lleva la clave 0 con la versión del esquema. Los números con
+// decimales se escriben como float32.
+//
+// La tabla solo crece: un campo nuevo toma el siguiente identificador libre
+// y un cambio de significado requiere subir VERSION_ESQUEMA. El decodificador
+// de referencia está en herramientas/payload_binario.py.
+//
+// Sin dependencias de Arduino (solo ArduinoJson): test/test_codificador_binario
+// lo compara con payload_binario.py y con serializeJson (pio test -e native).
+class CodificadorBinario {
+public:
+    static const uint8_t VERSION_ESQUEMA = 1;
+    static const uint8_t CLAVE_VERSION = 0;
+    static const size_t TAMANO_CABECERA_ARREGLO = 3;   // array16
+
+private:
+    struct Escritor {
+        uint8_t* destino;
+        size_t capacidad;
+        size_t posicion;
+        bool desbordado;
+
+        void escribir(uint8_t byte);
+        void escribir(const void* datos, size_t longitud);
+        void escribirEntero(int64_t valor);
+        void escribirFlotante(float valor);
+        void escribirTexto(const char* texto);
+        void escribirCabeceraMapa(size_t cantidad);
+        void escribirCabeceraArreglo(size_t cantidad);
+    };
+
+    static void escribirValor(Escritor& escritor, JsonVariantConst valor, bool raiz);
+
+public:
+    // Devuelve los bytes escritos, 0 si no entra en el destino
+    static size_t codificar(JsonVariantConst datos, uint8_t* destino, size_t capacidad);
+
+    // Cabecera de un arreglo de mensajes ya codificados (lotes)
+    static size_t codificarCabeceraArreglo(uint16_t cantidad, uint8_t* destino, size_t capacidad);
+
+    // Identificador del campo en el esquema, -1 si no figura
+    static int obtenerIdCampo(const char* nombre);
+
+    // Inversa de obtenerIdCampo, nullptr si el identificador no figura
+    static const char* obtenerNombreCampo(int id);
+};
+
+#endif
@@ -0,0 +1,27 @@
+#include "ConversionCanal.h"
+
+namespace ConversionCanal {
+
+Resultado convertir(const PerfilSensor& perfil, float milivoltios, float r0, float umbral,
+                    float alimentacionV, float cargaKOhm) {
+    Resultado resultado;
+    const float numerador = alimentacionV * cargaKOhm * 1000.0f; // mV·kΩ
+
+    float mv = milivoltios > 0 ? milivoltios : 1.0f;
+    float resistencia = numerador / mv - cargaKOhm;
+    resultado.rs = resistencia > 0 ? resistencia : 0;
+    resultado.ratio = resultado.rs / r0;
+    resultado.ppm = CurvasGas::evaluar(*perfil.curva, resultado.ratio) * perfil.factorCurva;
+
+    // A fondo de escala Rs = 0: la curva da su máximo y la lectura satura
+    resultado.saturada = milivoltios > 0 && resultado.ppm > perfil.rangoMaximo;
+    if (resultado.saturada) {
+        resultado.ppm = perfil.rangoMaximo;
+    }
+
+    resultado.valida = milivoltios > 0 && resultado.ppm >= perfil.rangoMinimo;
+    resultado.alarma = resultado.valida && resultado.ppm >= umbral;
+    return resultado;
+}
+
+}
@@ -0,0 +1,31 @@
+#ifndef CONVERSIONCANAL_H
+#define CONVERSIONCANAL_H
+
+#include "PerfilesSensor.h"
+
+// Conversión de un canal MQ: mV -> Rs -> Rs/R0 -> ppm, con la validez y la
+// alarma de la lectura. La usa GasSensorArray::convertirCanales() en cada
+// medición; test/test_conversion_canal la prueba (pio test -e native).
+// Sin dependencias de Arduino.
+//
+// Solo es inválida una lectura sin señal (0 mV, sensor desconectado) o por
+// debajo del rango del perfil. Por encima del rango la concentración se
+// recorta a rangoMaximo y se marca saturada: el gas sigue presente y la
+// alarma se mantiene.
+namespace ConversionCanal {
+
+struct Resultado {
+    float rs;           // kΩ
+    float ratio;        // Rs/R0
+    float ppm;          // Recortada a rangoMaximo si satura
+    bool valida;
+    bool saturada;
+    bool alarma;
+};
+
+Resultado convertir(const PerfilSensor& perfil, float milivoltios, float r0, float umbral,
+                    float alimentacionV, float cargaKOhm);
+
+}
+
+#endif
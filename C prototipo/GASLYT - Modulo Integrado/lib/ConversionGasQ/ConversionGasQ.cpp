@@ -0,0 +1,166 @@
+#include "ConversionGasQ.h"
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define LEER_TABLA(tabla, i) pgm_read_dword(&(tabla)[i])
+#else
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#define LEER_TABLA(tabla, i) ((tabla)[i])
+#endif
+
+namespace ConversionGasQ {
+
+const int BITS_TABLA = 5;
+const int PUNTOS_TABLA = (1 << BITS_TABLA) + 1;
+
+// log2(1 + i/32) en Q16.16
+static const uint32_t TABLA_LOG2[PUNTOS_TABLA] PROGMEM = {
+    0, 2909, 5732, 8473, 11136, 13727, 16248, 18704,
+    21098, 23433, 25711, 27936, 30109, 32234, 34312, 36346,
+    38336, 40286, 42196, 44068, 45904, 47705, 49472, 51207,
+    52911, 54584, 56229, 57845, 59434, 60997, 62534, 64047,
+    65536
+};
+
+// 2^(i/32) en Q16.16
+static const uint32_t TABLA_EXP2[PUNTOS_TABLA] PROGMEM = {
+    65536, 66971, 68438, 69936, 71468, 73032, 74632, 76266,
+    77936, 79642, 81386, 83169, 84990, 86851, 88752, 90696,
+    92682, 94711, 96785, 98905, 101070, 103283, 105545, 107856,
+    110218, 112631, 115098, 117618, 120194, 122825, 125515, 128263,
+    131072
+};
+
+const CurvaQ CURVA_MQ2 = {Q16(9.948352629), Q16(-2.162)};
+const CurvaQ CURVA_MQ3 = {Q16(-1.358453971), Q16(-1.504)};
+const CurvaQ CURVA_MQ4 = {Q16(9.983991141), Q16(-2.786)};
+const CurvaQ CURVA_MQ5 = {Q16(10.184627436), Q16(-3.874)};
+const CurvaQ CURVA_MQ6 = {Q16(11.054739967), Q16(-2.526)};
+const CurvaQ CURVA_MQ7 = {Q16(6.629968543), Q16(-1.518)};
+const CurvaQ CURVA_MQ8 = {Q16(9.932170452), Q16(-0.688)};
+const CurvaQ CURVA_MQ9 = {Q16(9.227976873), Q16(-2.244)};
+const CurvaQ CURVA_MQ135 = {Q16(6.787510824), Q16(-2.862)};
+
+// Interpolación lineal en una tabla de 33 puntos; fraccion en [0, 2^16)
+static uint32_t interpolar(const uint32_t* tabla, uint16_t fraccion) {
+    uint8_t indice = fraccion >> (BITS_FRACCION - BITS_TABLA);
+    uint16_t resto = fraccion & ((1U << (BITS_FRACCION - BITS_TABLA)) - 1);
+    uint32_t inicio = LEER_TABLA(tabla, indice);
+    uint32_t fin = LEER_TABLA(tabla, indice + 1);
+    return inicio + (((fin - inicio) * resto) >> (BITS_FRACCION - BITS_TABLA));
+}
+
+q16_t log2Entero(uint32_t x) {
+    if (x == 0) {
+        return -(q16_t)(32L << BITS_FRACCION);
+    }
+
+    // Parte entera: posición del bit más significativo
+    int8_t exponente = 31;
+    while (!(x & 0x80000000UL)) {
+        x <<= 1;
+        exponente--;
+    }
+
+    // Mantisa normalizada en [1,2): los 16 bits siguientes al bit líder
+    uint16_t fraccion = (uint16_t)(x >> 15);
+    return ((q16_t)exponente << BITS_FRACCION) + (q16_t)interpolar(TABLA_LOG2, fraccion);
+}
+
+uint32_t exp2Q(q16_t y) {
+    // 2^y = 2^entero * 2^fraccion, con 2^fraccion en Q16.16 desde la tabla
+    int16_t entero = (int16_t)(y >> BITS_FRACCION);
+    uint16_t fraccion = (uint16_t)(y & 0xFFFF);
+    uint32_t mantisa = interpolar(TABLA_EXP2, fraccion);
+
+    if (entero >= 15) {
+        return SATURACION;
+    }
+    if (entero >= 0) {
+        return mantisa << entero;
+    }
+    if (entero <= -32) {
+        return 0;
+    }
+    return mantisa >> -entero;
+}
+
+q16_t multiplicarQ(q16_t a, q16_t b) {
+    return (q16_t)(((int64_t)a * b) >> BITS_FRACCION);
+}
+
+q16_t log2RsRL(uint16_t muestra, uint16_t escala) {
+    // Extremos: sin señal -> Rs muy alta; señal a escala completa -> Rs nula
+    if (muestra == 0) {
+        return log2Entero(escala);
+    }
+    if (muestra >= escala) {
+        return -log2Entero(escala);
+    }
+    return log2Entero(escala - muestra) - log2Entero(muestra);
+}
+
+q16_t log2Ratio(const SensorQ& sensor, uint16_t muestra) {
+    return log2RsRL(muestra, sensor.escala) - sensor.log2R0RL;
+}
+
+uint32_t ppmDesdeLog2Ratio(const CurvaQ& curva, q16_t log2Ratio) {
+    return exp2Q(curva.log2A + multiplicarQ(curva.b, log2Ratio));
+}
+
+uint32_t convertir(const SensorQ& sensor, uint16_t muestra) {
+    return ppmDesdeLog2Ratio(*sensor.curva, log2Ratio(sensor, muestra));
+}
+
+q16_t calibrarLog2R0RL(q16_t mediaLog2RsRL, q16_t log2RatioAireLimpio) {
+    // En aire limpio Rs/R0 = ratio de aire limpio
+    return mediaLog2RsRL - log2RatioAireLimpio;
+}
+
+uint8_t formatear(char* destino, uint8_t tamano, uint32_t valorQ, uint8_t decimales) {
+    if (!destino || tamano < 2) {
+        return 0;
+    }
+    if (decimales > 4) {
+        decimales = 4;
+    }
+
+    // Redondeo al último decimal pedido
+    uint32_t factor = 1;
+    for (uint8_t i = 0; i < decimales; i++) {
+        factor *= 10;
+    }
+    uint32_t entero = valorQ >> BITS_FRACCION;
+    uint32_t decimal = (uint32_t)((((uint64_t)(valorQ & 0xFFFF) * factor) + (UNO / 2)) >> BITS_FRACCION);
+    if (decimal >= factor) {
+        entero++;
+        decimal -= factor;
+    }
+
+    // Parte entera, de atrás hacia adelante
+    char digitos[16];
+    uint8_t cantidad = 0;
+    do {
+        digitos[cantidad++] = '0' + (entero % 10);
+        entero /= 10;
+    } while (entero > 0);
+
+    uint8_t longitud = 0;
+    while (cantidad > 0 && longitud < tamano - 1) {
+        destino[longitud++] = digitos[--cantidad];
+    }
+
+    if (decimales > 0 && longitud < tamano - 1) {
+        destino[longitud++] = '.';
+        for (uint32_t divisor = factor / 10; divisor > 0 && longitud < tamano - 1; divisor /= 10) {
+            destino[longitud++] = '0' + (decimal / divisor) % 10;
+        }
+    }
+
+    destino[longitud] = '\0';
+    return longitud;
+}
+
+}
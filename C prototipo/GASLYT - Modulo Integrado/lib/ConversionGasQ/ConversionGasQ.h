@@ -0,0 +1,80 @@
+#ifndef CONVERSIONGASQ_H
+#define CONVERSIONGASQ_H
+
+#include <stdint.h>
+
+// Conversión de sensores MQ en punto fijo Q16.16, sin operaciones de coma
+// flotante en tiempo de ejecución. Pensada para nodos sin FPU (Arduino Nano)
+// y compartida con el módulo ESP32.
+//
+// La conversión trabaja en el dominio logarítmico:
+//   Rs/RL  = (escala - muestra) / muestra      (divisor resistivo, ratiométrico)
+//   ratio  = Rs/R0  ->  log2(ratio) = log2(Rs/RL) - log2(R0/RL)
+//   ppm    = a * ratio^b  ->  log2(ppm) = log2(a) + b * log2(ratio)
+// log2 y 2^x salen de tablas de 33 puntos con interpolación lineal.
+//
+// Error relativo frente a a*pow(ratio, b) en double, para muestras de 10
+// bits entre 1% y 99% de la escala, R0/RL entre 0.5 y 10 y ppm en
+// [0.01, 10000]: ppm < 0.18% (0.177% MQ-135, 0.166% MQ-5, 0.156% MQ-3),
+// concentrado por debajo de 1 ppm, donde pesa la resolución de 1/65536 del
+// Q16.16; desde 1 ppm, < 0.06% (MQ-5). ratio < 0.02% para ratio > 0.05.
+// test/test_conversion_gas_q mide estas cotas (pio test -e native).
+// Sin dependencias de Arduino.
+namespace ConversionGasQ {
+
+typedef int32_t q16_t;
+
+const int BITS_FRACCION = 16;
+const q16_t UNO = 1L << BITS_FRACCION;
+const uint32_t SATURACION = 0xFFFFFFFFUL;
+
+// Constante Q16.16 calculada al compilar
+#define Q16(x) ((ConversionGasQ::q16_t)((x) * 65536.0 + ((x) < 0 ? -0.5 : 0.5)))
+
+// Curva ppm = a * ratio^b en dominio logarítmico
+struct CurvaQ {
+    q16_t log2A;
+    q16_t b;
+};
+
+// Estado de un sensor
+struct SensorQ {
+    uint16_t escala;    // Muestra equivalente a la alimentación (1023 en AVR, mV en ESP32)
+    q16_t log2R0RL;     // log2(R0/RL), resultado de la calibración
+    const CurvaQ* curva;
+};
+
+// Operaciones básicas
+q16_t log2Entero(uint32_t x);           // log2(x) para x > 0
+uint32_t exp2Q(q16_t y);                // 2^y en Q16.16, satura
+q16_t multiplicarQ(q16_t a, q16_t b);
+
+// Etapas de la conversión
+q16_t log2RsRL(uint16_t muestra, uint16_t escala);
+q16_t log2Ratio(const SensorQ& sensor, uint16_t muestra);
+uint32_t ppmDesdeLog2Ratio(const CurvaQ& curva, q16_t log2Ratio);   // ppm Q16.16
+
+// Conversión completa: una muestra del ADC a ppm Q16.16
+uint32_t convertir(const SensorQ& sensor, uint16_t muestra);
+
+// Calibración: media de log2(Rs/RL) en aire limpio -> log2(R0/RL)
+q16_t calibrarLog2R0RL(q16_t mediaLog2RsRL, q16_t log2RatioAireLimpio);
+
+// Formatea un valor Q16.16 sin signo con 0-4 decimales; devuelve la longitud
+uint8_t formatear(char* destino, uint8_t tamano, uint32_t valorQ, uint8_t decimales);
+
+// Curvas de los sensores (mismos coeficientes que CurvasGas del ESP32).
+// CURVA_MQ3 da mg/L de alcohol, no ppm (ver factorCurva en PerfilesSensor)
+extern const CurvaQ CURVA_MQ2;
+extern const CurvaQ CURVA_MQ3;
+extern const CurvaQ CURVA_MQ4;
+extern const CurvaQ CURVA_MQ5;
+extern const CurvaQ CURVA_MQ6;
+extern const CurvaQ CURVA_MQ7;
+extern const CurvaQ CURVA_MQ8;
+extern const CurvaQ CURVA_MQ9;
+extern const CurvaQ CURVA_MQ135;
+
+}
+
+#endif
@@ -0,0 +1,59 @@
+#include "PayloadMQTT.h"
+#include "CodificadorBinario.h"
+
+namespace PayloadMQTT {
+
+bool armarLectura(JsonDocument& doc, const DatosLectura& datos) {
+    doc.clear();
+    doc["timestamp"] = datos.timestamp;
+    doc["fecha"] = datos.fecha;
+    doc["concentracion"] = datos.concentracion;
+    doc["unidad"] = "ppm";
+    doc["umbral"] = datos.umbral;
+    doc["alarma"] = datos.alarma;
+    doc["idDispositivo"] = datos.idDispositivo;
+    doc["rssi"] = datos.rssi;
+    doc["arranque"] = datos.arranque;
+    doc["secuencia"] = datos.secuencia;
+
+    JsonArray canales = doc.createNestedArray("canales");
+    for (int i = 0; i < datos.cantidadCanales; i++) {
+        const DatosCanal& datosCanal = datos.canales[i];
+        JsonObject canal = canales.createNestedObject();
+        canal["tipo"] = datosCanal.tipo;
+        canal["gas"] = datosCanal.gas;
+        canal["concentracion"] = datosCanal.concentracion;
+        canal["ratio"] = datosCanal.ratio;
+        canal["umbral"] = datosCanal.umbral;
+        canal["alarma"] = datosCanal.alarma;
+        canal["valida"] = datosCanal.valida;
+        canal["saturada"] = datosCanal.saturada;
+
+        JsonObject resumen = canal.createNestedObject("estadisticas");
+        resumen["media"] = datosCanal.media;
+        resumen["desviacion"] = datosCanal.desviacion;
+        resumen["ewma"] = datosCanal.ewma;
+        resumen["minimo"] = datosCanal.minimo;
+        resumen["maximo"] = datosCanal.maximo;
+        resumen["muestras"] = datosCanal.muestras;
+
+        canal["tendencia"] = datosCanal.tendencia;
+        canal["tiempoHastaUmbral"] = datosCanal.tiempoHastaUmbral;
+    }
+    return !doc.overflowed();
+}
+
+size_t serializar(JsonVariantConst datos, bool binario, uint8_t* destino, size_t capacidad) {
+    if (binario) {
+        return CodificadorBinario::codificar(datos, destino, capacidad);
+    }
+
+    // Se deja lugar para el terminador
+    size_t longitud = measureJson(datos);
+    if (longitud + 1 > capacidad) {
+        return 0;
+    }
+    return serializeJson(datos, (char*)destino, capacidad);
+}
+
+}
@@ -0,0 +1,59 @@
+#ifndef PAYLOADMQTT_H
+#define PAYLOADMQTT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// Payload de los mensajes MQTT: el documento de una lectura y su
+// serialización en JSON o MessagePack en los buffers fijos de MQTTManager.
+// Sin String ni memoria dinámica, porque corre en cada lectura:
+// test/test_payload_mqtt recorre armarLectura(), serializar() y
+// PlanificadorSalida::encolar() contando las reservas de memoria
+// (pio test -e native). Sin dependencias de Arduino (solo ArduinoJson).
+namespace PayloadMQTT {
+
+struct DatosCanal {
+    const char* tipo;           // Nombre del perfil, p. ej. "MQ-2"
+    const char* gas;
+    float concentracion;        // ppm
+    float ratio;                // Rs/R0
+    float umbral;
+    bool alarma;
+    bool valida;
+    bool saturada;              // ppm recortada a rangoMaximo
+    float media;
+    float desviacion;
+    float ewma;
+    float minimo;
+    float maximo;
+    uint32_t muestras;
+    float tendencia;            // ppm/s
+    float tiempoHastaUmbral;    // s, -1 = sin cruce
+};
+
+struct DatosLectura {
+    unsigned long timestamp;
+    const char* fecha;
+    float concentracion;        // Canal más cercano a su umbral
+    float umbral;
+    bool alarma;
+    const char* idDispositivo;
+    int rssi;
+    uint32_t arranque;
+    uint32_t secuencia;
+    const DatosCanal* canales;
+    int cantidadCanales;
+};
+
+// Vacía doc y arma la lectura; false si no entró. Los textos se guardan
+// por puntero: deben seguir vigentes hasta serializar
+bool armarLectura(JsonDocument& doc, const DatosLectura& datos);
+
+// JSON (con lugar para el terminador) o MessagePack. Devuelve los bytes
+// escritos, 0 si no entra en el destino
+size_t serializar(JsonVariantConst datos, bool binario, uint8_t* destino, size_t capacidad);
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "PerfilesSensor.h"
+#include <string.h>
+
+// mg/m3 = ppm * PM / 24.45 (25 °C, 1 atm); %LEL = ppm / LEL(ppm) * 100
+#define MG_M3(pesoMolecular) ((pesoMolecular) / 24.45f)
+#define LEL(limitePpm) (100.0f / (limitePpm))
+// Curvas en mg/L: ppm = mg/L * 1000 * 24.45 / PM
+#define PPM_MG_L(pesoMolecular) (24450.0f / (pesoMolecular))
+
+static const PerfilSensor PERFILES[CANTIDAD_TIPOS_SENSOR] = {
+    // nombre    gas        curva                ppm/curva              ratio  min  max                        ppm   mg/m3            %LEL
+    { "MQ-2",   "H2",      &CurvasGas::MQ2,     1.0f,                  9.83,  0, 10000,                    { 1.0f, MG_M3(2.016f),  LEL(40000.0f) } },
+    { "MQ-3",   "Alcohol", &CurvasGas::MQ3,     PPM_MG_L(46.07f),      60.0,  0, 10 * PPM_MG_L(46.07f),    { 1.0f, MG_M3(46.07f),  LEL(33000.0f) } }, // 10 mg/L
+    { "MQ-4",   "CH4",     &CurvasGas::MQ4,     1.0f,                  4.4,   0, 10000,                    { 1.0f, MG_M3(16.04f),  LEL(50000.0f) } },
+    { "MQ-5",   "H2",      &CurvasGas::MQ5,     1.0f,                  6.5,   0, 10000,                    { 1.0f, MG_M3(2.016f),  LEL(40000.0f) } },
+    { "MQ-6",   "GLP",     &CurvasGas::MQ6,     1.0f,                  10.0,  0, 10000,                    { 1.0f, MG_M3(44.10f),  LEL(21000.0f) } },
+    { "MQ-7",   "CO",      &CurvasGas::MQ7,     1.0f,                  27.5,  0, 2000,                     { 1.0f, MG_M3(28.01f),  LEL(125000.0f) } },
+    { "MQ-8",   "H2",      &CurvasGas::MQ8,     1.0f,                  70.0,  0, 10000,                    { 1.0f, MG_M3(2.016f),  LEL(40000.0f) } },
+    { "MQ-9",   "CO",      &CurvasGas::MQ9,     1.0f,                  9.6,   0, 1000,                     { 1.0f, MG_M3(28.01f),  LEL(125000.0f) } },
+    { "MQ-135", "CO2",     &CurvasGas::MQ135,   1.0f,                  3.6,   0, 10000,                    { 1.0f, MG_M3(44.01f),  0.0f } }, // No inflamable
+};
+
+static const char* const NOMBRES_UNIDADES[CANTIDAD_UNIDADES] = { "ppm", "mg/m3", "%LEL" };
+
+namespace PerfilesSensor {
+
+const PerfilSensor& obtener(TipoSensorMQ tipo) {
+    if (tipo >= CANTIDAD_TIPOS_SENSOR) {
+        return PERFILES[SENSOR_MQ2];
+    }
+    return PERFILES[tipo];
+}
+
+const char* nombreUnidad(UnidadConcentracion unidad) {
+    if (unidad >= CANTIDAD_UNIDADES) {
+        return NOMBRES_UNIDADES[UNIDAD_PPM];
+    }
+    return NOMBRES_UNIDADES[unidad];
+}
+
+float convertir(const PerfilSensor& perfil, float ppm, UnidadConcentracion unidad) {
+    if (unidad >= CANTIDAD_UNIDADES) {
+        return ppm;
+    }
+    return ppm * perfil.factorConversion[unidad];
+}
+
+bool buscarTipo(const char* nombre, TipoSensorMQ& tipo) {
+    for (uint8_t i = 0; i < CANTIDAD_TIPOS_SENSOR; i++) {
+        if (strcmp(nombre, PERFILES[i].nombre) == 0) {
+            tipo = (TipoSensorMQ)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool buscarUnidad(const char* nombre, UnidadConcentracion& unidad) {
+    for (uint8_t i = 0; i < CANTIDAD_UNIDADES; i++) {
+        if (strcmp(nombre, NOMBRES_UNIDADES[i]) == 0) {
+            unidad = (UnidadConcentracion)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,55 @@
+#ifndef PERFILESSENSOR_H
+#define PERFILESSENSOR_H
+
+#include <stdint.h>
+#include "CurvasGas.h"
+
+// Registro de perfiles de sensores MQ indexado por tipo.
+// Cada perfil reúne la curva, el ratio Rs/R0 en aire limpio, el rango válido
+// y los factores de conversión desde ppm. Todo el camino de lectura trabaja
+// en ppm: factorCurva lleva la salida de la curva a ppm (la del MQ-3 está en
+// mg/L de alcohol). Agregar un sensor es agregar una
+// entrada al enum y una fila a la tabla de PerfilesSensor.cpp.
+
+enum TipoSensorMQ : uint8_t {
+    SENSOR_MQ2 = 0,
+    SENSOR_MQ3,
+    SENSOR_MQ4,
+    SENSOR_MQ5,
+    SENSOR_MQ6,
+    SENSOR_MQ7,
+    SENSOR_MQ8,
+    SENSOR_MQ9,
+    SENSOR_MQ135,
+    CANTIDAD_TIPOS_SENSOR
+};
+
+enum UnidadConcentracion : uint8_t {
+    UNIDAD_PPM = 0,
+    UNIDAD_MG_M3,
+    UNIDAD_LEL,       // % del límite inferior de explosividad
+    CANTIDAD_UNIDADES
+};
+
+struct PerfilSensor {
+    const char* nombre;
+    const char* gas;
+    const CurvasGas::TablaCurva* curva;
+    float factorCurva;                           // ppm = curva(Rs/R0) * factor
+    float ratioAireLimpio;                       // Rs/R0 en aire limpio
+    float rangoMinimo;                           // ppm
+    float rangoMaximo;                           // ppm
+    float factorConversion[CANTIDAD_UNIDADES];   // valor = ppm * factor (0 = no aplica)
+};
+
+namespace PerfilesSensor {
+    const PerfilSensor& obtener(TipoSensorMQ tipo);
+    const char* nombreUnidad(UnidadConcentracion unidad);
+    float convertir(const PerfilSensor& perfil, float ppm, UnidadConcentracion unidad);
+
+    // Solo para entrada de configuración (no usar en el camino de lectura)
+    bool buscarTipo(const char* nombre, TipoSensorMQ& tipo);
+    bool buscarUnidad(const char* nombre, UnidadConcentracion& unidad);
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef DESTINOSALIDA_H
+#define DESTINOSALIDA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Lo que PlanificadorSalida usa del transporte: TransporteMQTT en el
+// equipo, un destino simulado en los tests
+class DestinoSalida {
+public:
+    // Entrega de un mensaje con identificador: entregado = true al escribirse
+    // (QoS 0) o al recibir el PUBACK (QoS 1); false si se descartó sin enviar
+    typedef void (*CallbackEntrega)(uint32_t identificador, bool entregado);
+
+    virtual ~DestinoSalida() {}
+
+    virtual bool estaConectado() = 0;
+    virtual bool puedePublicar(const char* topic, size_t longitud, uint8_t qos) { return true; }
+    virtual bool publicar(const char* topic, const uint8_t* datos, size_t longitud, uint8_t qos, bool retener,
+                          uint32_t identificador) = 0;
+};
+
+#endif
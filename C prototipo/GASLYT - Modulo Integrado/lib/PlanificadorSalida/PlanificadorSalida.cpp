@@ -0,0 +1,213 @@
+#include "PlanificadorSalida.h"
+#include <string.h>
+
+PlanificadorSalida::PlanificadorSalida() :
+    cantidad(0), memoriaUsada(0), rechazados(0), enviados(0), descartadosPorIntentos(0), ultimoNumero(0),
+    callbackEntrega(nullptr) {
+    // Profundidad por clase (suma = MAXIMO_MENSAJES)
+    profundidad[PRIORIDAD_ALARMA] = 8;
+    profundidad[PRIORIDAD_CONFIRMACION] = 4;
+    profundidad[PRIORIDAD_LECTURA] = 8;
+    profundidad[PRIORIDAD_METADATA] = 2;
+    profundidad[PRIORIDAD_PROGRESO] = 2;
+
+    for (int i = 0; i < CANTIDAD_PRIORIDADES; i++) {
+        enCola[i] = 0;
+        descartados[i] = 0;
+    }
+}
+
+uint32_t PlanificadorSalida::encolar(Prioridad prioridad, const char* topic, const uint8_t* datos, size_t longitud,
+                                     uint8_t qos, bool retener, uint32_t identificador) {
+    size_t longitudTopic = strlen(topic);
+    size_t necesario = longitudTopic + 1 + longitud;
+    if (prioridad >= CANTIDAD_PRIORIDADES || necesario > TAMANO_MEMORIA) {
+        rechazados++;
+        return 0;
+    }
+
+    // Clase llena: una alarma toma el lugar del mensaje más antiguo de menor prioridad
+    if (enCola[prioridad] >= profundidad[prioridad]) {
+        int indice = prioridad == PRIORIDAD_ALARMA ? buscarDescartable(prioridad) : -1;
+        if (indice < 0) {
+            rechazados++;
+            return 0;
+        }
+        descartar(indice);
+    }
+
+    // Hacer lugar descartando lo más antiguo de las clases de menor prioridad
+    while (cantidad >= MAXIMO_MENSAJES || memoriaUsada + necesario > TAMANO_MEMORIA) {
+        int indice = buscarDescartable(prioridad);
+        if (indice < 0) {
+            rechazados++;
+            return 0;
+        }
+        descartar(indice);
+    }
+
+    // 0 queda para "rechazado"
+    if (++ultimoNumero == 0) {
+        ultimoNumero = 1;
+    }
+
+    Mensaje& mensaje = mensajes[cantidad];
+    mensaje.prioridad = prioridad;
+    mensaje.qos = qos;
+    mensaje.retener = retener;
+    mensaje.intentos = 0;
+    mensaje.numero = ultimoNumero;
+    mensaje.identificador = identificador;
+    mensaje.inicio = memoriaUsada;
+    mensaje.longitudTopic = longitudTopic;
+    mensaje.longitudDatos = longitud;
+
+    memcpy(memoria + memoriaUsada, topic, longitudTopic + 1);
+    memcpy(memoria + memoriaUsada + longitudTopic + 1, datos, longitud);
+    memoriaUsada += necesario;
+    enCola[prioridad]++;
+    cantidad++;
+    return mensaje.numero;
+}
+
+int PlanificadorSalida::despachar(DestinoSalida* transporte) {
+    int enviadosAhora = 0;
+    while (cantidad > 0 && transporte && transporte->estaConectado()) {
+        int indice = buscarSiguiente();
+        Mensaje& mensaje = mensajes[indice];
+
+        const char* topic = (const char*)(memoria + mensaje.inicio);
+
+        // Sin lugar en el transporte (ventana QoS 1 llena): se sigue en el próximo loop
+        if (!transporte->puedePublicar(topic, mensaje.longitudDatos, mensaje.qos)) {
+            break;
+        }
+
+        const uint8_t* datos = memoria + mensaje.inicio + mensaje.longitudTopic + 1;
+        if (transporte->publicar(topic, datos, mensaje.longitudDatos, mensaje.qos, mensaje.retener, mensaje.identificador)) {
+            quitar(indice);
+            enviados++;
+            enviadosAhora++;
+            continue;
+        }
+
+        // Un mensaje que el transporte rechaza con lugar disponible no bloquea la cola para siempre
+        if (++mensaje.intentos >= MAXIMO_INTENTOS) {
+            descartadosPorIntentos++;
+            descartar(indice);
+            continue;
+        }
+        break;
+    }
+    return enviadosAhora;
+}
+
+int PlanificadorSalida::buscarSiguiente() const {
+    // El más antiguo de la clase de mayor prioridad
+    int mejor = -1;
+    for (int i = 0; i < cantidad; i++) {
+        if (mejor < 0 || mensajes[i].prioridad < mensajes[mejor].prioridad) {
+            mejor = i;
+        }
+    }
+    return mejor;
+}
+
+int PlanificadorSalida::buscarDescartable(uint8_t prioridad) const {
+    // El más antiguo de la clase de menor prioridad, si es menor que la pedida
+    int peor = -1;
+    for (int i = 0; i < cantidad; i++) {
+        if (mensajes[i].prioridad > prioridad && (peor < 0 || mensajes[i].prioridad > mensajes[peor].prioridad)) {
+            peor = i;
+        }
+    }
+    return peor;
+}
+
+void PlanificadorSalida::descartar(int indice) {
+    uint32_t identificador = mensajes[indice].identificador;
+    descartados[mensajes[indice].prioridad]++;
+    quitar(indice);
+    if (identificador != 0 && callbackEntrega) {
+        callbackEntrega(identificador, false);
+    }
+}
+
+void PlanificadorSalida::establecerCallbackEntrega(DestinoSalida::CallbackEntrega callback) {
+    callbackEntrega = callback;
+}
+
+void PlanificadorSalida::quitar(int indice) {
+    Mensaje quitado = mensajes[indice];
+    size_t longitud = quitado.longitudTopic + 1 + quitado.longitudDatos;
+
+    // Compactar memoria y descriptores posteriores
+    memmove(memoria + quitado.inicio, memoria + quitado.inicio + longitud, memoriaUsada - quitado.inicio - longitud);
+    memoriaUsada -= longitud;
+    for (int i = indice + 1; i < cantidad; i++) {
+        mensajes[i - 1] = mensajes[i];
+        mensajes[i - 1].inicio -= longitud;
+    }
+    cantidad--;
+    enCola[quitado.prioridad]--;
+}
+
+bool PlanificadorSalida::estaEnEspera(uint32_t numero) const {
+    for (int i = 0; i < cantidad; i++) {
+        if (mensajes[i].numero == numero) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int PlanificadorSalida::obtenerEnEspera() const {
+    return cantidad;
+}
+
+int PlanificadorSalida::obtenerEnEspera(Prioridad prioridad) const {
+    return prioridad < CANTIDAD_PRIORIDADES ? enCola[prioridad] : 0;
+}
+
+uint32_t PlanificadorSalida::obtenerDescartados() const {
+    uint32_t total = 0;
+    for (int i = 0; i < CANTIDAD_PRIORIDADES; i++) {
+        total += descartados[i];
+    }
+    return total;
+}
+
+uint32_t PlanificadorSalida::obtenerDescartados(Prioridad prioridad) const {
+    return prioridad < CANTIDAD_PRIORIDADES ? descartados[prioridad] : 0;
+}
+
+uint32_t PlanificadorSalida::obtenerRechazados() const {
+    return rechazados;
+}
+
+uint32_t PlanificadorSalida::obtenerEnviados() const {
+    return enviados;
+}
+
+uint32_t PlanificadorSalida::obtenerDescartadosPorIntentos() const {
+    return descartadosPorIntentos;
+}
+
+size_t PlanificadorSalida::obtenerMemoriaUsada() const {
+    return memoriaUsada;
+}
+
+int PlanificadorSalida::obtenerProfundidad(Prioridad prioridad) const {
+    return prioridad < CANTIDAD_PRIORIDADES ? profundidad[prioridad] : 0;
+}
+
+const char* PlanificadorSalida::obtenerNombrePrioridad(Prioridad prioridad) {
+    switch (prioridad) {
+        case PRIORIDAD_ALARMA: return "alarmas";
+        case PRIORIDAD_CONFIRMACION: return "confirmaciones";
+        case PRIORIDAD_LECTURA: return "lecturas";
+        case PRIORIDAD_METADATA: return "metadata";
+        case PRIORIDAD_PROGRESO: return "progreso";
+        default: return "desconocida";
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef PLANIFICADORSALIDA_H
+#define PLANIFICADORSALIDA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "DestinoSalida.h"
+
+// Cola de salida de MQTTManager con una cola por clase de mensaje. Se
+// despacha siempre el mensaje más antiguo de la clase de mayor prioridad
+// mientras el transporte tenga lugar, así una alarma sale antes que la
+// telemetría y la metadata que esperan. Cada clase tiene una profundidad
+// máxima; un mensaje que no entra en su clase se rechaza (el llamador
+// decide, p. ej. la cola persistente), salvo las alarmas, que con su clase
+// llena ocupan el lugar de un mensaje de menor prioridad. Con la memoria o
+// los lugares agotados se descartan primero los mensajes más antiguos de la
+// clase de menor prioridad que la del mensaje nuevo.
+//
+// Topic y datos se copian a un bloque de memoria fijo en orden de llegada;
+// al quitar un mensaje se compacta el bloque (a lo sumo unos KB). El
+// identificador de un mensaje pasa al transporte, que informa su entrega;
+// si se descarta sin enviarse se informa aquí con entregado = false.
+//
+// Sin dependencias de Arduino: test/test_payload_mqtt lo recorre con un
+// destino simulado (pio test -e native).
+class PlanificadorSalida {
+public:
+    enum Prioridad {
+        PRIORIDAD_ALARMA,               // Mayor prioridad
+        PRIORIDAD_CONFIRMACION,         // Respuestas a configuración y actualizaciones
+        PRIORIDAD_LECTURA,
+        PRIORIDAD_METADATA,
+        PRIORIDAD_PROGRESO,             // Calibración y progreso de OTA
+        CANTIDAD_PRIORIDADES
+    };
+
+    static const int MAXIMO_MENSAJES = 24;
+    static const size_t TAMANO_MEMORIA = 16384;
+    static const uint8_t MAXIMO_INTENTOS = 3;   // Rechazos del transporte con lugar disponible
+
+private:
+    struct Mensaje {
+        uint8_t prioridad;
+        uint8_t qos;
+        bool retener;
+        uint8_t intentos;
+        uint32_t numero;                // Orden de llegada, para estaEnEspera()
+        uint32_t identificador;         // Del llamador (0 = sin seguimiento)
+        uint32_t inicio;                // Posición en memoria: topic + '\0' + datos
+        uint16_t longitudTopic;
+        uint32_t longitudDatos;
+    };
+
+    Mensaje mensajes[MAXIMO_MENSAJES];  // En orden de llegada
+    int cantidad;
+    uint8_t memoria[TAMANO_MEMORIA];
+    size_t memoriaUsada;
+
+    uint8_t profundidad[CANTIDAD_PRIORIDADES];
+    uint8_t enCola[CANTIDAD_PRIORIDADES];
+    uint32_t descartados[CANTIDAD_PRIORIDADES];
+    uint32_t rechazados;
+    uint32_t enviados;
+    uint32_t descartadosPorIntentos;
+    uint32_t ultimoNumero;
+    DestinoSalida::CallbackEntrega callbackEntrega;
+
+    int buscarSiguiente() const;
+    int buscarDescartable(uint8_t prioridad) const;
+    void quitar(int indice);
+    void descartar(int indice);
+
+public:
+    PlanificadorSalida();
+
+    // Devuelve el número del mensaje, 0 si no entra sin desplazar mensajes
+    // de prioridad igual o mayor
+    uint32_t encolar(Prioridad prioridad, const char* topic, const uint8_t* datos, size_t longitud, uint8_t qos, bool retener,
+                     uint32_t identificador = 0);
+    void establecerCallbackEntrega(DestinoSalida::CallbackEntrega callback);
+
+    // Publica en orden de prioridad mientras el transporte acepte; devuelve los enviados
+    int despachar(DestinoSalida* transporte);
+
+    // Estado. Un mensaje que ya no está en espera salió al transporte o se descartó
+    bool estaEnEspera(uint32_t numero) const;
+    int obtenerEnEspera() const;
+    int obtenerEnEspera(Prioridad prioridad) const;
+    uint32_t obtenerDescartados() const;
+    uint32_t obtenerDescartados(Prioridad prioridad) const;
+    uint32_t obtenerRechazados() const;
+    uint32_t obtenerEnviados() const;
+    uint32_t obtenerDescartadosPorIntentos() const;    // Tras MAXIMO_INTENTOS rechazos
+    size_t obtenerMemoriaUsada() const;
+    int obtenerProfundidad(Prioridad prioridad) const;
+    static const char* obtenerNombrePrioridad(Prioridad prioridad);
+};
+
+#endif
@@ -0,0 +1,77 @@
+#include "ReanudacionTLS.h"
+// Estructura interna del handshake: es la única forma de saber si el
+// servidor aceptó la sesión cuando se reanuda con ticket (mbedTLS 2.x)
+#include <mbedtls/ssl_internal.h>
+
+ReanudacionTLS::ReanudacionTLS() : haySesion(false) {
+    mbedtls_ssl_session_init(&sesion);
+}
+
+ReanudacionTLS::~ReanudacionTLS() {
+    mbedtls_ssl_session_free(&sesion);
+}
+
+bool ReanudacionTLS::ofrecer(mbedtls_ssl_context* ssl, const char* host, uint16_t puerto) {
+    return haySesion && destino.coincide(host, puerto) && mbedtls_ssl_set_session(ssl, &sesion) == 0;
+}
+
+int ReanudacionTLS::avanzarHandshake(mbedtls_ssl_context* ssl, bool& reanudado) {
+    int resultado = mbedtls_ssl_handshake_step(ssl);
+
+    // set_session() marca resume antes del ClientHello; recién al leer el
+    // ServerHello queda en 0 si el servidor no aceptó la sesión. Con ticket
+    // el ID de sesión cambia en cada conexión y no sirve para detectarlo
+    if (ssl->handshake && ssl->state > MBEDTLS_SSL_SERVER_HELLO) {
+        reanudado = ssl->handshake->resume != 0;
+    }
+    return resultado;
+}
+
+bool ReanudacionTLS::handshakeTerminado(const mbedtls_ssl_context* ssl) {
+    return ssl->state == MBEDTLS_SSL_HANDSHAKE_OVER;
+}
+
+bool ReanudacionTLS::guardar(const mbedtls_ssl_context* ssl, const char* host, uint16_t puerto) {
+    mbedtls_ssl_session_free(&sesion);
+    mbedtls_ssl_session_init(&sesion);
+    if (mbedtls_ssl_get_session(ssl, &sesion) != 0 || !destino.establecer(host, puerto)) {
+        descartar();
+        return false;
+    }
+    haySesion = true;
+    return true;
+}
+
+void ReanudacionTLS::descartar() {
+    mbedtls_ssl_session_free(&sesion);
+    mbedtls_ssl_session_init(&sesion);
+    haySesion = false;
+    destino.borrar();
+}
+
+size_t ReanudacionTLS::serializar(uint8_t* copia, size_t capacidad) const {
+    size_t longitud = 0;
+    if (!haySesion || mbedtls_ssl_session_save(&sesion, copia, capacidad, &longitud) != 0) {
+        return 0;
+    }
+    return longitud;
+}
+
+bool ReanudacionTLS::cargar(const uint8_t* datos, size_t longitud, const char* host, uint16_t puerto) {
+    descartar();
+    if (longitud == 0 || mbedtls_ssl_session_load(&sesion, datos, longitud) != 0 ||
+        !destino.establecer(host, puerto)) {
+        descartar();
+        return false;
+    }
+    haySesion = true;
+    return true;
+}
+
+bool ReanudacionTLS::tieneSesion() const {
+    return haySesion;
+}
+
+const DestinoSesion& ReanudacionTLS::obtenerDestino() const {
+    return destino;
+}
@@ -0,0 +1,56 @@
+#ifndef REANUDACIONTLS_H
+#define REANUDACIONTLS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mbedtls/version.h>
+#include <mbedtls/ssl.h>
+#include "SesionTLS.h"
+
+// avanzarHandshake() lee ssl->state y handshake->resume, internos de
+// mbedTLS 2.x (Arduino-ESP32 2.0, platform espressif32 6.x) que cambian en 3.x
+#if MBEDTLS_VERSION_MAJOR >= 3
+#error "ReanudacionTLS requiere mbedTLS 2.x (platform espressif32 6.x)"
+#endif
+
+// Reanudación de sesiones TLS del lado del cliente, sin Arduino: la sesión
+// del último handshake, a qué servidor se ofrece, el handshake paso a paso
+// que detecta si el servidor la aceptó y la copia serializada que ClienteTLS
+// guarda en memoria RTC. test/test_reanudacion_tls la prueba contra un
+// servidor mbedTLS en memoria (pio test -e native_tls).
+class ReanudacionTLS {
+public:
+    static const size_t TAMANO_COPIA = 2048;    // Sesión serializada (incluye el certificado del par)
+
+private:
+    mbedtls_ssl_session sesion;
+    bool haySesion;
+    DestinoSesion destino;
+
+public:
+    ReanudacionTLS();
+    ~ReanudacionTLS();
+
+    // Antes del handshake: ofrece la sesión guardada si es del mismo servidor
+    bool ofrecer(mbedtls_ssl_context* ssl, const char* host, uint16_t puerto);
+
+    // Un paso del handshake; devuelve lo mismo que mbedtls_ssl_handshake_step.
+    // reanudado queda en true si el servidor aceptó la sesión ofrecida
+    static int avanzarHandshake(mbedtls_ssl_context* ssl, bool& reanudado);
+    static bool handshakeTerminado(const mbedtls_ssl_context* ssl);
+
+    // Tras cada handshake: el servidor puede haber emitido un ticket nuevo
+    bool guardar(const mbedtls_ssl_context* ssl, const char* host, uint16_t puerto);
+    void descartar();
+
+    // Copia de la sesión, sin el servidor; serializar() devuelve 0 si no
+    // hay sesión o no entra. cargar() falla con una copia de otra versión
+    // de mbedTLS o del firmware
+    size_t serializar(uint8_t* destino, size_t capacidad) const;
+    bool cargar(const uint8_t* datos, size_t longitud, const char* host, uint16_t puerto);
+
+    bool tieneSesion() const;
+    const DestinoSesion& obtenerDestino() const;
+};
+
+#endif
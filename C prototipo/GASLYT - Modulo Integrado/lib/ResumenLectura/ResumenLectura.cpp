@@ -0,0 +1,49 @@
+#include "ResumenLectura.h"
+#include <stdio.h>
+
+namespace ResumenLectura {
+
+// snprintf devuelve lo que habría escrito; se recorta a lo que entró
+static size_t recortar(int escritos, size_t tamano) {
+    if (escritos < 0 || tamano == 0) {
+        return 0;
+    }
+    return (size_t)escritos < tamano ? (size_t)escritos : tamano - 1;
+}
+
+size_t formatearCanal(char* destino, size_t tamano, const DatosCanal& datos) {
+    if (!destino || tamano == 0) {
+        return 0;
+    }
+    int escritos = snprintf(destino, tamano, "Canal %d [%s] pin %d: %.2f ppm (umbral %.2f) Rs/R0=%.3f%s%s",
+                            datos.canal, datos.nombre ? datos.nombre : "?", datos.pin,
+                            datos.ppm, datos.umbral, datos.ratio,
+                            datos.valida ? (datos.saturada ? " SATURADA" : "") : " INVALIDA", datos.alarma ? " ALARMA" : "");
+    return recortar(escritos, tamano);
+}
+
+size_t formatearEstadisticas(char* destino, size_t tamano, const DatosCanal& datos) {
+    if (!destino || tamano == 0) {
+        return 0;
+    }
+    int escritos = snprintf(destino, tamano, "  media=%.2f desv=%.2f ewma=%.2f min=%.2f max=%.2f n=%lu",
+                            datos.media, datos.desviacion, datos.ewma, datos.minimo, datos.maximo,
+                            (unsigned long)datos.cantidad);
+    return recortar(escritos, tamano);
+}
+
+size_t formatearTendencia(char* destino, size_t tamano, const DatosCanal& datos) {
+    if (!destino || tamano == 0) {
+        return 0;
+    }
+    int escritos;
+    if (datos.tiempoHastaUmbral >= 0) {
+        escritos = snprintf(destino, tamano, "  tendencia=%.3f ppm/s umbral en %.0f s",
+                            datos.pendiente, datos.tiempoHastaUmbral);
+    } else {
+        escritos = snprintf(destino, tamano, "  tendencia=%.3f ppm/s", datos.pendiente);
+    }
+    return recortar(escritos, tamano);
+}
+
+}
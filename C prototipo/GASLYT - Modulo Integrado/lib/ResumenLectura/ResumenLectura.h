@@ -0,0 +1,44 @@
+#ifndef RESUMENLECTURA_H
+#define RESUMENLECTURA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Líneas del resumen de GasSensorArray::imprimirLecturas(), armadas con
+// snprintf en un buffer del llamador: sin String ni memoria dinámica, porque
+// el resumen sale en cada medición. test/test_resumen_lectura cuenta las
+// reservas de memoria (pio test -e native). Sin dependencias de Arduino.
+namespace ResumenLectura {
+
+// Igual a SistemaLogging::LONGITUD_MENSAJE: cada línea entra en un registro
+const size_t LONGITUD_LINEA = 120;
+
+struct DatosCanal {
+    int canal;
+    const char* nombre;
+    int pin;
+    float ppm;
+    float umbral;
+    float ratio;                // Rs/R0
+    bool valida;
+    bool saturada;              // ppm recortada a rangoMaximo
+    bool alarma;
+    float media;
+    float desviacion;
+    float ewma;
+    float minimo;
+    float maximo;
+    uint32_t cantidad;
+    float pendiente;            // ppm/s
+    float tiempoHastaUmbral;    // s, negativo si no se acerca
+};
+
+// Cada una escribe una línea terminada en '\0' y devuelve su longitud,
+// recortada a tamano - 1 si no entra
+size_t formatearCanal(char* destino, size_t tamano, const DatosCanal& datos);
+size_t formatearEstadisticas(char* destino, size_t tamano, const DatosCanal& datos);
+size_t formatearTendencia(char* destino, size_t tamano, const DatosCanal& datos);
+
+}
+
+#endif
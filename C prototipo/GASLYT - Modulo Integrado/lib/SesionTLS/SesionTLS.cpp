@@ -0,0 +1,83 @@
+#include "SesionTLS.h"
+#include <string.h>
+
+DestinoSesion::DestinoSesion() : puerto(0) {
+    host[0] = '\0';
+}
+
+bool DestinoSesion::establecer(const char* nuevoHost, uint16_t nuevoPuerto) {
+    size_t longitud = nuevoHost ? strlen(nuevoHost) : 0;
+    if (longitud == 0 || longitud >= LONGITUD_HOST) {
+        borrar();
+        return false;
+    }
+
+    memcpy(host, nuevoHost, longitud + 1);
+    puerto = nuevoPuerto;
+    return true;
+}
+
+void DestinoSesion::borrar() {
+    host[0] = '\0';
+    puerto = 0;
+}
+
+bool DestinoSesion::estaVacio() const {
+    return host[0] == '\0';
+}
+
+bool DestinoSesion::coincide(const char* otroHost, uint16_t otroPuerto) const {
+    return !estaVacio() && otroHost && puerto == otroPuerto && strcmp(host, otroHost) == 0;
+}
+
+const char* DestinoSesion::obtenerHost() const {
+    return host;
+}
+
+uint16_t DestinoSesion::obtenerPuerto() const {
+    return puerto;
+}
+
+EstadisticasHandshake::EstadisticasHandshake() :
+    completos(0), reanudados(0), tiempoTotalCompletosMs(0), tiempoTotalReanudadosMs(0) {
+}
+
+void EstadisticasHandshake::registrar(uint32_t duracionMs, bool reanudado) {
+    if (reanudado) {
+        reanudados++;
+        tiempoTotalReanudadosMs += duracionMs;
+    } else {
+        completos++;
+        tiempoTotalCompletosMs += duracionMs;
+    }
+}
+
+uint32_t EstadisticasHandshake::obtenerCompletos() const {
+    return completos;
+}
+
+uint32_t EstadisticasHandshake::obtenerReanudados() const {
+    return reanudados;
+}
+
+uint32_t EstadisticasHandshake::obtenerPromedioCompletoMs() const {
+    return completos > 0 ? tiempoTotalCompletosMs / completos : 0;
+}
+
+uint32_t EstadisticasHandshake::obtenerPromedioReanudadoMs() const {
+    return reanudados > 0 ? tiempoTotalReanudadosMs / reanudados : 0;
+}
+
+uint32_t EstadisticasHandshake::obtenerAceleracionCentesimas() const {
+    if (completos == 0 || reanudados == 0) {
+        return 0;
+    }
+
+    // Con los totales, no con los promedios ya redondeados; 0 ms reanudando cuenta como 1 ms
+    uint64_t numerador = (uint64_t)tiempoTotalCompletosMs * reanudados * 100;
+    uint64_t denominador = (uint64_t)tiempoTotalReanudadosMs * completos;
+    if (denominador == 0) {
+        denominador = completos;
+    }
+    return (uint32_t)(numerador / denominador);
+}
@@ -0,0 +1,56 @@
+#ifndef SESIONTLS_H
+#define SESIONTLS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Lógica de ClienteTLS sin mbedTLS ni Arduino: a qué servidor se ofrece la
+// sesión guardada y cuánto se ahorra al reanudar. test/test_sesion_tls la
+// prueba en el PC (pio test -e native); la reanudación con mbedTLS está en
+// lib/ReanudacionTLS y la duración con el broker real se mide en el equipo
+// (ClienteTLS::imprimirEstadisticas).
+
+// Servidor (host y puerto) de la sesión guardada
+class DestinoSesion {
+public:
+    static const size_t LONGITUD_HOST = 64;     // Con el '\0'
+
+private:
+    char host[LONGITUD_HOST];
+    uint16_t puerto;
+
+public:
+    DestinoSesion();
+
+    // Un host que no entra no se guarda: recortado nunca coincidiría
+    bool establecer(const char* host, uint16_t puerto);
+    void borrar();
+    bool estaVacio() const;
+    bool coincide(const char* host, uint16_t puerto) const;
+    const char* obtenerHost() const;
+    uint16_t obtenerPuerto() const;
+};
+
+// Handshakes completos y reanudados, con su duración
+class EstadisticasHandshake {
+private:
+    uint32_t completos;
+    uint32_t reanudados;
+    uint32_t tiempoTotalCompletosMs;
+    uint32_t tiempoTotalReanudadosMs;
+
+public:
+    EstadisticasHandshake();
+
+    void registrar(uint32_t duracionMs, bool reanudado);
+    uint32_t obtenerCompletos() const;
+    uint32_t obtenerReanudados() const;
+    uint32_t obtenerPromedioCompletoMs() const;
+    uint32_t obtenerPromedioReanudadoMs() const;
+
+    // Promedio completo / promedio reanudado, en centésimas (350 = 3.5 veces
+    // más rápido); 0 hasta tener handshakes de los dos tipos
+    uint32_t obtenerAceleracionCentesimas() const;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "TopicCorto.h"
+
+namespace TopicCorto {
+
+static const char ALFABETO[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static int valorCaracter(char c) {
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    if (c == '-') {
+        return 62;
+    }
+    return c == '_' ? 63 : -1;
+}
+
+bool formatearId(char* destino, size_t tamano, const uint8_t mac[LONGITUD_MAC]) {
+    if (!destino || !mac || tamano < LONGITUD_ID + 1) {
+        return false;
+    }
+
+    // 48 bits, el primer byte de la MAC en los bits altos
+    uint64_t bits = 0;
+    for (size_t i = 0; i < LONGITUD_MAC; i++) {
+        bits = (bits << 8) | mac[i];
+    }
+    for (size_t i = 0; i < LONGITUD_ID; i++) {
+        destino[i] = ALFABETO[(bits >> (6 * (LONGITUD_ID - 1 - i))) & 0x3F];
+    }
+    destino[LONGITUD_ID] = '\0';
+    return true;
+}
+
+bool leerId(const char* id, uint8_t mac[LONGITUD_MAC]) {
+    if (!id || !mac) {
+        return false;
+    }
+
+    uint64_t bits = 0;
+    for (size_t i = 0; i < LONGITUD_ID; i++) {
+        int valor = valorCaracter(id[i]);
+        if (valor < 0) {
+            return false;
+        }
+        bits = (bits << 6) | (uint64_t)valor;
+    }
+    if (id[LONGITUD_ID] != '\0') {
+        return false;
+    }
+    for (size_t i = 0; i < LONGITUD_MAC; i++) {
+        mac[LONGITUD_MAC - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,27 @@
+#ifndef TOPICCORTO_H
+#define TOPICCORTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Identificador de los topics cortos (g/{ID_CORTO}/l): los 48 bits de la MAC
+// en base64url, 8 caracteres. Es biyectivo, así que dos equipos con MAC
+// distinta nunca comparten topic; el sufijo de 6 dígitos del ID del
+// dispositivo usaba solo los 3 bytes bajos y podía repetirse entre equipos
+// de distinto prefijo de fabricante. El alfabeto (A-Z a-z 0-9 - _) no tiene
+// '/', '+' ni '#'. test/test_topic_corto mide colisiones, longitudes y bytes
+// por mensaje (pio test -e native). Sin dependencias de Arduino.
+namespace TopicCorto {
+
+const size_t LONGITUD_MAC = 6;
+const size_t LONGITUD_ID = 8;
+
+// destino necesita LONGITUD_ID + 1 bytes
+bool formatearId(char* destino, size_t tamano, const uint8_t mac[LONGITUD_MAC]);
+
+// Inversa de formatearId, para el backend y las pruebas
+bool leerId(const char* id, uint8_t mac[LONGITUD_MAC]);
+
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "AdquisicionADC.h"
+
+AdquisicionADC::AdquisicionADC() :
+    cantidadCanales(0), contadorDecimacion(0), tarea(nullptr), activa(false) {
+    memset(canales, 0, sizeof(canales));
+}
+
+AdquisicionADC::~AdquisicionADC() {
+    detener();
+}
+
+int AdquisicionADC::agregarCanal(int pin) {
+    if (activa || cantidadCanales >= MAX_CANALES) {
+        return -1;
+    }
+
+    Canal& canal = canales[cantidadCanales];
+    canal.pin = pin;
+    canal.indiceEscritura = 0;
+    canal.sumaVentana = 0;
+    canal.muestrasEnVentana = 0;
+    canal.promedioMilivoltios = 0.0;
+    canal.valoresDecimados = 0;
+
+    pinMode(pin, INPUT);
+    analogSetPinAttenuation(pin, ADC_11db); // Rango completo 0-3.3V
+
+    return cantidadCanales++;
+}
+
+bool AdquisicionADC::iniciar() {
+    if (activa) {
+        return true;
+    }
+    if (cantidadCanales == 0) {
+        Serial.println("Error: Adquisición ADC sin canales configurados");
+        return false;
+    }
+
+    activa = true;
+    // Core 0 para no competir con loop(), prioridad baja
+    BaseType_t resultado = xTaskCreatePinnedToCore(
+        tareaAdquisicion, "adquisicionADC", 2048, this, 1, &tarea, 0);
+
+    if (resultado != pdPASS) {
+        activa = false;
+        tarea = nullptr;
+        Serial.println("Error al crear tarea de adquisición ADC");
+        return false;
+    }
+
+    Serial.println("Adquisición ADC iniciada: " + String(cantidadCanales) + " canal(es), " +
+                   String(1000 / PERIODO_MUESTREO_MS) + " Hz, decimación x" + String(FACTOR_DECIMACION));
+    return true;
+}
+
+void AdquisicionADC::detener() {
+    if (tarea) {
+        vTaskDelete(tarea);
+        tarea = nullptr;
+    }
+    activa = false;
+}
+
+void AdquisicionADC::tareaAdquisicion(void* parametro) {
+    AdquisicionADC* adquisicion = static_cast<AdquisicionADC*>(parametro);
+    TickType_t ultimoDespertar = xTaskGetTickCount();
+    const TickType_t periodo = pdMS_TO_TICKS(PERIODO_MUESTREO_MS) > 0 ? pdMS_TO_TICKS(PERIODO_MUESTREO_MS) : 1;
+
+    for (;;) {
+        adquisicion->tomarMuestras();
+        vTaskDelayUntil(&ultimoDespertar, periodo);
+    }
+}
+
+void AdquisicionADC::tomarMuestras() {
+    for (int i = 0; i < cantidadCanales; i++) {
+        Canal& canal = canales[i];
+        uint16_t muestra = analogReadMilliVolts(canal.pin);
+
+        // Ventana deslizante: sumar la nueva muestra y descontar la que se pisa
+        canal.sumaVentana += muestra;
+        canal.sumaVentana -= canal.buffer[canal.indiceEscritura];
+        canal.buffer[canal.indiceEscritura] = muestra;
+        canal.indiceEscritura = (canal.indiceEscritura + 1) & (TAMANO_BUFFER - 1);
+        if (canal.muestrasEnVentana < TAMANO_BUFFER) {
+            canal.muestrasEnVentana++;
+        }
+    }
+
+    if (++contadorDecimacion < FACTOR_DECIMACION) {
+        return;
+    }
+    contadorDecimacion = 0;
+
+    // Publicar el promedio de la ventana (escritura de 32 bits, atómica en el ESP32)
+    for (int i = 0; i < cantidadCanales; i++) {
+        Canal& canal = canales[i];
+        canal.promedioMilivoltios = (float)canal.sumaVentana / canal.muestrasEnVentana;
+        canal.valoresDecimados = canal.valoresDecimados + 1;
+    }
+}
+
+float AdquisicionADC::obtenerMilivoltios(int canal) const {
+    if (canal < 0 || canal >= cantidadCanales) {
+        return -1.0;
+    }
+    return canales[canal].promedioMilivoltios;
+}
+
+uint32_t AdquisicionADC::obtenerValoresDecimados(int canal) const {
+    if (canal < 0 || canal >= cantidadCanales) {
+        return 0;
+    }
+    return canales[canal].valoresDecimados;
+}
+
+bool AdquisicionADC::hayDatos(int canal) const {
+    return obtenerValoresDecimados(canal) > 0;
+}
+
+bool AdquisicionADC::estaActiva() const {
+    return activa;
+}
+
+int AdquisicionADC::obtenerCantidadCanales() const {
+    return cantidadCanales;
+}
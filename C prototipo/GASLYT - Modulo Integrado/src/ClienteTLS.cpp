@@ -0,0 +1,448 @@
+#include "ClienteTLS.h"
+#include <WiFi.h>
+#include <esp_attr.h>
+#include <lwip/sockets.h>
+#include <mbedtls/error.h>
+
+// Sesión serializada en memoria RTC: sobrevive al sueño profundo (no a un
+// corte de energía ni a un reinicio por software)
+RTC_DATA_ATTR static uint8_t sesionRTC[ClienteTLS::TAMANO_SESION_RTC];
+RTC_DATA_ATTR static uint16_t longitudSesionRTC = 0;
+RTC_DATA_ATTR static char hostSesionRTC[DestinoSesion::LONGITUD_HOST];
+RTC_DATA_ATTR static uint16_t puertoSesionRTC = 0;
+
+ClienteTLS::ClienteTLS() :
+    certificadoCA(nullptr), certificado(nullptr), clavePrivada(nullptr), inseguro(false),
+    conectado(false), bytePeek(-1),
+    ultimoHandshakeMs(0), ultimaConexionTCPMs(0), ultimoReanudado(false) {
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&configuracion);
+    mbedtls_ctr_drbg_init(&generador);
+    mbedtls_entropy_init(&entropia);
+    mbedtls_x509_crt_init(&certificadoRaiz);
+    mbedtls_x509_crt_init(&certificadoPropio);
+    mbedtls_pk_init(&clavePropia);
+    mbedtls_net_init(&red);
+
+    restaurarSesionRTC();
+}
+
+ClienteTLS::~ClienteTLS() {
+    stop();
+}
+
+void ClienteTLS::establecerCA(const char* ca) {
+    // Como en WiFiClientSecure, un CA anula establecerInseguro()
+    certificadoCA = ca && ca[0] ? ca : nullptr;
+    if (certificadoCA) {
+        inseguro = false;
+    }
+}
+
+void ClienteTLS::establecerCertificado(const char* cert) {
+    certificado = cert && cert[0] ? cert : nullptr;
+}
+
+void ClienteTLS::establecerClavePrivada(const char* clave) {
+    clavePrivada = clave && clave[0] ? clave : nullptr;
+}
+
+void ClienteTLS::establecerInseguro(bool sinVerificar) {
+    inseguro = sinVerificar;
+}
+
+int ClienteTLS::connect(IPAddress ip, uint16_t puerto) {
+    return connect(ip.toString().c_str(), puerto, TIMEOUT_CONEXION_MS);
+}
+
+int ClienteTLS::connect(const char* host, uint16_t puerto) {
+    return connect(host, puerto, TIMEOUT_CONEXION_MS);
+}
+
+int ClienteTLS::connect(IPAddress ip, uint16_t puerto, int32_t timeout) {
+    return connect(ip.toString().c_str(), puerto, timeout);
+}
+
+int ClienteTLS::connect(const char* host, uint16_t puerto, int32_t timeout) {
+    stop();
+
+    unsigned long inicio = millis();
+    if (!abrirSocket(host, puerto, timeout > 0 ? timeout : TIMEOUT_CONEXION_MS)) {
+        stop();
+        return 0;
+    }
+    ultimaConexionTCPMs = millis() - inicio;
+
+    if (!configurarTLS(host)) {
+        stop();
+        return 0;
+    }
+
+    // Se ofrece la sesión guardada solo al mismo servidor
+    bool ofrecida = reanudacion.ofrecer(&ssl, host, puerto);
+
+    unsigned long inicioTLS = millis();
+    bool reanudado = false;
+    if (!hacerHandshake(reanudado)) {
+        // Un servidor que rechaza mal la sesión no debe trabar las reconexiones
+        if (ofrecida) {
+            descartarSesion();
+        }
+        stop();
+        return 0;
+    }
+    ultimoHandshakeMs = millis() - inicioTLS;
+    ultimoReanudado = reanudado;
+
+    estadisticas.registrar(ultimoHandshakeMs, reanudado);
+    Serial.println(String("TLS: handshake ") + (reanudado ? "reanudado" : "completo") + " en " +
+                   String(ultimoHandshakeMs) + " ms (TCP " + String(ultimaConexionTCPMs) + " ms)");
+
+    // Tras cada handshake: el servidor puede haber emitido un ticket nuevo
+    guardarSesion(host, puerto);
+
+    conectado = true;
+    return 1;
+}
+
+bool ClienteTLS::abrirSocket(const char* host, uint16_t puerto, unsigned long timeoutMs) {
+    IPAddress ip;
+    if (!WiFi.hostByName(host, ip)) {
+        Serial.println("TLS: no se pudo resolver " + String(host));
+        return false;
+    }
+
+    int fd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) {
+        Serial.println("TLS: no se pudo crear el socket");
+        return false;
+    }
+    red.fd = fd;
+
+    struct sockaddr_in direccion;
+    memset(&direccion, 0, sizeof(direccion));
+    direccion.sin_family = AF_INET;
+    direccion.sin_addr.s_addr = (uint32_t)ip;
+    direccion.sin_port = htons(puerto);
+
+    // Conexión no bloqueante con límite de tiempo
+    lwip_fcntl(fd, F_SETFL, lwip_fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    int resultado = lwip_connect(fd, (struct sockaddr*)&direccion, sizeof(direccion));
+    if (resultado < 0 && errno != EINPROGRESS) {
+        Serial.println("TLS: error de conexión TCP (" + String(errno) + ")");
+        return false;
+    }
+
+    fd_set escritura;
+    FD_ZERO(&escritura);
+    FD_SET(fd, &escritura);
+    struct timeval espera;
+    espera.tv_sec = timeoutMs / 1000;
+    espera.tv_usec = (timeoutMs % 1000) * 1000;
+    if (lwip_select(fd + 1, NULL, &escritura, NULL, &espera) <= 0) {
+        Serial.println("TLS: timeout de conexión TCP con " + String(host));
+        return false;
+    }
+
+    int error = 0;
+    socklen_t longitud = sizeof(error);
+    if (lwip_getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &longitud) < 0 || error != 0) {
+        Serial.println("TLS: error de conexión TCP (" + String(error) + ")");
+        return false;
+    }
+    return true;
+}
+
+bool ClienteTLS::configurarTLS(const char* host) {
+    int resultado = mbedtls_ctr_drbg_seed(&generador, mbedtls_entropy_func, &entropia, NULL, 0);
+    if (resultado == 0) {
+        resultado = mbedtls_ssl_config_defaults(&configuracion, MBEDTLS_SSL_IS_CLIENT,
+                                                MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    }
+    if (resultado != 0) {
+        Serial.println("TLS: error de inicialización (" + String(resultado) + ")");
+        return false;
+    }
+
+    if (certificadoCA && !inseguro) {
+        resultado = mbedtls_x509_crt_parse(&certificadoRaiz, (const unsigned char*)certificadoCA,
+                                           strlen(certificadoCA) + 1);
+        if (resultado != 0) {
+            Serial.println("TLS: certificado CA inválido (" + String(resultado) + ")");
+            return false;
+        }
+        mbedtls_ssl_conf_ca_chain(&configuracion, &certificadoRaiz, NULL);
+        mbedtls_ssl_conf_authmode(&configuracion, MBEDTLS_SSL_VERIFY_REQUIRED);
+    } else {
+        mbedtls_ssl_conf_authmode(&configuracion, MBEDTLS_SSL_VERIFY_NONE);
+    }
+
+    if (certificado && clavePrivada) {
+        resultado = mbedtls_x509_crt_parse(&certificadoPropio, (const unsigned char*)certificado,
+                                           strlen(certificado) + 1);
+        if (resultado == 0) {
+            resultado = mbedtls_pk_parse_key(&clavePropia, (const unsigned char*)clavePrivada,
+                                             strlen(clavePrivada) + 1, NULL, 0);
+        }
+        if (resultado == 0) {
+            resultado = mbedtls_ssl_conf_own_cert(&configuracion, &certificadoPropio, &clavePropia);
+        }
+        if (resultado != 0) {
+            Serial.println("TLS: certificado o clave del dispositivo inválidos (" + String(resultado) + ")");
+            return false;
+        }
+    }
+
+    mbedtls_ssl_conf_rng(&configuracion, mbedtls_ctr_drbg_random, &generador);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(&configuracion, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+
+    resultado = mbedtls_ssl_setup(&ssl, &configuracion);
+    if (resultado == 0) {
+        resultado = mbedtls_ssl_set_hostname(&ssl, host);
+    }
+    if (resultado != 0) {
+        Serial.println("TLS: error de configuración (" + String(resultado) + ")");
+        return false;
+    }
+
+    mbedtls_ssl_set_bio(&ssl, &red, mbedtls_net_send, mbedtls_net_recv, NULL);
+    return true;
+}
+
+bool ClienteTLS::hacerHandshake(bool& reanudado) {
+    // Paso a paso para saber si el servidor aceptó la sesión: con ticket
+    // el ID de sesión cambia en cada conexión y no sirve para detectarlo
+    unsigned long inicio = millis();
+    while (!ReanudacionTLS::handshakeTerminado(&ssl)) {
+        int resultado = ReanudacionTLS::avanzarHandshake(&ssl, reanudado);
+
+        if (resultado == MBEDTLS_ERR_SSL_WANT_READ || resultado == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            if (millis() - inicio >= TIMEOUT_HANDSHAKE_MS) {
+                Serial.println("TLS: timeout de handshake");
+                return false;
+            }
+            delay(2);
+        } else if (resultado != 0) {
+            char descripcion[96];
+            mbedtls_strerror(resultado, descripcion, sizeof(descripcion));
+            Serial.println("TLS: error de handshake (" + String(resultado) + "): " + String(descripcion));
+            return false;
+        }
+    }
+    return true;
+}
+
+void ClienteTLS::guardarSesion(const char* host, uint16_t puerto) {
+    if (!reanudacion.guardar(&ssl, host, puerto)) {
+        longitudSesionRTC = 0;
+        return;
+    }
+
+    // Copia para después del sueño profundo, si entra
+    longitudSesionRTC = reanudacion.serializar(sesionRTC, sizeof(sesionRTC));
+    if (longitudSesionRTC > 0) {
+        memcpy(hostSesionRTC, reanudacion.obtenerDestino().obtenerHost(), sizeof(hostSesionRTC));
+        puertoSesionRTC = reanudacion.obtenerDestino().obtenerPuerto();
+    }
+}
+
+void ClienteTLS::descartarSesion() {
+    reanudacion.descartar();
+    longitudSesionRTC = 0;
+}
+
+void ClienteTLS::restaurarSesionRTC() {
+    if (longitudSesionRTC == 0 || longitudSesionRTC > sizeof(sesionRTC)) {
+        return;
+    }
+
+    hostSesionRTC[sizeof(hostSesionRTC) - 1] = '\0';
+    if (!reanudacion.cargar(sesionRTC, longitudSesionRTC, hostSesionRTC, puertoSesionRTC)) {
+        // Otra versión de firmware o de mbedTLS: se descarta
+        descartarSesion();
+        return;
+    }
+    Serial.println("TLS: sesión restaurada desde memoria RTC para " +
+                   String(reanudacion.obtenerDestino().obtenerHost()));
+}
+
+void ClienteTLS::liberar() {
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_config_free(&configuracion);
+    mbedtls_ctr_drbg_free(&generador);
+    mbedtls_entropy_free(&entropia);
+    mbedtls_x509_crt_free(&certificadoRaiz);
+    mbedtls_x509_crt_free(&certificadoPropio);
+    mbedtls_pk_free(&clavePropia);
+
+    // Quedan listos para la próxima conexión
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&configuracion);
+    mbedtls_ctr_drbg_init(&generador);
+    mbedtls_entropy_init(&entropia);
+    mbedtls_x509_crt_init(&certificadoRaiz);
+    mbedtls_x509_crt_init(&certificadoPropio);
+    mbedtls_pk_init(&clavePropia);
+}
+
+size_t ClienteTLS::write(uint8_t byte) {
+    return write(&byte, 1);
+}
+
+size_t ClienteTLS::write(const uint8_t* datos, size_t longitud) {
+    if (!conectado) {
+        return 0;
+    }
+
+    size_t enviados = 0;
+    unsigned long inicio = millis();
+    while (enviados < longitud) {
+        int resultado = mbedtls_ssl_write(&ssl, datos + enviados, longitud - enviados);
+        if (resultado > 0) {
+            enviados += resultado;
+        } else if (resultado == MBEDTLS_ERR_SSL_WANT_READ || resultado == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            if (millis() - inicio >= TIMEOUT_ESCRITURA_MS) {
+                break;
+            }
+            delay(1);
+        } else {
+            stop();
+            break;
+        }
+    }
+    return enviados;
+}
+
+int ClienteTLS::available() {
+    if (!conectado) {
+        return 0;
+    }
+
+    // Lectura vacía: procesa registros pendientes sin consumir datos
+    int resultado = mbedtls_ssl_read(&ssl, NULL, 0);
+    if (resultado < 0 && resultado != MBEDTLS_ERR_SSL_WANT_READ && resultado != MBEDTLS_ERR_SSL_WANT_WRITE) {
+        stop();
+        return bytePeek >= 0 ? 1 : 0;
+    }
+    return mbedtls_ssl_get_bytes_avail(&ssl) + (bytePeek >= 0 ? 1 : 0);
+}
+
+int ClienteTLS::read() {
+    uint8_t byte;
+    return read(&byte, 1) == 1 ? byte : -1;
+}
+
+int ClienteTLS::read(uint8_t* destino, size_t longitud) {
+    if (longitud == 0) {
+        return 0;
+    }
+
+    int leidos = 0;
+    if (bytePeek >= 0) {
+        destino[0] = (uint8_t)bytePeek;
+        bytePeek = -1;
+        destino++;
+        longitud--;
+        leidos = 1;
+        if (longitud == 0) {
+            return leidos;
+        }
+    }
+
+    if (!conectado) {
+        return leidos > 0 ? leidos : -1;
+    }
+
+    int resultado = mbedtls_ssl_read(&ssl, destino, longitud);
+    if (resultado > 0) {
+        return leidos + resultado;
+    }
+    if (resultado != MBEDTLS_ERR_SSL_WANT_READ && resultado != MBEDTLS_ERR_SSL_WANT_WRITE) {
+        // 0 o cierre del servidor: la conexión terminó
+        stop();
+    }
+    return leidos > 0 ? leidos : -1;
+}
+
+int ClienteTLS::peek() {
+    if (bytePeek < 0) {
+        uint8_t byte;
+        if (read(&byte, 1) == 1) {
+            bytePeek = byte;
+        }
+    }
+    return bytePeek;
+}
+
+void ClienteTLS::flush() {
+    // mbedtls_ssl_write no deja datos en buffers propios
+}
+
+void ClienteTLS::stop() {
+    if (red.fd >= 0) {
+        if (conectado) {
+            mbedtls_ssl_close_notify(&ssl);
+        }
+        mbedtls_net_free(&red);
+    }
+    conectado = false;
+    bytePeek = -1;
+    liberar();
+}
+
+uint8_t ClienteTLS::connected() {
+    if (conectado) {
+        available();
+    }
+    return conectado || bytePeek >= 0;
+}
+
+ClienteTLS::operator bool() {
+    return connected();
+}
+
+bool ClienteTLS::tieneSesion() const {
+    return reanudacion.tieneSesion();
+}
+
+bool ClienteTLS::fueReanudada() const {
+    return ultimoReanudado;
+}
+
+unsigned long ClienteTLS::obtenerUltimoHandshakeMs() const {
+    return ultimoHandshakeMs;
+}
+
+uint32_t ClienteTLS::obtenerHandshakesCompletos() const {
+    return estadisticas.obtenerCompletos();
+}
+
+uint32_t ClienteTLS::obtenerHandshakesReanudados() const {
+    return estadisticas.obtenerReanudados();
+}
+
+uint32_t ClienteTLS::obtenerPromedioCompletoMs() const {
+    return estadisticas.obtenerPromedioCompletoMs();
+}
+
+uint32_t ClienteTLS::obtenerPromedioReanudadoMs() const {
+    return estadisticas.obtenerPromedioReanudadoMs();
+}
+
+uint32_t ClienteTLS::obtenerAceleracionCentesimas() const {
+    return estadisticas.obtenerAceleracionCentesimas();
+}
+
+void ClienteTLS::imprimirEstadisticas() const {
+    uint32_t aceleracion = estadisticas.obtenerAceleracionCentesimas();
+    Serial.println("TLS: " + String(estadisticas.obtenerCompletos()) + " handshake(s) completo(s) (promedio " +
+                   String(estadisticas.obtenerPromedioCompletoMs()) + " ms), " +
+                   String(estadisticas.obtenerReanudados()) + " reanudado(s) (promedio " +
+                   String(estadisticas.obtenerPromedioReanudadoMs()) + " ms)" +
+                   (aceleracion > 0 ? ", reanudar es " + String(aceleracion / 100.0f, 1) + " veces más rápido" : String("")));
+    Serial.println("TLS: último handshake " + String(ultimoHandshakeMs) + " ms" +
+                   (ultimoReanudado ? " (reanudado)" : "") + ", sesión guardada: " +
+                   (reanudacion.tieneSesion() ? "sí" : "no"));
+}
@@ -0,0 +1,348 @@
+#include "ColaPersistente.h"
+
+ColaPersistente::ColaPersistente() :
+    particion(nullptr), cantidadSectores(0), inicializada(false),
+    sectorEscritura(0), posicionEscritura(0), numeroSectorEscritura(0),
+    sectorLectura(0), posicionLectura(0), pendientes(0), descartados(0),
+    tipoActual(0), formatoActual(FORMATO_DESCONOCIDO), direccionActual(0), longitudActual(0), hayActual(false) {
+}
+
+bool ColaPersistente::inicializar() {
+    particion = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, "spiffs");
+    if (!particion) {
+        Serial.println("Error: No se encontró la partición spiffs para la cola persistente");
+        return false;
+    }
+
+    cantidadSectores = particion->size / TAMANO_SECTOR;
+    if (cantidadSectores < 2) {
+        Serial.println("Error: Partición spiffs demasiado chica para la cola persistente");
+        return false;
+    }
+
+    // Buscar el sector más antiguo y el más reciente
+    bool hayDatos = false;
+    uint16_t sectorAntiguo = 0;
+    uint16_t sectorReciente = 0;
+    uint32_t numeroAntiguo = 0;
+    uint32_t numeroReciente = 0;
+
+    for (uint16_t s = 0; s < cantidadSectores; s++) {
+        CabeceraSector cabecera;
+        if (!leerCabeceraSector(s, cabecera)) {
+            continue;
+        }
+        if (!hayDatos || cabecera.numero < numeroAntiguo) {
+            numeroAntiguo = cabecera.numero;
+            sectorAntiguo = s;
+        }
+        if (!hayDatos || cabecera.numero > numeroReciente) {
+            numeroReciente = cabecera.numero;
+            sectorReciente = s;
+        }
+        hayDatos = true;
+    }
+
+    pendientes = 0;
+    descartados = 0;
+    hayActual = false;
+
+    // Contar pendientes del más antiguo al más reciente
+    if (hayDatos) {
+        bool lecturaUbicada = false;
+        uint16_t s = sectorAntiguo;
+        for (uint16_t recorridos = 0; recorridos < cantidadSectores; recorridos++) {
+            uint32_t enSector = contarPendientes(s);
+            if (enSector > 0 && !lecturaUbicada) {
+                sectorLectura = s;
+                posicionLectura = sizeof(CabeceraSector);
+                lecturaUbicada = true;
+            }
+            pendientes += enSector;
+
+            if (s == sectorReciente) {
+                break;
+            }
+            s = (s + 1) % cantidadSectores;
+        }
+    }
+
+    // Escribir siempre en un sector nuevo
+    uint16_t sectorNuevo = hayDatos ? (sectorReciente + 1) % cantidadSectores : 0;
+    if (!abrirSector(sectorNuevo, hayDatos ? numeroReciente + 1 : 1)) {
+        Serial.println("Error al preparar la cola persistente");
+        return false;
+    }
+
+    inicializada = true;
+    Serial.println("Cola persistente inicializada: " + String(pendientes) + " mensaje(s) pendiente(s), " +
+                   String(obtenerCapacidadBytes() / 1024) + " KB");
+    return true;
+}
+
+bool ColaPersistente::encolar(TipoMensaje tipo, FormatoRegistro formato, const uint8_t* mensaje, size_t longitud) {
+    if (!inicializada || !mensaje || longitud == 0) {
+        return false;
+    }
+    if (longitud > TAMANO_MAXIMO_MENSAJE) {
+        Serial.println("Error: Mensaje de " + String(longitud) + " bytes excede la cola persistente");
+        return false;
+    }
+
+    uint32_t tamano = alinear(sizeof(CabeceraRegistro) + longitud);
+    if (posicionEscritura + tamano > TAMANO_SECTOR) {
+        if (!abrirSector((sectorEscritura + 1) % cantidadSectores, numeroSectorEscritura + 1)) {
+            return false;
+        }
+    }
+
+    uint32_t direccion = sectorEscritura * TAMANO_SECTOR + posicionEscritura;
+
+    // Primero el mensaje y después la cabecera: sin cabecera el registro no existe.
+    // Si una escritura falla la zona queda sucia y se abandona el sector.
+    if (esp_partition_write(particion, direccion + sizeof(CabeceraRegistro), mensaje, longitud) != ESP_OK) {
+        Serial.println("Error al escribir mensaje en la cola persistente");
+        posicionEscritura = TAMANO_SECTOR;
+        return false;
+    }
+
+    CabeceraRegistro cabecera;
+    cabecera.marca = MARCA_REGISTRO;
+    cabecera.longitud = longitud;
+    cabecera.tipo = (uint8_t)tipo | ((uint8_t)formato << DESPLAZAMIENTO_FORMATO);
+    cabecera.estado = ESTADO_PENDIENTE;
+    cabecera.suma = calcularSuma(mensaje, longitud);
+
+    if (esp_partition_write(particion, direccion, &cabecera, sizeof(cabecera)) != ESP_OK) {
+        Serial.println("Error al escribir cabecera en la cola persistente");
+        posicionEscritura = TAMANO_SECTOR;
+        return false;
+    }
+
+    if (pendientes == 0) {
+        sectorLectura = sectorEscritura;
+        posicionLectura = posicionEscritura;
+    }
+    posicionEscritura += tamano;
+    pendientes++;
+    return true;
+}
+
+bool ColaPersistente::obtenerSiguiente(TipoMensaje& tipo, FormatoRegistro& formato, const uint8_t*& mensaje,
+                                       size_t& longitud) {
+    if (!inicializada) {
+        return false;
+    }
+
+    // Sin confirmar, se vuelve a entregar el mismo mensaje
+    if (hayActual) {
+        tipo = (TipoMensaje)tipoActual;
+        formato = (FormatoRegistro)formatoActual;
+        mensaje = mensajeActual;
+        longitud = longitudActual;
+        return true;
+    }
+
+    while (pendientes > 0) {
+        if (sectorLectura == sectorEscritura && posicionLectura >= posicionEscritura) {
+            pendientes = 0;
+            break;
+        }
+
+        uint32_t direccion = sectorLectura * TAMANO_SECTOR + posicionLectura;
+        CabeceraRegistro cabecera;
+
+        // Fin de los registros del sector: pasar al siguiente
+        if (posicionLectura + sizeof(CabeceraRegistro) > TAMANO_SECTOR || !leerRegistro(direccion, cabecera)) {
+            if (sectorLectura == sectorEscritura) {
+                pendientes = 0;
+                break;
+            }
+            sectorLectura = (sectorLectura + 1) % cantidadSectores;
+            posicionLectura = sizeof(CabeceraSector);
+            continue;
+        }
+
+        uint32_t tamano = alinear(sizeof(CabeceraRegistro) + cabecera.longitud);
+        if (cabecera.estado != ESTADO_PENDIENTE) {
+            posicionLectura += tamano;
+            continue;
+        }
+
+        uint8_t tipoRegistro = cabecera.tipo & MASCARA_TIPO;
+        uint8_t formatoRegistro = cabecera.tipo >> DESPLAZAMIENTO_FORMATO;
+        bool valido = (tipoRegistro == MENSAJE_LECTURA || tipoRegistro == MENSAJE_ALARMA) &&
+                      formatoRegistro <= FORMATO_MSGPACK &&
+                      esp_partition_read(particion, direccion + sizeof(CabeceraRegistro),
+                                         mensajeActual, cabecera.longitud) == ESP_OK &&
+                      calcularSuma(mensajeActual, cabecera.longitud) == cabecera.suma;
+
+        if (!valido) {
+            // Registro dañado (p. ej. corte de energía al escribir): se descarta
+            marcarConsumido(direccion);
+            posicionLectura += tamano;
+            pendientes--;
+            descartados++;
+            continue;
+        }
+
+        tipoActual = tipoRegistro;
+        formatoActual = formatoRegistro;
+        direccionActual = direccion;
+        longitudActual = cabecera.longitud;
+        hayActual = true;
+
+        tipo = (TipoMensaje)tipoActual;
+        formato = (FormatoRegistro)formatoActual;
+        mensaje = mensajeActual;
+        longitud = longitudActual;
+        return true;
+    }
+
+    return false;
+}
+
+uint32_t ColaPersistente::obtenerIdentificadorActual() const {
+    return hayActual ? direccionActual : 0;
+}
+
+bool ColaPersistente::confirmarEnvio() {
+    if (!hayActual) {
+        return false;
+    }
+
+    hayActual = false;
+    if (!marcarConsumido(direccionActual)) {
+        return false;
+    }
+
+    posicionLectura += alinear(sizeof(CabeceraRegistro) + longitudActual);
+    pendientes--;
+
+    if (pendientes == 0) {
+        sectorLectura = sectorEscritura;
+        posicionLectura = posicionEscritura;
+    }
+    return true;
+}
+
+uint32_t ColaPersistente::alinear(uint32_t tamano) {
+    return (tamano + 3) & ~3UL;
+}
+
+uint16_t ColaPersistente::calcularSuma(const uint8_t* datos, size_t longitud) {
+    uint16_t suma1 = 0;
+    uint16_t suma2 = 0;
+    for (size_t i = 0; i < longitud; i++) {
+        suma1 = (suma1 + datos[i]) % 255;
+        suma2 = (suma2 + suma1) % 255;
+    }
+    return (suma2 << 8) | suma1;
+}
+
+bool ColaPersistente::leerCabeceraSector(uint16_t sector, CabeceraSector& cabecera) const {
+    if (esp_partition_read(particion, sector * TAMANO_SECTOR, &cabecera, sizeof(cabecera)) != ESP_OK) {
+        return false;
+    }
+    return cabecera.marca == MARCA_SECTOR;
+}
+
+bool ColaPersistente::leerRegistro(uint32_t direccion, CabeceraRegistro& cabecera) const {
+    if (esp_partition_read(particion, direccion, &cabecera, sizeof(cabecera)) != ESP_OK) {
+        return false;
+    }
+    return cabecera.marca == MARCA_REGISTRO &&
+           cabecera.longitud <= TAMANO_MAXIMO_MENSAJE &&
+           (direccion % TAMANO_SECTOR) + alinear(sizeof(CabeceraRegistro) + cabecera.longitud) <= TAMANO_SECTOR;
+}
+
+uint32_t ColaPersistente::contarPendientes(uint16_t sector) const {
+    CabeceraSector cabeceraSector;
+    if (!leerCabeceraSector(sector, cabeceraSector)) {
+        return 0;
+    }
+
+    uint32_t cantidad = 0;
+    uint32_t posicion = sizeof(CabeceraSector);
+    CabeceraRegistro cabecera;
+    while (posicion + sizeof(CabeceraRegistro) <= TAMANO_SECTOR &&
+           leerRegistro(sector * TAMANO_SECTOR + posicion, cabecera)) {
+        if (cabecera.estado == ESTADO_PENDIENTE) {
+            cantidad++;
+        }
+        posicion += alinear(sizeof(CabeceraRegistro) + cabecera.longitud);
+    }
+    return cantidad;
+}
+
+bool ColaPersistente::abrirSector(uint16_t sector, uint32_t numero) {
+    // Cola llena: el sector a reutilizar todavía tiene mensajes sin enviar
+    if (pendientes > 0 && sector == sectorLectura) {
+        uint32_t perdidos = contarPendientes(sector);
+        pendientes = perdidos < pendientes ? pendientes - perdidos : 0;
+        descartados += perdidos;
+        sectorLectura = (sector + 1) % cantidadSectores;
+        posicionLectura = sizeof(CabeceraSector);
+        hayActual = false;
+        Serial.println("Cola persistente llena: " + String(perdidos) + " mensaje(s) descartado(s)");
+    }
+
+    if (esp_partition_erase_range(particion, sector * TAMANO_SECTOR, TAMANO_SECTOR) != ESP_OK) {
+        Serial.println("Error al borrar sector " + String(sector) + " de la cola persistente");
+        return false;
+    }
+
+    CabeceraSector cabecera;
+    cabecera.marca = MARCA_SECTOR;
+    cabecera.numero = numero;
+    if (esp_partition_write(particion, sector * TAMANO_SECTOR, &cabecera, sizeof(cabecera)) != ESP_OK) {
+        Serial.println("Error al escribir sector " + String(sector) + " de la cola persistente");
+        return false;
+    }
+
+    sectorEscritura = sector;
+    posicionEscritura = sizeof(CabeceraSector);
+    numeroSectorEscritura = numero;
+
+    if (pendientes == 0) {
+        sectorLectura = sectorEscritura;
+        posicionLectura = posicionEscritura;
+    }
+    return true;
+}
+
+bool ColaPersistente::marcarConsumido(uint32_t direccion) {
+    // En flash solo se pueden bajar bits: 0xFE -> 0x00 sin borrar el sector
+    uint8_t estado = ESTADO_CONSUMIDO;
+    return esp_partition_write(particion, direccion + offsetof(CabeceraRegistro, estado), &estado, sizeof(estado)) == ESP_OK;
+}
+
+bool ColaPersistente::estaInicializada() const {
+    return inicializada;
+}
+
+bool ColaPersistente::hayPendientes() const {
+    return pendientes > 0;
+}
+
+uint32_t ColaPersistente::obtenerPendientes() const {
+    return pendientes;
+}
+
+uint32_t ColaPersistente::obtenerDescartados() const {
+    return descartados;
+}
+
+uint32_t ColaPersistente::obtenerCapacidadBytes() const {
+    return (uint32_t)cantidadSectores * (TAMANO_SECTOR - sizeof(CabeceraSector));
+}
+
+void ColaPersistente::imprimirEstado() const {
+    Serial.println("=== COLA PERSISTENTE ===");
+    Serial.println("Inicializada: " + String(inicializada ? "Sí" : "No"));
+    Serial.println("Pendientes: " + String(pendientes));
+    Serial.println("Descartados: " + String(descartados));
+    Serial.println("Sector escritura: " + String(sectorEscritura) + "/" + String(cantidadSectores));
+    Serial.println("Sector lectura: " + String(sectorLectura));
+    Serial.println("========================");
+}
@@ -1,6 +1,6 @@
 #include "ConfigManager.h"
 
-ConfigManager::ConfigManager() : configuracionCargada(false) {
+ConfigManager::ConfigManager() : configuracionCargada(false), contadorArranques(0) {
     // Valores por defecto
     configuracion.idDispositivo = "";
     configuracion.intervaloMedicion = 30; // 30 segundos por defecto
@@ -14,6 +14,22 @@ ConfigManager::ConfigManager() : configuracionCargada(false) {
     configuracion.pinSensorGas = 36; // ADC1_CH0 en ESP32
     configuracion.pinLED = 4;
     configuracion.pinBuzzer = 5;
+    configuracion.alfaEWMA = 0.2;
+    configuracion.muestreoAdaptativo = true;
+    configuracion.intervaloMinimo = 2;
+    configuracion.intervaloMaximo = 120;
+    configuracion.horizontePrediccion = 300;
+    configuracion.tamanoLote = 1;
+    configuracion.tiempoLote = 60;
+    configuracion.formatoPayload = "json";
+    configuracion.ventanaQoS = 4;
+    configuracion.publicacionExcepcion = false;
+    configuracion.bandaAbsoluta = 5.0;
+    configuracion.bandaRelativa = 5.0;
+    configuracion.intervaloLatido = 300;
+    configuracion.topicsCortos = false;
+    establecerCanalesPorDefecto();
+    reiniciarR0Canales();
 }
 
 ConfigManager::~ConfigManager() {
@@ -45,6 +61,37 @@ bool ConfigManager::cargarConfiguracion() {
     configuracion.pinSensorGas = preferences.getInt("pinSensorGas", 36);
     configuracion.pinLED = preferences.getInt("pinLED", 4);
     configuracion.pinBuzzer = preferences.getInt("pinBuzzer", 5);
+    configuracion.alfaEWMA = preferences.getFloat("alfaEWMA", 0.2);
+    configuracion.muestreoAdaptativo = preferences.getBool("muestreoAdapt", true);
+    configuracion.intervaloMinimo = preferences.getInt("intervaloMin", 2);
+    configuracion.intervaloMaximo = preferences.getInt("intervaloMax", 120);
+    configuracion.horizontePrediccion = preferences.getInt("horizontePred", 300);
+    configuracion.tamanoLote = preferences.getInt("tamanoLote", 1);
+    configuracion.tiempoLote = preferences.getInt("tiempoLote", 60);
+    configuracion.formatoPayload = preferences.getString("formatoPayload", "json");
+    configuracion.ventanaQoS = preferences.getInt("ventanaQoS", 4);
+    configuracion.publicacionExcepcion = preferences.getBool("pubExcepcion", false);
+    configuracion.bandaAbsoluta = preferences.getFloat("bandaAbsoluta", 5.0);
+    configuracion.bandaRelativa = preferences.getFloat("bandaRelativa", 5.0);
+    configuracion.intervaloLatido = preferences.getInt("latido", 300);
+    configuracion.topicsCortos = preferences.getBool("topicsCortos", false);
+    
+    // Canales de sensores de gas
+    establecerCanalesPorDefecto();
+    int cantidadCanales = preferences.getInt("cantCanales", 0);
+    if (cantidadCanales > 0 && cantidadCanales <= MAX_CANALES_SENSOR &&
+        preferences.getBytesLength("canalesGas") == sizeof(configuracion.canales)) {
+        preferences.getBytes("canalesGas", configuracion.canales, sizeof(configuracion.canales));
+        configuracion.cantidadCanales = cantidadCanales;
+    }
+    
+    // R0 por canal (calibración y línea base)
+    reiniciarR0Canales();
+    if (preferences.getBytesLength("r0Canales") == sizeof(configuracion.r0Canales) &&
+        preferences.getBytesLength("r0Referencia") == sizeof(configuracion.r0ReferenciaCanales)) {
+        preferences.getBytes("r0Canales", configuracion.r0Canales, sizeof(configuracion.r0Canales));
+        preferences.getBytes("r0Referencia", configuracion.r0ReferenciaCanales, sizeof(configuracion.r0ReferenciaCanales));
+    }
     
     // Generar ID del dispositivo si no existe
     if (configuracion.idDispositivo.isEmpty()) {
@@ -74,6 +121,24 @@ bool ConfigManager::guardarConfiguracion() {
     preferences.putInt("pinSensorGas", configuracion.pinSensorGas);
     preferences.putInt("pinLED", configuracion.pinLED);
     preferences.putInt("pinBuzzer", configuracion.pinBuzzer);
+    preferences.putFloat("alfaEWMA", configuracion.alfaEWMA);
+    preferences.putBool("muestreoAdapt", configuracion.muestreoAdaptativo);
+    preferences.putInt("intervaloMin", configuracion.intervaloMinimo);
+    preferences.putInt("intervaloMax", configuracion.intervaloMaximo);
+    preferences.putInt("horizontePred", configuracion.horizontePrediccion);
+    preferences.putInt("tamanoLote", configuracion.tamanoLote);
+    preferences.putInt("tiempoLote", configuracion.tiempoLote);
+    preferences.putString("formatoPayload", configuracion.formatoPayload);
+    preferences.putInt("ventanaQoS", configuracion.ventanaQoS);
+    preferences.putBool("pubExcepcion", configuracion.publicacionExcepcion);
+    preferences.putFloat("bandaAbsoluta", configuracion.bandaAbsoluta);
+    preferences.putFloat("bandaRelativa", configuracion.bandaRelativa);
+    preferences.putInt("latido", configuracion.intervaloLatido);
+    preferences.putBool("topicsCortos", configuracion.topicsCortos);
+    preferences.putInt("cantCanales", configuracion.cantidadCanales);
+    preferences.putBytes("canalesGas", configuracion.canales, sizeof(configuracion.canales));
+    preferences.putBytes("r0Canales", configuracion.r0Canales, sizeof(configuracion.r0Canales));
+    preferences.putBytes("r0Referencia", configuracion.r0ReferenciaCanales, sizeof(configuracion.r0ReferenciaCanales));
     
     Serial.println("Configuración guardada exitosamente");
     return true;
@@ -96,13 +161,38 @@ void ConfigManager::resetearConfiguracion() {
     configuracion.pinSensorGas = 36;
     configuracion.pinLED = 4;
     configuracion.pinBuzzer = 5;
+    configuracion.alfaEWMA = 0.2;
+    configuracion.muestreoAdaptativo = true;
+    configuracion.intervaloMinimo = 2;
+    configuracion.intervaloMaximo = 120;
+    configuracion.horizontePrediccion = 300;
+    configuracion.tamanoLote = 1;
+    configuracion.tiempoLote = 60;
+    configuracion.formatoPayload = "json";
+    configuracion.ventanaQoS = 4;
+    configuracion.publicacionExcepcion = false;
+    configuracion.bandaAbsoluta = 5.0;
+    configuracion.bandaRelativa = 5.0;
+    configuracion.intervaloLatido = 300;
+    configuracion.topicsCortos = false;
+    establecerCanalesPorDefecto();
+    reiniciarR0Canales();
+    
+    // El contador de arranques sobrevive al reseteo para no repetir numeración
+    preferences.putUInt("arranques", contadorArranques);
     
     guardarConfiguracion();
     Serial.println("Configuración reseteada a valores por defecto");
 }
 
+uint32_t ConfigManager::registrarArranque() {
+    contadorArranques = preferences.getUInt("arranques", 0) + 1;
+    preferences.putUInt("arranques", contadorArranques);
+    return contadorArranques;
+}
+
 // Getters
-String ConfigManager::obtenerIdDispositivo() const {
+const String& ConfigManager::obtenerIdDispositivo() const {
     return configuracion.idDispositivo;
 }
 
@@ -118,7 +208,7 @@ bool ConfigManager::esModoAWS() const {
     return configuracion.modoAWS;
 }
 
-String ConfigManager::obtenerBrokerMQTT() const {
+const String& ConfigManager::obtenerBrokerMQTT() const {
     return configuracion.brokerMQTT;
 }
 
@@ -150,6 +240,91 @@ int ConfigManager::obtenerPinBuzzer() const {
     return configuracion.pinBuzzer;
 }
 
+int ConfigManager::obtenerCantidadCanales() const {
+    return configuracion.cantidadCanales;
+}
+
+ConfigManager::CanalSensor ConfigManager::obtenerCanal(int indice) const {
+    if (indice < 0 || indice >= configuracion.cantidadCanales) {
+        return {(int8_t)configuracion.pinSensorGas, SENSOR_MQ2};
+    }
+    return configuracion.canales[indice];
+}
+
+float ConfigManager::obtenerAlfaEWMA() const {
+    return configuracion.alfaEWMA;
+}
+
+bool ConfigManager::esMuestreoAdaptativo() const {
+    return configuracion.muestreoAdaptativo;
+}
+
+int ConfigManager::obtenerIntervaloMinimo() const {
+    return configuracion.intervaloMinimo;
+}
+
+int ConfigManager::obtenerIntervaloMaximo() const {
+    return configuracion.intervaloMaximo;
+}
+
+int ConfigManager::obtenerHorizontePrediccion() const {
+    return configuracion.horizontePrediccion;
+}
+
+int ConfigManager::obtenerTamanoLote() const {
+    return configuracion.tamanoLote;
+}
+
+int ConfigManager::obtenerTiempoLote() const {
+    return configuracion.tiempoLote;
+}
+
+const String& ConfigManager::obtenerFormatoPayload() const {
+    return configuracion.formatoPayload;
+}
+
+int ConfigManager::obtenerVentanaQoS() const {
+    return configuracion.ventanaQoS;
+}
+
+bool ConfigManager::esPublicacionExcepcion() const {
+    return configuracion.publicacionExcepcion;
+}
+
+float ConfigManager::obtenerBandaAbsoluta() const {
+    return configuracion.bandaAbsoluta;
+}
+
+float ConfigManager::obtenerBandaRelativa() const {
+    return configuracion.bandaRelativa;
+}
+
+int ConfigManager::obtenerIntervaloLatido() const {
+    return configuracion.intervaloLatido;
+}
+
+bool ConfigManager::esTopicsCortos() const {
+    return configuracion.topicsCortos;
+}
+
+float ConfigManager::obtenerR0Canal(int indice) const {
+    if (indice < 0 || indice >= MAX_CANALES_SENSOR) {
+        return 0.0;
+    }
+    return configuracion.r0Canales[indice];
+}
+
+float ConfigManager::obtenerR0ReferenciaCanal(int indice) const {
+    if (indice < 0 || indice >= MAX_CANALES_SENSOR) {
+        return 0.0;
+    }
+    return configuracion.r0ReferenciaCanales[indice];
+}
+
+uint32_t ConfigManager::obtenerContadorArranques() const {
+    return contadorArranques;
+}
+
 // Setters
 void ConfigManager::establecerIntervaloMedicion(int intervalo) {
     if (intervalo >= 10 && intervalo <= 60) {
@@ -199,6 +374,148 @@ void ConfigManager::establecerPinExtractor(int pin) {
     }
 }
 
+bool ConfigManager::establecerCanales(const CanalSensor* canales, int cantidad) {
+    if (!canales || cantidad < 1 || cantidad > MAX_CANALES_SENSOR) {
+        return false;
+    }
+    
+    for (int i = 0; i < cantidad; i++) {
+        if (canales[i].pin < 0 || canales[i].pin > 39 || canales[i].tipo >= CANTIDAD_TIPOS_SENSOR) {
+            return false;
+        }
+    }
+    
+    memset(configuracion.canales, 0, sizeof(configuracion.canales));
+    memcpy(configuracion.canales, canales, cantidad * sizeof(CanalSensor));
+    configuracion.cantidadCanales = cantidad;
+    configuracion.pinSensorGas = canales[0].pin;
+    reiniciarR0Canales(); // Los sensores nuevos requieren calibración
+    guardarConfiguracion();
+    return true;
+}
+
+void ConfigManager::establecerAlfaEWMA(float alfa) {
+    if (alfa > 0 && alfa <= 1) {
+        configuracion.alfaEWMA = alfa;
+        guardarConfiguracion();
+    }
+}
+
+void ConfigManager::establecerMuestreoAdaptativo(bool adaptativo) {
+    configuracion.muestreoAdaptativo = adaptativo;
+    guardarConfiguracion();
+}
+
+void ConfigManager::establecerIntervaloMinimo(int intervalo) {
+    if (intervalo >= 1 && intervalo <= 60 && intervalo < configuracion.intervaloMaximo) {
+        configuracion.intervaloMinimo = intervalo;
+        guardarConfiguracion();
+    }
+}
+
+void ConfigManager::establecerIntervaloMaximo(int intervalo) {
+    if (intervalo >= 10 && intervalo <= 600 && intervalo > configuracion.intervaloMinimo) {
+        configuracion.intervaloMaximo = intervalo;
+        guardarConfiguracion();
+    }
+}
+
+void ConfigManager::establecerHorizontePrediccion(int horizonte) {
+    if (horizonte >= 0 && horizonte <= 3600) {
+        configuracion.horizontePrediccion = horizonte;
+        guardarConfiguracion();
+    }
+}
+
+void ConfigManager::establecerTamanoLote(int tamano) {
+    if (tamano >= 1 && tamano <= 20) {
+        configuracion.tamanoLote = tamano;
+        guardarConfiguracion();
+    }
+}
+
+void ConfigManager::establecerTiempoLote(int tiempo) {
+    if (tiempo >= 1 && tiempo <= 600) {
+        configuracion.tiempoLote = tiempo;
+        guardarConfiguracion();
+    }
+}
+
+void ConfigManager::establecerFormatoPayload(const String& formato) {
+    if (formato == "json" || formato == "msgpack") {
+        configuracion.formatoPayload = formato;
+        guardarConfiguracion();
+    }
+}
+
+void ConfigManager::establecerVentanaQoS(int ventana) {
+    if (ventana >= 1 && ventana <= 16) {
+        configuracion.ventanaQoS = ventana;
+        guardarConfiguracion();
+    }
+}
+
+void ConfigManager::establecerPublicacionExcepcion(bool activa) {
+    configuracion.publicacionExcepcion = activa;
+    guardarConfiguracion();
+}
+
+void ConfigManager::establecerBandaAbsoluta(float banda) {
+    if (banda >= 0 && banda <= 1000) {
+        configuracion.bandaAbsoluta = banda;
+        guardarConfiguracion();
+    }
+}
+
+void ConfigManager::establecerBandaRelativa(float banda) {
+    if (banda >= 0 && banda <= 100) {
+        configuracion.bandaRelativa = banda;
+        guardarConfiguracion();
+    }
+}
+
+void ConfigManager::establecerIntervaloLatido(int intervalo) {
+    if (intervalo >= 10 && intervalo <= 3600) {
+        configuracion.intervaloLatido = intervalo;
+        guardarConfiguracion();
+    }
+}
+
+void ConfigManager::establecerTopicsCortos(bool activos) {
+    configuracion.topicsCortos = activos;
+    guardarConfiguracion();
+}
+
+bool ConfigManager::establecerR0Canales(const float* r0, const float* referencias, int cantidad) {
+    if (!r0 || !referencias || cantidad < 1 || cantidad > MAX_CANALES_SENSOR) {
+        return false;
+    }
+    
+    for (int i = 0; i < cantidad; i++) {
+        if (r0[i] <= 0 || referencias[i] <= 0) {
+            return false;
+        }
+    }
+    
+    memcpy(configuracion.r0Canales, r0, cantidad * sizeof(float));
+    memcpy(configuracion.r0ReferenciaCanales, referencias, cantidad * sizeof(float));
+    guardarConfiguracion();
+    return true;
+}
+
+void ConfigManager::reiniciarR0Canales() {
+    memset(configuracion.r0Canales, 0, sizeof(configuracion.r0Canales));
+    memset(configuracion.r0ReferenciaCanales, 0, sizeof(configuracion.r0ReferenciaCanales));
+}
+
+void ConfigManager::establecerCanalesPorDefecto() {
+    // Un único MQ-2 en el pin del sensor principal
+    memset(configuracion.canales, 0, sizeof(configuracion.canales));
+    configuracion.canales[0].pin = configuracion.pinSensorGas;
+    configuracion.canales[0].tipo = SENSOR_MQ2;
+    configuracion.cantidadCanales = 1;
+}
+
 // Utilidades
 String ConfigManager::generarIdDispositivo() {
     String mac = WiFi.macAddress();
@@ -229,5 +546,20 @@ void ConfigManager::imprimirConfiguracion() const {
     Serial.println("Pin Sensor Gas: " + String(configuracion.pinSensorGas));
     Serial.println("Pin LED: " + String(configuracion.pinLED));
     Serial.println("Pin Buzzer: " + String(configuracion.pinBuzzer));
+    Serial.println("Alfa EWMA: " + String(configuracion.alfaEWMA, 3));
+    Serial.println("Muestreo Adaptativo: " + String(configuracion.muestreoAdaptativo ? "Sí" : "No") +
+                   " (" + String(configuracion.intervaloMinimo) + "-" + String(configuracion.intervaloMaximo) + " segundos)");
+    Serial.println("Horizonte Predicción: " + String(configuracion.horizontePrediccion) + " segundos");
+    Serial.println("Lotes MQTT: " + String(configuracion.tamanoLote) + " lectura(s), máximo " + String(configuracion.tiempoLote) + " segundos");
+    Serial.println("Formato de payload: " + configuracion.formatoPayload);
+    Serial.println("Ventana QoS 1: " + String(configuracion.ventanaQoS) + " mensaje(s)");
+    Serial.println("Publicación por excepción: " + String(configuracion.publicacionExcepcion ? "Sí" : "No") + " (banda " + String(configuracion.bandaAbsoluta, 1) + " ppm / " + String(configuracion.bandaRelativa, 1) + " %, latido " + String(configuracion.intervaloLatido) + " s)");
+    Serial.println("Topics cortos: " + String(configuracion.topicsCortos ? "Sí" : "No"));
+    for (int i = 0; i < configuracion.cantidadCanales; i++) {
+        Serial.println("Canal " + String(i) + ": " +
+                       String(PerfilesSensor::obtener((TipoSensorMQ)configuracion.canales[i].tipo).nombre) +
+                       " en pin " + String(configuracion.canales[i].pin) +
+                       (configuracion.r0Canales[i] > 0 ? ", R0 " + String(configuracion.r0Canales[i], 3) + " kΩ" : ", sin calibrar"));
+    }
     Serial.println("================================");
 }
@@ -1,27 +1,28 @@
 #include "ConfiguracionRemota.h"
 
 ConfiguracionRemota::ConfiguracionRemota() : 
-    configManager(nullptr), sensorGas(nullptr), sistemaAlarmas(nullptr), logger(nullptr),
-    topicConfiguracion(""), configuracionRecibida(false), ultimaConfiguracion(0),
+    configManager(nullptr), sensoresGas(nullptr), sistemaAlarmas(nullptr), logger(nullptr), mqttManager(nullptr),
+    topicConfiguracion(""), topicConfirmacion(""), configuracionRecibida(false), ultimaConfiguracion(0),
     callbackConfiguracionCambiada(nullptr) {
 }
 
 ConfiguracionRemota::~ConfiguracionRemota() {
 }
 
-bool ConfiguracionRemota::inicializar(ConfigManager* config, GasSensor* sensor, 
+bool ConfiguracionRemota::inicializar(ConfigManager* config, GasSensorArray* sensores, 
                                     SistemaAlarmas* alarmas, SistemaLogging* log) {
-    if (!config || !sensor || !alarmas || !log) {
+    if (!config || !sensores || !alarmas || !log) {
         return false;
     }
     
     configManager = config;
-    sensorGas = sensor;
+    sensoresGas = sensores;
     sistemaAlarmas = alarmas;
     logger = log;
     
     // Configurar topic de configuración
     topicConfiguracion = "/" + configManager->obtenerIdDispositivo() + "/configuracion";
+    topicConfirmacion = topicConfiguracion + "/confirmacion";
     
     logger->info("CONFIG_REMOTA", "Sistema de configuración remota inicializado");
     logger->info("CONFIG_REMOTA", "Topic configuración: " + topicConfiguracion);
@@ -29,17 +30,41 @@ bool ConfiguracionRemota::inicializar(ConfigManager* config, GasSensor* sensor,
     return true;
 }
 
+bool ConfiguracionRemota::registrarManejadores(MQTTManager* mqtt) {
+    if (!mqtt || !logger) {
+        return false;
+    }
+    mqttManager = mqtt;
+    
+    // Topic propio y configuración difundida a toda la flota
+    bool exito = mqtt->registrarManejador(topicConfiguracion, manejarMensaje, this);
+    exito = mqtt->registrarManejador("/flota/configuracion", manejarMensaje, this) && exito;
+    
+    if (!exito) {
+        logger->error("CONFIG_REMOTA", "Error al registrar manejadores MQTT");
+    }
+    return exito;
+}
+
+void ConfiguracionRemota::manejarMensaje(void* contexto, const char* topic, const uint8_t* payload, size_t longitud) {
+    static_cast<ConfiguracionRemota*>(contexto)->procesarMensajeConfiguracion(payload, longitud);
+}
+
 void ConfiguracionRemota::procesarMensajeConfiguracion(const String& payload) {
+    procesarMensajeConfiguracion((const uint8_t*)payload.c_str(), payload.length());
+}
+
+void ConfiguracionRemota::procesarMensajeConfiguracion(const uint8_t* payload, size_t longitud) {
     if (!configManager || !logger) {
         return;
     }
     
     logger->info("CONFIG_REMOTA", "Procesando mensaje de configuración remota");
-    logger->debug("CONFIG_REMOTA", "Payload recibido: " + payload);
+    logger->debug("CONFIG_REMOTA", "Payload recibido: " + String(longitud) + " bytes");
     
-    // Parsear JSON
+    // Parsear JSON directamente del buffer del transporte
     DynamicJsonDocument doc(1024);
-    DeserializationError error = deserializeJson(doc, payload);
+    DeserializationError error = deserializeJson(doc, payload, longitud);
     
     if (error) {
         logger->error("CONFIG_REMOTA", "Error al parsear JSON: " + String(error.c_str()));
@@ -133,6 +158,150 @@ void ConfiguracionRemota::procesarMensajeConfiguracion(const String& payload) {
         }
     }
     
+    if (config.containsKey("canales_sensor")) {
+        if (procesarCanalesSensor(config["canales_sensor"])) {
+            parametrosProcesados += "canales_sensor ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("alfa_ewma")) {
+        float alfa = config["alfa_ewma"];
+        if (procesarAlfaEWMA(alfa)) {
+            parametrosProcesados += "alfa_ewma ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("muestreo_adaptativo")) {
+        bool adaptativo = config["muestreo_adaptativo"];
+        if (procesarMuestreoAdaptativo(adaptativo)) {
+            parametrosProcesados += "muestreo_adaptativo ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("intervalo_minimo")) {
+        int intervalo = config["intervalo_minimo"];
+        if (procesarIntervaloMinimo(intervalo)) {
+            parametrosProcesados += "intervalo_minimo ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("intervalo_maximo")) {
+        int intervalo = config["intervalo_maximo"];
+        if (procesarIntervaloMaximo(intervalo)) {
+            parametrosProcesados += "intervalo_maximo ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("horizonte_prediccion")) {
+        int horizonte = config["horizonte_prediccion"];
+        if (procesarHorizontePrediccion(horizonte)) {
+            parametrosProcesados += "horizonte_prediccion ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("tamano_lote")) {
+        int tamano = config["tamano_lote"];
+        if (procesarTamanoLote(tamano)) {
+            parametrosProcesados += "tamano_lote ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("tiempo_lote")) {
+        int tiempo = config["tiempo_lote"];
+        if (procesarTiempoLote(tiempo)) {
+            parametrosProcesados += "tiempo_lote ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("formato_payload")) {
+        String formato = config["formato_payload"];
+        if (procesarFormatoPayload(formato)) {
+            parametrosProcesados += "formato_payload ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("ventana_qos")) {
+        int ventana = config["ventana_qos"];
+        if (procesarVentanaQoS(ventana)) {
+            parametrosProcesados += "ventana_qos ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("publicacion_excepcion")) {
+        bool activa = config["publicacion_excepcion"];
+        if (procesarPublicacionExcepcion(activa)) {
+            parametrosProcesados += "publicacion_excepcion ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("banda_absoluta")) {
+        float banda = config["banda_absoluta"];
+        if (procesarBandaAbsoluta(banda)) {
+            parametrosProcesados += "banda_absoluta ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("banda_relativa")) {
+        float banda = config["banda_relativa"];
+        if (procesarBandaRelativa(banda)) {
+            parametrosProcesados += "banda_relativa ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("intervalo_latido")) {
+        int intervalo = config["intervalo_latido"];
+        if (procesarIntervaloLatido(intervalo)) {
+            parametrosProcesados += "intervalo_latido ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("topics_cortos")) {
+        bool activos = config["topics_cortos"];
+        if (procesarTopicsCortos(activos)) {
+            parametrosProcesados += "topics_cortos ";
+        } else {
+            exito = false;
+        }
+    }
+    
+    // Acción: calibración en aire limpio (-1 = todos los canales)
+    if (config.containsKey("calibrar_sensor")) {
+        int canal = config["calibrar_sensor"];
+        if (procesarCalibracionSensor(canal)) {
+            parametrosProcesados += "calibrar_sensor ";
+        } else {
+            exito = false;
+        }
+    }
+    
     // Enviar confirmación
     if (exito) {
         logger->info("CONFIG_REMOTA", "Configuración aplicada exitosamente: " + parametrosProcesados);
@@ -182,7 +351,7 @@ bool ConfiguracionRemota::procesarUmbralAlarma(float umbral) {
     }
     
     configManager->establecerUmbralAlarma(umbral);
-    sensorGas->establecerUmbral(umbral);
+    sensoresGas->establecerUmbral(umbral);
     logger->info("CONFIG_REMOTA", "Umbral de alarma actualizado a: " + String(umbral) + " ppm");
     
     if (callbackConfiguracionCambiada) {
@@ -270,18 +439,8 @@ bool ConfiguracionRemota::procesarNivelLogging(const String& nivel) {
         return false;
     }
     
-    SistemaLogging::NivelLog nivelLog;
-    if (nivel == "DEBUG") {
-        nivelLog = SistemaLogging::DEBUG;
-    } else if (nivel == "INFO") {
-        nivelLog = SistemaLogging::INFO;
-    } else if (nivel == "WARNING") {
-        nivelLog = SistemaLogging::WARNING;
-    } else if (nivel == "ERROR") {
-        nivelLog = SistemaLogging::ERROR;
-    }
-    
-    logger->establecerNivel(nivelLog);
+    // Nivel general y, opcionalmente, por componente: "INFO,MQTT=DEBUG"
+    logger->aplicarNiveles(nivel);
     logger->info("CONFIG_REMOTA", "Nivel de logging actualizado a: " + nivel);
     
     if (callbackConfiguracionCambiada) {
@@ -291,6 +450,273 @@ bool ConfiguracionRemota::procesarNivelLogging(const String& nivel) {
     return true;
 }
 
+bool ConfiguracionRemota::procesarCanalesSensor(const JsonArray& canales) {
+    ConfigManager::CanalSensor nuevosCanales[ConfigManager::MAX_CANALES_SENSOR];
+    int cantidad = 0;
+    
+    for (JsonObject canal : canales) {
+        if (cantidad >= ConfigManager::MAX_CANALES_SENSOR) {
+            logger->warning("CONFIG_REMOTA", "Demasiados canales de sensor, máximo " + String(ConfigManager::MAX_CANALES_SENSOR));
+            return false;
+        }
+        
+        TipoSensorMQ tipo;
+        const char* nombreTipo = canal["tipo"] | "";
+        if (!PerfilesSensor::buscarTipo(nombreTipo, tipo)) {
+            logger->warning("CONFIG_REMOTA", "Tipo de sensor inválido: " + String(nombreTipo));
+            return false;
+        }
+        
+        nuevosCanales[cantidad].pin = canal["pin"] | -1;
+        nuevosCanales[cantidad].tipo = tipo;
+        cantidad++;
+    }
+    
+    if (!configManager->establecerCanales(nuevosCanales, cantidad)) {
+        logger->warning("CONFIG_REMOTA", "Configuración de canales de sensor inválida");
+        return false;
+    }
+    
+    // Los canales ADC se registran al arrancar
+    logger->info("CONFIG_REMOTA", "Canales de sensor actualizados: " + String(cantidad) + " (se aplican al reiniciar)");
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("canales_sensor", String(cantidad));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarAlfaEWMA(float alfa) {
+    if (!validarAlfaEWMA(alfa)) {
+        logger->warning("CONFIG_REMOTA", "Factor EWMA inválido: " + String(alfa));
+        return false;
+    }
+    
+    configManager->establecerAlfaEWMA(alfa);
+    sensoresGas->establecerAlfaEWMA(alfa);
+    logger->info("CONFIG_REMOTA", "Factor EWMA actualizado a: " + String(alfa, 3));
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("alfa_ewma", String(alfa, 3));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarCalibracionSensor(int canal) {
+    if (canal < -1 || canal >= sensoresGas->obtenerCantidadCanales()) {
+        logger->warning("CONFIG_REMOTA", "Canal de calibración inválido: " + String(canal));
+        return false;
+    }
+    
+    if (!sensoresGas->iniciarCalibracion(canal)) {
+        logger->warning("CONFIG_REMOTA", "No se pudo iniciar la calibración");
+        return false;
+    }
+    
+    logger->info("CONFIG_REMOTA", "Calibración iniciada en canal " + String(canal));
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("calibrar_sensor", String(canal));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarMuestreoAdaptativo(bool adaptativo) {
+    configManager->establecerMuestreoAdaptativo(adaptativo);
+    logger->info("CONFIG_REMOTA", "Muestreo adaptativo " + String(adaptativo ? "activado" : "desactivado"));
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("muestreo_adaptativo", adaptativo ? "true" : "false");
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarIntervaloMinimo(int intervalo) {
+    if (!validarIntervaloMinimo(intervalo)) {
+        logger->warning("CONFIG_REMOTA", "Intervalo mínimo inválido: " + String(intervalo));
+        return false;
+    }
+    
+    configManager->establecerIntervaloMinimo(intervalo);
+    logger->info("CONFIG_REMOTA", "Intervalo mínimo actualizado a: " + String(intervalo) + " segundos");
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("intervalo_minimo", String(intervalo));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarIntervaloMaximo(int intervalo) {
+    if (!validarIntervaloMaximo(intervalo)) {
+        logger->warning("CONFIG_REMOTA", "Intervalo máximo inválido: " + String(intervalo));
+        return false;
+    }
+    
+    configManager->establecerIntervaloMaximo(intervalo);
+    logger->info("CONFIG_REMOTA", "Intervalo máximo actualizado a: " + String(intervalo) + " segundos");
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("intervalo_maximo", String(intervalo));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarHorizontePrediccion(int horizonte) {
+    if (!validarHorizontePrediccion(horizonte)) {
+        logger->warning("CONFIG_REMOTA", "Horizonte de predicción inválido: " + String(horizonte));
+        return false;
+    }
+    
+    configManager->establecerHorizontePrediccion(horizonte);
+    logger->info("CONFIG_REMOTA", "Horizonte de predicción actualizado a: " + String(horizonte) + " segundos");
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("horizonte_prediccion", String(horizonte));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarTamanoLote(int tamano) {
+    if (!validarTamanoLote(tamano)) {
+        logger->warning("CONFIG_REMOTA", "Tamaño de lote inválido: " + String(tamano));
+        return false;
+    }
+    
+    configManager->establecerTamanoLote(tamano);
+    logger->info("CONFIG_REMOTA", "Tamaño de lote actualizado a: " + String(tamano) + " lectura(s)");
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("tamano_lote", String(tamano));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarTiempoLote(int tiempo) {
+    if (!validarTiempoLote(tiempo)) {
+        logger->warning("CONFIG_REMOTA", "Tiempo de lote inválido: " + String(tiempo));
+        return false;
+    }
+    
+    configManager->establecerTiempoLote(tiempo);
+    logger->info("CONFIG_REMOTA", "Tiempo de lote actualizado a: " + String(tiempo) + " segundos");
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("tiempo_lote", String(tiempo));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarFormatoPayload(const String& formato) {
+    if (!validarFormatoPayload(formato)) {
+        logger->warning("CONFIG_REMOTA", "Formato de payload inválido: " + formato);
+        return false;
+    }
+    
+    configManager->establecerFormatoPayload(formato);
+    logger->info("CONFIG_REMOTA", "Formato de payload actualizado a: " + formato);
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("formato_payload", formato);
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarVentanaQoS(int ventana) {
+    if (!validarVentanaQoS(ventana)) {
+        logger->warning("CONFIG_REMOTA", "Ventana QoS 1 inválido: " + String(ventana));
+        return false;
+    }
+    
+    configManager->establecerVentanaQoS(ventana);
+    logger->info("CONFIG_REMOTA", "Ventana QoS 1 actualizado a: " + String(ventana) + " mensaje(s)");
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("ventana_qos", String(ventana));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarPublicacionExcepcion(bool activa) {
+    configManager->establecerPublicacionExcepcion(activa);
+    logger->info("CONFIG_REMOTA", "Publicación por excepción " + String(activa ? "activada" : "desactivada"));
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("publicacion_excepcion", activa ? "true" : "false");
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarBandaAbsoluta(float banda) {
+    if (!validarBandaAbsoluta(banda)) {
+        logger->warning("CONFIG_REMOTA", "Banda absoluta inválida: " + String(banda));
+        return false;
+    }
+    
+    configManager->establecerBandaAbsoluta(banda);
+    logger->info("CONFIG_REMOTA", "Banda absoluta actualizada a: " + String(banda) + " ppm");
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("banda_absoluta", String(banda));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarBandaRelativa(float banda) {
+    if (!validarBandaRelativa(banda)) {
+        logger->warning("CONFIG_REMOTA", "Banda relativa inválida: " + String(banda));
+        return false;
+    }
+    
+    configManager->establecerBandaRelativa(banda);
+    logger->info("CONFIG_REMOTA", "Banda relativa actualizada a: " + String(banda) + " %");
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("banda_relativa", String(banda));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarIntervaloLatido(int intervalo) {
+    if (!validarIntervaloLatido(intervalo)) {
+        logger->warning("CONFIG_REMOTA", "Intervalo de latido inválido: " + String(intervalo));
+        return false;
+    }
+    
+    configManager->establecerIntervaloLatido(intervalo);
+    logger->info("CONFIG_REMOTA", "Intervalo de latido actualizado a: " + String(intervalo) + " segundos");
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("intervalo_latido", String(intervalo));
+    }
+    
+    return true;
+}
+
+bool ConfiguracionRemota::procesarTopicsCortos(bool activos) {
+    configManager->establecerTopicsCortos(activos);
+    logger->info("CONFIG_REMOTA", "Topics cortos " + String(activos ? "activados" : "desactivados"));
+    
+    if (callbackConfiguracionCambiada) {
+        callbackConfiguracionCambiada("topics_cortos", activos ? "true" : "false");
+    }
+    
+    return true;
+}
+
 bool ConfiguracionRemota::procesarConfiguracionCompleta(const JsonObject& config) {
     logger->info("CONFIG_REMOTA", "Procesando configuración completa");
     
@@ -361,6 +787,126 @@ bool ConfiguracionRemota::procesarConfiguracionCompleta(const JsonObject& config
         }
     }
     
+    if (config.containsKey("canales_sensor")) {
+        if (procesarCanalesSensor(config["canales_sensor"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("alfa_ewma")) {
+        if (procesarAlfaEWMA(config["alfa_ewma"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("muestreo_adaptativo")) {
+        if (procesarMuestreoAdaptativo(config["muestreo_adaptativo"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("intervalo_minimo")) {
+        if (procesarIntervaloMinimo(config["intervalo_minimo"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("intervalo_maximo")) {
+        if (procesarIntervaloMaximo(config["intervalo_maximo"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("horizonte_prediccion")) {
+        if (procesarHorizontePrediccion(config["horizonte_prediccion"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("tamano_lote")) {
+        if (procesarTamanoLote(config["tamano_lote"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("tiempo_lote")) {
+        if (procesarTiempoLote(config["tiempo_lote"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("formato_payload")) {
+        if (procesarFormatoPayload(config["formato_payload"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("ventana_qos")) {
+        if (procesarVentanaQoS(config["ventana_qos"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("publicacion_excepcion")) {
+        if (procesarPublicacionExcepcion(config["publicacion_excepcion"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("banda_absoluta")) {
+        if (procesarBandaAbsoluta(config["banda_absoluta"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("banda_relativa")) {
+        if (procesarBandaRelativa(config["banda_relativa"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("intervalo_latido")) {
+        if (procesarIntervaloLatido(config["intervalo_latido"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
+    if (config.containsKey("topics_cortos")) {
+        if (procesarTopicsCortos(config["topics_cortos"])) {
+            parametrosProcesados++;
+        } else {
+            exito = false;
+        }
+    }
+    
     logger->info("CONFIG_REMOTA", "Configuración completa procesada: " + String(parametrosProcesados) + " parámetros");
     enviarConfirmacionConfiguracion("CONFIGURACION_COMPLETA", exito, 
                                    "Procesados " + String(parametrosProcesados) + " parámetros");
@@ -386,17 +932,69 @@ bool ConfiguracionRemota::validarPinExtractor(int pin) {
 }
 
 bool ConfiguracionRemota::validarNivelLogging(const String& nivel) {
-    return nivel == "DEBUG" || nivel == "INFO" || nivel == "WARNING" || nivel == "ERROR";
+    return SistemaLogging::esEspecificacionValida(nivel);
+}
+
+bool ConfiguracionRemota::validarAlfaEWMA(float alfa) {
+    return alfa > 0 && alfa <= 1;
+}
+
+bool ConfiguracionRemota::validarIntervaloMinimo(int intervalo) {
+    return intervalo >= 1 && intervalo <= 60 && intervalo < configManager->obtenerIntervaloMaximo();
+}
+
+bool ConfiguracionRemota::validarIntervaloMaximo(int intervalo) {
+    return intervalo >= 10 && intervalo <= 600 && intervalo > configManager->obtenerIntervaloMinimo();
+}
+
+bool ConfiguracionRemota::validarHorizontePrediccion(int horizonte) {
+    return horizonte >= 0 && horizonte <= 3600;
+}
+
+bool ConfiguracionRemota::validarTamanoLote(int tamano) {
+    return tamano >= 1 && tamano <= 20;
+}
+
+bool ConfiguracionRemota::validarTiempoLote(int tiempo) {
+    return tiempo >= 1 && tiempo <= 600;
+}
+
+bool ConfiguracionRemota::validarFormatoPayload(const String& formato) {
+    return formato == "json" || formato == "msgpack";
+}
+
+bool ConfiguracionRemota::validarVentanaQoS(int ventana) {
+    return ventana >= 1 && ventana <= 16;
+}
+
+bool ConfiguracionRemota::validarBandaAbsoluta(float banda) {
+    return banda >= 0 && banda <= 1000;
+}
+
+bool ConfiguracionRemota::validarBandaRelativa(float banda) {
+    return banda >= 0 && banda <= 100;
+}
+
+bool ConfiguracionRemota::validarIntervaloLatido(int intervalo) {
+    return intervalo >= 10 && intervalo <= 3600;
 }
 
 void ConfiguracionRemota::enviarConfirmacionConfiguracion(const String& parametro, bool exito, const String& mensaje) {
-    // Esta función debería enviar la confirmación por MQTT
-    // Por ahora solo logueamos
     if (exito) {
         logger->info("CONFIG_REMOTA", "Confirmación: " + parametro + " - " + mensaje);
     } else {
         logger->error("CONFIG_REMOTA", "Error: " + parametro + " - " + mensaje);
     }
+    
+    // Confirmación por MQTT, antes que la telemetría en espera
+    if (mqttManager && mqttManager->estaConectado()) {
+        StaticJsonDocument<256> doc;
+        doc["parametro"] = parametro;
+        doc["exito"] = exito;
+        doc["mensaje"] = mensaje;
+        doc["timestamp"] = millis();
+        mqttManager->publicarEvento(topicConfirmacion, doc.as<JsonObject>(), PlanificadorSalida::PRIORIDAD_CONFIRMACION);
+    }
 }
 
 void ConfiguracionRemota::enviarEstadoConfiguracion() {
@@ -426,7 +1024,23 @@ void ConfiguracionRemota::imprimirConfiguracionesDisponibles() const {
     logger->info("CONFIG_REMOTA", "- puerto_mqtt: 1-65535");
     logger->info("CONFIG_REMOTA", "- extractor_alambrico: true/false");
     logger->info("CONFIG_REMOTA", "- pin_extractor: 0-39");
-    logger->info("CONFIG_REMOTA", "- nivel_logging: DEBUG/INFO/WARNING/ERROR");
+    logger->info("CONFIG_REMOTA", "- nivel_logging: DEBUG/INFO/WARNING/ERROR, con excepciones por componente (INFO,MQTT=DEBUG)");
+    logger->info("CONFIG_REMOTA", "- canales_sensor: [{pin, tipo}] hasta " + String(ConfigManager::MAX_CANALES_SENSOR));
+    logger->info("CONFIG_REMOTA", "- alfa_ewma: 0-1 (suavizado de estadísticas)");
+    logger->info("CONFIG_REMOTA", "- calibrar_sensor: canal o -1 para todos (acción)");
+    logger->info("CONFIG_REMOTA", "- muestreo_adaptativo: true/false");
+    logger->info("CONFIG_REMOTA", "- intervalo_minimo: 1-60 segundos (menor que intervalo_maximo)");
+    logger->info("CONFIG_REMOTA", "- intervalo_maximo: 10-600 segundos (mayor que intervalo_minimo)");
+    logger->info("CONFIG_REMOTA", "- horizonte_prediccion: 0-3600 segundos (0 = sin alerta predictiva)");
+    logger->info("CONFIG_REMOTA", "- tamano_lote: 1-20 lecturas por publicación (1 = sin lotes)");
+    logger->info("CONFIG_REMOTA", "- tiempo_lote: 1-600 segundos de espera máxima de un lote");
+    logger->info("CONFIG_REMOTA", "- formato_payload: \"json\" o \"msgpack\" (binario con IDs de campo)");
+    logger->info("CONFIG_REMOTA", "- ventana_qos: 1-16 mensajes QoS 1 en vuelo sin PUBACK");
+    logger->info("CONFIG_REMOTA", "- publicacion_excepcion: true/false (publicar lecturas solo ante cambios)");
+    logger->info("CONFIG_REMOTA", "- banda_absoluta: 0-1000 ppm de variación para publicar");
+    logger->info("CONFIG_REMOTA", "- banda_relativa: 0-100 % del último valor publicado");
+    logger->info("CONFIG_REMOTA", "- intervalo_latido: 10-3600 segundos sin publicar como máximo");
+    logger->info("CONFIG_REMOTA", "- topics_cortos: true/false (g/{id corto}/l, /a, /m, /c en lugar de /{id}/lecturas, etc.)");
 }
 
 // Getters
@@ -434,8 +1048,8 @@ ConfigManager* ConfiguracionRemota::obtenerConfigManager() const {
     return configManager;
 }
 
-GasSensor* ConfiguracionRemota::obtenerSensorGas() const {
-    return sensorGas;
+GasSensorArray* ConfiguracionRemota::obtenerSensoresGas() const {
+    return sensoresGas;
 }
 
 SistemaAlarmas* ConfiguracionRemota::obtenerSistemaAlarmas() const {
@@ -0,0 +1,117 @@
+#include "EnrutadorMQTT.h"
+
+EnrutadorMQTT::EnrutadorMQTT() : cantidadRutas(0) {
+}
+
+bool EnrutadorMQTT::registrar(const char* filtro, Manejador manejador, void* contexto) {
+    if (cantidadRutas >= MAXIMO_RUTAS || !manejador || !esFiltroValido(filtro)) {
+        return false;
+    }
+
+    size_t longitud = strlen(filtro);
+    if (longitud >= LONGITUD_MAXIMA_FILTRO) {
+        return false;
+    }
+
+    Ruta& ruta = rutas[cantidadRutas];
+    memcpy(ruta.filtro, filtro, longitud + 1);
+    ruta.longitudLiteral = strcspn(filtro, "+#");
+    if (filtro[ruta.longitudLiteral] == '#' && ruta.longitudLiteral > 0) {
+        ruta.longitudLiteral--;         // "a/#" también coincide con "a"
+    }
+    ruta.manejador = manejador;
+    ruta.contexto = contexto;
+    cantidadRutas++;
+    return true;
+}
+
+bool EnrutadorMQTT::esFiltroValido(const char* filtro) {
+    if (!filtro || filtro[0] == '\0') {
+        return false;
+    }
+
+    // '+' y '#' ocupan un nivel completo; '#' solo al final
+    for (const char* c = filtro; *c; c++) {
+        bool inicioNivel = c == filtro || c[-1] == '/';
+        bool finNivel = c[1] == '\0' || c[1] == '/';
+        if (*c == '+' && !(inicioNivel && finNivel)) {
+            return false;
+        }
+        if (*c == '#' && !(inicioNivel && c[1] == '\0')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EnrutadorMQTT::coincide(const char* filtro, const char* topic) {
+    // Los topics del sistema ($SYS/...) no coinciden con comodines en el primer nivel
+    if (topic[0] == '$' && (filtro[0] == '+' || filtro[0] == '#')) {
+        return false;
+    }
+
+    const char* f = filtro;
+    const char* t = topic;
+    while (true) {
+        if (*f == '#') {
+            return true;
+        }
+
+        if (*f == '+') {
+            // Cualquier contenido hasta el próximo separador
+            f++;
+            while (*t && *t != '/') {
+                t++;
+            }
+        } else {
+            while (*f && *f != '/' && *f == *t) {
+                f++;
+                t++;
+            }
+            if ((*f && *f != '/') || (*t && *t != '/')) {
+                return false;
+            }
+        }
+
+        if (*f == '\0' && *t == '\0') {
+            return true;
+        }
+        if (*f == '/' && *t == '/') {
+            f++;
+            t++;
+            continue;
+        }
+        // "a/#" también coincide con "a"
+        return *t == '\0' && f[0] == '/' && f[1] == '#';
+    }
+}
+
+int EnrutadorMQTT::despachar(const char* topic, const uint8_t* payload, size_t longitud) const {
+    int entregados = 0;
+    for (int i = 0; i < cantidadRutas; i++) {
+        const Ruta& ruta = rutas[i];
+        if (strncmp(ruta.filtro, topic, ruta.longitudLiteral) != 0 || !coincide(ruta.filtro, topic)) {
+            continue;
+        }
+        ruta.manejador(ruta.contexto, topic, payload, longitud);
+        entregados++;
+    }
+    return entregados;
+}
+
+int EnrutadorMQTT::obtenerCantidadRutas() const {
+    return cantidadRutas;
+}
+
+const char* EnrutadorMQTT::obtenerFiltro(int indice) const {
+    return indice >= 0 && indice < cantidadRutas ? rutas[indice].filtro : nullptr;
+}
+
+bool EnrutadorMQTT::esFiltroRepetido(int indice) const {
+    for (int i = 0; i < indice && i < cantidadRutas; i++) {
+        if (strcmp(rutas[i].filtro, rutas[indice].filtro) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,106 @@
+#include "EstadisticasFlujo.h"
+#include <math.h>
+
+const float EstadisticasFlujo::ALFA_POR_DEFECTO = 0.2;
+
+EstadisticasFlujo::EstadisticasFlujo() : alfa(ALFA_POR_DEFECTO) {
+    reiniciar();
+}
+
+void EstadisticasFlujo::agregar(float valor) {
+    // Welford: media y suma de cuadrados de desviaciones en una pasada
+    cantidad++;
+    float delta = valor - media;
+    media += delta / cantidad;
+    m2 += delta * (valor - media);
+
+    // EWMA, inicializada con la primera muestra
+    ewma = (cantidad == 1) ? valor : ewma + alfa * (valor - ewma);
+
+    // Mínimo/máximo del bloque en curso
+    if (muestrasBloque == 0) {
+        minimoBloque = valor;
+        maximoBloque = valor;
+    } else {
+        if (valor < minimoBloque) minimoBloque = valor;
+        if (valor > maximoBloque) maximoBloque = valor;
+    }
+
+    if (++muestrasBloque >= MUESTRAS_POR_BLOQUE) {
+        minimoAnterior = minimoBloque;
+        maximoAnterior = maximoBloque;
+        hayBloqueAnterior = true;
+        muestrasBloque = 0;
+    }
+
+    ultimoValor = valor;
+}
+
+void EstadisticasFlujo::reiniciar() {
+    cantidad = 0;
+    media = 0.0;
+    m2 = 0.0;
+    ewma = 0.0;
+    muestrasBloque = 0;
+    minimoBloque = 0.0;
+    maximoBloque = 0.0;
+    minimoAnterior = 0.0;
+    maximoAnterior = 0.0;
+    hayBloqueAnterior = false;
+    ultimoValor = 0.0;
+}
+
+void EstadisticasFlujo::establecerAlfa(float nuevoAlfa) {
+    if (nuevoAlfa > 0 && nuevoAlfa <= 1) {
+        alfa = nuevoAlfa;
+    }
+}
+
+float EstadisticasFlujo::obtenerAlfa() const {
+    return alfa;
+}
+
+uint32_t EstadisticasFlujo::obtenerCantidad() const {
+    return cantidad;
+}
+
+float EstadisticasFlujo::obtenerMedia() const {
+    return media;
+}
+
+float EstadisticasFlujo::obtenerVarianza() const {
+    // Varianza muestral
+    return cantidad > 1 ? m2 / (cantidad - 1) : 0.0;
+}
+
+float EstadisticasFlujo::obtenerDesviacion() const {
+    return sqrtf(obtenerVarianza());
+}
+
+float EstadisticasFlujo::obtenerEWMA() const {
+    return ewma;
+}
+
+float EstadisticasFlujo::obtenerMinimo() const {
+    if (muestrasBloque == 0) {
+        return minimoAnterior;
+    }
+    if (!hayBloqueAnterior) {
+        return minimoBloque;
+    }
+    return minimoBloque < minimoAnterior ? minimoBloque : minimoAnterior;
+}
+
+float EstadisticasFlujo::obtenerMaximo() const {
+    if (muestrasBloque == 0) {
+        return maximoAnterior;
+    }
+    if (!hayBloqueAnterior) {
+        return maximoBloque;
+    }
+    return maximoBloque > maximoAnterior ? maximoBloque : maximoAnterior;
+}
+
+float EstadisticasFlujo::obtenerUltimoValor() const {
+    return ultimoValor;
+}
@@ -0,0 +1,577 @@
+#include "GasSensorArray.h"
+#include "ConversionCanal.h"
+#include "ResumenLectura.h"
+#include "SistemaLogging.h"
+
+const float GasSensorArray::VOLTAJE_ALIMENTACION = 3.3;
+const float GasSensorArray::RESISTENCIA_CARGA = 10.0;
+const float GasSensorArray::R0_POR_DEFECTO = 10.0;
+const float GasSensorArray::DISPERSION_MAXIMA_CALIBRACION = 0.1;
+const float GasSensorArray::GANANCIA_LINEA_BASE = 0.25;
+const float GasSensorArray::PASO_MAXIMO_LINEA_BASE = 0.02;
+const float GasSensorArray::DESVIO_MAXIMO_LINEA_BASE = 0.5;
+
+GasSensorArray::GasSensorArray() :
+    cantidadCanales(0), inicializado(false), ultimaMedicion(0),
+    estadoCalibracion(CALIBRACION_INACTIVA), canalCalibracion(-1),
+    inicioCalibracion(0), ultimaMuestraCalibracion(0), muestrasCalibracion(0),
+    seguimientoLineaBase(true), inicioVentanaLineaBase(0) {
+
+    for (int i = 0; i < MAX_CANALES; i++) {
+        pines[i] = -1;
+        tipos[i] = SENSOR_MQ2;
+        perfiles[i] = &PerfilesSensor::obtener(SENSOR_MQ2);
+        ratiosAireLimpio[i] = perfiles[i]->ratioAireLimpio;
+        r0[i] = R0_POR_DEFECTO;
+        r0Referencia[i] = R0_POR_DEFECTO;
+        rsMaximoVentana[i] = 0.0;
+        muestrasLineaBase[i] = 0;
+        umbrales[i] = 1000.0;
+        milivoltios[i] = 0.0;
+        rs[i] = 0.0;
+        ratios[i] = 0.0;
+        ppm[i] = 0.0;
+        lecturasValidas[i] = false;
+        lecturasSaturadas[i] = false;
+        alarmas[i] = false;
+    }
+}
+
+GasSensorArray::~GasSensorArray() {
+    adquisicion.detener();
+}
+
+int GasSensorArray::agregarCanal(int pin, TipoSensorMQ tipo) {
+    if (inicializado || cantidadCanales >= MAX_CANALES) {
+        return -1;
+    }
+
+    int canal = cantidadCanales++;
+    pines[canal] = pin;
+    establecerTipoSensor(canal, tipo);
+    return canal;
+}
+
+bool GasSensorArray::inicializar() {
+    if (cantidadCanales == 0) {
+        Serial.println("Error: No hay canales de sensor configurados");
+        return false;
+    }
+
+    for (int i = 0; i < cantidadCanales; i++) {
+        if (adquisicion.agregarCanal(pines[i]) != i) {
+            Serial.println("Error al registrar canal ADC en pin " + String(pines[i]));
+            return false;
+        }
+    }
+
+    if (!adquisicion.iniciar()) {
+        Serial.println("Advertencia: adquisición continua no disponible, se usará lectura directa");
+    }
+
+    inicializado = true;
+    inicioVentanaLineaBase = millis();
+
+    Serial.println("Sensores de gas inicializados: " + String(cantidadCanales) + " canal(es)");
+    for (int i = 0; i < cantidadCanales; i++) {
+        Serial.println("- Canal " + String(i) + ": " + String(perfiles[i]->nombre) + " (" +
+                       String(perfiles[i]->gas) + ") en pin " + String(pines[i]));
+    }
+
+    return true;
+}
+
+bool GasSensorArray::leerConcentraciones() {
+    if (!inicializado) {
+        return false;
+    }
+
+    actualizarMilivoltios();
+    convertirCanales();
+    ultimaMedicion = millis();
+
+    bool todasValidas = true;
+    for (int i = 0; i < cantidadCanales; i++) {
+        if (lecturasValidas[i]) {
+            estadisticas[i].agregar(ppm[i]);
+            tendencias[i].agregar(ultimaMedicion, ppm[i]);
+        }
+        todasValidas = todasValidas && lecturasValidas[i];
+    }
+
+    return todasValidas;
+}
+
+void GasSensorArray::actualizarMilivoltios() {
+    // Recoger el último valor decimado de cada canal
+    bool adquisicionActiva = adquisicion.estaActiva();
+    for (int i = 0; i < cantidadCanales; i++) {
+        if (adquisicionActiva && adquisicion.hayDatos(i)) {
+            milivoltios[i] = adquisicion.obtenerMilivoltios(i);
+        } else {
+            // Lectura directa mientras la adquisición no tenga datos
+            milivoltios[i] = analogReadMilliVolts(pines[i]);
+        }
+    }
+}
+
+void GasSensorArray::convertirCanales() {
+    // Lazo único sobre todos los canales: mV -> Rs -> Rs/R0 -> ppm
+    for (int i = 0; i < cantidadCanales; i++) {
+        ConversionCanal::Resultado resultado = ConversionCanal::convertir(
+            *perfiles[i], milivoltios[i], r0[i], umbrales[i], VOLTAJE_ALIMENTACION, RESISTENCIA_CARGA);
+        rs[i] = resultado.rs;
+        ratios[i] = resultado.ratio;
+        ppm[i] = resultado.ppm;
+        lecturasValidas[i] = resultado.valida;
+        lecturasSaturadas[i] = resultado.saturada;
+        alarmas[i] = resultado.alarma;
+    }
+}
+
+bool GasSensorArray::verificarUmbral() const {
+    for (int i = 0; i < cantidadCanales; i++) {
+        if (alarmas[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GasSensorArray::establecerUmbral(float umbral) {
+    for (int i = 0; i < cantidadCanales; i++) {
+        establecerUmbral(i, umbral);
+    }
+}
+
+void GasSensorArray::establecerUmbral(int canal, float umbral) {
+    if (esCanalValido(canal) && umbral > 0) {
+        umbrales[canal] = umbral;
+        Serial.println("Umbral de alarma canal " + String(canal) + " establecido en: " + String(umbral) + " ppm");
+    }
+}
+
+void GasSensorArray::establecerTipoSensor(int canal, TipoSensorMQ tipo) {
+    if (!esCanalValido(canal)) {
+        return;
+    }
+
+    tipos[canal] = tipo;
+    perfiles[canal] = &PerfilesSensor::obtener(tipo);
+    ratiosAireLimpio[canal] = perfiles[canal]->ratioAireLimpio;
+}
+
+void GasSensorArray::establecerRatioAireLimpio(int canal, float ratio) {
+    if (esCanalValido(canal) && ratio > 0) {
+        ratiosAireLimpio[canal] = ratio;
+    }
+}
+
+void GasSensorArray::establecerR0(int canal, float valor) {
+    if (esCanalValido(canal) && valor > 0) {
+        r0[canal] = valor;
+    }
+}
+
+bool GasSensorArray::calibrarR0(int canal) {
+    if (!esCanalValido(canal) || rs[canal] <= 0) {
+        return false;
+    }
+
+    // En aire limpio Rs/R0 = ratio de aire limpio del perfil
+    r0[canal] = rs[canal] / ratiosAireLimpio[canal];
+    r0Referencia[canal] = r0[canal];
+    reiniciarVentanaLineaBase();
+    Serial.println("Canal " + String(canal) + " calibrado, nuevo R0: " + String(r0[canal]) + " kΩ");
+    return true;
+}
+
+void GasSensorArray::establecerAlfaEWMA(float alfa) {
+    if (alfa > 0 && alfa <= 1) {
+        for (int i = 0; i < MAX_CANALES; i++) {
+            estadisticas[i].establecerAlfa(alfa);
+        }
+        Serial.println("Factor EWMA establecido en: " + String(alfa, 3));
+    }
+}
+
+void GasSensorArray::reiniciarEstadisticas() {
+    for (int i = 0; i < MAX_CANALES; i++) {
+        estadisticas[i].reiniciar();
+    }
+}
+
+// Calibración no bloqueante
+bool GasSensorArray::iniciarCalibracion(int canal) {
+    if (!inicializado || (canal != -1 && !esCanalValido(canal))) {
+        return false;
+    }
+    if (estaCalibrando()) {
+        Serial.println("Calibración ya en curso");
+        return false;
+    }
+
+    canalCalibracion = canal;
+    inicioCalibracion = millis();
+    muestrasCalibracion = 0;
+    for (int i = 0; i < MAX_CANALES; i++) {
+        rsCalibracion[i].reiniciar();
+    }
+    estadoCalibracion = CALIBRACION_ESTABILIZANDO;
+
+    Serial.println("Iniciando calibración " + (canal == -1 ? String("de todos los canales") : "del canal " + String(canal)));
+    Serial.println("Asegúrese de que el sensor esté en aire limpio");
+    return true;
+}
+
+bool GasSensorArray::actualizarCalibracion() {
+    if (!estaCalibrando()) {
+        return false;
+    }
+
+    unsigned long ahora = millis();
+
+    if (estadoCalibracion == CALIBRACION_ESTABILIZANDO) {
+        if (ahora - inicioCalibracion < TIEMPO_ESTABILIZACION_MS) {
+            return false;
+        }
+        estadoCalibracion = CALIBRACION_MUESTREANDO;
+        ultimaMuestraCalibracion = ahora - PERIODO_MUESTRA_CALIBRACION_MS;
+    }
+
+    if (ahora - ultimaMuestraCalibracion < PERIODO_MUESTRA_CALIBRACION_MS) {
+        return false;
+    }
+    ultimaMuestraCalibracion = ahora;
+
+    // Una muestra de Rs por canal; el sensado normal sigue entre muestras
+    actualizarMilivoltios();
+    convertirCanales();
+
+    for (int i = 0; i < cantidadCanales; i++) {
+        if (!esCanalEnCalibracion(i)) {
+            continue;
+        }
+        if (milivoltios[i] <= 0 || rs[i] <= 0) {
+            Serial.println("Calibración fallida: lectura inválida en canal " + String(i));
+            estadoCalibracion = CALIBRACION_FALLIDA;
+            return true;
+        }
+        rsCalibracion[i].agregar(rs[i]);
+    }
+
+    muestrasCalibracion++;
+    Serial.println("Calibrando... " + String(obtenerProgresoCalibracion()) + "%");
+
+    if (muestrasCalibracion >= MUESTRAS_CALIBRACION) {
+        finalizarCalibracion();
+    }
+    return true;
+}
+
+void GasSensorArray::finalizarCalibracion() {
+    // Rechazar si Rs no fue estable (sensor sin precalentar o aire contaminado)
+    for (int i = 0; i < cantidadCanales; i++) {
+        if (!esCanalEnCalibracion(i)) {
+            continue;
+        }
+        float media = rsCalibracion[i].obtenerMedia();
+        if (media <= 0 || rsCalibracion[i].obtenerDesviacion() > media * DISPERSION_MAXIMA_CALIBRACION) {
+            Serial.println("Calibración fallida: Rs inestable en canal " + String(i));
+            estadoCalibracion = CALIBRACION_FALLIDA;
+            return;
+        }
+    }
+
+    for (int i = 0; i < cantidadCanales; i++) {
+        if (esCanalEnCalibracion(i)) {
+            // En aire limpio Rs/R0 = ratio de aire limpio del perfil
+            r0[i] = rsCalibracion[i].obtenerMedia() / ratiosAireLimpio[i];
+            r0Referencia[i] = r0[i];
+            Serial.println("Canal " + String(i) + " calibrado, nuevo R0: " + String(r0[i]) + " kΩ");
+        }
+    }
+
+    reiniciarVentanaLineaBase();
+    estadoCalibracion = CALIBRACION_COMPLETADA;
+    Serial.println("Calibración completada");
+}
+
+void GasSensorArray::cancelarCalibracion() {
+    if (estaCalibrando()) {
+        estadoCalibracion = CALIBRACION_INACTIVA;
+        Serial.println("Calibración cancelada");
+    }
+}
+
+bool GasSensorArray::estaCalibrando() const {
+    return estadoCalibracion == CALIBRACION_ESTABILIZANDO || estadoCalibracion == CALIBRACION_MUESTREANDO;
+}
+
+GasSensorArray::EstadoCalibracion GasSensorArray::obtenerEstadoCalibracion() const {
+    return estadoCalibracion;
+}
+
+const char* GasSensorArray::obtenerNombreEstadoCalibracion() const {
+    switch (estadoCalibracion) {
+        case CALIBRACION_ESTABILIZANDO: return "ESTABILIZANDO";
+        case CALIBRACION_MUESTREANDO: return "MUESTREANDO";
+        case CALIBRACION_COMPLETADA: return "COMPLETADA";
+        case CALIBRACION_FALLIDA: return "FALLIDA";
+        default: return "INACTIVA";
+    }
+}
+
+int GasSensorArray::obtenerProgresoCalibracion() const {
+    const unsigned long duracionTotal = TIEMPO_ESTABILIZACION_MS + MUESTRAS_CALIBRACION * PERIODO_MUESTRA_CALIBRACION_MS;
+
+    switch (estadoCalibracion) {
+        case CALIBRACION_ESTABILIZANDO: {
+            unsigned long transcurrido = millis() - inicioCalibracion;
+            if (transcurrido > TIEMPO_ESTABILIZACION_MS) {
+                transcurrido = TIEMPO_ESTABILIZACION_MS;
+            }
+            return transcurrido * 100 / duracionTotal;
+        }
+        case CALIBRACION_MUESTREANDO:
+            return (TIEMPO_ESTABILIZACION_MS + muestrasCalibracion * PERIODO_MUESTRA_CALIBRACION_MS) * 100 / duracionTotal;
+        case CALIBRACION_COMPLETADA:
+            return 100;
+        default:
+            return 0;
+    }
+}
+
+int GasSensorArray::obtenerCanalCalibracion() const {
+    return canalCalibracion;
+}
+
+// Seguimiento de línea base
+bool GasSensorArray::actualizarLineaBase() {
+    if (!inicializado || !seguimientoLineaBase || estaCalibrando()) {
+        return false;
+    }
+
+    // Acumular el techo de Rs solo con lecturas válidas y sin alarma
+    for (int i = 0; i < cantidadCanales; i++) {
+        if (lecturasValidas[i] && !alarmas[i]) {
+            if (rs[i] > rsMaximoVentana[i]) {
+                rsMaximoVentana[i] = rs[i];
+            }
+            if (muestrasLineaBase[i] < UINT16_MAX) {
+                muestrasLineaBase[i]++;
+            }
+        }
+    }
+
+    if (millis() - inicioVentanaLineaBase < VENTANA_LINEA_BASE_MS) {
+        return false;
+    }
+
+    bool r0Actualizado = false;
+    for (int i = 0; i < cantidadCanales; i++) {
+        if (muestrasLineaBase[i] < MUESTRAS_MINIMAS_LINEA_BASE || rsMaximoVentana[i] <= 0) {
+            continue;
+        }
+
+        // Acercar R0 al estimado de la ventana, con paso y desvío acotados
+        float estimado = rsMaximoVentana[i] / ratiosAireLimpio[i];
+        float paso = GANANCIA_LINEA_BASE * (estimado - r0[i]);
+        float pasoMaximo = r0[i] * PASO_MAXIMO_LINEA_BASE;
+        paso = constrain(paso, -pasoMaximo, pasoMaximo);
+
+        float nuevoR0 = constrain(r0[i] + paso,
+                                  r0Referencia[i] * (1.0f - DESVIO_MAXIMO_LINEA_BASE),
+                                  r0Referencia[i] * (1.0f + DESVIO_MAXIMO_LINEA_BASE));
+        if (nuevoR0 != r0[i]) {
+            r0[i] = nuevoR0;
+            r0Actualizado = true;
+            Serial.println("Canal " + String(i) + " línea base actualizada, R0: " + String(r0[i], 3) + " kΩ");
+        }
+
+        if (estimado < r0Referencia[i] * (1.0f - DESVIO_MAXIMO_LINEA_BASE) ||
+            estimado > r0Referencia[i] * (1.0f + DESVIO_MAXIMO_LINEA_BASE)) {
+            Serial.println("Advertencia: deriva excesiva en canal " + String(i) + ", se recomienda recalibrar");
+        }
+    }
+
+    reiniciarVentanaLineaBase();
+    return r0Actualizado;
+}
+
+void GasSensorArray::reiniciarVentanaLineaBase() {
+    inicioVentanaLineaBase = millis();
+    for (int i = 0; i < MAX_CANALES; i++) {
+        rsMaximoVentana[i] = 0.0;
+        muestrasLineaBase[i] = 0;
+    }
+}
+
+void GasSensorArray::establecerSeguimientoLineaBase(bool activo) {
+    seguimientoLineaBase = activo;
+    reiniciarVentanaLineaBase();
+}
+
+void GasSensorArray::establecerR0Referencia(int canal, float valor) {
+    if (esCanalValido(canal) && valor > 0) {
+        r0Referencia[canal] = valor;
+    }
+}
+
+float GasSensorArray::obtenerR0Referencia(int canal) const {
+    return esCanalValido(canal) ? r0Referencia[canal] : -1.0;
+}
+
+// Getters
+int GasSensorArray::obtenerCantidadCanales() const {
+    return cantidadCanales;
+}
+
+float GasSensorArray::obtenerConcentracion(int canal) const {
+    return esCanalValido(canal) ? ppm[canal] : -1.0;
+}
+
+float GasSensorArray::obtenerMilivoltios(int canal) const {
+    return esCanalValido(canal) ? milivoltios[canal] : -1.0;
+}
+
+float GasSensorArray::obtenerRs(int canal) const {
+    return esCanalValido(canal) ? rs[canal] : -1.0;
+}
+
+float GasSensorArray::obtenerRatio(int canal) const {
+    return esCanalValido(canal) ? ratios[canal] : -1.0;
+}
+
+float GasSensorArray::obtenerR0(int canal) const {
+    return esCanalValido(canal) ? r0[canal] : -1.0;
+}
+
+float GasSensorArray::obtenerUmbral(int canal) const {
+    return esCanalValido(canal) ? umbrales[canal] : -1.0;
+}
+
+bool GasSensorArray::esLecturaValida(int canal) const {
+    return esCanalValido(canal) && lecturasValidas[canal];
+}
+
+bool GasSensorArray::esLecturaSaturada(int canal) const {
+    return esCanalValido(canal) && lecturasSaturadas[canal];
+}
+
+bool GasSensorArray::esAlarmaActiva(int canal) const {
+    return esCanalValido(canal) && alarmas[canal];
+}
+
+int GasSensorArray::obtenerPin(int canal) const {
+    return esCanalValido(canal) ? pines[canal] : -1;
+}
+
+TipoSensorMQ GasSensorArray::obtenerTipo(int canal) const {
+    return esCanalValido(canal) ? tipos[canal] : SENSOR_MQ2;
+}
+
+const PerfilSensor& GasSensorArray::obtenerPerfil(int canal) const {
+    return esCanalValido(canal) ? *perfiles[canal] : PerfilesSensor::obtener(SENSOR_MQ2);
+}
+
+const EstadisticasFlujo& GasSensorArray::obtenerEstadisticas(int canal) const {
+    return esCanalValido(canal) ? estadisticas[canal] : estadisticas[0];
+}
+
+const PrediccionTendencia& GasSensorArray::obtenerTendencia(int canal) const {
+    return esCanalValido(canal) ? tendencias[canal] : tendencias[0];
+}
+
+float GasSensorArray::obtenerTiempoHastaUmbral(int canal) const {
+    if (!esCanalValido(canal)) {
+        return PrediccionTendencia::SIN_CRUCE;
+    }
+    return tendencias[canal].obtenerTiempoHastaUmbral(umbrales[canal]);
+}
+
+int GasSensorArray::obtenerCanalPrediccion(float horizonte) const {
+    // Canal sin alarma cuya tendencia cruza antes su umbral dentro del horizonte
+    int canal = -1;
+    float menorTiempo = horizonte;
+    for (int i = 0; i < cantidadCanales; i++) {
+        if (alarmas[i] || !lecturasValidas[i]) {
+            continue;
+        }
+        float tiempo = obtenerTiempoHastaUmbral(i);
+        if (tiempo >= 0 && tiempo <= menorTiempo) {
+            menorTiempo = tiempo;
+            canal = i;
+        }
+    }
+    return canal;
+}
+
+int GasSensorArray::obtenerCanalCritico() const {
+    // Canal más cercano (o más por encima) de su umbral
+    int critico = 0;
+    float mayorFraccion = -1.0;
+    for (int i = 0; i < cantidadCanales; i++) {
+        float fraccion = ppm[i] / umbrales[i];
+        if (lecturasValidas[i] && fraccion > mayorFraccion) {
+            mayorFraccion = fraccion;
+            critico = i;
+        }
+    }
+    return critico;
+}
+
+unsigned long GasSensorArray::obtenerTiempoUltimaMedicion() const {
+    return ultimaMedicion;
+}
+
+// Utilidades
+float GasSensorArray::convertirUnidades(int canal, float lectura, UnidadConcentracion unidadDestino) const {
+    return PerfilesSensor::convertir(obtenerPerfil(canal), lectura, unidadDestino);
+}
+
+void GasSensorArray::imprimirLecturas() const {
+    // Se llama en cada medición: solo en DEBUG, por el logger y sin String
+    if (!SistemaLoggingSingleton::getInstance().estaActivo(SistemaLogging::DEBUG, "SENSOR")) {
+        return;
+    }
+    
+    char linea[ResumenLectura::LONGITUD_LINEA];
+    LOG_DEBUGF("SENSOR", "=== LECTURA DE SENSORES ===");
+    for (int i = 0; i < cantidadCanales; i++) {
+        ResumenLectura::DatosCanal datos;
+        datos.canal = i;
+        datos.nombre = perfiles[i]->nombre;
+        datos.pin = pines[i];
+        datos.ppm = ppm[i];
+        datos.umbral = umbrales[i];
+        datos.ratio = ratios[i];
+        datos.valida = lecturasValidas[i];
+        datos.saturada = lecturasSaturadas[i];
+        datos.alarma = alarmas[i];
+        datos.media = estadisticas[i].obtenerMedia();
+        datos.desviacion = estadisticas[i].obtenerDesviacion();
+        datos.ewma = estadisticas[i].obtenerEWMA();
+        datos.minimo = estadisticas[i].obtenerMinimo();
+        datos.maximo = estadisticas[i].obtenerMaximo();
+        datos.cantidad = estadisticas[i].obtenerCantidad();
+        datos.pendiente = tendencias[i].obtenerPendiente();
+        datos.tiempoHastaUmbral = obtenerTiempoHastaUmbral(i);
+        
+        ResumenLectura::formatearCanal(linea, sizeof(linea), datos);
+        LOG_DEBUG("SENSOR", linea);
+        ResumenLectura::formatearEstadisticas(linea, sizeof(linea), datos);
+        LOG_DEBUG("SENSOR", linea);
+        ResumenLectura::formatearTendencia(linea, sizeof(linea), datos);
+        LOG_DEBUG("SENSOR", linea);
+    }
+    LOG_DEBUGF("SENSOR", "Tiempo última medición: %lu ms", ultimaMedicion);
+}
+
+bool GasSensorArray::esCanalValido(int canal) const {
+    return canal >= 0 && canal < cantidadCanales;
+}
+
+bool GasSensorArray::esCanalEnCalibracion(int canal) const {
+    return canalCalibracion == -1 || canalCalibracion == canal;
+}
@@ -33,6 +33,9 @@ bool GestorActualizaciones::inicializar(CertificadosManager* cert, SistemaOTA* o
     
     // Configurar topics
     configurarTopics(mqttManager->obtenerIdDispositivo());
+    if (!registrarManejadores()) {
+        logger->error("ACTUALIZACIONES", "Error al registrar manejadores MQTT");
+    }
     
     // Configurar callbacks del sistema OTA
     sistemaOTA->establecerCallbackProgreso([](int progreso) {
@@ -113,10 +116,44 @@ bool GestorActualizaciones::procesarComandoActualizacion(const JsonObject& coman
     }
 }
 
+bool GestorActualizaciones::registrarManejadores() {
+    // Comandos generales, certificados y firmware propios, y despliegues a la flota
+    bool exito = mqttManager->registrarManejador("/" + idDispositivo + "/actualizaciones", manejarComando, this);
+    exito = mqttManager->registrarManejador(topicCertificados, manejarMensaje, this) && exito;
+    exito = mqttManager->registrarManejador(topicFirmware, manejarMensaje, this) && exito;
+    exito = mqttManager->registrarManejador("/flota/actualizaciones/+", manejarMensaje, this) && exito;
+    return exito;
+}
+
+void GestorActualizaciones::manejarComando(void* contexto, const char* topic, const uint8_t* payload, size_t longitud) {
+    GestorActualizaciones* gestor = static_cast<GestorActualizaciones*>(contexto);
+    DynamicJsonDocument doc(2048);
+    DeserializationError error = deserializeJson(doc, payload, longitud);
+    
+    if (error) {
+        gestor->logger->error("ACTUALIZACIONES", "Error al parsear comando de actualización");
+        return;
+    }
+    
+    gestor->procesarComandoActualizacion(doc.as<JsonObject>());
+}
+
+void GestorActualizaciones::manejarMensaje(void* contexto, const char* topic, const uint8_t* payload, size_t longitud) {
+    static_cast<GestorActualizaciones*>(contexto)->procesarMensajeMQTT(topic, payload, longitud);
+}
+
 void GestorActualizaciones::procesarMensajeMQTT(const String& topic, const String& payload) {
-    if (topic.endsWith("/certificados")) {
+    procesarMensajeMQTT(topic.c_str(), (const uint8_t*)payload.c_str(), payload.length());
+}
+
+void GestorActualizaciones::procesarMensajeMQTT(const char* topic, const uint8_t* payload, size_t longitud) {
+    // Último nivel del topic: certificados o firmware
+    const char* ultimoNivel = strrchr(topic, '/');
+    ultimoNivel = ultimoNivel ? ultimoNivel + 1 : topic;
+    
+    if (strcmp(ultimoNivel, "certificados") == 0) {
         DynamicJsonDocument doc(2048);
-        DeserializationError error = deserializeJson(doc, payload);
+        DeserializationError error = deserializeJson(doc, payload, longitud);
         
         if (error) {
             logger->error("ACTUALIZACIONES", "Error al parsear comando de certificados");
@@ -124,9 +161,9 @@ void GestorActualizaciones::procesarMensajeMQTT(const String& topic, const Strin
         }
         
         procesarComandoCertificados(doc.as<JsonObject>());
-    } else if (topic.endsWith("/firmware")) {
+    } else if (strcmp(ultimoNivel, "firmware") == 0) {
         DynamicJsonDocument doc(2048);
-        DeserializationError error = deserializeJson(doc, payload);
+        DeserializationError error = deserializeJson(doc, payload, longitud);
         
         if (error) {
             logger->error("ACTUALIZACIONES", "Error al parsear comando de firmware");
@@ -221,10 +258,7 @@ void GestorActualizaciones::notificarEstadoCertificados() {
     doc["hash"] = certificadosManager->obtenerHash();
     doc["endpoint"] = certificadosManager->obtenerEndpoint();
     
-    String payload;
-    serializeJson(doc, payload);
-    
-    if (mqttManager->publicarMetadata(doc.as<JsonObject>())) {
+    if (mqttManager->publicarEvento(topicEstado, doc.as<JsonObject>(), PlanificadorSalida::PRIORIDAD_METADATA)) {
         logger->info("ACTUALIZACIONES", "Estado de certificados enviado");
     } else {
         logger->error("ACTUALIZACIONES", "Error al enviar estado de certificados");
@@ -351,10 +385,7 @@ void GestorActualizaciones::notificarEstadoFirmware() {
     doc["espacio_disponible"] = sistemaOTA->obtenerEspacioDisponible();
     doc["inicializado"] = sistemaOTA->esInicializado();
     
-    String payload;
-    serializeJson(doc, payload);
-    
-    if (mqttManager->publicarMetadata(doc.as<JsonObject>())) {
+    if (mqttManager->publicarEvento(topicEstado, doc.as<JsonObject>(), PlanificadorSalida::PRIORIDAD_METADATA)) {
         logger->info("ACTUALIZACIONES", "Estado de firmware enviado");
     } else {
         logger->error("ACTUALIZACIONES", "Error al enviar estado de firmware");
@@ -484,10 +515,7 @@ void GestorActualizaciones::enviarNotificacionEstado(const String& estado, const
     doc["timestamp"] = millis();
     doc["dispositivo"] = idDispositivo;
     
-    String payload;
-    serializeJson(doc, payload);
-    
-    if (mqttManager->publicarMetadata(doc.as<JsonObject>())) {
+    if (mqttManager->publicarEvento(topicEstado, doc.as<JsonObject>(), PlanificadorSalida::PRIORIDAD_CONFIRMACION)) {
         logger->info("ACTUALIZACIONES", "Notificación de estado enviada: " + estado);
     }
 }
@@ -499,10 +527,7 @@ void GestorActualizaciones::enviarNotificacionProgreso(int progreso, const Strin
     doc["timestamp"] = millis();
     doc["dispositivo"] = idDispositivo;
     
-    String payload;
-    serializeJson(doc, payload);
-    
-    if (mqttManager->publicarMetadata(doc.as<JsonObject>())) {
+    if (mqttManager->publicarEvento(topicProgreso, doc.as<JsonObject>(), PlanificadorSalida::PRIORIDAD_PROGRESO)) {
         logger->debug("ACTUALIZACIONES", "Progreso: " + String(progreso) + "% - " + descripcion);
     }
 }
@@ -515,10 +540,7 @@ void GestorActualizaciones::enviarNotificacionConfirmacion(const String& comando
     doc["timestamp"] = millis();
     doc["dispositivo"] = idDispositivo;
     
-    String payload;
-    serializeJson(doc, payload);
-    
-    if (mqttManager->publicarMetadata(doc.as<JsonObject>())) {
+    if (mqttManager->publicarEvento(topicConfirmacion, doc.as<JsonObject>(), PlanificadorSalida::PRIORIDAD_CONFIRMACION)) {
         logger->info("ACTUALIZACIONES", "Confirmación enviada: " + comando + " - " + String(exito ? "Éxito" : "Error"));
     }
 }
@@ -530,10 +552,7 @@ void GestorActualizaciones::enviarNotificacionError(const String& error, const S
     doc["timestamp"] = millis();
     doc["dispositivo"] = idDispositivo;
     
-    String payload;
-    serializeJson(doc, payload);
-    
-    if (mqttManager->publicarMetadata(doc.as<JsonObject>())) {
+    if (mqttManager->publicarEvento(topicEstado, doc.as<JsonObject>(), PlanificadorSalida::PRIORIDAD_CONFIRMACION)) {
         logger->error("ACTUALIZACIONES", "Error enviado: " + error + " (" + contexto + ")");
     }
 }
@@ -1,22 +1,30 @@
 #include "MQTTManager.h"
+#include "TransporteCliente.h"
+#include "TransporteAsync.h"
+#include "SistemaLogging.h"
+#include "TopicCorto.h"
+
+MQTTManager* MQTTManager::instancia = nullptr;
 
 MQTTManager::MQTTManager() : 
-    clienteMQTT(nullptr), clienteSeguro(nullptr), clienteNormal(nullptr),
+    transporte(nullptr), clienteSeguro(nullptr), clienteNormal(nullptr),
     idDispositivo(""), broker(""), puerto(8883), usarSSL(true), 
-    usarWebSocket(false), conectado(false), callbackMensaje(nullptr), 
-    callbackConfiguracion(nullptr), callbackActualizaciones(nullptr) {
+    usarWebSocket(false), conectado(false), estadoConexion(CONEXION_INACTIVA), intentosConexion(0),
+    inicioEspera(0), esperaReconexionMs(0), desconexiones(0), ventanaQoS(4), formato(FORMATO_JSON), tamanoLote(1),
+    tiempoMaximoLoteMs(60000), longitudLote(0), formatoLote(FORMATO_JSON),
+    lecturasEnLote(0), inicioLote(0), topicsCortos(false), bytesAhorradosTopics(0), callbackEntrega(nullptr) {
     
     // Inicializar clientes
-    clienteSeguro = new WiFiClientSecure();
+    clienteSeguro = new ClienteTLS();
     clienteNormal = new WiFiClient();
     
     // Configurar cliente seguro
-    clienteSeguro->setInsecure(); // Para desarrollo, en producción usar certificados
+    clienteSeguro->establecerInseguro(true); // Para desarrollo, en producción usar certificados
 }
 
 MQTTManager::~MQTTManager() {
-    if (clienteMQTT) {
-        delete clienteMQTT;
+    if (transporte) {
+        delete transporte;
     }
     if (clienteSeguro) {
         delete clienteSeguro;
@@ -27,112 +35,193 @@ MQTTManager::~MQTTManager() {
 }
 
 bool MQTTManager::inicializar() {
-    // Configurar cliente MQTT
-    if (usarSSL) {
-        clienteMQTT = new PubSubClient(*clienteSeguro);
-    } else {
-        clienteMQTT = new PubSubClient(*clienteNormal);
+    // Transporte: ClienteMQTT con QoS 1 sobre ClienteTLS o WiFiClient; sin
+    // TLS puede usarse AsyncMqttClient (AsyncTCP no implementa TLS)
+#if TRANSPORTE_ASYNC_MQTT
+    if (!usarSSL) {
+        transporte = new TransporteAsync();
+    }
+#endif
+    if (!transporte) {
+        if (usarSSL) {
+            transporte = new TransporteCliente(*clienteSeguro, TAMANO_MAXIMO_LOTE + 256);
+        } else {
+            transporte = new TransporteCliente(*clienteNormal, TAMANO_MAXIMO_LOTE + 256);
+        }
     }
     
-    if (!clienteMQTT) {
+    if (!transporte) {
         Serial.println("Error al inicializar cliente MQTT");
         return false;
     }
     
     // Configurar callback
-    clienteMQTT->setCallback(callbackMensajeRecibido);
+    instancia = this;
+    transporte->establecerCallback(callbackMensajeRecibido);
+    transporte->establecerCallbackEntrega(callbackEntrega);
+    transporte->configurarVentana(ventanaQoS);
     
     // Configurar topics
-    topicLecturas = "/" + idDispositivo + "/lecturas";
-    topicAlarmas = "/" + idDispositivo + "/alarmas";
-    topicMetadata = "/" + idDispositivo + "/metadata";
-    topicConfiguracion = "/" + idDispositivo + "/configuracion";
+    construirTopics();
     
     Serial.println("MQTTManager inicializado");
     Serial.println("ID Dispositivo: " + idDispositivo);
     Serial.println("Broker: " + broker);
     Serial.println("Puerto: " + String(puerto));
     Serial.println("SSL: " + String(usarSSL ? "Sí" : "No"));
+    if (usarSSL && clienteSeguro) {
+        clienteSeguro->imprimirEstadisticas();
+    }
     Serial.println("WebSocket: " + String(usarWebSocket ? "Sí" : "No"));
+    Serial.println("Transporte: " + String(transporte->obtenerNombre()) + " (QoS máximo " +
+                   String(transporte->obtenerQoSMaximo()) + ")");
     
     return true;
 }
 
 bool MQTTManager::conectar() {
-    if (!clienteMQTT) {
+    if (!transporte) {
         Serial.println("Error: Cliente MQTT no inicializado");
         return false;
     }
     
     // Configurar servidor
-    clienteMQTT->setServer(broker.c_str(), puerto);
+    transporte->configurarServidor(broker.c_str(), puerto);
     
-    // Intentar conectar
-    int intentos = 0;
-    while (!clienteMQTT->connected() && intentos < 5) {
-        Serial.println("Intentando conectar a MQTT... Intento " + String(intentos + 1));
-        
-        if (clienteMQTT->connect(idDispositivo.c_str())) {
-            conectado = true;
-            Serial.println("Conectado a MQTT exitosamente");
-            
-            // Suscribirse a topics
-            if (clienteMQTT->subscribe(topicConfiguracion.c_str())) {
-                Serial.println("Suscrito a topic de configuración: " + topicConfiguracion);
-            } else {
-                Serial.println("Error al suscribirse a topic de configuración");
-            }
-            
-            // Suscribirse a topic de actualizaciones
-            String topicActualizaciones = "/" + idDispositivo + "/actualizaciones";
-            if (clienteMQTT->subscribe(topicActualizaciones.c_str())) {
-                Serial.println("Suscrito a topic de actualizaciones: " + topicActualizaciones);
-            } else {
-                Serial.println("Error al suscribirse a topic de actualizaciones");
-            }
-            
-            return true;
-        } else {
-            Serial.println("Error de conexión MQTT: " + String(clienteMQTT->state()));
-            delay(2000);
-            intentos++;
-        }
+    // Un único intento: los siguientes los agenda la máquina de conexión
+    intentosConexion = 0;
+    return intentarConexion();
+}
+
+bool MQTTManager::intentarConexion() {
+    Serial.println("Intentando conectar a MQTT... Intento " + String(intentosConexion + 1));
+    
+    if (transporte->conectar(idDispositivo.c_str())) {
+        registrarConexion();
+        return true;
     }
     
-    Serial.println("No se pudo conectar a MQTT después de 5 intentos");
+    // Transporte asíncrono: el resultado llega después, en procesarMensajes()
+    if (transporte->estaConectando()) {
+        estadoConexion = CONEXION_CONECTANDO;
+        return false;
+    }
+    
+    Serial.println("Error de conexión MQTT: " + String(transporte->obtenerEstado()));
     conectado = false;
+    intentosConexion++;
+    programarReintento();
+    return false;
+}
+
+void MQTTManager::registrarConexion() {
+    conectado = true;
+    estadoConexion = CONEXION_ACTIVA;
+    intentosConexion = 0;
+    LOG_TRANSICIONF("MQTT", "Conectado a MQTT exitosamente");
+    
+    // Suscribirse a los filtros registrados (una vez por filtro)
+    for (int i = 0; i < enrutador.obtenerCantidadRutas(); i++) {
+        if (!enrutador.esFiltroRepetido(i)) {
+            suscribirFiltro(enrutador.obtenerFiltro(i));
+        }
+    }
+}
+
+bool MQTTManager::suscribirFiltro(const char* filtro) {
+    if (transporte->suscribir(filtro, 1)) {
+        Serial.println("Suscrito a: " + String(filtro));
+        return true;
+    }
+    Serial.println("Error al suscribirse a: " + String(filtro));
     return false;
 }
 
+void MQTTManager::programarReintento() {
+    // Espera exponencial con tope y jitter completo (al azar entre 0 y el tope):
+    // si el broker se reinicia, los equipos no reintentan todos a la vez
+    unsigned long tope = ESPERA_RECONEXION_MAXIMA_MS;
+    if (intentosConexion < 16 && (ESPERA_RECONEXION_BASE_MS << intentosConexion) < tope) {
+        tope = ESPERA_RECONEXION_BASE_MS << intentosConexion;
+    }
+    
+    esperaReconexionMs = random(tope + 1);
+    inicioEspera = millis();
+    estadoConexion = CONEXION_ESPERANDO;
+    
+    Serial.println("Próximo intento MQTT en " + String(esperaReconexionMs) + " ms");
+}
+
+void MQTTManager::registrarDesconexion() {
+    conectado = false;
+    desconexiones++;
+    LOG_TRANSICIONF("MQTT", "MQTT desconectado (%lu desconexiones)", (unsigned long)desconexiones);
+    
+    if (estadoConexion == CONEXION_ACTIVA) {
+        intentosConexion = 0;
+        programarReintento();
+    }
+}
+
 void MQTTManager::desconectar() {
-    if (clienteMQTT && clienteMQTT->connected()) {
-        clienteMQTT->disconnect();
+    // Sin reconexión automática hasta el próximo conectar() o reconectar()
+    estadoConexion = CONEXION_INACTIVA;
+    
+    if (transporte && transporte->estaConectando()) {
+        // Intento en curso: el transporte lo cierra al terminar
+        transporte->desconectar();
+    }
+    if (transporte && transporte->estaConectado()) {
+        transporte->desconectar();
         conectado = false;
         Serial.println("Desconectado de MQTT");
     }
 }
 
 bool MQTTManager::verificarConexion() {
-    if (!clienteMQTT) {
+    if (!transporte) {
         return false;
     }
     
-    bool estado = clienteMQTT->connected();
-    if (estado != conectado) {
-        conectado = estado;
-        if (conectado) {
-            Serial.println("MQTT reconectado");
-        } else {
-            Serial.println("MQTT desconectado");
-        }
+    if (conectado && !transporte->estaConectado()) {
+        registrarDesconexion();
     }
     
     return conectado;
 }
 
 void MQTTManager::procesarMensajes() {
-    if (clienteMQTT && clienteMQTT->connected()) {
-        clienteMQTT->loop();
+    if (!transporte) {
+        return;
+    }
+    
+    transporte->procesar();
+    
+    if (transporte->estaConectado()) {
+        // Conexión asíncrona completada
+        if (estadoConexion == CONEXION_CONECTANDO) {
+            registrarConexion();
+        }
+        
+        // Lo que esperaba lugar en el transporte, por prioridad
+        despacharSalida();
+        return;
+    }
+    
+    if (conectado) {
+        registrarDesconexion();
+    }
+    
+    // Intento asíncrono fallido (rechazo o timeout del transporte)
+    if (estadoConexion == CONEXION_CONECTANDO && !transporte->estaConectando()) {
+        Serial.println("Error de conexión MQTT: " + String(transporte->obtenerEstado()));
+        intentosConexion++;
+        programarReintento();
+    }
+    
+    // Reintentar solo al vencer la espera: el loop sigue atendiendo sensores y alarmas
+    if (estadoConexion == CONEXION_ESPERANDO && millis() - inicioEspera >= esperaReconexionMs) {
+        intentarConexion();
     }
 }
 
@@ -141,13 +230,13 @@ void MQTTManager::configurarAWS(const String& endpoint, const String& certificad
     endpointAWS = endpoint;
     certificadoAWS = certificado;
     clavePrivadaAWS = clavePrivada;
-    certificadoCA = certificadoCA;
+    this->certificadoCA = certificadoCA;
     
-    // Configurar certificados
+    // Configurar certificados: el cliente guarda punteros, se usan las copias propias
     if (clienteSeguro) {
-        clienteSeguro->setCACert(certificadoCA.c_str());
-        clienteSeguro->setCertificate(certificado.c_str());
-        clienteSeguro->setPrivateKey(clavePrivada.c_str());
+        clienteSeguro->establecerCA(this->certificadoCA.c_str());
+        clienteSeguro->establecerCertificado(certificadoAWS.c_str());
+        clienteSeguro->establecerClavePrivada(clavePrivadaAWS.c_str());
     }
     
     // Configurar broker
@@ -192,20 +281,60 @@ void MQTTManager::establecerModoWebSocket(bool usar) {
     // Implementar lógica de WebSocket si es necesario
 }
 
-bool MQTTManager::publicarLectura(const JsonObject& datos) {
-    if (!clienteMQTT || !clienteMQTT->connected()) {
-        return false;
+MQTTManager::ResultadoPublicacion MQTTManager::publicarLectura(const JsonObject& datos) {
+    if (!transporte || !transporte->estaConectado()) {
+        return PUBLICACION_RECHAZADA;
     }
     
-    String payload;
-    serializeJson(datos, payload);
+    size_t longitud = serializar(datos, bufferPayload, sizeof(bufferPayload));
+    if (longitud == 0) {
+        Serial.println("Error: Lectura excede el buffer de " + String(TAMANO_MAXIMO_PAYLOAD) + " bytes");
+        return PUBLICACION_RECHAZADA;
+    }
+    
+    // Modo lote: acumular en el arreglo y publicar al completarlo
+    if (tamanoLote > 1) {
+        // Un lote lleva un solo formato: si cambió, se publica el anterior
+        if (lecturasEnLote > 0 && formatoLote != formato && !vaciarLote()) {
+            return PUBLICACION_RECHAZADA;
+        }
+        
+        // JSON necesita separador y "]" de cierre; MessagePack no
+        size_t extra = (formato == FORMATO_JSON) ? 2 : 0;
+        if (lecturasEnLote > 0 && longitudLote + longitud + extra > TAMANO_MAXIMO_LOTE && !vaciarLote()) {
+            return PUBLICACION_RECHAZADA;
+        }
+        
+        if (lecturasEnLote == 0) {
+            formatoLote = formato;
+            if (formatoLote == FORMATO_JSON) {
+                bufferLote[0] = '[';
+                longitudLote = 1;
+            } else {
+                // Espacio para la cabecera, que se escribe al conocer la cantidad
+                longitudLote = CodificadorBinario::TAMANO_CABECERA_ARREGLO;
+            }
+            inicioLote = millis();
+        } else if (formatoLote == FORMATO_JSON) {
+            bufferLote[longitudLote++] = ',';
+        }
+        memcpy(bufferLote + longitudLote, bufferPayload, longitud);
+        longitudLote += longitud;
+        lecturasEnLote++;
+        
+        if (lecturasEnLote >= tamanoLote) {
+            vaciarLote();
+        }
+        return PUBLICACION_ENCOLADA;
+    }
     
-    bool resultado = clienteMQTT->publish(topicLecturas.c_str(), payload.c_str(), false);
+    ResultadoPublicacion resultado = publicarDatos(topicLecturas, bufferPayload, longitud, QOS_LECTURAS, false,
+                                                   PlanificadorSalida::PRIORIDAD_LECTURA);
     
-    if (resultado) {
-        Serial.println("Lectura publicada exitosamente");
-        Serial.println("Topic: " + topicLecturas);
-        Serial.println("Payload: " + payload);
+    if (resultado == PUBLICACION_ENVIADA) {
+        imprimirPublicacion("Lectura publicada", topicLecturas, longitud);
+    } else if (resultado == PUBLICACION_ENCOLADA) {
+        imprimirPublicacion("Lectura en la cola de salida", topicLecturas, longitud);
     } else {
         Serial.println("Error al publicar lectura");
     }
@@ -213,20 +342,23 @@ bool MQTTManager::publicarLectura(const JsonObject& datos) {
     return resultado;
 }
 
-bool MQTTManager::publicarAlarma(const JsonObject& datos) {
-    if (!clienteMQTT || !clienteMQTT->connected()) {
-        return false;
+MQTTManager::ResultadoPublicacion MQTTManager::publicarAlarma(const JsonObject& datos) {
+    if (!transporte || !transporte->estaConectado()) {
+        return PUBLICACION_RECHAZADA;
     }
     
-    String payload;
-    serializeJson(datos, payload);
+    // El lote en curso se encola antes; si el transporte no tiene lugar, la alarma sale primero
+    vaciarLote();
     
-    bool resultado = clienteMQTT->publish(topicAlarmas.c_str(), payload.c_str(), true); // QoS 2
+    size_t longitud = serializar(datos, bufferPayload, sizeof(bufferPayload));
+    ResultadoPublicacion resultado = longitud > 0 ? publicarDatos(topicAlarmas, bufferPayload, longitud, QOS_ALARMAS, true,
+                                                                  PlanificadorSalida::PRIORIDAD_ALARMA) // Retenida
+                                                  : PUBLICACION_RECHAZADA;
     
-    if (resultado) {
-        Serial.println("Alarma publicada exitosamente");
-        Serial.println("Topic: " + topicAlarmas);
-        Serial.println("Payload: " + payload);
+    if (resultado == PUBLICACION_ENVIADA) {
+        imprimirPublicacion("Alarma publicada", topicAlarmas, longitud);
+    } else if (resultado == PUBLICACION_ENCOLADA) {
+        imprimirPublicacion("Alarma en la cola de salida", topicAlarmas, longitud);
     } else {
         Serial.println("Error al publicar alarma");
     }
@@ -235,19 +367,16 @@ bool MQTTManager::publicarAlarma(const JsonObject& datos) {
 }
 
 bool MQTTManager::publicarMetadata(const JsonObject& datos) {
-    if (!clienteMQTT || !clienteMQTT->connected()) {
+    if (!transporte || !transporte->estaConectado()) {
         return false;
     }
     
-    String payload;
-    serializeJson(datos, payload);
-    
-    bool resultado = clienteMQTT->publish(topicMetadata.c_str(), payload.c_str(), true); // QoS 2
+    size_t longitud = serializar(datos, bufferPayload, sizeof(bufferPayload));
+    bool resultado = longitud > 0 && publicarDatos(topicMetadata, bufferPayload, longitud, QOS_METADATA, true,
+                                                    PlanificadorSalida::PRIORIDAD_METADATA) != PUBLICACION_RECHAZADA; // Retenida
     
     if (resultado) {
-        Serial.println("Metadata publicada exitosamente");
-        Serial.println("Topic: " + topicMetadata);
-        Serial.println("Payload: " + payload);
+        imprimirPublicacion("Metadata publicada", topicMetadata, longitud);
     } else {
         Serial.println("Error al publicar metadata");
     }
@@ -255,28 +384,335 @@ bool MQTTManager::publicarMetadata(const JsonObject& datos) {
     return resultado;
 }
 
+bool MQTTManager::publicarCalibracion(const JsonObject& datos) {
+    if (!transporte || !transporte->estaConectado()) {
+        return false;
+    }
+    
+    size_t longitud = serializar(datos, bufferPayload, sizeof(bufferPayload));
+    bool resultado = longitud > 0 && publicarDatos(topicCalibracion, bufferPayload, longitud, QOS_CALIBRACION, false,
+                                                    PlanificadorSalida::PRIORIDAD_PROGRESO) != PUBLICACION_RECHAZADA;
+    
+    if (resultado) {
+        imprimirPublicacion("Estado de calibración publicado", topicCalibracion, longitud);
+    } else {
+        Serial.println("Error al publicar estado de calibración");
+    }
+    
+    return resultado;
+}
+
+bool MQTTManager::publicarEvento(const String& topic, const JsonObject& datos, PlanificadorSalida::Prioridad prioridad) {
+    if (!transporte || !transporte->estaConectado()) {
+        return false;
+    }
+    
+    size_t longitud = serializar(datos, bufferPayload, sizeof(bufferPayload));
+    bool resultado = longitud > 0 &&
+                     publicarDatos(topic, bufferPayload, longitud, QOS_EVENTOS, false, prioridad) != PUBLICACION_RECHAZADA;
+    
+    if (resultado) {
+        imprimirPublicacion("Evento publicado", topic, longitud);
+    } else {
+        Serial.println("Error al publicar evento en " + topic);
+    }
+    
+    return resultado;
+}
+
+MQTTManager::ResultadoPublicacion MQTTManager::publicarLecturaSerializada(const uint8_t* payload, size_t longitud,
+                                                                          uint32_t identificador) {
+    if (!transporte || !transporte->estaConectado() || !payload) {
+        return PUBLICACION_RECHAZADA;
+    }
+    
+    ResultadoPublicacion resultado = publicarDatos(topicLecturas, payload, longitud, QOS_LECTURAS, false,
+                                                   PlanificadorSalida::PRIORIDAD_LECTURA, identificador);
+    
+    if (resultado == PUBLICACION_RECHAZADA) {
+        Serial.println("Error al publicar lectura pendiente");
+    }
+    
+    return resultado;
+}
+
+MQTTManager::ResultadoPublicacion MQTTManager::publicarAlarmaSerializada(const uint8_t* payload, size_t longitud,
+                                                                         uint32_t identificador) {
+    if (!transporte || !transporte->estaConectado() || !payload) {
+        return PUBLICACION_RECHAZADA;
+    }
+    
+    vaciarLote();
+    
+    ResultadoPublicacion resultado = publicarDatos(topicAlarmas, payload, longitud, QOS_ALARMAS, true,
+                                                   PlanificadorSalida::PRIORIDAD_ALARMA, identificador);
+    
+    if (resultado == PUBLICACION_RECHAZADA) {
+        Serial.println("Error al publicar alarma pendiente");
+    }
+    
+    return resultado;
+}
+
+MQTTManager::ResultadoPublicacion MQTTManager::publicarRegistroVuelo(const uint8_t* fragmento, size_t longitud,
+                                                                     uint32_t identificador) {
+    if (!transporte || !transporte->estaConectado() || !fragmento) {
+        return PUBLICACION_RECHAZADA;
+    }
+    
+    // Última prioridad: se sube de a un fragmento sin demorar lecturas ni alarmas
+    ResultadoPublicacion resultado = publicarDatos(topicVuelo, fragmento, longitud, QOS_REGISTRO_VUELO, false,
+                                                   PlanificadorSalida::PRIORIDAD_PROGRESO, identificador);
+    
+    if (resultado == PUBLICACION_RECHAZADA) {
+        Serial.println("Error al publicar fragmento del registro de vuelo");
+    }
+    
+    return resultado;
+}
+
+void MQTTManager::establecerFormato(FormatoPayload nuevoFormato) {
+    if (nuevoFormato != formato) {
+        formato = nuevoFormato;
+        Serial.println("Formato de payload: " + String(formato == FORMATO_JSON ? "JSON" : "MessagePack"));
+    }
+}
+
+MQTTManager::FormatoPayload MQTTManager::obtenerFormato() const {
+    return formato;
+}
+
+size_t MQTTManager::serializar(const JsonObject& datos, uint8_t* destino, size_t capacidad) const {
+    return PayloadMQTT::serializar(datos, formato == FORMATO_MSGPACK, destino, capacidad);
+}
+
+MQTTManager::ResultadoPublicacion MQTTManager::publicarDatos(const String& topic, const uint8_t* datos, size_t longitud,
+                                                             uint8_t qos, bool retener,
+                                                             PlanificadorSalida::Prioridad prioridad,
+                                                             uint32_t identificador) {
+    // Pasa por la cola de salida: si su clase está llena se rechaza y el
+    // llamador decide (lecturas y alarmas van a la cola persistente)
+    uint8_t qosMaximo = transporte->obtenerQoSMaximo();
+    uint32_t numero = planificador.encolar(prioridad, topic.c_str(), datos, longitud, qos < qosMaximo ? qos : qosMaximo,
+                                           retener, identificador);
+    if (numero == 0) {
+        return PUBLICACION_RECHAZADA;
+    }
+    bytesAhorradosTopics += obtenerAhorroTopic(topic);
+    despacharSalida();
+    
+    // Recién encolado no se descarta por intentos en este despacho: si ya no
+    // está en espera es porque el transporte lo aceptó
+    return planificador.estaEnEspera(numero) ? PUBLICACION_ENCOLADA : PUBLICACION_ENVIADA;
+}
+
+void MQTTManager::despacharSalida() {
+    uint32_t descartadosAntes = planificador.obtenerDescartadosPorIntentos();
+    planificador.despachar(transporte);
+    
+    uint32_t descartados = planificador.obtenerDescartadosPorIntentos() - descartadosAntes;
+    if (descartados > 0) {
+        Serial.println("Descartado(s) " + String(descartados) + " mensaje(s) tras " +
+                       String(PlanificadorSalida::MAXIMO_INTENTOS) + " intentos");
+    }
+}
+
+void MQTTManager::establecerCallbackEntrega(TransporteMQTT::CallbackEntrega callback) {
+    callbackEntrega = callback;
+    planificador.establecerCallbackEntrega(callback);
+    if (transporte) {
+        transporte->establecerCallbackEntrega(callback);
+    }
+}
+
+void MQTTManager::imprimirPublicacion(const char* descripcion, const String& topic, size_t longitud) const {
+    // Por partes para no armar Strings temporales en cada publicación
+    Serial.print(descripcion);
+    Serial.print(" en ");
+    Serial.print(topic);
+    Serial.print(" (");
+    Serial.print(longitud);
+    Serial.println(formato == FORMATO_JSON ? " bytes JSON)" : " bytes MessagePack)");
+}
+
+void MQTTManager::configurarVentanaQoS(int tamano) {
+    if (tamano < 1 || tamano > 255) {
+        return;
+    }
+    
+    ventanaQoS = tamano;
+    if (transporte) {
+        transporte->configurarVentana(ventanaQoS);
+    }
+}
+
+uint8_t MQTTManager::obtenerEnVuelo() const {
+    return transporte ? transporte->obtenerEnVuelo() : 0;
+}
+
+int MQTTManager::obtenerMensajesEnEspera() const {
+    return planificador.obtenerEnEspera();
+}
+
+uint32_t MQTTManager::obtenerMensajesDescartados() const {
+    return planificador.obtenerDescartados();
+}
+
+void MQTTManager::configurarLotes(int tamano, unsigned long tiempoMaximoMs) {
+    if (tamano < 1 || tiempoMaximoMs == 0) {
+        return;
+    }
+    
+    tamanoLote = tamano;
+    tiempoMaximoLoteMs = tiempoMaximoMs;
+    
+    // Al achicar el lote, publicar lo que ya lo completa
+    if (lecturasEnLote >= tamanoLote) {
+        vaciarLote();
+    }
+}
+
+bool MQTTManager::vaciarLote() {
+    if (lecturasEnLote == 0) {
+        return true;
+    }
+    if (!transporte || !transporte->estaConectado()) {
+        return false;
+    }
+    
+    // Cerrar el arreglo sin tocar longitudLote, así un fallo se reintenta igual
+    size_t longitud = longitudLote;
+    if (formatoLote == FORMATO_JSON) {
+        bufferLote[longitud++] = ']';
+    } else {
+        CodificadorBinario::codificarCabeceraArreglo(lecturasEnLote, bufferLote, sizeof(bufferLote));
+    }
+    bool resultado = publicarDatos(topicLecturas, bufferLote, longitud, QOS_LECTURAS, false,
+                                   PlanificadorSalida::PRIORIDAD_LECTURA) != PUBLICACION_RECHAZADA;
+    
+    if (resultado) {
+        Serial.print("Lote de ");
+        Serial.print(lecturasEnLote);
+        Serial.print(" lectura(s) publicado (");
+        Serial.print(longitud);
+        Serial.println(" bytes)");
+        longitudLote = 0;
+        lecturasEnLote = 0;
+    } else {
+        // Se conserva para reintentar
+        Serial.println("Error al publicar lote de lecturas");
+    }
+    
+    return resultado;
+}
+
+void MQTTManager::procesarLote() {
+    if (lecturasEnLote > 0 && millis() - inicioLote >= tiempoMaximoLoteMs) {
+        vaciarLote();
+    }
+}
+
+int MQTTManager::obtenerLecturasEnLote() const {
+    return lecturasEnLote;
+}
+
 void MQTTManager::establecerIdDispositivo(const String& id) {
     idDispositivo = id;
     
     // Actualizar topics
-    topicLecturas = "/" + idDispositivo + "/lecturas";
-    topicAlarmas = "/" + idDispositivo + "/alarmas";
-    topicMetadata = "/" + idDispositivo + "/metadata";
-    topicConfiguracion = "/" + idDispositivo + "/configuracion";
+    construirTopics();
     
     Serial.println("ID del dispositivo establecido: " + id);
 }
 
-void MQTTManager::establecerCallback(void (*callback)(String, String)) {
-    callbackMensaje = callback;
+void MQTTManager::establecerTopicsCortos(bool activos) {
+    if (activos == topicsCortos) {
+        return;
+    }
+    
+    topicsCortos = activos;
+    construirTopics();
+    Serial.println("Topics de salida: " + topicLecturas + ", " + topicAlarmas + ", " + topicMetadata + ", " +
+                   topicCalibracion);
+}
+
+bool MQTTManager::usaTopicsCortos() const {
+    return topicsCortos;
 }
 
-void MQTTManager::establecerCallbackConfiguracion(void (*callback)(String)) {
-    callbackConfiguracion = callback;
+uint32_t MQTTManager::obtenerBytesAhorradosTopics() const {
+    return bytesAhorradosTopics;
+}
+
+// Con un ID configurado muy corto el topic abreviado puede ser más largo
+static uint8_t calcularAhorro(size_t largo, size_t corto) {
+    if (largo <= corto) {
+        return 0;
+    }
+    return largo - corto > 255 ? 255 : (uint8_t)(largo - corto);
+}
+
+void MQTTManager::construirTopics() {
+    String largo = "/" + idDispositivo;
+    
+    // Los topics entrantes no cambian: los publica el backend y son poco frecuentes
+    topicConfiguracion = largo + "/configuracion";
+    topicVuelo = largo + "/vuelo";      // Solo tras un reinicio: no vale la pena abreviarlo
+    
+    if (!topicsCortos) {
+        topicLecturas = largo + "/lecturas";
+        topicAlarmas = largo + "/alarmas";
+        topicMetadata = largo + "/metadata";
+        topicCalibracion = largo + "/calibracion";
+        memset(ahorroTopics, 0, sizeof(ahorroTopics));
+        return;
+    }
+    
+    // Toda la MAC, no solo el sufijo del ID: no se repite entre equipos
+    uint8_t mac[TopicCorto::LONGITUD_MAC];
+    char idCorto[TopicCorto::LONGITUD_ID + 1];
+    WiFi.macAddress(mac);
+    TopicCorto::formatearId(idCorto, sizeof(idCorto), mac);
+    String corto = String("g/") + idCorto;
+    topicLecturas = corto + "/l";
+    topicAlarmas = corto + "/a";
+    topicMetadata = corto + "/m";
+    topicCalibracion = corto + "/c";
+    ahorroTopics[0] = calcularAhorro(largo.length() + strlen("/lecturas"), topicLecturas.length());
+    ahorroTopics[1] = calcularAhorro(largo.length() + strlen("/alarmas"), topicAlarmas.length());
+    ahorroTopics[2] = calcularAhorro(largo.length() + strlen("/metadata"), topicMetadata.length());
+    ahorroTopics[3] = calcularAhorro(largo.length() + strlen("/calibracion"), topicCalibracion.length());
+}
+
+size_t MQTTManager::obtenerAhorroTopic(const String& topic) const {
+    // Por identidad: publicarDatos() recibe siempre los miembros
+    if (!topicsCortos) {
+        return 0;
+    }
+    if (&topic == &topicLecturas) {
+        return ahorroTopics[0];
+    }
+    if (&topic == &topicAlarmas) {
+        return ahorroTopics[1];
+    }
+    if (&topic == &topicMetadata) {
+        return ahorroTopics[2];
+    }
+    return &topic == &topicCalibracion ? ahorroTopics[3] : 0;
 }
 
-void MQTTManager::establecerCallbackActualizaciones(void (*callback)(String)) {
-    callbackActualizaciones = callback;
+bool MQTTManager::registrarManejador(const String& filtro, EnrutadorMQTT::Manejador manejador, void* contexto) {
+    if (!enrutador.registrar(filtro.c_str(), manejador, contexto)) {
+        Serial.println("Error al registrar manejador MQTT para: " + filtro);
+        return false;
+    }
+    
+    // Con la conexión ya establecida la suscripción no espera a la próxima
+    int indice = enrutador.obtenerCantidadRutas() - 1;
+    if (conectado && transporte && !enrutador.esFiltroRepetido(indice)) {
+        suscribirFiltro(filtro.c_str());
+    }
+    return true;
 }
 
 // Getters
@@ -284,6 +720,14 @@ bool MQTTManager::estaConectado() const {
     return conectado;
 }
 
+MQTTManager::EstadoConexion MQTTManager::obtenerEstadoConexion() const {
+    return estadoConexion;
+}
+
+uint32_t MQTTManager::obtenerDesconexiones() const {
+    return desconexiones;
+}
+
 String MQTTManager::obtenerIdDispositivo() const {
     return idDispositivo;
 }
@@ -300,22 +744,61 @@ int MQTTManager::obtenerPuerto() const {
 void MQTTManager::imprimirEstado() const {
     Serial.println("=== ESTADO MQTT ===");
     Serial.println("Conectado: " + String(conectado ? "Sí" : "No"));
+    if (estadoConexion == CONEXION_ESPERANDO) {
+        unsigned long transcurrido = millis() - inicioEspera;
+        unsigned long restante = transcurrido < esperaReconexionMs ? esperaReconexionMs - transcurrido : 0;
+        Serial.println("Reintento: " + String(intentosConexion) + " fallido(s), próximo en " + String(restante) + " ms");
+    }
+    Serial.println("Desconexiones: " + String(desconexiones));
     Serial.println("ID Dispositivo: " + idDispositivo);
     Serial.println("Broker: " + broker);
     Serial.println("Puerto: " + String(puerto));
     Serial.println("SSL: " + String(usarSSL ? "Sí" : "No"));
+    if (usarSSL && clienteSeguro) {
+        clienteSeguro->imprimirEstadisticas();
+    }
     Serial.println("WebSocket: " + String(usarWebSocket ? "Sí" : "No"));
     Serial.println("Topic Lecturas: " + topicLecturas);
     Serial.println("Topic Alarmas: " + topicAlarmas);
     Serial.println("Topic Metadata: " + topicMetadata);
     Serial.println("Topic Configuración: " + topicConfiguracion);
+    Serial.println("Rutas de entrada: " + String(enrutador.obtenerCantidadRutas()));
+    Serial.println("Topic Calibración: " + topicCalibracion);
+    if (topicsCortos) {
+        Serial.println("Topics cortos: " + String(ahorroTopics[0]) + " bytes menos por lectura, " +
+                       String(bytesAhorradosTopics) + " bytes ahorrados en total");
+    }
+    Serial.println("Formato: " + String(formato == FORMATO_JSON ? "JSON" : "MessagePack"));
+    if (transporte) {
+        Serial.println("Transporte: " + String(transporte->obtenerNombre()) + " (QoS máximo " +
+                       String(transporte->obtenerQoSMaximo()) + ")");
+        transporte->imprimirEstado();
+    }
+    Serial.println("Cola de salida: " + String(planificador.obtenerEnEspera()) + " mensaje(s), " +
+                   String(planificador.obtenerMemoriaUsada()) + "/" + String(PlanificadorSalida::TAMANO_MEMORIA) +
+                   " bytes, " + String(planificador.obtenerEnviados()) + " enviado(s), " +
+                   String(planificador.obtenerRechazados()) + " rechazado(s)");
+    for (int i = 0; i < PlanificadorSalida::CANTIDAD_PRIORIDADES; i++) {
+        PlanificadorSalida::Prioridad prioridad = (PlanificadorSalida::Prioridad)i;
+        if (planificador.obtenerEnEspera(prioridad) > 0 || planificador.obtenerDescartados(prioridad) > 0) {
+            Serial.println("  " + String(PlanificadorSalida::obtenerNombrePrioridad(prioridad)) + ": " +
+                           String(planificador.obtenerEnEspera(prioridad)) + "/" +
+                           String(planificador.obtenerProfundidad(prioridad)) + " en espera, " +
+                           String(planificador.obtenerDescartados(prioridad)) + " descartado(s)");
+        }
+    }
+    Serial.println("Lotes: " + String(tamanoLote) + " lectura(s) o " + String(tiempoMaximoLoteMs / 1000) +
+                   " s, " + String(lecturasEnLote) + " en espera");
     Serial.println("==================");
 }
 
 void MQTTManager::reconectar() {
-    if (clienteMQTT && !clienteMQTT->connected()) {
-        Serial.println("Intentando reconectar MQTT...");
-        conectar();
+    // No conecta acá: reactiva la máquina de conexión, que respeta el jitter
+    if (transporte && !transporte->estaConectado() && estadoConexion == CONEXION_INACTIVA) {
+        Serial.println("Reconexión MQTT programada");
+        transporte->configurarServidor(broker.c_str(), puerto);
+        intentosConexion = 0;
+        programarReintento();
     }
 }
 
@@ -323,42 +806,14 @@ bool MQTTManager::esConfiguracionValida() const {
     return !idDispositivo.isEmpty() && !broker.isEmpty() && puerto > 0;
 }
 
-// Callback estático
+// Callback estático: el transporte entrega el topic y su propio buffer, que se
+// pasa a los manejadores sin copiar
 void MQTTManager::callbackMensajeRecibido(char* topic, byte* payload, unsigned int length) {
-    String topicStr = String(topic);
-    String payloadStr = "";
-    
-    for (int i = 0; i < length; i++) {
-        payloadStr += (char)payload[i];
+    if (!instancia) {
+        return;
     }
     
-    Serial.println("Mensaje MQTT recibido:");
-    Serial.println("Topic: " + topicStr);
-    Serial.println("Payload: " + payloadStr);
-    
-    // Procesar mensaje según el topic
-    if (topicStr.endsWith("/configuracion")) {
-        // Procesar configuración
-        Serial.println("Configuración recibida: " + payloadStr);
-        // Aquí se llamaría al callback de configuración
-    } else if (topicStr.endsWith("/actualizaciones")) {
-        // Procesar actualizaciones
-        Serial.println("Actualización recibida: " + payloadStr);
-        // Aquí se llamaría al callback de actualizaciones
-    } else if (topicStr.endsWith("/comandos")) {
-        // Procesar comandos
-        Serial.println("Comando recibido: " + payloadStr);
-    }
-}
-
-void MQTTManager::procesarMensajeConfiguracion(const String& payload) {
-    if (callbackConfiguracion) {
-        callbackConfiguracion(payload);
-    }
-}
-
-void MQTTManager::procesarMensajeActualizaciones(const String& payload) {
-    if (callbackActualizaciones) {
-        callbackActualizaciones(payload);
+    if (instancia->enrutador.despachar(topic, payload, length) == 0) {
+        Serial.println("Mensaje MQTT sin manejador en: " + String(topic));
     }
 }
@@ -0,0 +1,101 @@
+#include "MuestreoAdaptativo.h"
+
+const float MuestreoAdaptativo::NIVEL_REPOSO = 0.2;
+const float MuestreoAdaptativo::NIVEL_URGENTE = 0.8;
+const float MuestreoAdaptativo::VARIACION_URGENTE = 0.1;
+const float MuestreoAdaptativo::FACTOR_RETROCESO = 1.25;
+
+MuestreoAdaptativo::MuestreoAdaptativo() :
+    activo(true), intervaloFijoMs(30000), intervaloMinimoMs(2000), intervaloMaximoMs(120000),
+    intervaloActualMs(30000), nivelAnterior(0.0), hayNivelAnterior(false), urgencia(0.0) {
+}
+
+void MuestreoAdaptativo::configurar(int intervaloFijo, int intervaloMinimo, int intervaloMaximo, bool adaptativo) {
+    if (intervaloFijo <= 0 || intervaloMinimo <= 0 || intervaloMaximo < intervaloMinimo) {
+        return;
+    }
+
+    intervaloFijoMs = intervaloFijo * 1000UL;
+    intervaloMinimoMs = intervaloMinimo * 1000UL;
+    intervaloMaximoMs = intervaloMaximo * 1000UL;
+
+    if (adaptativo != activo) {
+        activo = adaptativo;
+        reiniciar();
+    }
+
+    intervaloActualMs = activo ? limitarIntervalo(intervaloActualMs) : intervaloFijoMs;
+}
+
+unsigned long MuestreoAdaptativo::actualizar(float nivel) {
+    if (!activo) {
+        intervaloActualMs = intervaloFijoMs;
+        return intervaloActualMs;
+    }
+
+    // Urgencia por nivel: 0 en reposo, 1 cerca del umbral
+    float urgenciaNivel = constrain((nivel - NIVEL_REPOSO) / (NIVEL_URGENTE - NIVEL_REPOSO), 0.0f, 1.0f);
+
+    // Urgencia por variación desde la medición anterior
+    float urgenciaVariacion = 0.0;
+    if (hayNivelAnterior) {
+        float variacion = fabsf(nivel - nivelAnterior);
+        urgenciaVariacion = constrain(variacion / VARIACION_URGENTE, 0.0f, 1.0f);
+    }
+    nivelAnterior = nivel;
+    hayNivelAnterior = true;
+
+    urgencia = urgenciaNivel > urgenciaVariacion ? urgenciaNivel : urgenciaVariacion;
+
+    unsigned long objetivo = intervaloMaximoMs - (unsigned long)(urgencia * (intervaloMaximoMs - intervaloMinimoMs));
+
+    if (objetivo < intervaloActualMs) {
+        // Acelerar de inmediato
+        intervaloActualMs = objetivo;
+    } else {
+        // Retroceder gradualmente mientras la señal se mantenga estable
+        unsigned long retroceso = (unsigned long)(intervaloActualMs * FACTOR_RETROCESO);
+        intervaloActualMs = retroceso < objetivo ? retroceso : objetivo;
+    }
+
+    intervaloActualMs = limitarIntervalo(intervaloActualMs);
+    return intervaloActualMs;
+}
+
+void MuestreoAdaptativo::reiniciar() {
+    hayNivelAnterior = false;
+    nivelAnterior = 0.0;
+    urgencia = 0.0;
+    intervaloActualMs = activo ? intervaloMinimoMs : intervaloFijoMs;
+}
+
+unsigned long MuestreoAdaptativo::limitarIntervalo(unsigned long intervalo) const {
+    if (intervalo < intervaloMinimoMs) {
+        return intervaloMinimoMs;
+    }
+    if (intervalo > intervaloMaximoMs) {
+        return intervaloMaximoMs;
+    }
+    return intervalo;
+}
+
+bool MuestreoAdaptativo::estaActivo() const {
+    return activo;
+}
+
+unsigned long MuestreoAdaptativo::obtenerIntervaloMs() const {
+    return intervaloActualMs;
+}
+
+float MuestreoAdaptativo::obtenerUrgencia() const {
+    return urgencia;
+}
+
+void MuestreoAdaptativo::imprimirEstado() const {
+    Serial.println("=== MUESTREO ADAPTATIVO ===");
+    Serial.println("Activo: " + String(activo ? "Sí" : "No"));
+    Serial.println("Intervalo actual: " + String(intervaloActualMs / 1000.0, 1) + " s");
+    Serial.println("Rango: " + String(intervaloMinimoMs / 1000) + "-" + String(intervaloMaximoMs / 1000) + " s");
+    Serial.println("Urgencia: " + String(urgencia, 2));
+    Serial.println("===========================");
+}
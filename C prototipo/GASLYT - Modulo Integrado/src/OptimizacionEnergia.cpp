@@ -1,4 +1,5 @@
 #include "OptimizacionEnergia.h"
+#include "SistemaLogging.h"
 
 OptimizacionEnergia::OptimizacionEnergia() : 
     modoAhorroEnergia(false), ultimaActividad(0), tiempoInactividad(0),
@@ -171,7 +172,8 @@ void OptimizacionEnergia::entrarModoSueño() {
     // Configurar despertador
     esp_sleep_enable_timer_wakeup(1000000); // 1 segundo
     
-    // Entrar en modo sueño
+    // Entrar en modo sueño, sin perder el log pendiente
+    SistemaLoggingSingleton::getInstance().vaciar();
     esp_deep_sleep_start();
 }
 
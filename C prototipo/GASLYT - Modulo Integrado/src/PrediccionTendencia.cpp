@@ -0,0 +1,89 @@
+#include "PrediccionTendencia.h"
+
+const float PrediccionTendencia::SIN_CRUCE = -1.0;
+
+PrediccionTendencia::PrediccionTendencia() {
+    reiniciar();
+}
+
+void PrediccionTendencia::agregar(unsigned long tiempoMs, float valor) {
+    tiempos[indice] = tiempoMs;
+    valores[indice] = valor;
+    indice = (indice + 1) % TAMANO_VENTANA;
+    if (cantidad < TAMANO_VENTANA) {
+        cantidad++;
+    }
+
+    ajustar();
+}
+
+void PrediccionTendencia::reiniciar() {
+    indice = 0;
+    cantidad = 0;
+    pendiente = 0.0;
+    valorAjustado = 0.0;
+}
+
+void PrediccionTendencia::ajustar() {
+    if (cantidad < MUESTRAS_MINIMAS) {
+        pendiente = 0.0;
+        valorAjustado = cantidad > 0 ? valores[(indice + TAMANO_VENTANA - 1) % TAMANO_VENTANA] : 0.0;
+        return;
+    }
+
+    // Tiempos relativos a la lectura más antigua, en segundos, para no
+    // perder precisión en float con millis() grandes
+    int inicio = (indice + TAMANO_VENTANA - cantidad) % TAMANO_VENTANA;
+    unsigned long origen = tiempos[inicio];
+
+    float sumaT = 0.0;
+    float sumaV = 0.0;
+    for (int i = 0; i < cantidad; i++) {
+        int j = (inicio + i) % TAMANO_VENTANA;
+        sumaT += (tiempos[j] - origen) / 1000.0f;
+        sumaV += valores[j];
+    }
+    float mediaT = sumaT / cantidad;
+    float mediaV = sumaV / cantidad;
+
+    float covarianza = 0.0;
+    float varianzaT = 0.0;
+    for (int i = 0; i < cantidad; i++) {
+        int j = (inicio + i) % TAMANO_VENTANA;
+        float dt = (tiempos[j] - origen) / 1000.0f - mediaT;
+        covarianza += dt * (valores[j] - mediaV);
+        varianzaT += dt * dt;
+    }
+
+    pendiente = varianzaT > 0 ? covarianza / varianzaT : 0.0;
+
+    int ultimo = (indice + TAMANO_VENTANA - 1) % TAMANO_VENTANA;
+    float tUltimo = (tiempos[ultimo] - origen) / 1000.0f;
+    valorAjustado = mediaV + pendiente * (tUltimo - mediaT);
+}
+
+bool PrediccionTendencia::hayTendencia() const {
+    return cantidad >= MUESTRAS_MINIMAS;
+}
+
+float PrediccionTendencia::obtenerPendiente() const {
+    return pendiente;
+}
+
+float PrediccionTendencia::obtenerValorAjustado() const {
+    return valorAjustado;
+}
+
+float PrediccionTendencia::obtenerTiempoHastaUmbral(float umbral) const {
+    if (!hayTendencia() || pendiente <= 0) {
+        return SIN_CRUCE;
+    }
+    if (valorAjustado >= umbral) {
+        return 0.0;
+    }
+    return (umbral - valorAjustado) / pendiente;
+}
+
+int PrediccionTendencia::obtenerCantidad() const {
+    return cantidad;
+}
@@ -0,0 +1,106 @@
+#include "PublicacionExcepcion.h"
+
+PublicacionExcepcion::PublicacionExcepcion() :
+    activo(false), bandaAbsoluta(5.0), bandaRelativa(0.05), latidoMs(300000),
+    cantidadCanales(0), hayReferencia(false), ultimaPublicacion(0), suprimidas(0), publicadasTotal(0) {
+}
+
+void PublicacionExcepcion::configurar(bool activar, float absoluta, float relativa, int latido) {
+    if (absoluta < 0 || relativa < 0 || latido <= 0) {
+        return;
+    }
+
+    bandaAbsoluta = absoluta;
+    bandaRelativa = relativa / 100.0;
+    latidoMs = latido * 1000UL;
+
+    if (activar != activo) {
+        activo = activar;
+        reiniciar();
+    }
+}
+
+PublicacionExcepcion::Motivo PublicacionExcepcion::evaluar(const float* concentraciones, const bool* alarmas,
+                                                         int cantidad, unsigned long ahora) {
+    if (cantidad > MAX_CANALES) {
+        cantidad = MAX_CANALES;
+    }
+
+    Motivo motivo = MOTIVO_SUPRIMIDA;
+    if (!activo) {
+        motivo = MOTIVO_DESACTIVADA;
+    } else if (!hayReferencia || cantidad != cantidadCanales) {
+        motivo = MOTIVO_PRIMERA;
+    } else {
+        for (int i = 0; i < cantidad && motivo == MOTIVO_SUPRIMIDA; i++) {
+            // Con alarma activa se publica cada lectura
+            if (alarmas[i] || alarmas[i] != alarmasPublicadas[i]) {
+                motivo = MOTIVO_ALARMA;
+            }
+        }
+        for (int i = 0; i < cantidad && motivo == MOTIVO_SUPRIMIDA; i++) {
+            float banda = bandaRelativa * fabsf(publicadas[i]);
+            if (banda < bandaAbsoluta) {
+                banda = bandaAbsoluta;
+            }
+            if (fabsf(concentraciones[i] - publicadas[i]) > banda) {
+                motivo = MOTIVO_VARIACION;
+            }
+        }
+        if (motivo == MOTIVO_SUPRIMIDA && ahora - ultimaPublicacion >= latidoMs) {
+            motivo = MOTIVO_LATIDO;
+        }
+    }
+
+    if (motivo == MOTIVO_SUPRIMIDA) {
+        suprimidas++;
+        return motivo;
+    }
+
+    for (int i = 0; i < cantidad; i++) {
+        publicadas[i] = concentraciones[i];
+        alarmasPublicadas[i] = alarmas[i];
+    }
+    cantidadCanales = cantidad;
+    hayReferencia = true;
+    ultimaPublicacion = ahora;
+    publicadasTotal++;
+    return motivo;
+}
+
+void PublicacionExcepcion::reiniciar() {
+    hayReferencia = false;
+}
+
+bool PublicacionExcepcion::estaActivo() const {
+    return activo;
+}
+
+uint32_t PublicacionExcepcion::obtenerSuprimidas() const {
+    return suprimidas;
+}
+
+uint32_t PublicacionExcepcion::obtenerPublicadas() const {
+    return publicadasTotal;
+}
+
+const char* PublicacionExcepcion::obtenerNombreMotivo(Motivo motivo) {
+    switch (motivo) {
+        case MOTIVO_SUPRIMIDA: return "suprimida";
+        case MOTIVO_DESACTIVADA: return "sin banda";
+        case MOTIVO_PRIMERA: return "primera";
+        case MOTIVO_VARIACION: return "variación";
+        case MOTIVO_ALARMA: return "alarma";
+        case MOTIVO_LATIDO: return "latido";
+        default: return "desconocido";
+    }
+}
+
+void PublicacionExcepcion::imprimirEstado() const {
+    Serial.println("=== PUBLICACIÓN POR EXCEPCIÓN ===");
+    Serial.println("Activa: " + String(activo ? "Sí" : "No"));
+    Serial.println("Banda: " + String(bandaAbsoluta, 1) + " ppm o " + String(bandaRelativa * 100.0, 1) + " %");
+    Serial.println("Latido: " + String(latidoMs / 1000) + " segundos");
+    Serial.println("Lecturas publicadas: " + String(publicadasTotal) + ", suprimidas: " + String(suprimidas));
+    Serial.println("=================================");
+}
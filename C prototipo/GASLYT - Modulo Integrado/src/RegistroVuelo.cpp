@@ -0,0 +1,524 @@
+#include "RegistroVuelo.h"
+#include <esp_attr.h>
+#include <esp_system.h>
+
+// Página pendiente: RTC_NOINIT no se borra al reiniciar, solo al perder la energía
+struct PaginaPendiente {
+    uint32_t marca;
+    uint32_t longitud;          // Bytes de entradas completas
+    uint8_t datos[RegistroVuelo::TAMANO_PAGINA];
+};
+
+static const uint32_t MARCA_PAGINA = 0x50524C47;   // "GLRP"
+static RTC_NOINIT_ATTR PaginaPendiente paginaPendiente;
+
+RegistroVuelo::RegistroVuelo() :
+    particion(nullptr), cantidadSectores(0), inicializado(false), cerrojo(nullptr), arranque(0),
+    sectorEscritura(0), posicionEscritura(0), numeroSectorEscritura(0), inicioPagina(0),
+    subidaPendiente(false), sectorSubida(0), posicionSubida(0), sectorFinSubida(0xFFFF),
+    posicionFinSubida(0), numeroFinSubida(0), indiceFragmento(0), hayFragmento(false),
+    fragmentoFinal(false), longitudFragmento(0), sectorSiguiente(0), posicionSiguiente(0),
+    entradas(0), bytesEntradas(0), escrituras(0), borrados(0), descartadas(0) {
+    cerrojo = xSemaphoreCreateMutex();
+}
+
+RegistroVuelo::~RegistroVuelo() {
+    if (cerrojo) {
+        vSemaphoreDelete(cerrojo);
+    }
+}
+
+bool RegistroVuelo::inicializar(uint32_t numeroArranque) {
+    arranque = numeroArranque;
+    particion = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "vuelo");
+    if (!particion) {
+        Serial.println("Error: No se encontró la partición vuelo para el registro de vuelo");
+        return false;
+    }
+
+    cantidadSectores = particion->size / TAMANO_SECTOR;
+    if (cantidadSectores < 2 || !cerrojo) {
+        Serial.println("Error: Partición vuelo demasiado chica para el registro de vuelo");
+        return false;
+    }
+
+    // Seguir en el sector más reciente si lo que sigue a sus entradas está borrado; si no, uno nuevo
+    uint16_t sectorAntiguo;
+    uint16_t sectorReciente;
+    uint32_t numeroReciente;
+    bool hayDatos = buscarExtremos(sectorAntiguo, sectorReciente, numeroReciente);
+    uint32_t finReciente = sizeof(CabeceraSector);
+    CabeceraEntrada cabecera;
+    while (hayDatos && leerEntrada(sectorReciente, finReciente, cabecera)) {
+        finReciente += sizeof(cabecera) + cabecera.longitud;
+    }
+
+    if (hayDatos && estaBorrado(sectorReciente, finReciente)) {
+        sectorEscritura = sectorReciente;
+        posicionEscritura = finReciente;
+        numeroSectorEscritura = numeroReciente;
+    } else if (!abrirSector(hayDatos ? (sectorReciente + 1) % cantidadSectores : 0, hayDatos ? numeroReciente + 1 : 1)) {
+        Serial.println("Error al preparar el registro de vuelo");
+        return false;
+    }
+
+    // Lo que quedó en la página antes del reinicio va primero (puede traer la última marca de subida)
+    recuperarPagina();
+    if (posicionEscritura + paginaPendiente.longitud > TAMANO_SECTOR &&
+        !abrirSector((sectorEscritura + 1) % cantidadSectores, numeroSectorEscritura + 1)) {
+        return false;
+    }
+    volcarPagina();
+
+    // La subida arranca en la última marca; si su sector ya se reutilizó, en lo más antiguo
+    buscarExtremos(sectorAntiguo, sectorReciente, numeroReciente);
+    sectorSubida = sectorAntiguo;
+    posicionSubida = sizeof(CabeceraSector);
+    uint16_t sector = sectorAntiguo;
+    for (uint16_t recorridos = 0; recorridos < cantidadSectores; recorridos++) {
+        uint32_t posicion = sizeof(CabeceraSector);
+        while (leerEntrada(sector, posicion, cabecera)) {
+            uint8_t marca[6];
+            uint32_t numeroMarca;
+            uint16_t posicionMarca;
+            if (cabecera.tipo == ENTRADA_SUBIDA && cabecera.longitud == sizeof(marca) &&
+                esp_partition_read(particion, sector * TAMANO_SECTOR + posicion + sizeof(cabecera), marca, sizeof(marca)) == ESP_OK &&
+                calcularSuma(marca, sizeof(marca)) == cabecera.suma) {
+                memcpy(&numeroMarca, marca, 4);
+                memcpy(&posicionMarca, marca + 4, 2);
+                sectorSubida = sectorAntiguo;
+                posicionSubida = sizeof(CabeceraSector);
+                for (uint16_t s = 0; s < cantidadSectores; s++) {
+                    CabeceraSector cabeceraSector;
+                    if (leerCabeceraSector(s, cabeceraSector) && cabeceraSector.numero == numeroMarca) {
+                        sectorSubida = s;
+                        posicionSubida = posicionMarca;
+                    }
+                }
+            }
+            posicion += sizeof(cabecera) + cabecera.longitud;
+        }
+        if (sector == sectorEscritura) {
+            break;
+        }
+        sector = (sector + 1) % cantidadSectores;
+    }
+    subidaPendiente = true;
+
+    int motivo = esp_reset_reason();
+    uint8_t datosArranque[5];
+    memcpy(datosArranque, &arranque, 4);
+    datosArranque[4] = (uint8_t)motivo;
+    agregarEntrada(ENTRADA_ARRANQUE, datosArranque, sizeof(datosArranque));
+    volcarPagina();
+
+    // Se sube hasta acá; lo que se registre ahora, en el próximo arranque
+    sectorFinSubida = sectorEscritura;
+    posicionFinSubida = posicionEscritura;
+    numeroFinSubida = numeroSectorEscritura;
+
+    // Solo si hay mensajes sin subir o el reinicio fue por una falla
+    bool hayRegistros = false;
+    uint32_t posicion = posicionSubida;
+    sector = sectorSubida;
+    while (subidaPendiente && !hayRegistros && ubicarEntrada(sector, posicion, cabecera)) {
+        uint8_t clase = cabecera.tipo & 0xF0;
+        hayRegistros = clase == ENTRADA_TEXTO || clase == ENTRADA_TOKEN;
+        posicion += sizeof(cabecera) + cabecera.longitud;
+    }
+    subidaPendiente = subidaPendiente && (hayRegistros || esReinicioAnomalo(motivo));
+
+    inicializado = true;
+    Serial.println("Registro de vuelo inicializado: " + String(obtenerCapacidadBytes() / 1024) + " KB, motivo del reinicio " +
+                   String(motivo) + ", subida " + String(subidaPendiente ? "pendiente" : "al día"));
+    return true;
+}
+
+bool RegistroVuelo::agregarTexto(uint8_t nivel, uint32_t marcaMs, const char* componente, const char* mensaje) {
+    if (!inicializado) {
+        return false;
+    }
+
+    // Marca, componente con su longitud y mensaje sin terminador
+    uint8_t datos[160];
+    size_t longitudComponente = strnlen(componente, 15);
+    size_t longitudMensaje = strnlen(mensaje, sizeof(datos) - 5 - longitudComponente);
+    memcpy(datos, &marcaMs, 4);
+    datos[4] = (uint8_t)longitudComponente;
+    memcpy(datos + 5, componente, longitudComponente);
+    memcpy(datos + 5 + longitudComponente, mensaje, longitudMensaje);
+
+    xSemaphoreTake(cerrojo, portMAX_DELAY);
+    bool resultado = agregarEntrada(ENTRADA_TEXTO | (nivel & 0x0F), datos, 5 + longitudComponente + longitudMensaje);
+    xSemaphoreGive(cerrojo);
+    return resultado;
+}
+
+bool RegistroVuelo::agregarToken(uint8_t nivel, uint32_t marcaMs, const uint8_t* datosToken, size_t longitud) {
+    uint8_t datos[4 + 128];
+    if (!inicializado || longitud > sizeof(datos) - 4) {
+        return false;
+    }
+
+    // Marca e identificador con los argumentos tal como los arma SistemaLogging
+    memcpy(datos, &marcaMs, 4);
+    memcpy(datos + 4, datosToken, longitud);
+
+    xSemaphoreTake(cerrojo, portMAX_DELAY);
+    bool resultado = agregarEntrada(ENTRADA_TOKEN | (nivel & 0x0F), datos, 4 + longitud);
+    xSemaphoreGive(cerrojo);
+    return resultado;
+}
+
+bool RegistroVuelo::volcar() {
+    if (!inicializado) {
+        return false;
+    }
+
+    xSemaphoreTake(cerrojo, portMAX_DELAY);
+    bool resultado = volcarPagina();
+    xSemaphoreGive(cerrojo);
+    return resultado;
+}
+
+void RegistroVuelo::procesar() {
+    if (!inicializado) {
+        return;
+    }
+
+    // Acota lo que se pierde en un corte de energía
+    xSemaphoreTake(cerrojo, portMAX_DELAY);
+    if (paginaPendiente.longitud > 0 && millis() - inicioPagina >= PERIODO_VOLCADO_MS) {
+        volcarPagina();
+    }
+    xSemaphoreGive(cerrojo);
+}
+
+bool RegistroVuelo::haySubidaPendiente() const {
+    return inicializado && subidaPendiente;
+}
+
+bool RegistroVuelo::obtenerFragmento(const uint8_t*& datos, size_t& longitud) {
+    if (!inicializado) {
+        return false;
+    }
+
+    xSemaphoreTake(cerrojo, portMAX_DELAY);
+    if (!subidaPendiente) {
+        xSemaphoreGive(cerrojo);
+        return false;
+    }
+
+    // Sin confirmar, se vuelve a entregar el mismo fragmento
+    if (!hayFragmento) {
+        uint16_t sector = sectorSubida;
+        uint32_t posicion = posicionSubida;
+        size_t usado = CABECERA_FRAGMENTO;
+        bool lleno = false;
+        CabeceraEntrada cabecera;
+
+        // Entradas completas, tal como están en flash
+        while (ubicarEntrada(sector, posicion, cabecera)) {
+            size_t tamano = sizeof(cabecera) + cabecera.longitud;
+            if (usado + tamano > TAMANO_FRAGMENTO) {
+                lleno = true;
+                break;
+            }
+            if (esp_partition_read(particion, sector * TAMANO_SECTOR + posicion, fragmento + usado, tamano) == ESP_OK &&
+                calcularSuma(fragmento + usado + sizeof(cabecera), cabecera.longitud) == cabecera.suma) {
+                usado += tamano;
+            } else {
+                descartadas++;
+            }
+            posicion += tamano;
+        }
+
+        fragmento[0] = VERSION_FRAGMENTO;
+        memcpy(fragmento + 1, &arranque, 4);
+        memcpy(fragmento + 5, &indiceFragmento, 2);
+        fragmento[7] = lleno ? 0 : 1;
+
+        fragmentoFinal = !lleno;
+        longitudFragmento = usado;
+        sectorSiguiente = sector;
+        posicionSiguiente = posicion;
+        hayFragmento = true;
+    }
+
+    datos = fragmento;
+    longitud = longitudFragmento;
+    xSemaphoreGive(cerrojo);
+    return true;
+}
+
+bool RegistroVuelo::confirmarFragmento() {
+    if (!inicializado) {
+        return false;
+    }
+
+    xSemaphoreTake(cerrojo, portMAX_DELAY);
+    if (!hayFragmento) {
+        xSemaphoreGive(cerrojo);
+        return false;
+    }
+
+    hayFragmento = false;
+    sectorSubida = sectorSiguiente;
+    posicionSubida = posicionSiguiente;
+    indiceFragmento++;
+
+    if (fragmentoFinal) {
+        // Marca de subida: el próximo arranque sigue desde el fin de esta. Va
+        // a flash ya, para no repetir la subida si se corta la energía
+        subidaPendiente = false;
+        uint8_t marca[6];
+        uint16_t posicion = posicionFinSubida;
+        memcpy(marca, &numeroFinSubida, 4);
+        memcpy(marca + 4, &posicion, 2);
+        agregarEntrada(ENTRADA_SUBIDA, marca, sizeof(marca));
+        volcarPagina();
+    }
+
+    xSemaphoreGive(cerrojo);
+    return true;
+}
+
+uint16_t RegistroVuelo::calcularSuma(const uint8_t* datos, size_t longitud) {
+    uint16_t suma1 = 0;
+    uint16_t suma2 = 0;
+    for (size_t i = 0; i < longitud; i++) {
+        suma1 = (suma1 + datos[i]) % 255;
+        suma2 = (suma2 + suma1) % 255;
+    }
+    return (suma2 << 8) | suma1;
+}
+
+bool RegistroVuelo::esReinicioAnomalo(int motivo) {
+    return motivo == ESP_RST_PANIC || motivo == ESP_RST_INT_WDT || motivo == ESP_RST_TASK_WDT ||
+           motivo == ESP_RST_WDT || motivo == ESP_RST_BROWNOUT;
+}
+
+bool RegistroVuelo::buscarExtremos(uint16_t& antiguo, uint16_t& reciente, uint32_t& numeroReciente) const {
+    bool hayDatos = false;
+    uint32_t numeroAntiguo = 0;
+    antiguo = 0;
+    reciente = 0;
+    numeroReciente = 0;
+    for (uint16_t s = 0; s < cantidadSectores; s++) {
+        CabeceraSector cabecera;
+        if (!leerCabeceraSector(s, cabecera)) {
+            continue;
+        }
+        if (!hayDatos || cabecera.numero < numeroAntiguo) {
+            numeroAntiguo = cabecera.numero;
+            antiguo = s;
+        }
+        if (!hayDatos || cabecera.numero > numeroReciente) {
+            numeroReciente = cabecera.numero;
+            reciente = s;
+        }
+        hayDatos = true;
+    }
+    return hayDatos;
+}
+
+bool RegistroVuelo::leerCabeceraSector(uint16_t sector, CabeceraSector& cabecera) const {
+    if (esp_partition_read(particion, sector * TAMANO_SECTOR, &cabecera, sizeof(cabecera)) != ESP_OK) {
+        return false;
+    }
+    return cabecera.marca == MARCA_SECTOR;
+}
+
+bool RegistroVuelo::leerEntrada(uint16_t sector, uint32_t posicion, CabeceraEntrada& cabecera) const {
+    if (posicion + sizeof(CabeceraEntrada) > TAMANO_SECTOR ||
+        esp_partition_read(particion, sector * TAMANO_SECTOR + posicion, &cabecera, sizeof(cabecera)) != ESP_OK) {
+        return false;
+    }
+
+    uint8_t clase = cabecera.tipo & 0xF0;
+    bool tipoValido = clase == ENTRADA_TEXTO || clase == ENTRADA_TOKEN ||
+                      cabecera.tipo == ENTRADA_ARRANQUE || cabecera.tipo == ENTRADA_SUBIDA;
+    return tipoValido && posicion + sizeof(cabecera) + cabecera.longitud <= TAMANO_SECTOR;
+}
+
+bool RegistroVuelo::estaBorrado(uint16_t sector, uint32_t posicion) const {
+    // Una escritura cortada deja bytes programados después de la última entrada válida
+    uint8_t bloque[64];
+    while (posicion < TAMANO_SECTOR) {
+        size_t cantidad = TAMANO_SECTOR - posicion < sizeof(bloque) ? TAMANO_SECTOR - posicion : sizeof(bloque);
+        if (esp_partition_read(particion, sector * TAMANO_SECTOR + posicion, bloque, cantidad) != ESP_OK) {
+            return false;
+        }
+        for (size_t i = 0; i < cantidad; i++) {
+            if (bloque[i] != 0xFF) {
+                return false;
+            }
+        }
+        posicion += cantidad;
+    }
+    return true;
+}
+
+bool RegistroVuelo::abrirSector(uint16_t sector, uint32_t numero) {
+    // El sector a reutilizar tiene lo más antiguo sin subir: la subida sigue en el próximo
+    if (subidaPendiente && sector == sectorSubida) {
+        if (sector == sectorFinSubida) {
+            subidaPendiente = false;
+        } else {
+            sectorSubida = (sector + 1) % cantidadSectores;
+            posicionSubida = sizeof(CabeceraSector);
+        }
+        hayFragmento = false;
+        descartadas++;
+        Serial.println("Registro de vuelo lleno: se pisó un sector sin subir");
+    }
+
+    if (esp_partition_erase_range(particion, sector * TAMANO_SECTOR, TAMANO_SECTOR) != ESP_OK) {
+        Serial.println("Error al borrar sector " + String(sector) + " del registro de vuelo");
+        return false;
+    }
+    borrados++;
+
+    CabeceraSector cabecera;
+    cabecera.marca = MARCA_SECTOR;
+    cabecera.numero = numero;
+    if (esp_partition_write(particion, sector * TAMANO_SECTOR, &cabecera, sizeof(cabecera)) != ESP_OK) {
+        Serial.println("Error al escribir sector " + String(sector) + " del registro de vuelo");
+        return false;
+    }
+
+    sectorEscritura = sector;
+    posicionEscritura = sizeof(CabeceraSector);
+    numeroSectorEscritura = numero;
+    return true;
+}
+
+bool RegistroVuelo::agregarEntrada(uint8_t tipo, const uint8_t* datos, size_t longitud) {
+    size_t tamano = sizeof(CabeceraEntrada) + longitud;
+    if (longitud > 0xFF || tamano > TAMANO_PAGINA) {
+        return false;
+    }
+
+    // Las entradas no cruzan sectores; la página se escribe entera al llenarse
+    if (posicionEscritura + paginaPendiente.longitud + tamano > TAMANO_SECTOR) {
+        if (!volcarPagina() || !abrirSector((sectorEscritura + 1) % cantidadSectores, numeroSectorEscritura + 1)) {
+            return false;
+        }
+    } else if (paginaPendiente.longitud + tamano > TAMANO_PAGINA && !volcarPagina()) {
+        return false;
+    }
+
+    CabeceraEntrada cabecera;
+    cabecera.tipo = tipo;
+    cabecera.longitud = longitud;
+    cabecera.suma = calcularSuma(datos, longitud);
+
+    if (paginaPendiente.longitud == 0) {
+        inicioPagina = millis();
+    }
+    memcpy(paginaPendiente.datos + paginaPendiente.longitud, &cabecera, sizeof(cabecera));
+    memcpy(paginaPendiente.datos + paginaPendiente.longitud + sizeof(cabecera), datos, longitud);
+    paginaPendiente.longitud += tamano;     // Recién ahora la entrada cuenta para recuperarPagina()
+
+    entradas++;
+    bytesEntradas += tamano;
+    return true;
+}
+
+bool RegistroVuelo::volcarPagina() {
+    if (paginaPendiente.longitud == 0) {
+        return true;
+    }
+
+    uint32_t direccion = sectorEscritura * TAMANO_SECTOR + posicionEscritura;
+    if (esp_partition_write(particion, direccion, paginaPendiente.datos, paginaPendiente.longitud) != ESP_OK) {
+        // La zona queda sucia: se pierde la página y se abandona el sector
+        Serial.println("Error al escribir en el registro de vuelo");
+        paginaPendiente.longitud = 0;
+        posicionEscritura = TAMANO_SECTOR;
+        descartadas++;
+        return false;
+    }
+
+    posicionEscritura += paginaPendiente.longitud;
+    paginaPendiente.longitud = 0;
+    escrituras++;
+    return true;
+}
+
+void RegistroVuelo::recuperarPagina() {
+    // Tras un corte de energía la memoria RTC tiene cualquier cosa
+    if (paginaPendiente.marca != MARCA_PAGINA || paginaPendiente.longitud > TAMANO_PAGINA ||
+        esp_reset_reason() == ESP_RST_POWERON) {
+        paginaPendiente.marca = MARCA_PAGINA;
+        paginaPendiente.longitud = 0;
+        return;
+    }
+
+    // Solo las entradas completas y con la suma correcta
+    uint32_t validos = 0;
+    while (validos + sizeof(CabeceraEntrada) <= paginaPendiente.longitud) {
+        CabeceraEntrada cabecera;
+        memcpy(&cabecera, paginaPendiente.datos + validos, sizeof(cabecera));
+        uint32_t tamano = sizeof(cabecera) + cabecera.longitud;
+        if (validos + tamano > paginaPendiente.longitud ||
+            calcularSuma(paginaPendiente.datos + validos + sizeof(cabecera), cabecera.longitud) != cabecera.suma) {
+            break;
+        }
+        validos += tamano;
+    }
+    paginaPendiente.longitud = validos;
+
+    if (validos > 0) {
+        Serial.println("Registro de vuelo: " + String(validos) + " bytes recuperados de la memoria RTC");
+    }
+}
+
+bool RegistroVuelo::esFinSubida(uint16_t sector, uint32_t posicion) const {
+    return sector == sectorFinSubida && posicion >= posicionFinSubida;
+}
+
+bool RegistroVuelo::ubicarEntrada(uint16_t& sector, uint32_t& posicion, CabeceraEntrada& cabecera) const {
+    // Próxima entrada antes del fin de la subida, pasando de sector al terminar uno
+    for (uint16_t recorridos = 0; recorridos <= cantidadSectores; recorridos++) {
+        if (esFinSubida(sector, posicion)) {
+            return false;
+        }
+        if (leerEntrada(sector, posicion, cabecera)) {
+            return true;
+        }
+        if (sector == sectorFinSubida) {
+            return false;
+        }
+        sector = (sector + 1) % cantidadSectores;
+        posicion = sizeof(CabeceraSector);
+    }
+    return false;
+}
+
+bool RegistroVuelo::estaInicializado() const {
+    return inicializado;
+}
+
+uint32_t RegistroVuelo::obtenerCapacidadBytes() const {
+    return (uint32_t)cantidadSectores * (TAMANO_SECTOR - sizeof(CabeceraSector));
+}
+
+uint32_t RegistroVuelo::obtenerEscrituras() const {
+    return escrituras;
+}
+
+uint32_t RegistroVuelo::obtenerBorrados() const {
+    return borrados;
+}
+
+void RegistroVuelo::imprimirEstado() const {
+    Serial.println("=== REGISTRO DE VUELO ===");
+    Serial.println("Inicializado: " + String(inicializado ? "Sí" : "No"));
+    Serial.println("Entradas: " + String(entradas) + " (" + String(bytesEntradas) + " bytes)");
+    Serial.println("Escrituras de página: " + String(escrituras) + ", sectores borrados: " + String(borrados));
+    Serial.println("Descartadas: " + String(descartadas));
+    Serial.println("Sector escritura: " + String(sectorEscritura) + "/" + String(cantidadSectores));
+    Serial.println("Subida: " + String(subidaPendiente ? "pendiente, fragmento " + String(indiceFragmento) : String("al día")));
+    Serial.println("=========================");
+}
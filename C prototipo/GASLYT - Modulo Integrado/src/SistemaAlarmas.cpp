@@ -1,4 +1,5 @@
 #include "SistemaAlarmas.h"
+#include "SistemaLogging.h"
 
 SistemaAlarmas::SistemaAlarmas(int pinLED, int pinBuzzer, int pinExtractor, bool extractorAlambrico) :
     pinBuzzer(pinBuzzer), pinExtractor(pinExtractor), extractorAlambrico(extractorAlambrico),
@@ -51,11 +52,12 @@ void SistemaAlarmas::actualizarEstado(EstadoSistema estado) {
         return; // No cambiar si es el mismo estado
     }
     
+    // Transición: queda también en el registro de vuelo
+    LOG_TRANSICIONF("ALARMAS", "Estado del sistema: %s -> %s", obtenerNombreEstado(estadoActual), obtenerNombreEstado(estado));
+    
     estadoActual = estado;
     alarmaActiva = (estado == ALARMA);
     
-    Serial.println("Estado del sistema cambiado a: " + String(estado));
-    
     // Aplicar cambios según el estado
     switch (estado) {
         case NORMAL:
@@ -245,9 +247,20 @@ bool SistemaAlarmas::esExtractorActivo() const {
 }
 
 // Utilidades
+const char* SistemaAlarmas::obtenerNombreEstado(EstadoSistema estado) {
+    switch (estado) {
+        case NORMAL: return "NORMAL";
+        case ADVERTENCIA: return "ADVERTENCIA";
+        case ALARMA: return "ALARMA";
+        case SIN_WIFI: return "SIN_WIFI";
+        case ERROR_SENSOR: return "ERROR_SENSOR";
+        default: return "DESCONOCIDO";
+    }
+}
+
 void SistemaAlarmas::imprimirEstado() const {
     Serial.println("=== ESTADO SISTEMA ALARMAS ===");
-    Serial.println("Estado actual: " + String(estadoActual));
+    Serial.println("Estado actual: " + String(obtenerNombreEstado(estadoActual)));
     Serial.println("Alarma activa: " + String(alarmaActiva ? "Sí" : "No"));
     Serial.println("Extractor activo: " + String(esExtractorActivo() ? "Sí" : "No"));
     Serial.println("Extractor alámbrico: " + String(extractorAlambrico ? "Sí" : "No"));
@@ -1,10 +1,12 @@
 #include "SistemaLogging.h"
+#include "RegistroVuelo.h"
 
 // Definición de colores ANSI
 const String SistemaLogging::COLOR_DEBUG = "\033[36m";    // Cyan
 const String SistemaLogging::COLOR_INFO = "\033[32m";     // Verde
 const String SistemaLogging::COLOR_WARNING = "\033[33m";  // Amarillo
 const String SistemaLogging::COLOR_ERROR = "\033[31m";    // Rojo
+const String SistemaLogging::COLOR_TRANSICION = "\033[35m"; // Magenta
 const String SistemaLogging::COLOR_RESET = "\033[0m";     // Reset
 
 // Definición de componentes
@@ -19,12 +21,32 @@ const String SistemaLogging::COMPONENTE_ENERGIA = "ENERGIA";
 // Singleton
 SistemaLogging* SistemaLoggingSingleton::instancia = nullptr;
 
+// En el orden de SistemaLogging::Componente
+static const char* const NOMBRES_COMPONENTES[SistemaLogging::CANTIDAD_COMPONENTES] = {
+    "SISTEMA", "SENSOR", "WIFI", "MQTT", "ALARMAS", "CONFIG", "ENERGIA", "CONFIG_REMOTA", "ACTUALIZACIONES"
+};
+
 SistemaLogging::SistemaLogging() : 
     nivelActual(INFO), habilitado(true), incluirTimestamp(true), 
-    incluirNivel(true), incluirComponente(true) {
+    incluirNivel(true), incluirComponente(true), cabeza(0), cola(0), tareaSalida(nullptr), cerrojoSalida(nullptr), registroVuelo(nullptr),
+    descartados(0), truncados(0), descartadosInformados(0), ocupacionMaxima(0) {
+    for (int i = 0; i < CAPACIDAD_REGISTROS; i++) {
+        celdas[i].secuencia.store(i, std::memory_order_relaxed);
+    }
+    memset(nivelesComponente, NIVEL_GLOBAL, sizeof(nivelesComponente));
+    cerrojoSalida = xSemaphoreCreateMutex();
 }
 
 SistemaLogging::~SistemaLogging() {
+    if (tareaSalida) {
+        vaciar();
+        vTaskDelete(tareaSalida);
+        tareaSalida = nullptr;
+    }
+    if (cerrojoSalida) {
+        vSemaphoreDelete(cerrojoSalida);
+        cerrojoSalida = nullptr;
+    }
 }
 
 bool SistemaLogging::inicializar() {
@@ -33,6 +55,13 @@ bool SistemaLogging::inicializar() {
     Serial.println("Formato: [TIMESTAMP] [NIVEL] [COMPONENTE] MENSAJE");
     Serial.println("=====================================");
     
+    // Misma prioridad que loop(): la salida por Serial avanza cuando loop()
+    // espera, sin demorar las mediciones
+    if (!tareaSalida && xTaskCreate(tareaEscritura, "logging", 4096, this, 1, &tareaSalida) != pdPASS) {
+        tareaSalida = nullptr;
+        Serial.println("Error al crear tarea de logging, la salida será sincrónica");
+    }
+    
     info(COMPONENTE_SISTEMA, "Sistema de logging inicializado correctamente");
     return true;
 }
@@ -61,96 +90,495 @@ void SistemaLogging::configurarFormato(bool timestamp, bool nivel, bool componen
          ", Componente: " + String(componente ? "Sí" : "No"));
 }
 
+void SistemaLogging::establecerRegistroVuelo(RegistroVuelo* registro) {
+    // Se fija una vez en setup(); desde ahí lo usa la tarea de salida
+    registroVuelo = registro;
+}
+
 void SistemaLogging::debug(const String& componente, const String& mensaje) {
-    if (habilitado && nivelActual <= DEBUG) {
-        imprimirLog(DEBUG, componente, mensaje);
+    if (estaActivo(DEBUG, componente.c_str())) {
+        encolar(DEBUG, componente.c_str(), mensaje.c_str());
     }
 }
 
 void SistemaLogging::info(const String& componente, const String& mensaje) {
-    if (habilitado && nivelActual <= INFO) {
-        imprimirLog(INFO, componente, mensaje);
+    if (estaActivo(INFO, componente.c_str())) {
+        encolar(INFO, componente.c_str(), mensaje.c_str());
     }
 }
 
 void SistemaLogging::warning(const String& componente, const String& mensaje) {
-    if (habilitado && nivelActual <= WARNING) {
-        imprimirLog(WARNING, componente, mensaje);
+    if (estaActivo(WARNING, componente.c_str())) {
+        encolar(WARNING, componente.c_str(), mensaje.c_str());
     }
 }
 
 void SistemaLogging::error(const String& componente, const String& mensaje) {
-    if (habilitado && nivelActual <= ERROR) {
-        imprimirLog(ERROR, componente, mensaje);
+    if (estaActivo(ERROR, componente.c_str())) {
+        encolar(ERROR, componente.c_str(), mensaje.c_str());
     }
 }
 
 void SistemaLogging::debugf(const String& componente, const String& formato, ...) {
-    if (habilitado && nivelActual <= DEBUG) {
-        char buffer[512];
+    if (estaActivo(DEBUG, componente.c_str())) {
         va_list args;
         va_start(args, formato);
-        vsnprintf(buffer, sizeof(buffer), formato.c_str(), args);
+        encolarFormato(DEBUG, componente.c_str(), formato.c_str(), args);
         va_end(args);
-        imprimirLog(DEBUG, componente, String(buffer));
     }
 }
 
 void SistemaLogging::infof(const String& componente, const String& formato, ...) {
-    if (habilitado && nivelActual <= INFO) {
-        char buffer[512];
+    if (estaActivo(INFO, componente.c_str())) {
         va_list args;
         va_start(args, formato);
-        vsnprintf(buffer, sizeof(buffer), formato.c_str(), args);
+        encolarFormato(INFO, componente.c_str(), formato.c_str(), args);
         va_end(args);
-        imprimirLog(INFO, componente, String(buffer));
     }
 }
 
 void SistemaLogging::warningf(const String& componente, const String& formato, ...) {
-    if (habilitado && nivelActual <= WARNING) {
-        char buffer[512];
+    if (estaActivo(WARNING, componente.c_str())) {
         va_list args;
         va_start(args, formato);
-        vsnprintf(buffer, sizeof(buffer), formato.c_str(), args);
+        encolarFormato(WARNING, componente.c_str(), formato.c_str(), args);
         va_end(args);
-        imprimirLog(WARNING, componente, String(buffer));
     }
 }
 
 void SistemaLogging::errorf(const String& componente, const String& formato, ...) {
-    if (habilitado && nivelActual <= ERROR) {
-        char buffer[512];
+    if (estaActivo(ERROR, componente.c_str())) {
         va_list args;
         va_start(args, formato);
-        vsnprintf(buffer, sizeof(buffer), formato.c_str(), args);
+        encolarFormato(ERROR, componente.c_str(), formato.c_str(), args);
         va_end(args);
-        imprimirLog(ERROR, componente, String(buffer));
     }
 }
 
-void SistemaLogging::imprimirLog(NivelLog nivel, const String& componente, const String& mensaje) {
-    String logLine = "";
+bool SistemaLogging::estaActivo(NivelLog nivel, const char* componente) const {
+    if (!habilitado || nivel < NIVEL_LOG_MINIMO) {
+        return false;
+    }
+    
+    int indice = obtenerIndiceComponente(componente);
+    uint8_t minimo = indice >= 0 && nivelesComponente[indice] != NIVEL_GLOBAL ? nivelesComponente[indice] : nivelActual;
+    return nivel >= minimo;
+}
+
+int SistemaLogging::obtenerIndiceComponente(const char* nombre) {
+    // Inicial y longitud distinguen a todos los componentes: queda una sola comparación
+    size_t longitud = strnlen(nombre, LONGITUD_COMPONENTE + 1);
+    int indice = -1;
+    switch (nombre[0]) {
+        case 'S': indice = longitud == 7 ? COMP_SISTEMA : COMP_SENSOR; break;
+        case 'W': indice = COMP_WIFI; break;
+        case 'M': indice = COMP_MQTT; break;
+        case 'A': indice = longitud == 7 ? COMP_ALARMAS : COMP_ACTUALIZACIONES; break;
+        case 'C': indice = longitud == 6 ? COMP_CONFIG : COMP_CONFIG_REMOTA; break;
+        case 'E': indice = COMP_ENERGIA; break;
+    }
+    return indice >= 0 && strcmp(nombre, NOMBRES_COMPONENTES[indice]) == 0 ? indice : -1;
+}
+
+const char* SistemaLogging::obtenerNombreComponente(int indice) {
+    return indice >= 0 && indice < CANTIDAD_COMPONENTES ? NOMBRES_COMPONENTES[indice] : "";
+}
+
+void SistemaLogging::establecerNivelComponente(int indice, uint8_t nivel) {
+    if (indice >= 0 && indice < CANTIDAD_COMPONENTES && (nivel <= ERROR || nivel == NIVEL_GLOBAL)) {
+        nivelesComponente[indice] = nivel;
+    }
+}
+
+uint8_t SistemaLogging::obtenerNivelComponente(int indice) const {
+    return indice >= 0 && indice < CANTIDAD_COMPONENTES ? nivelesComponente[indice] : NIVEL_GLOBAL;
+}
+
+bool SistemaLogging::interpretarNivel(const String& texto, NivelLog& nivel) {
+    if (texto == "DEBUG") {
+        nivel = DEBUG;
+    } else if (texto == "INFO") {
+        nivel = INFO;
+    } else if (texto == "WARNING") {
+        nivel = WARNING;
+    } else if (texto == "ERROR") {
+        nivel = ERROR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool SistemaLogging::interpretarNiveles(const String& especificacion, NivelLog& global, bool& hayGlobal, uint8_t* niveles) {
+    hayGlobal = false;
+    memset(niveles, NIVEL_GLOBAL, CANTIDAD_COMPONENTES);
+    
+    int inicio = 0;
+    while (inicio <= (int)especificacion.length()) {
+        int fin = especificacion.indexOf(',', inicio);
+        if (fin < 0) {
+            fin = especificacion.length();
+        }
+        String parte = especificacion.substring(inicio, fin);
+        parte.trim();
+        
+        NivelLog nivel;
+        int igual = parte.indexOf('=');
+        if (igual < 0) {
+            // Nivel general, una sola vez
+            if (hayGlobal || !interpretarNivel(parte, nivel)) {
+                return false;
+            }
+            global = nivel;
+            hayGlobal = true;
+        } else {
+            String nombre = parte.substring(0, igual);
+            String valor = parte.substring(igual + 1);
+            nombre.trim();
+            valor.trim();
+            int indice = obtenerIndiceComponente(nombre.c_str());
+            if (indice < 0 || !interpretarNivel(valor, nivel)) {
+                return false;
+            }
+            niveles[indice] = nivel;
+        }
+        inicio = fin + 1;
+    }
+    return true;
+}
+
+bool SistemaLogging::esEspecificacionValida(const String& especificacion) {
+    NivelLog global;
+    bool hayGlobal;
+    uint8_t niveles[CANTIDAD_COMPONENTES];
+    return interpretarNiveles(especificacion, global, hayGlobal, niveles);
+}
+
+bool SistemaLogging::aplicarNiveles(const String& especificacion) {
+    NivelLog global;
+    bool hayGlobal;
+    uint8_t niveles[CANTIDAD_COMPONENTES];
+    if (!interpretarNiveles(especificacion, global, hayGlobal, niveles)) {
+        return false;
+    }
+    
+    if (hayGlobal) {
+        nivelActual = global;
+    }
+    memcpy(nivelesComponente, niveles, sizeof(nivelesComponente));
+    return true;
+}
+
+void SistemaLogging::registrar(NivelLog nivel, const char* componente, const String& mensaje) {
+    encolar(nivel, componente, mensaje.c_str());
+}
+
+void SistemaLogging::registrar(NivelLog nivel, const char* componente, const char* mensaje) {
+    encolar(nivel, componente, mensaje);
+}
+
+void SistemaLogging::registrarf(NivelLog nivel, const char* componente, const char* formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    encolarFormato(nivel, componente, formato, args);
+    va_end(args);
+}
+
+SistemaLogging::Registro* SistemaLogging::reservar(uint32_t& posicion) {
+    // Cada celda lleva el turno en que se puede escribir: si coincide con la
+    // posición, el productor que gana el CAS sobre la cabeza se la queda
+    posicion = cabeza.load(std::memory_order_relaxed);
+    for (;;) {
+        Celda& celda = celdas[posicion & (CAPACIDAD_REGISTROS - 1)];
+        int32_t diferencia = (int32_t)(celda.secuencia.load(std::memory_order_acquire) - posicion);
+        if (diferencia == 0) {
+            if (cabeza.compare_exchange_weak(posicion, posicion + 1, std::memory_order_relaxed)) {
+                return &celda.registro;
+            }
+        } else if (diferencia < 0) {
+            // Lleno: la tarea de salida no dio abasto
+            descartados.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            posicion = cabeza.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void SistemaLogging::confirmar(uint32_t posicion) {
+    celdas[posicion & (CAPACIDAD_REGISTROS - 1)].secuencia.store(posicion + 1, std::memory_order_release);
+    
+    // Aproximada: dos productores pueden pisarse el máximo
+    uint32_t ocupacion = posicion + 1 - cola.load(std::memory_order_relaxed);
+    if (ocupacion > ocupacionMaxima.load(std::memory_order_relaxed) && ocupacion <= CAPACIDAD_REGISTROS) {
+        ocupacionMaxima.store(ocupacion, std::memory_order_relaxed);
+    }
+    
+    // Sin tarea (antes de inicializar() o si no se pudo crear) se escribe en el momento
+    if (!tareaSalida) {
+        escribirPendientes();
+    }
+}
+
+void SistemaLogging::encolar(uint8_t nivel, const char* componente, const char* mensaje) {
+    uint32_t posicion;
+    Registro* registro = reservar(posicion);
+    if (!registro) {
+        return;
+    }
+    
+    registro->marcaMs = millis();
+    time_t ahora = time(nullptr);
+    registro->hora = ahora > 1000000000 ? (uint32_t)ahora : 0;
+    registro->nivel = nivel;
+    strncpy(registro->componente, componente, LONGITUD_COMPONENTE);
+    registro->componente[LONGITUD_COMPONENTE] = '\0';
+    
+    size_t longitud = strlen(mensaje);
+    if (longitud >= LONGITUD_MENSAJE) {
+        longitud = LONGITUD_MENSAJE - 1;
+        truncados.fetch_add(1, std::memory_order_relaxed);
+    }
+    memcpy(registro->mensaje, mensaje, longitud);
+    registro->mensaje[longitud] = '\0';
+    
+    confirmar(posicion);
+}
+
+void SistemaLogging::encolarFormato(uint8_t nivel, const char* componente, const char* formato, va_list argumentos) {
+    uint32_t posicion;
+    Registro* registro = reservar(posicion);
+    if (!registro) {
+        return;
+    }
+    
+    // Se formatea directo en el registro, sin buffers intermedios
+    registro->marcaMs = millis();
+    time_t ahora = time(nullptr);
+    registro->hora = ahora > 1000000000 ? (uint32_t)ahora : 0;
+    registro->nivel = nivel;
+    strncpy(registro->componente, componente, LONGITUD_COMPONENTE);
+    registro->componente[LONGITUD_COMPONENTE] = '\0';
+    if (vsnprintf(registro->mensaje, LONGITUD_MENSAJE, formato, argumentos) >= LONGITUD_MENSAJE) {
+        truncados.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    confirmar(posicion);
+}
+
+SistemaLogging::Registro* SistemaLogging::reservarToken(NivelLog nivel, uint32_t token, uint32_t& posicion,
+                                                       EscritorToken& escritor) {
+    Registro* registro = reservar(posicion);
+    if (!registro) {
+        return nullptr;
+    }
+    
+    // Sin hora ni componente: la tabla de tokens trae nivel, componente y formato
+    registro->marcaMs = millis();
+    registro->hora = 0;
+    registro->nivel = nivel | BANDERA_TOKEN;
+    registro->componente[0] = '\0';
+    
+    uint8_t* datos = (uint8_t*)registro->mensaje;
+    for (int i = 0; i < 4; i++) {
+        datos[i] = (uint8_t)(token >> (8 * i));
+    }
+    escritor.datos = datos;
+    escritor.longitud = 4;
+    escritor.truncado = false;
+    return registro;
+}
+
+void SistemaLogging::confirmarToken(uint32_t posicion, Registro* registro, const EscritorToken& escritor) {
+    registro->longitudToken = escritor.longitud;
+    if (escritor.truncado) {
+        truncados.fetch_add(1, std::memory_order_relaxed);
+    }
+    confirmar(posicion);
+}
+
+void SistemaLogging::EscritorToken::agregarVarint(uint64_t valor) {
+    uint8_t bytes[10];
+    int cantidad = 0;
+    do {
+        bytes[cantidad] = (uint8_t)(valor & 0x7F);
+        valor >>= 7;
+        if (valor != 0) {
+            bytes[cantidad] |= 0x80;
+        }
+        cantidad++;
+    } while (valor != 0);
+    
+    if (truncado || longitud + cantidad > LONGITUD_MENSAJE) {
+        truncado = true;
+        return;
+    }
+    memcpy(datos + longitud, bytes, cantidad);
+    longitud += cantidad;
+}
+
+void SistemaLogging::EscritorToken::agregarEntero(int64_t valor) {
+    // Zigzag: los negativos chicos también ocupan pocos bytes
+    agregarVarint(((uint64_t)valor << 1) ^ (uint64_t)(valor >> 63));
+}
+
+void SistemaLogging::EscritorToken::agregarFlotante(float valor) {
+    if (truncado || longitud + sizeof(valor) > LONGITUD_MENSAJE) {
+        truncado = true;
+        return;
+    }
+    memcpy(datos + longitud, &valor, sizeof(valor));     // Xtensa: little endian
+    longitud += sizeof(valor);
+}
+
+void SistemaLogging::EscritorToken::agregarTexto(const char* texto) {
+    if (truncado || longitud + 1 > LONGITUD_MENSAJE) {
+        truncado = true;
+        return;
+    }
+    
+    // Lo que queda del registro es menor que 128: la longitud ocupa un byte
+    size_t disponible = LONGITUD_MENSAJE - longitud - 1;
+    size_t largo = texto ? strlen(texto) : 0;
+    if (largo > disponible) {
+        largo = disponible;
+        truncado = true;
+    }
+    datos[longitud++] = (uint8_t)largo;
+    memcpy(datos + longitud, texto, largo);
+    longitud += largo;
+}
+
+bool SistemaLogging::escribirSiguiente() {
+    uint32_t posicion = cola.load(std::memory_order_relaxed);
+    Celda& celda = celdas[posicion & (CAPACIDAD_REGISTROS - 1)];
+    if ((int32_t)(celda.secuencia.load(std::memory_order_acquire) - (posicion + 1)) < 0) {
+        return false;           // Vacío, o el productor todavía está copiando
+    }
+    
+    escribirRegistro(celda.registro);
+    
+    // La celda vuelve a estar libre una vuelta más adelante
+    celda.secuencia.store(posicion + CAPACIDAD_REGISTROS, std::memory_order_release);
+    cola.store(posicion + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void SistemaLogging::escribirPendientes() {
+    // Sin tarea de salida varios productores (tarea del ADC, callbacks de
+    // MQTT, loop()) llegan acá a la vez; escribirSiguiente() admite un solo consumidor.
+    // Sin cerrojo no se escribe: los registros quedan en el buffer
+    if (!cerrojoSalida || xSemaphoreTake(cerrojoSalida, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    while (escribirSiguiente()) {
+    }
+    xSemaphoreGive(cerrojoSalida);
+}
+
+void SistemaLogging::escribirRegistro(const Registro& registro) {
+    static const char* const NIVELES[] = {"DEBUG", "INFO ", "WARN ", "ERROR", "TRANS"};
+    static const char* const COLORES[] = {"\033[36m", "\033[32m", "\033[33m", "\033[31m", "\033[35m"};
+    
+    if (registro.nivel == NIVEL_SEPARADOR) {
+        Serial.println(registro.mensaje);
+        return;
+    }
+    
+    // Advertencias, errores y transiciones también van a flash, fuera del camino de quien registra
+    uint8_t nivel = registro.nivel & ~BANDERA_TOKEN;
+    if (registroVuelo && nivel >= WARNING) {
+        if (registro.nivel & BANDERA_TOKEN) {
+            registroVuelo->agregarToken(nivel, registro.marcaMs, (const uint8_t*)registro.mensaje, registro.longitudToken);
+        } else {
+            registroVuelo->agregarTexto(nivel, registro.marcaMs, registro.componente, registro.mensaje);
+        }
+    }
+    
+    if (registro.nivel & BANDERA_TOKEN) {
+        // Trama: inicio, longitud, identificador, marca en ms y argumentos
+        uint8_t trama[2 + LONGITUD_MENSAJE + 5];
+        size_t longitud = 2;
+        memcpy(trama + longitud, registro.mensaje, 4);
+        longitud += 4;
+        uint32_t marca = registro.marcaMs;
+        while (marca >= 0x80) {
+            trama[longitud++] = (uint8_t)(marca | 0x80);
+            marca >>= 7;
+        }
+        trama[longitud++] = (uint8_t)marca;
+        memcpy(trama + longitud, registro.mensaje + 4, registro.longitudToken - 4);
+        longitud += registro.longitudToken - 4;
+        
+        trama[0] = INICIO_TRAMA;
+        trama[1] = (uint8_t)(longitud - 2);
+        Serial.write(trama, longitud);
+        return;
+    }
+    
+    char linea[LONGITUD_MENSAJE + 64];
+    int longitud = 0;
     
     // Timestamp
     if (incluirTimestamp) {
-        logLine += "[" + obtenerTimestamp() + "] ";
+        if (registro.hora != 0) {
+            time_t hora = registro.hora;
+            struct tm tiempoInfo;
+            localtime_r(&hora, &tiempoInfo);
+            longitud += strftime(linea, sizeof(linea), "[%H:%M:%S] ", &tiempoInfo);
+        } else {
+            longitud += snprintf(linea, sizeof(linea), "[%lus] ", (unsigned long)(registro.marcaMs / 1000));
+        }
     }
     
     // Nivel
-    if (incluirNivel) {
-        logLine += "[" + obtenerColorNivel(nivel) + obtenerNivelString(nivel) + COLOR_RESET + "] ";
+    if (incluirNivel && registro.nivel <= TRANSICION) {
+        longitud += snprintf(linea + longitud, sizeof(linea) - longitud, "[%s%s\033[0m] ",
+                             COLORES[registro.nivel], NIVELES[registro.nivel]);
     }
     
     // Componente
     if (incluirComponente) {
-        logLine += "[" + componente + "] ";
+        longitud += snprintf(linea + longitud, sizeof(linea) - longitud, "[%s] ", registro.componente);
     }
     
     // Mensaje
-    logLine += mensaje;
+    snprintf(linea + longitud, sizeof(linea) - longitud, "%s", registro.mensaje);
+    Serial.println(linea);
+}
+
+void SistemaLogging::tareaEscritura(void* parametro) {
+    SistemaLogging* logging = static_cast<SistemaLogging*>(parametro);
     
-    Serial.println(logLine);
+    for (;;) {
+        // Con el cerrojo: un productor pudo empezar a escribir antes de crearse la tarea
+        logging->escribirPendientes();
+        
+        // Descartes desde la última vez: se informan en la misma salida
+        uint32_t descartados = logging->descartados.load(std::memory_order_relaxed);
+        if (descartados != logging->descartadosInformados) {
+            Serial.println("[LOG] " + String(descartados - logging->descartadosInformados) +
+                           " registro(s) descartado(s) por buffer lleno");
+            logging->descartadosInformados = descartados;
+        }
+        
+        vTaskDelay(pdMS_TO_TICKS(PERIODO_SALIDA_MS));
+    }
+}
+
+void SistemaLogging::vaciar(unsigned long timeoutMs) {
+    unsigned long inicio = millis();
+    while (obtenerRegistrosPendientes() > 0 && millis() - inicio < timeoutMs) {
+        if (!tareaSalida) {
+            escribirPendientes();
+        } else {
+            delay(PERIODO_SALIDA_MS);
+        }
+    }
+    
+    if (registroVuelo) {
+        registroVuelo->volcar();
+    }
 }
 
 void SistemaLogging::logEstadoSistema() {
@@ -160,6 +588,18 @@ void SistemaLogging::logEstadoSistema() {
     info(COMPONENTE_SISTEMA, "Versión: 1.0.0");
     info(COMPONENTE_SISTEMA, "Memoria libre: " + String(ESP.getFreeHeap()) + " bytes");
     info(COMPONENTE_SISTEMA, "Frecuencia CPU: " + String(getCpuFrequencyMhz()) + " MHz");
+    info(COMPONENTE_SISTEMA, "Buffer de log: ocupación máxima " + String(obtenerOcupacionMaxima()) + "/" +
+         String(CAPACIDAD_REGISTROS) + ", " + String(obtenerRegistrosDescartados()) + " descartado(s), " +
+         String(obtenerRegistrosTruncados()) + " truncado(s)");
+    
+    String excepciones = "";
+    for (int i = 0; i < CANTIDAD_COMPONENTES; i++) {
+        if (nivelesComponente[i] != NIVEL_GLOBAL) {
+            excepciones += " " + String(NOMBRES_COMPONENTES[i]) + "=" + obtenerNivelString((NivelLog)nivelesComponente[i]);
+        }
+    }
+    info(COMPONENTE_SISTEMA, "Nivel de logging: " + obtenerNivelString(nivelActual) +
+         (excepciones.isEmpty() ? String("") : ", por componente:" + excepciones));
 }
 
 void SistemaLogging::logEstadoSensor() {
@@ -237,6 +677,7 @@ String SistemaLogging::obtenerNivelString(NivelLog nivel) const {
         case INFO: return "INFO ";
         case WARNING: return "WARN ";
         case ERROR: return "ERROR";
+        case TRANSICION: return "TRANS";
         default: return "UNKNOWN";
     }
 }
@@ -247,15 +688,17 @@ String SistemaLogging::obtenerColorNivel(NivelLog nivel) const {
         case INFO: return COLOR_INFO;
         case WARNING: return COLOR_WARNING;
         case ERROR: return COLOR_ERROR;
+        case TRANSICION: return COLOR_TRANSICION;
         default: return COLOR_RESET;
     }
 }
 
 void SistemaLogging::imprimirSeparador(const String& titulo) {
+    // Por el buffer, para que no se adelante a los registros pendientes
     if (titulo.isEmpty()) {
-        Serial.println("========================================");
+        encolar(NIVEL_SEPARADOR, "", "========================================");
     } else {
-        Serial.println("========== " + titulo + " ==========");
+        encolar(NIVEL_SEPARADOR, "", ("========== " + titulo + " ==========").c_str());
     }
 }
 
@@ -280,6 +723,22 @@ bool SistemaLogging::incluyeComponente() const {
     return incluirComponente;
 }
 
+uint32_t SistemaLogging::obtenerRegistrosDescartados() const {
+    return descartados.load(std::memory_order_relaxed);
+}
+
+uint32_t SistemaLogging::obtenerRegistrosTruncados() const {
+    return truncados.load(std::memory_order_relaxed);
+}
+
+uint32_t SistemaLogging::obtenerOcupacionMaxima() const {
+    return ocupacionMaxima.load(std::memory_order_relaxed);
+}
+
+int SistemaLogging::obtenerRegistrosPendientes() const {
+    return (int)(cabeza.load(std::memory_order_relaxed) - cola.load(std::memory_order_relaxed));
+}
+
 // Implementación del Singleton
 SistemaLogging& SistemaLoggingSingleton::getInstance() {
     if (instancia == nullptr) {
@@ -358,6 +358,7 @@ bool SistemaOTA::verificarIntegridadFirmware() {
 
 void SistemaOTA::reiniciarConNuevaVersion() {
     Serial.println("Reiniciando con nueva versión...");
+    SistemaLoggingSingleton::getInstance().vaciar();
     ESP.restart();
 }
 
@@ -433,6 +434,7 @@ bool SistemaOTA::hacerRollback() {
     
     Serial.println("Rollback completado. Reiniciando...");
     delay(2000);
+    SistemaLoggingSingleton::getInstance().vaciar();
     ESP.restart();
     
     return true;
@@ -0,0 +1,329 @@
+#include "TransporteAsync.h"
+
+#if TRANSPORTE_ASYNC_MQTT
+
+TransporteAsync::TransporteAsync() :
+    eventos(nullptr), puerto(1883), conectando(false), conectado(false), inicioConexion(0),
+    ultimoMotivo(0), callbackMensaje(nullptr), entrantesDescartados(0), primeroEntrante(0), cantidadEntrantes(0), finEntrada(0), descartandoEntrada(false) {
+    host[0] = '\0';
+    idCliente[0] = '\0';
+
+    eventos = xQueueCreate(2 * VentanaQoS::TAMANO_MAXIMO, sizeof(Evento));
+
+    // Estos callbacks corren en la tarea de AsyncTCP: solo encolan
+    cliente.onConnect([this](bool sesionPresente) {
+        Evento evento = {EVENTO_CONECTADO, (uint8_t)sesionPresente, 0};
+        xQueueSend(eventos, &evento, 0);
+    });
+    cliente.onDisconnect([this](AsyncMqttClientDisconnectReason motivo) {
+        Evento evento = {EVENTO_DESCONECTADO, (uint8_t)motivo, 0};
+        xQueueSend(eventos, &evento, 0);
+    });
+    cliente.onPublish([this](uint16_t idPaquete) {
+        // Si la cola está llena el PUBACK se pierde y el mensaje se reenvía
+        // al vencer TIEMPO_MAXIMO_PUBACK_MS: se mantiene "al menos una vez"
+        Evento evento = {EVENTO_PUBACK, 0, idPaquete};
+        xQueueSend(eventos, &evento, 0);
+    });
+    cliente.onMessage([this](char* topic, char* payload, AsyncMqttClientMessageProperties propiedades,
+                             size_t longitud, size_t indice, size_t total) {
+        recibirMensaje(topic, payload, longitud, indice, total);
+    });
+}
+
+TransporteAsync::~TransporteAsync() {
+    cliente.disconnect(true);
+    if (eventos) {
+        vQueueDelete(eventos);
+    }
+}
+
+const char* TransporteAsync::obtenerNombre() const {
+    return "AsyncMqttClient";
+}
+
+void TransporteAsync::configurarServidor(const char* nuevoHost, uint16_t nuevoPuerto) {
+    // AsyncMqttClient guarda el puntero: se usa una copia propia
+    strncpy(host, nuevoHost, sizeof(host) - 1);
+    host[sizeof(host) - 1] = '\0';
+    puerto = nuevoPuerto;
+    cliente.setServer(host, puerto);
+}
+
+bool TransporteAsync::conectar(const char* id) {
+    if (conectado) {
+        return true;
+    }
+
+    strncpy(idCliente, id, sizeof(idCliente) - 1);
+    idCliente[sizeof(idCliente) - 1] = '\0';
+    cliente.setClientId(idCliente);
+
+    // Sesión persistente: el broker conserva suscripciones y espera los reenvíos
+    cliente.setCleanSession(false);
+
+    conectando = true;
+    inicioConexion = millis();
+    cliente.connect();
+    return false;
+}
+
+bool TransporteAsync::estaConectando() const {
+    return conectando;
+}
+
+bool TransporteAsync::estaConectado() {
+    return conectado;
+}
+
+void TransporteAsync::desconectar() {
+    // Los mensajes sin confirmar se conservan para reenviarlos
+    conectando = false;
+    conectado = false;
+    cliente.disconnect();
+}
+
+int TransporteAsync::obtenerEstado() {
+    return ultimoMotivo;
+}
+
+bool TransporteAsync::suscribir(const char* topic, uint8_t qos) {
+    return conectado && cliente.subscribe(topic, qos > 1 ? 1 : qos) != 0;
+}
+
+bool TransporteAsync::publicar(const char* topic, const uint8_t* datos, size_t longitud, uint8_t qos, bool retener,
+                               uint32_t identificador) {
+    if (!conectado) {
+        return false;
+    }
+
+    if (qos == 0) {
+        if (cliente.publish(topic, 0, retener, (const char*)datos, longitud) == 0) {
+            return false;
+        }
+        informarEntrega(identificador, true);
+        return true;
+    }
+
+    // QoS 1: hace falta lugar en la ventana y memoria para la copia
+    if (!ventana.hayLugar(strlen(topic), longitud)) {
+        ventana.registrarRechazo();
+        return false;
+    }
+
+    uint16_t idPaquete = cliente.publish(topic, 1, retener, (const char*)datos, longitud);
+    if (idPaquete == 0) {
+        return false;
+    }
+    return ventana.agregar(idPaquete, identificador, topic, datos, longitud, retener, millis());
+}
+
+bool TransporteAsync::puedePublicar(const char* topic, size_t longitud, uint8_t qos) {
+    return qos == 0 || ventana.hayLugar(strlen(topic), longitud);
+}
+
+void TransporteAsync::establecerCallback(CallbackMensaje callback) {
+    callbackMensaje = callback;
+}
+
+void TransporteAsync::procesar() {
+    Evento evento;
+    while (xQueueReceive(eventos, &evento, 0) == pdTRUE) {
+        switch (evento.tipo) {
+            case EVENTO_CONECTADO:
+                conectando = false;
+                conectado = true;
+                reenviarPendientes(evento.dato != 0);
+                break;
+
+            case EVENTO_DESCONECTADO:
+                conectando = false;
+                conectado = false;
+                ultimoMotivo = evento.dato;
+                break;
+
+            case EVENTO_PUBACK: {
+                uint32_t identificador;
+                if (ventana.confirmar(evento.idPaquete, identificador)) {
+                    informarEntrega(identificador, true);
+                }
+                break;
+            }
+        }
+    }
+
+    unsigned long ahora = millis();
+
+    // Intento de conexión sin respuesta
+    if (conectando && ahora - inicioConexion >= TIEMPO_MAXIMO_CONEXION_MS) {
+        Serial.println("Timeout de conexión MQTT asíncrona");
+        conectando = false;
+        ultimoMotivo = -1;
+        cliente.disconnect(true);
+    }
+
+    // PUBACK demorado: la conexión se da por perdida y se reenvía al reconectar
+    if (conectado && ventana.estaVencida(ahora, TIEMPO_MAXIMO_PUBACK_MS)) {
+        Serial.println("Sin PUBACK del paquete " + String(ventana.obtenerIdMasAntiguo()) + ", reconectando");
+        conectado = false;
+        cliente.disconnect(true);
+    }
+
+    atenderEntrantes();
+}
+
+uint8_t TransporteAsync::obtenerQoSMaximo() const {
+    return 1;
+}
+
+void TransporteAsync::configurarVentana(uint8_t tamano) {
+    ventana.configurar(tamano);
+}
+
+uint8_t TransporteAsync::obtenerEnVuelo() const {
+    return ventana.obtenerCantidad();
+}
+
+void TransporteAsync::imprimirEstado() const {
+    Serial.println("Ventana QoS 1: " + String(ventana.obtenerCantidad()) + "/" + String(ventana.obtenerTamano()) +
+                   " en vuelo, " + String(ventana.obtenerConfirmados()) + " confirmado(s), " +
+                   String(ventana.obtenerReenviados()) + " reenviado(s), " + String(ventana.obtenerRechazados()) +
+                   " rechazado(s)");
+    if (entrantesDescartados > 0) {
+        Serial.println("Mensajes entrantes descartados: " + String(entrantesDescartados));
+    }
+}
+
+void TransporteAsync::reenviarPendientes(bool sesionPresente) {
+    uint8_t reenviadosAhora = 0;
+    for (uint8_t i = 0; i < ventana.obtenerCantidad(); i++) {
+        VentanaQoS::Pendiente pendiente;
+        if (!ventana.obtenerPendiente(i, pendiente)) {
+            continue;
+        }
+
+        // Con sesión se repite el identificador y se marca DUP; sin sesión es un envío nuevo
+        const char* datos = (const char*)pendiente.datos;
+        uint16_t idPaquete = sesionPresente
+            ? cliente.publish(pendiente.topic, 1, pendiente.retener, datos, pendiente.longitud, true,
+                              pendiente.idPaquete)
+            : cliente.publish(pendiente.topic, 1, pendiente.retener, datos, pendiente.longitud);
+        if (idPaquete != 0) {
+            ventana.registrarReenvio(i, idPaquete, millis());
+            reenviadosAhora++;
+        }
+    }
+
+    if (reenviadosAhora > 0) {
+        Serial.println("Reenviados " + String(reenviadosAhora) + " mensaje(s) QoS 1 sin confirmar");
+    }
+}
+
+void TransporteAsync::recibirMensaje(const char* topic, const char* payload, size_t longitud, size_t indice, size_t total) {
+    // Tarea de AsyncTCP: mensajes en fragmentos (indice/total) se arman en el anillo
+    if (indice == 0) {
+        size_t longitudTopic = strlen(topic);
+        size_t necesario = longitudTopic + 1 + total + 1;
+        descartandoEntrada = total > TAMANO_MENSAJE_ENTRANTE || necesario > TAMANO_MEMORIA_ENTRADA;
+
+        // Anillo lleno: esperar a que loop() lo vacíe antes de descartar
+        uint32_t inicio = 0;
+        unsigned long inicioEspera = millis();
+        while (!descartandoEntrada && !reservarEntrada(necesario, inicio)) {
+            if (millis() - inicioEspera >= ESPERA_MAXIMA_ENTRADA_MS) {
+                descartandoEntrada = true;
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(5));
+        }
+        if (descartandoEntrada) {
+            entrantesDescartados++;
+            return;
+        }
+
+        armado.inicio = inicio;
+        armado.longitudTopic = longitudTopic;
+        armado.longitud = total;
+        memcpy(memoriaEntrada + inicio, topic, longitudTopic + 1);
+        finEntrada = inicio + necesario;
+    }
+
+    if (descartandoEntrada || indice + longitud > armado.longitud) {
+        return;
+    }
+
+    uint8_t* datos = memoriaEntrada + armado.inicio + armado.longitudTopic + 1;
+    memcpy(datos + indice, payload, longitud);
+
+    // Completo: recién ahora lo ve loop()
+    if (indice + longitud == total) {
+        datos[total] = '\0';
+        portENTER_CRITICAL(&cerrojoEntrada);
+        entrantes[(primeroEntrante + cantidadEntrantes) % MAXIMO_ENTRANTES] = armado;
+        cantidadEntrantes++;
+        portEXIT_CRITICAL(&cerrojoEntrada);
+    }
+}
+
+bool TransporteAsync::reservarEntrada(size_t longitud, uint32_t& inicio) {
+    // Tarea de AsyncTCP. loop() solo libera lugar, así que la foto alcanza
+    portENTER_CRITICAL(&cerrojoEntrada);
+    uint8_t cantidad = cantidadEntrantes;
+    uint32_t ocupadoDesde = entrantes[primeroEntrante].inicio;
+    portEXIT_CRITICAL(&cerrojoEntrada);
+
+    if (cantidad >= MAXIMO_ENTRANTES) {
+        return false;
+    }
+    if (cantidad == 0) {
+        inicio = 0;
+        return true;
+    }
+
+    if (finEntrada > ocupadoDesde) {
+        // Sin vuelta: después del último o, si no entra, al principio
+        if (finEntrada + longitud <= TAMANO_MEMORIA_ENTRADA) {
+            inicio = finEntrada;
+            return true;
+        }
+        if (longitud < ocupadoDesde) {
+            inicio = 0;
+            return true;
+        }
+        return false;
+    }
+
+    // Con vuelta: solo el hueco hasta el más antiguo
+    if (finEntrada + longitud < ocupadoDesde) {
+        inicio = finEntrada;
+        return true;
+    }
+    return false;
+}
+
+void TransporteAsync::atenderEntrantes() {
+    // Todos los completos, en orden de llegada. El manejador puede publicar;
+    // el mensaje sigue ocupando su lugar hasta que vuelve
+    while (true) {
+        portENTER_CRITICAL(&cerrojoEntrada);
+        bool hay = cantidadEntrantes > 0;
+        Entrante entrante = entrantes[primeroEntrante];
+        portEXIT_CRITICAL(&cerrojoEntrada);
+        if (!hay) {
+            break;
+        }
+
+        if (callbackMensaje) {
+            char* topic = (char*)(memoriaEntrada + entrante.inicio);
+            uint8_t* datos = memoriaEntrada + entrante.inicio + entrante.longitudTopic + 1;
+            callbackMensaje(topic, datos, entrante.longitud);
+        }
+
+        portENTER_CRITICAL(&cerrojoEntrada);
+        primeroEntrante = (primeroEntrante + 1) % MAXIMO_ENTRANTES;
+        cantidadEntrantes--;
+        portEXIT_CRITICAL(&cerrojoEntrada);
+    }
+}
+
+#endif
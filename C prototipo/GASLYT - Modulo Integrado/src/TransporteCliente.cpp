@@ -0,0 +1,218 @@
+#include "TransporteCliente.h"
+
+TransporteCliente::TransporteCliente(Client& red, uint16_t tamanoBuffer) :
+    red(red), bufferEntrada((uint8_t*)malloc(tamanoBuffer)),
+    bufferSalida((uint8_t*)malloc(tamanoBuffer)), sesion(bufferEntrada, tamanoBuffer, bufferSalida, tamanoBuffer),
+    puerto(1883), redAbierta(false), callbackMensaje(nullptr), tareaConexion(nullptr),
+    apertura(APERTURA_INACTIVA), aperturaCancelada(false) {
+    host[0] = '\0';
+    idCliente[0] = '\0';
+    if (!bufferEntrada || !bufferSalida) {
+        // Sin buffers la sesión no arranca: conectar() informa el error
+        Serial.println("Error al reservar buffers MQTT de " + String(tamanoBuffer) + " bytes");
+    }
+    sesion.establecerCallbacks(alRecibir, alEntregar, this);
+}
+
+TransporteCliente::~TransporteCliente() {
+    // La tarea usa la red y los buffers: esperar a que termine la apertura
+    while (apertura.load(std::memory_order_acquire) == APERTURA_EN_CURSO) {
+        delay(10);
+    }
+    if (tareaConexion) {
+        vTaskDelete(tareaConexion);
+    }
+    desconectar();
+    free(bufferEntrada);
+    free(bufferSalida);
+}
+
+const char* TransporteCliente::obtenerNombre() const {
+    return "ClienteMQTT";
+}
+
+void TransporteCliente::configurarServidor(const char* nuevoHost, uint16_t nuevoPuerto) {
+    strncpy(host, nuevoHost, sizeof(host) - 1);
+    host[sizeof(host) - 1] = '\0';
+    puerto = nuevoPuerto;
+}
+
+bool TransporteCliente::conectar(const char* id) {
+    if (apertura.load(std::memory_order_acquire) != APERTURA_INACTIVA) {
+        aperturaCancelada = false;
+        return false;
+    }
+    if (sesion.obtenerEstado() != SesionMQTT::DESCONECTADA) {
+        return sesion.obtenerEstado() == SesionMQTT::CONECTADA;
+    }
+
+    strncpy(idCliente, id, sizeof(idCliente) - 1);
+    idCliente[sizeof(idCliente) - 1] = '\0';
+
+    // Misma prioridad que loop(): abre la red mientras loop() espera
+    if (!tareaConexion &&
+        xTaskCreate(tareaApertura, "conexionMQTT", PILA_TAREA_CONEXION, this, 1, &tareaConexion) != pdPASS) {
+        tareaConexion = nullptr;
+        Serial.println("Error al crear tarea de conexión MQTT, la apertura será sincrónica");
+    }
+
+    aperturaCancelada = false;
+    if (tareaConexion) {
+        apertura.store(APERTURA_EN_CURSO, std::memory_order_release);
+        xTaskNotifyGive(tareaConexion);
+    } else {
+        apertura.store(red.connect(host, puerto) ? APERTURA_LISTA : APERTURA_FALLIDA, std::memory_order_release);
+        atenderApertura();
+    }
+
+    // El resultado llega en procesar(): mientras tanto estaConectando()
+    return false;
+}
+
+bool TransporteCliente::estaConectando() const {
+    return apertura.load(std::memory_order_acquire) != APERTURA_INACTIVA ||
+           sesion.obtenerEstado() == SesionMQTT::ESPERANDO_CONNACK;
+}
+
+bool TransporteCliente::estaConectado() {
+    return sesion.obtenerEstado() == SesionMQTT::CONECTADA;
+}
+
+void TransporteCliente::desconectar() {
+    // Una apertura en curso no se interrumpe: se cierra al terminar
+    if (apertura.load(std::memory_order_acquire) != APERTURA_INACTIVA) {
+        aperturaCancelada = true;
+    }
+
+    // Los mensajes sin confirmar se conservan para reenviarlos
+    sesion.terminar();
+    if (redAbierta) {
+        red.stop();
+        redAbierta = false;
+    }
+}
+
+int TransporteCliente::obtenerEstado() {
+    return sesion.obtenerCodigo();
+}
+
+bool TransporteCliente::suscribir(const char* topic, uint8_t qos) {
+    return sesion.suscribir(topic, qos, millis());
+}
+
+bool TransporteCliente::publicar(const char* topic, const uint8_t* datos, size_t longitud, uint8_t qos, bool retener,
+                                 uint32_t identificador) {
+    return sesion.publicar(topic, datos, longitud, qos, retener, identificador, millis());
+}
+
+bool TransporteCliente::puedePublicar(const char* topic, size_t longitud, uint8_t qos) {
+    return sesion.puedePublicar(topic, longitud, qos);
+}
+
+void TransporteCliente::establecerCallback(CallbackMensaje callback) {
+    callbackMensaje = callback;
+}
+
+void TransporteCliente::procesar() {
+    atenderApertura();
+
+    if (sesion.obtenerEstado() != SesionMQTT::DESCONECTADA && !red.connected()) {
+        sesion.perderConexion();
+    }
+
+    uint32_t reenviadosAntes = sesion.obtenerVentana().obtenerReenviados();
+    sesion.procesar(millis());
+
+    uint32_t reenviados = sesion.obtenerVentana().obtenerReenviados() - reenviadosAntes;
+    if (reenviados > 0) {
+        Serial.println("Reenviados " + String(reenviados) + " mensaje(s) QoS 1 sin confirmar");
+    }
+
+    // Cerrada por la sesión (PUBACK o keep alive vencidos, CONNACK rechazado): liberar el socket
+    if (sesion.obtenerEstado() == SesionMQTT::DESCONECTADA && redAbierta) {
+        Serial.println("Sesión MQTT cerrada: " + String(sesion.obtenerCodigo()));
+        red.stop();
+        redAbierta = false;
+    }
+}
+
+uint8_t TransporteCliente::obtenerQoSMaximo() const {
+    return 1;
+}
+
+void TransporteCliente::configurarVentana(uint8_t tamano) {
+    sesion.configurarVentana(tamano);
+}
+
+uint8_t TransporteCliente::obtenerEnVuelo() const {
+    return sesion.obtenerVentana().obtenerCantidad();
+}
+
+void TransporteCliente::imprimirEstado() const {
+    const VentanaQoS& ventana = sesion.obtenerVentana();
+    Serial.println("Ventana QoS 1: " + String(ventana.obtenerCantidad()) + "/" + String(ventana.obtenerTamano()) +
+                   " en vuelo, " + String(ventana.obtenerConfirmados()) + " confirmado(s), " +
+                   String(ventana.obtenerReenviados()) + " reenviado(s), " + String(ventana.obtenerRechazados()) +
+                   " rechazado(s)");
+    if (sesion.obtenerEntrantesDescartados() > 0) {
+        Serial.println("Mensajes entrantes descartados: " + String(sesion.obtenerEntrantesDescartados()));
+    }
+}
+
+size_t TransporteCliente::escribir(const uint8_t* datos, size_t longitud) {
+    return red.write(datos, longitud);
+}
+
+int TransporteCliente::leer(uint8_t* destino, size_t capacidad) {
+    // Solo lo ya recibido: read() con available() > 0 no espera
+    int disponibles = red.available();
+    if (disponibles <= 0) {
+        return 0;
+    }
+    int leidos = red.read(destino, (size_t)disponibles < capacidad ? (size_t)disponibles : capacidad);
+    return leidos > 0 ? leidos : 0;
+}
+
+void TransporteCliente::tareaApertura(void* parametro) {
+    TransporteCliente* transporte = static_cast<TransporteCliente*>(parametro);
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        bool abierta = transporte->red.connect(transporte->host, transporte->puerto);
+        transporte->apertura.store(abierta ? APERTURA_LISTA : APERTURA_FALLIDA, std::memory_order_release);
+    }
+}
+
+void TransporteCliente::atenderApertura() {
+    uint8_t resultado = apertura.load(std::memory_order_acquire);
+    if (resultado != APERTURA_LISTA && resultado != APERTURA_FALLIDA) {
+        return;
+    }
+    apertura.store(APERTURA_INACTIVA, std::memory_order_relaxed);
+
+    if (resultado == APERTURA_FALLIDA) {
+        sesion.perderConexion(SesionMQTT::ESTADO_CONEXION_FALLIDA);
+        return;
+    }
+    if (aperturaCancelada) {
+        red.stop();
+        return;
+    }
+
+    redAbierta = true;
+    if (!sesion.iniciar(*this, idCliente, millis())) {
+        red.stop();
+        redAbierta = false;
+    }
+}
+
+void TransporteCliente::alRecibir(void* contexto, char* topic, uint8_t* datos, unsigned int longitud) {
+    TransporteCliente* transporte = (TransporteCliente*)contexto;
+    if (transporte->callbackMensaje) {
+        transporte->callbackMensaje(topic, datos, longitud);
+    }
+}
+
+void TransporteCliente::alEntregar(void* contexto, uint32_t identificador) {
+    ((TransporteCliente*)contexto)->informarEntrega(identificador, true);
+}
@@ -274,15 +274,24 @@ bool WiFiManagerCustom::sincronizarHora() {
 }
 
 String WiFiManagerCustom::obtenerHoraActual() const {
-    time_t ahora = time(nullptr);
-    struct tm* tiempoInfo = localtime(&ahora);
-    
     char buffer[30];
-    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", tiempoInfo);
+    obtenerHoraActual(buffer, sizeof(buffer));
     
     return String(buffer);
 }
 
+size_t WiFiManagerCustom::obtenerHoraActual(char* destino, size_t capacidad) const {
+    time_t ahora = time(nullptr);
+    struct tm tiempoInfo;
+    localtime_r(&ahora, &tiempoInfo);
+    
+    size_t longitud = strftime(destino, capacidad, "%Y-%m-%d %H:%M:%S", &tiempoInfo);
+    if (longitud == 0 && capacidad > 0) {
+        destino[0] = '\0';
+    }
+    return longitud;
+}
+
 unsigned long WiFiManagerCustom::obtenerTimestamp() const {
     return time(nullptr);
 }
@@ -1,9 +1,14 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include "ConfigManager.h"
-#include "GasSensor.h"
+#include "GasSensorArray.h"
+#include "MuestreoAdaptativo.h"
+#include "PublicacionExcepcion.h"
+#include "ColaPersistente.h"
+#include "RegistroVuelo.h"
 #include "WiFiManager.h"
 #include "MQTTManager.h"
+#include "PayloadMQTT.h"
 #include "SistemaAlarmas.h"
 #include "SistemaLogging.h"
 #include "ConfiguracionRemota.h"
@@ -13,7 +18,11 @@
 
 // Instancias de las clases principales
 ConfigManager* configManager;
-GasSensor* sensorGas;
+GasSensorArray* sensoresGas;
+MuestreoAdaptativo* muestreo;
+PublicacionExcepcion* publicacionExcepcion;
+ColaPersistente* colaPersistente;
+RegistroVuelo* registroVuelo;
 WiFiManagerCustom* wifiManager;
 MQTTManager* mqttManager;
 SistemaAlarmas* sistemaAlarmas;
@@ -28,13 +37,76 @@ unsigned long ultimaMedicion = 0;
 unsigned long ultimaVerificacionWifi = 0;
 unsigned long ultimaVerificacionMQTT = 0;
 unsigned long ultimaMetadata = 0;
+unsigned long ultimoDrenajeCola = 0;
+unsigned long ultimaSubidaVuelo = 0;
+
+// Lo que espera confirmación de entrega del transporte (0 = nada): un
+// registro de la cola persistente y un fragmento del registro de vuelo
+uint32_t registroEnEnvio = 0;
+unsigned long inicioEnvioRegistro = 0;
+uint32_t fragmentoEnEnvio = 0;
+unsigned long inicioEnvioFragmento = 0;
+uint32_t numeroFragmento = 0;
+const uint32_t MARCA_FRAGMENTO = 0x80000000UL;           // Los registros de la cola son direcciones de flash
+
 bool primeraConexion = true;
 bool alarmaActiva = false;
+bool advertenciaPredictiva = false;
+
+// Numeración de mensajes: (arranque, secuencia) permite detectar huecos
+uint32_t secuenciaLecturas = 0;
+uint32_t secuenciaAlarmas = 0;
+
+// Documentos de publicación reservados una sola vez: armar un mensaje no usa memoria dinámica
+StaticJsonDocument<2048> documentoLectura;
+StaticJsonDocument<1024> documentoEvento;   // Alarmas, metadata y calibración
 
 // Configuración de tiempos
 const unsigned long INTERVALO_VERIFICACION_WIFI = 30000;  // 30 segundos
 const unsigned long INTERVALO_VERIFICACION_MQTT = 10000;  // 10 segundos
 const unsigned long INTERVALO_METADATA = 300000;          // 5 minutos
+const unsigned long INTERVALO_DRENAJE_COLA = 250;         // 4 mensajes por segundo
+const unsigned long INTERVALO_SUBIDA_VUELO = 500;         // 2 fragmentos por segundo
+const unsigned long TIEMPO_MAXIMO_ENTREGA = 120000;       // Sin confirmación de entrega se vuelve a ofrecer
+
+// Prototipos de funciones
+void realizarMedicion();
+void enviarLectura(bool alarma);
+void publicarLectura(bool alarma, int canalCritico, float concentracion, PublicacionExcepcion::Motivo motivo);
+void enviarAlarma(int canal);
+void enviarAlertaPredictiva(int canal);
+void enviarMetadataInicial();
+void enviarEstadoCalibracion();
+void guardarR0Sensores();
+void configurarMuestreo();
+void configurarPublicacionExcepcion();
+void configurarLotes();
+void configurarFormato();
+void configurarVentanaQoS();
+void configurarTopics();
+void enviarMetadata();
+void configurarLotes() {
+  // Se relee en cada lectura para aplicar cambios de configuración remota
+  mqttManager->configurarLotes(configManager->obtenerTamanoLote(), configManager->obtenerTiempoLote() * 1000UL);
+}
+
+void configurarFormato() {
+  mqttManager->establecerFormato(configManager->obtenerFormatoPayload() == "msgpack" ? MQTTManager::FORMATO_MSGPACK
+                                                                                     : MQTTManager::FORMATO_JSON);
+}
+
+void configurarVentanaQoS() {
+  mqttManager->configurarVentanaQoS(configManager->obtenerVentanaQoS());
+}
+
+void configurarTopics() {
+  mqttManager->establecerTopicsCortos(configManager->esTopicsCortos());
+}
+
+MQTTManager::ResultadoPublicacion publicarOEncolar(ColaPersistente::TipoMensaje tipo, const JsonObject& datos);
+void drenarColaPersistente();
+void subirRegistroVuelo();
+void entregaConfirmada(uint32_t identificador, bool entregado);
 
 void setup() {
   Serial.begin(115200);
@@ -46,30 +118,66 @@ void setup() {
   // Inicializar sistema de logging
   logger = &SistemaLoggingSingleton::getInstance();
   logger->inicializar();
-  logger->info("SISTEMA", "Sistema GASLYT iniciando...");
+  LOG_INFO("SISTEMA", "Sistema GASLYT iniciando...");
   
   // Inicializar gestor de configuración
   configManager = new ConfigManager();
   if (!configManager->inicializar()) {
-    logger->error("SISTEMA", "Error al inicializar ConfigManager");
+    LOG_ERROR("SISTEMA", "Error al inicializar ConfigManager");
     return;
   }
   
-  logger->info("SISTEMA", "ConfigManager inicializado correctamente");
+  LOG_INFO("SISTEMA", "ConfigManager inicializado correctamente");
+  LOG_INFO("SISTEMA", "Arranque número " + String(configManager->registrarArranque()));
+  
+  // Registro de vuelo: desde acá las advertencias, errores y transiciones también van a flash
+  registroVuelo = new RegistroVuelo();
+  if (registroVuelo->inicializar(configManager->obtenerContadorArranques())) {
+    logger->establecerRegistroVuelo(registroVuelo);
+  } else {
+    LOG_ERROR("SISTEMA", "Error al inicializar el registro de vuelo");
+  }
   configManager->imprimirConfiguracion();
   
-  // Inicializar sensor de gas
-  sensorGas = new GasSensor(configManager->obtenerPinSensorGas(), "MQ-2");
-  if (!sensorGas->inicializar()) {
-    logger->error("SISTEMA", "Error al inicializar sensor de gas");
+  // Inicializar sensores de gas (un canal por sensor MQ de la placa)
+  sensoresGas = new GasSensorArray();
+  for (int i = 0; i < configManager->obtenerCantidadCanales(); i++) {
+    ConfigManager::CanalSensor canal = configManager->obtenerCanal(i);
+    sensoresGas->agregarCanal(canal.pin, (TipoSensorMQ)canal.tipo);
+  }
+  
+  if (!sensoresGas->inicializar()) {
+    LOG_ERROR("SISTEMA", "Error al inicializar sensores de gas");
     return;
   }
   
-  logger->info("SISTEMA", "Sensor de gas inicializado correctamente");
+  LOG_INFO("SISTEMA", "Sensores de gas inicializados correctamente: " + String(sensoresGas->obtenerCantidadCanales()) + " canal(es)");
+  
+  // Configurar umbral de los sensores
+  sensoresGas->establecerUmbral(configManager->obtenerUmbralAlarma());
+  sensoresGas->establecerAlfaEWMA(configManager->obtenerAlfaEWMA());
+  
+  // Restaurar R0 guardado (calibración y seguimiento de línea base)
+  for (int i = 0; i < sensoresGas->obtenerCantidadCanales(); i++) {
+    if (configManager->obtenerR0Canal(i) > 0) {
+      sensoresGas->establecerR0(i, configManager->obtenerR0Canal(i));
+      sensoresGas->establecerR0Referencia(i, configManager->obtenerR0ReferenciaCanal(i));
+      LOG_INFO("SENSOR", "Canal " + String(i) + " R0 restaurado: " + String(configManager->obtenerR0Canal(i), 3) + " kΩ");
+    } else {
+      LOG_WARNING("SENSOR", "Canal " + String(i) + " sin calibrar, se usa R0 por defecto");
+    }
+  }
+  LOG_INFO("SENSOR", "Umbral de alarma configurado: " + String(configManager->obtenerUmbralAlarma()) + " ppm");
+  
+  // Inicializar muestreo adaptativo
+  muestreo = new MuestreoAdaptativo();
+  configurarMuestreo();
+  LOG_INFO("SENSOR", "Muestreo " + String(muestreo->estaActivo() ? "adaptativo" : "fijo") +
+               ", intervalo inicial: " + String(muestreo->obtenerIntervaloMs() / 1000) + " segundos");
   
-  // Configurar umbral del sensor
-  sensorGas->establecerUmbral(configManager->obtenerUmbralAlarma());
-  logger->info("SENSOR", "Umbral de alarma configurado: " + String(configManager->obtenerUmbralAlarma()) + " ppm");
+  // Inicializar publicación por excepción (banda muerta)
+  publicacionExcepcion = new PublicacionExcepcion();
+  configurarPublicacionExcepcion();
   
   // Inicializar sistema de alarmas
   sistemaAlarmas = new SistemaAlarmas(
@@ -80,30 +188,38 @@ void setup() {
   );
   
   if (!sistemaAlarmas->inicializar()) {
-    logger->error("SISTEMA", "Error al inicializar sistema de alarmas");
+    LOG_ERROR("SISTEMA", "Error al inicializar sistema de alarmas");
     return;
   }
   
-  logger->info("SISTEMA", "Sistema de alarmas inicializado correctamente");
+  LOG_INFO("SISTEMA", "Sistema de alarmas inicializado correctamente");
+  
+  // Inicializar cola persistente (lecturas y alarmas sin conexión)
+  colaPersistente = new ColaPersistente();
+  if (colaPersistente->inicializar()) {
+    LOG_INFO("SISTEMA", "Cola persistente inicializada: " + String(colaPersistente->obtenerPendientes()) + " mensaje(s) pendiente(s)");
+  } else {
+    LOG_WARNING("SISTEMA", "Cola persistente no disponible, las lecturas sin conexión se perderán");
+  }
   
   // Inicializar WiFi Manager
   wifiManager = new WiFiManagerCustom();
   if (!wifiManager->inicializar()) {
-    logger->error("SISTEMA", "Error al inicializar WiFiManager");
+    LOG_ERROR("SISTEMA", "Error al inicializar WiFiManager");
     return;
   }
   
-  logger->info("SISTEMA", "WiFiManager inicializado correctamente");
+  LOG_INFO("SISTEMA", "WiFiManager inicializado correctamente");
   
   // Intentar conectar a WiFi
   if (wifiManager->conectar()) {
-    logger->info("WIFI", "WiFi conectado exitosamente");
-    logger->info("WIFI", "SSID: " + wifiManager->obtenerSSID());
-    logger->info("WIFI", "IP: " + wifiManager->obtenerIP());
-    logger->info("WIFI", "RSSI: " + String(wifiManager->obtenerRSSI()) + " dBm");
+    LOG_INFO("WIFI", "WiFi conectado exitosamente");
+    LOG_INFO("WIFI", "SSID: " + wifiManager->obtenerSSID());
+    LOG_INFO("WIFI", "IP: " + wifiManager->obtenerIP());
+    LOG_INFO("WIFI", "RSSI: " + String(wifiManager->obtenerRSSI()) + " dBm");
     sistemaAlarmas->actualizarEstado(SistemaAlarmas::NORMAL);
   } else {
-    logger->warning("WIFI", "No se pudo conectar a WiFi, iniciando portal cautivo");
+    LOG_WARNING("WIFI", "No se pudo conectar a WiFi, iniciando portal cautivo");
     sistemaAlarmas->actualizarEstado(SistemaAlarmas::SIN_WIFI);
     wifiManager->iniciarPortalCautivo();
   }
@@ -112,12 +228,12 @@ void setup() {
   mqttManager = new MQTTManager();
   mqttManager->establecerIdDispositivo(configManager->obtenerIdDispositivo());
   
-  logger->info("SISTEMA", "MQTTManager inicializado correctamente");
-  logger->info("MQTT", "ID Dispositivo: " + configManager->obtenerIdDispositivo());
+  LOG_INFO("SISTEMA", "MQTTManager inicializado correctamente");
+  LOG_INFO("MQTT", "ID Dispositivo: " + configManager->obtenerIdDispositivo());
   
   // Configurar MQTT según el modo
   if (configManager->esModoAWS()) {
-    logger->info("MQTT", "Configurando modo AWS IoT Core");
+    LOG_INFO("MQTT", "Configurando modo AWS IoT Core");
     // Configurar AWS IoT Core (certificados deben estar en el código)
     mqttManager->configurarAWS(
       configManager->obtenerBrokerMQTT(),
@@ -126,7 +242,7 @@ void setup() {
       ""  // Certificado CA (debe ser configurado)
     );
   } else {
-    logger->info("MQTT", "Configurando modo DEV");
+    LOG_INFO("MQTT", "Configurando modo DEV");
     // Configurar modo DEV
     mqttManager->configurarDEV(
       configManager->obtenerBrokerMQTT(),
@@ -136,66 +252,63 @@ void setup() {
     );
   }
   
+  mqttManager->establecerCallbackEntrega(entregaConfirmada);
   if (!mqttManager->inicializar()) {
-    logger->error("SISTEMA", "Error al inicializar MQTTManager");
+    LOG_ERROR("SISTEMA", "Error al inicializar MQTTManager");
     return;
   }
+  configurarLotes();
+  configurarFormato();
+  configurarVentanaQoS();
+  configurarTopics();
   
   // Conectar a MQTT
   if (mqttManager->conectar()) {
-    logger->info("MQTT", "MQTT conectado exitosamente");
-    logger->info("MQTT", "Broker: " + mqttManager->obtenerBroker());
-    logger->info("MQTT", "Puerto: " + String(mqttManager->obtenerPuerto()));
+    LOG_INFO("MQTT", "MQTT conectado exitosamente");
+    LOG_INFO("MQTT", "Broker: " + mqttManager->obtenerBroker());
+    LOG_INFO("MQTT", "Puerto: " + String(mqttManager->obtenerPuerto()));
     enviarMetadataInicial();
+    primeraConexion = false;
   } else {
-    logger->error("MQTT", "No se pudo conectar a MQTT");
+    LOG_ERROR("MQTT", "No se pudo conectar a MQTT, se reintenta en segundo plano");
   }
   
   // Inicializar configuración remota
   configuracionRemota = new ConfiguracionRemota();
-  if (!configuracionRemota->inicializar(configManager, sensorGas, sistemaAlarmas, logger)) {
-    logger->error("SISTEMA", "Error al inicializar configuración remota");
+  if (!configuracionRemota->inicializar(configManager, sensoresGas, sistemaAlarmas, logger)) {
+    LOG_ERROR("SISTEMA", "Error al inicializar configuración remota");
     return;
   }
   
   // Inicializar gestor de certificados
   certificadosManager = new CertificadosManager();
   if (!certificadosManager->inicializar()) {
-    logger->error("SISTEMA", "Error al inicializar gestor de certificados");
+    LOG_ERROR("SISTEMA", "Error al inicializar gestor de certificados");
     return;
   }
   
   // Inicializar sistema OTA
   sistemaOTA = new SistemaOTA();
   if (!sistemaOTA->inicializar()) {
-    logger->error("SISTEMA", "Error al inicializar sistema OTA");
+    LOG_ERROR("SISTEMA", "Error al inicializar sistema OTA");
     return;
   }
   
   // Inicializar gestor de actualizaciones
   gestorActualizaciones = new GestorActualizaciones();
   if (!gestorActualizaciones->inicializar(certificadosManager, sistemaOTA, mqttManager, logger)) {
-    logger->error("SISTEMA", "Error al inicializar gestor de actualizaciones");
+    LOG_ERROR("SISTEMA", "Error al inicializar gestor de actualizaciones");
     return;
   }
   
-  // Configurar callbacks MQTT
-  mqttManager->establecerCallbackConfiguracion([](const String& payload) {
-    configuracionRemota->procesarMensajeConfiguracion(payload);
-  });
+  // Mensajes MQTT entrantes: cada módulo registra sus topics
+  // (el gestor de actualizaciones lo hace al inicializarse)
+  configuracionRemota->registrarManejadores(mqttManager);
   
-  mqttManager->establecerCallbackActualizaciones([](const String& payload) {
-    DynamicJsonDocument doc(2048);
-    DeserializationError error = deserializeJson(doc, payload);
-    if (!error) {
-      gestorActualizaciones->procesarComandoActualizacion(doc.as<JsonObject>());
-    }
-  });
-  
-  logger->info("SISTEMA", "Sistema inicializado correctamente");
-  logger->info("SISTEMA", "ID Dispositivo: " + configManager->obtenerIdDispositivo());
-  logger->info("SISTEMA", "Intervalo de medición: " + String(configManager->obtenerIntervaloMedicion()) + " segundos");
-  logger->info("SISTEMA", "Umbral de alarma: " + String(configManager->obtenerUmbralAlarma()) + " ppm");
+  LOG_INFO("SISTEMA", "Sistema inicializado correctamente");
+  LOG_INFO("SISTEMA", "ID Dispositivo: " + configManager->obtenerIdDispositivo());
+  LOG_INFO("SISTEMA", "Intervalo de medición: " + String(configManager->obtenerIntervaloMedicion()) + " segundos");
+  LOG_INFO("SISTEMA", "Umbral de alarma: " + String(configManager->obtenerUmbralAlarma()) + " ppm");
   
   // Imprimir estado completo del sistema
   logger->logEstadoSistema();
@@ -229,11 +342,11 @@ void loop() {
     
     if (!wifiManager->verificarConexion()) {
       sistemaAlarmas->actualizarEstado(SistemaAlarmas::SIN_WIFI);
-      logger->warning("WIFI", "WiFi desconectado");
+      LOG_WARNINGF("WIFI", "WiFi desconectado");
     } else {
       if (sistemaAlarmas->obtenerEstadoActual() == SistemaAlarmas::SIN_WIFI) {
         sistemaAlarmas->actualizarEstado(SistemaAlarmas::NORMAL);
-        logger->info("WIFI", "WiFi reconectado");
+        LOG_INFOF("WIFI", "WiFi reconectado");
       }
     }
   }
@@ -242,21 +355,56 @@ void loop() {
   if (tiempoActual - ultimaVerificacionMQTT >= INTERVALO_VERIFICACION_MQTT) {
     ultimaVerificacionMQTT = tiempoActual;
     
-    if (wifiManager->estaConectado()) {
-      if (!mqttManager->verificarConexion()) {
-        mqttManager->reconectar();
-      }
-      mqttManager->procesarMensajes();
+    if (wifiManager->estaConectado() && !mqttManager->verificarConexion()) {
+      LOG_WARNINGF("MQTT", "MQTT desconectado, reconexión en curso");
     }
   }
   
-  // Realizar medición según el intervalo configurado
-  if (tiempoActual - ultimaMedicion >= (configManager->obtenerIntervaloMedicion() * 1000)) {
+  // Mensajes entrantes y reconexión con espera exponencial, sin bloquear el loop
+  if (wifiManager->estaConectado()) {
+    mqttManager->procesarMensajes();
+    
+    if (primeraConexion && mqttManager->estaConectado()) {
+      enviarMetadataInicial();
+      primeraConexion = false;
+    }
+  }
+  
+  // Publicar el lote de lecturas si venció su tiempo máximo
+  mqttManager->procesarLote();
+  
+  // Reenviar en orden lo acumulado sin conexión, a ritmo acotado
+  if (colaPersistente->hayPendientes() && tiempoActual - ultimoDrenajeCola >= INTERVALO_DRENAJE_COLA &&
+      wifiManager->estaConectado() && mqttManager->estaConectado()) {
+    ultimoDrenajeCola = tiempoActual;
+    drenarColaPersistente();
+  }
+  
+  // Registro de vuelo: página vieja a flash y subida de lo anterior al reinicio,
+  // detrás de la cola persistente
+  registroVuelo->procesar();
+  if (registroVuelo->haySubidaPendiente() && !colaPersistente->hayPendientes() &&
+      tiempoActual - ultimaSubidaVuelo >= INTERVALO_SUBIDA_VUELO &&
+      wifiManager->estaConectado() && mqttManager->estaConectado()) {
+    ultimaSubidaVuelo = tiempoActual;
+    subirRegistroVuelo();
+  }
+  
+  // Realizar medición según el intervalo vigente (fijo o adaptativo)
+  if (tiempoActual - ultimaMedicion >= muestreo->obtenerIntervaloMs()) {
     ultimaMedicion = tiempoActual;
-    logger->debug("SENSOR", "Iniciando medición programada");
+    LOG_DEBUGF("SENSOR", "Iniciando medición programada");
     realizarMedicion();
   }
   
+  // Avanzar la calibración en curso sin bloquear el lazo
+  if (sensoresGas->actualizarCalibracion()) {
+    enviarEstadoCalibracion();
+    if (sensoresGas->obtenerEstadoCalibracion() == GasSensorArray::CALIBRACION_COMPLETADA) {
+      guardarR0Sensores();
+    }
+  }
+  
   // Enviar metadata periódicamente
   if (tiempoActual - ultimaMetadata >= INTERVALO_METADATA) {
     ultimaMetadata = tiempoActual;
@@ -276,133 +424,301 @@ void loop() {
 }
 
 void realizarMedicion() {
-  if (!sensorGas) {
-    logger->error("SENSOR", "Sensor de gas no inicializado");
+  if (!sensoresGas) {
+    LOG_ERRORF("SENSOR", "Sensores de gas no inicializados");
     return;
   }
   
-  logger->debug("SENSOR", "Realizando medición de gas...");
+  LOG_DEBUGF("SENSOR", "Realizando medición de gas...");
   
-  // Leer concentración de gas
-  float concentracion = sensorGas->leerConcentracion();
+  // Leer y convertir todos los canales en una pasada
+  if (!sensoresGas->leerConcentraciones()) {
+    bool algunaValida = false;
+    for (int i = 0; i < sensoresGas->obtenerCantidadCanales(); i++) {
+      if (sensoresGas->esLecturaValida(i)) {
+        algunaValida = true;
+      } else {
+        LOG_ERRORF("SENSOR", "Lectura inválida en canal %d (%s)", i, sensoresGas->obtenerPerfil(i).nombre);
+      }
+    }
+    
+    if (!algunaValida) {
+      LOG_ERRORF("SENSOR", "Error en la lectura de los sensores");
+      sistemaAlarmas->actualizarEstado(SistemaAlarmas::ERROR_SENSOR);
+      return;
+    }
+  }
   
-  if (concentracion < 0) {
-    logger->error("SENSOR", "Error en la lectura del sensor");
-    sistemaAlarmas->actualizarEstado(SistemaAlarmas::ERROR_SENSOR);
-    return;
+  for (int i = 0; i < sensoresGas->obtenerCantidadCanales(); i++) {
+    LOG_INFOF("SENSOR", "Concentración medida %s: %.2f ppm", sensoresGas->obtenerPerfil(i).nombre,
+              sensoresGas->obtenerConcentracion(i));
   }
   
-  logger->info("SENSOR", "Concentración medida: " + String(concentracion) + " ppm");
+  // Compensar la deriva de R0 con el techo de Rs en aire limpio
+  if (sensoresGas->actualizarLineaBase()) {
+    LOG_INFOF("SENSOR", "Línea base de R0 actualizada");
+    guardarR0Sensores();
+  }
   
-  // Verificar umbral
-  bool superaUmbral = sensorGas->verificarUmbral();
+  // Verificar umbral en cualquiera de los canales
+  bool superaUmbral = sensoresGas->verificarUmbral();
+  int canalCritico = sensoresGas->obtenerCanalCritico();
+  float concentracion = sensoresGas->obtenerConcentracion(canalCritico);
   
   // Actualizar estado del sistema
   if (superaUmbral) {
     if (!alarmaActiva) {
       alarmaActiva = true;
       sistemaAlarmas->actualizarEstado(SistemaAlarmas::ALARMA);
-      logger->warning("ALARMAS", "¡ALARMA! Concentración de gas supera el umbral: " + String(concentracion) + " ppm");
+      LOG_WARNINGF("ALARMAS", "¡ALARMA! Concentración de %s supera el umbral: %.2f ppm",
+                   sensoresGas->obtenerPerfil(canalCritico).gas, concentracion);
     }
   } else {
     if (alarmaActiva) {
       alarmaActiva = false;
       sistemaAlarmas->actualizarEstado(SistemaAlarmas::NORMAL);
-      logger->info("ALARMAS", "Concentración de gas normalizada: " + String(concentracion) + " ppm");
+      LOG_INFOF("ALARMAS", "Concentración de gas normalizada: %.2f ppm", concentracion);
     }
   }
   
-  // Imprimir lectura detallada
-  sensorGas->imprimirLectura();
+  // Alerta temprana: la tendencia reciente cruza el umbral dentro del horizonte
+  int canalPrediccion = -1;
+  int horizonte = configManager->obtenerHorizontePrediccion();
+  if (!superaUmbral && horizonte > 0) {
+    canalPrediccion = sensoresGas->obtenerCanalPrediccion(horizonte);
+  }
+  
+  if (canalPrediccion >= 0) {
+    if (!advertenciaPredictiva) {
+      advertenciaPredictiva = true;
+      sistemaAlarmas->actualizarEstado(SistemaAlarmas::ADVERTENCIA);
+      LOG_WARNINGF("ALARMAS", "Tendencia de %s alcanzaría el umbral en %.0f s",
+                   sensoresGas->obtenerPerfil(canalPrediccion).gas, sensoresGas->obtenerTiempoHastaUmbral(canalPrediccion));
+      enviarAlertaPredictiva(canalPrediccion);
+    }
+  } else if (advertenciaPredictiva) {
+    advertenciaPredictiva = false;
+    if (!superaUmbral) {
+      sistemaAlarmas->actualizarEstado(SistemaAlarmas::NORMAL);
+      LOG_INFOF("ALARMAS", "Tendencia de gas estabilizada");
+    }
+  }
   
-  // Enviar lectura por MQTT
-  if (wifiManager->estaConectado() && mqttManager->estaConectado()) {
-    logger->debug("MQTT", "Enviando lectura por MQTT");
-    enviarLectura(concentracion, superaUmbral);
-  } else {
-    logger->warning("MQTT", "No se puede enviar lectura - WiFi o MQTT desconectado");
+  // Ajustar el intervalo según nivel y variación del canal más comprometido
+  unsigned long intervaloAnterior = muestreo->obtenerIntervaloMs();
+  configurarMuestreo();
+  muestreo->actualizar(concentracion / sensoresGas->obtenerUmbral(canalCritico));
+  if (muestreo->obtenerIntervaloMs() != intervaloAnterior) {
+    LOG_INFOF("SENSOR", "Intervalo de medición ajustado a %.1f segundos (urgencia %.2f)",
+              muestreo->obtenerIntervaloMs() / 1000.0, muestreo->obtenerUrgencia());
   }
+  
+  // Lectura detallada (solo con el log en DEBUG)
+  sensoresGas->imprimirLecturas();
+  
+  // Enviar lectura por MQTT (o guardarla en la cola persistente sin conexión)
+  enviarLectura(superaUmbral);
 }
 
-void enviarLectura(float concentracion, bool alarma) {
+void enviarLectura(bool alarma) {
   if (!mqttManager) {
-    logger->error("MQTT", "MQTTManager no inicializado");
+    LOG_ERRORF("MQTT", "MQTTManager no inicializado");
     return;
   }
   
-  logger->debug("MQTT", "Preparando envío de lectura");
+  LOG_DEBUGF("MQTT", "Preparando envío de lectura");
   
-  // Crear JSON con los datos de la lectura
-  DynamicJsonDocument doc(1024);
-  doc["timestamp"] = wifiManager->obtenerTimestamp();
-  doc["fecha"] = wifiManager->obtenerHoraActual();
-  doc["concentracion"] = concentracion;
-  doc["unidad"] = "ppm";
-  doc["umbral"] = configManager->obtenerUmbralAlarma();
-  doc["alarma"] = alarma;
-  doc["idDispositivo"] = configManager->obtenerIdDispositivo();
-  doc["rssi"] = wifiManager->obtenerRSSI();
+  int canalCritico = sensoresGas->obtenerCanalCritico();
+  float concentracion = sensoresGas->obtenerConcentracion(canalCritico);
   
-  // Publicar lectura
-  JsonObject obj = doc.as<JsonObject>();
-  if (mqttManager->publicarLectura(obj)) {
-    logger->info("MQTT", "Lectura enviada exitosamente: " + String(concentracion) + " ppm");
+  // Publicación por excepción: sin cambios fuera de la banda ni latido vencido
+  // la lectura no se publica ni consume número de secuencia
+  float concentraciones[PublicacionExcepcion::MAX_CANALES];
+  bool alarmasCanales[PublicacionExcepcion::MAX_CANALES];
+  int cantidadCanales = min(sensoresGas->obtenerCantidadCanales(), PublicacionExcepcion::MAX_CANALES);
+  for (int i = 0; i < cantidadCanales; i++) {
+    concentraciones[i] = sensoresGas->obtenerConcentracion(i);
+    alarmasCanales[i] = sensoresGas->esAlarmaActiva(i);
+  }
+  configurarPublicacionExcepcion();
+  PublicacionExcepcion::Motivo motivo = publicacionExcepcion->evaluar(concentraciones, alarmasCanales, cantidadCanales, millis());
+  
+  if (motivo == PublicacionExcepcion::MOTIVO_SUPRIMIDA) {
+    LOG_DEBUGF("MQTT", "Lectura dentro de la banda, no se publica (%lu suprimida(s))",
+               (unsigned long)publicacionExcepcion->obtenerSuprimidas());
   } else {
-    logger->error("MQTT", "Error al enviar lectura");
+    publicarLectura(alarma, canalCritico, concentracion, motivo);
   }
   
-  // Si hay alarma, enviar también al topic de alarmas
+  // Si hay alarma, enviar también al topic de alarmas por cada canal afectado
   if (alarma) {
-    logger->warning("MQTT", "Enviando alarma por MQTT");
-    enviarAlarma(concentracion);
+    LOG_WARNINGF("MQTT", "Enviando alarma por MQTT");
+    for (int i = 0; i < sensoresGas->obtenerCantidadCanales(); i++) {
+      if (sensoresGas->esAlarmaActiva(i)) {
+        enviarAlarma(i);
+      }
+    }
   }
 }
 
-void enviarAlarma(float concentracion) {
+void publicarLectura(bool alarma, int canalCritico, float concentracion, PublicacionExcepcion::Motivo motivo) {
+  // Un único documento con todos los canales (ver lib/PayloadMQTT)
+  PayloadMQTT::DatosCanal canales[GasSensorArray::MAX_CANALES];
+  int cantidadCanales = sensoresGas->obtenerCantidadCanales();
+  for (int i = 0; i < cantidadCanales; i++) {
+    PayloadMQTT::DatosCanal& canal = canales[i];
+    canal.tipo = sensoresGas->obtenerPerfil(i).nombre;
+    canal.gas = sensoresGas->obtenerPerfil(i).gas;
+    canal.concentracion = sensoresGas->obtenerConcentracion(i);
+    canal.ratio = sensoresGas->obtenerRatio(i);
+    canal.umbral = sensoresGas->obtenerUmbral(i);
+    canal.alarma = sensoresGas->esAlarmaActiva(i);
+    canal.valida = sensoresGas->esLecturaValida(i);
+    canal.saturada = sensoresGas->esLecturaSaturada(i);
+    
+    const EstadisticasFlujo& estadisticas = sensoresGas->obtenerEstadisticas(i);
+    canal.media = estadisticas.obtenerMedia();
+    canal.desviacion = estadisticas.obtenerDesviacion();
+    canal.ewma = estadisticas.obtenerEWMA();
+    canal.minimo = estadisticas.obtenerMinimo();
+    canal.maximo = estadisticas.obtenerMaximo();
+    canal.muestras = estadisticas.obtenerCantidad();
+    
+    canal.tendencia = sensoresGas->obtenerTendencia(i).obtenerPendiente();
+    canal.tiempoHastaUmbral = sensoresGas->obtenerTiempoHastaUmbral(i);
+  }
+  
+  char fecha[20];
+  wifiManager->obtenerHoraActual(fecha, sizeof(fecha));
+  PayloadMQTT::DatosLectura lectura;
+  lectura.timestamp = wifiManager->obtenerTimestamp();
+  lectura.fecha = fecha;
+  lectura.concentracion = concentracion;
+  lectura.umbral = sensoresGas->obtenerUmbral(canalCritico);
+  lectura.alarma = alarma;
+  lectura.idDispositivo = configManager->obtenerIdDispositivo().c_str();
+  lectura.rssi = wifiManager->obtenerRSSI();
+  lectura.arranque = configManager->obtenerContadorArranques();
+  lectura.secuencia = secuenciaLecturas++;
+  lectura.canales = canales;
+  lectura.cantidadCanales = cantidadCanales;
+  
+  JsonDocument& doc = documentoLectura;
+  if (!PayloadMQTT::armarLectura(doc, lectura)) {
+    LOG_ERRORF("MQTT", "Lectura excede el documento de %u bytes", (unsigned)doc.capacity());
+    return;
+  }
+  
+  // Publicar lectura (directa o dentro del lote vigente)
+  configurarLotes();
+  JsonObject obj = doc.as<JsonObject>();
+  if (publicarOEncolar(ColaPersistente::MENSAJE_LECTURA, obj) != MQTTManager::PUBLICACION_RECHAZADA) {
+    if (publicacionExcepcion->estaActivo()) {
+      LOG_INFOF("MQTT", "Lectura aceptada: %d canal(es), motivo: %s",
+                sensoresGas->obtenerCantidadCanales(), PublicacionExcepcion::obtenerNombreMotivo(motivo));
+    } else {
+      LOG_INFOF("MQTT", "Lectura aceptada: %d canal(es)", sensoresGas->obtenerCantidadCanales());
+    }
+  }
+}
+
+void enviarAlarma(int canal) {
   if (!mqttManager) {
-    logger->error("MQTT", "MQTTManager no inicializado para alarma");
+    LOG_ERRORF("MQTT", "MQTTManager no inicializado para alarma");
     return;
   }
   
-  logger->warning("MQTT", "Preparando envío de alarma");
+  LOG_WARNINGF("MQTT", "Preparando envío de alarma");
+  
+  float concentracion = sensoresGas->obtenerConcentracion(canal);
   
   // Crear JSON con los datos de la alarma
-  DynamicJsonDocument doc(1024);
+  JsonDocument& doc = documentoEvento;
+  doc.clear();
+  char fecha[20];
+  wifiManager->obtenerHoraActual(fecha, sizeof(fecha));
   doc["timestamp"] = wifiManager->obtenerTimestamp();
-  doc["fecha"] = wifiManager->obtenerHoraActual();
+  doc["fecha"] = fecha;
   doc["tipo"] = "GAS_INFLAMABLE";
+  doc["sensor"] = sensoresGas->obtenerPerfil(canal).nombre;
+  doc["gas"] = sensoresGas->obtenerPerfil(canal).gas;
   doc["concentracion"] = concentracion;
-  doc["umbral"] = configManager->obtenerUmbralAlarma();
+  doc["umbral"] = sensoresGas->obtenerUmbral(canal);
   doc["severidad"] = "ALTA";
   doc["idDispositivo"] = configManager->obtenerIdDispositivo();
   doc["accion"] = "EXTRACTOR_ACTIVADO";
+  doc["arranque"] = configManager->obtenerContadorArranques();
+  doc["secuencia"] = secuenciaAlarmas++;
   
   // Publicar alarma
   JsonObject obj = doc.as<JsonObject>();
-  if (mqttManager->publicarAlarma(obj)) {
-    logger->warning("MQTT", "Alarma enviada exitosamente: " + String(concentracion) + " ppm");
-  } else {
-    logger->error("MQTT", "Error al enviar alarma");
+  MQTTManager::ResultadoPublicacion resultado = publicarOEncolar(ColaPersistente::MENSAJE_ALARMA, obj);
+  if (resultado == MQTTManager::PUBLICACION_ENVIADA) {
+    LOG_WARNINGF("MQTT", "Alarma enviada: %.2f ppm", concentracion);
+  } else if (resultado == MQTTManager::PUBLICACION_ENCOLADA) {
+    LOG_WARNINGF("MQTT", "Alarma en la cola de salida, sale al haber lugar en el transporte: %.2f ppm", concentracion);
+  }
+}
+
+void enviarAlertaPredictiva(int canal) {
+  if (!mqttManager) {
+    LOG_ERRORF("MQTT", "MQTTManager no inicializado para alerta predictiva");
+    return;
+  }
+  
+  // Crear JSON con la proyección de la tendencia
+  JsonDocument& doc = documentoEvento;
+  doc.clear();
+  char fecha[20];
+  wifiManager->obtenerHoraActual(fecha, sizeof(fecha));
+  doc["timestamp"] = wifiManager->obtenerTimestamp();
+  doc["fecha"] = fecha;
+  doc["tipo"] = "PREDICCION_UMBRAL";
+  doc["sensor"] = sensoresGas->obtenerPerfil(canal).nombre;
+  doc["gas"] = sensoresGas->obtenerPerfil(canal).gas;
+  doc["concentracion"] = sensoresGas->obtenerConcentracion(canal);
+  doc["umbral"] = sensoresGas->obtenerUmbral(canal);
+  doc["tendencia"] = sensoresGas->obtenerTendencia(canal).obtenerPendiente();
+  doc["tiempoHastaUmbral"] = sensoresGas->obtenerTiempoHastaUmbral(canal);
+  doc["severidad"] = "MEDIA";
+  doc["idDispositivo"] = configManager->obtenerIdDispositivo();
+  doc["accion"] = "ADVERTENCIA";
+  doc["arranque"] = configManager->obtenerContadorArranques();
+  doc["secuencia"] = secuenciaAlarmas++;
+  
+  // Publicar en el topic de alarmas
+  JsonObject obj = doc.as<JsonObject>();
+  if (publicarOEncolar(ColaPersistente::MENSAJE_ALARMA, obj) == MQTTManager::PUBLICACION_ENVIADA) {
+    LOG_WARNINGF("MQTT", "Alerta predictiva enviada");
   }
 }
 
 void enviarMetadataInicial() {
   if (!mqttManager) {
-    logger->error("MQTT", "MQTTManager no inicializado para metadata");
+    LOG_ERRORF("MQTT", "MQTTManager no inicializado para metadata");
     return;
   }
   
-  logger->info("MQTT", "Preparando envío de metadata inicial");
+  LOG_INFOF("MQTT", "Preparando envío de metadata inicial");
   
   // Crear JSON con metadata inicial
-  DynamicJsonDocument doc(1024);
+  JsonDocument& doc = documentoEvento;
+  doc.clear();
+  char fecha[20];
+  wifiManager->obtenerHoraActual(fecha, sizeof(fecha));
   doc["timestamp"] = wifiManager->obtenerTimestamp();
-  doc["fecha"] = wifiManager->obtenerHoraActual();
+  doc["fecha"] = fecha;
   doc["tipo"] = "INICIO_SISTEMA";
   doc["idDispositivo"] = configManager->obtenerIdDispositivo();
   doc["mac"] = WiFi.macAddress();
   doc["version"] = "1.0.0";
   doc["pinSensorGas"] = configManager->obtenerPinSensorGas();
+  JsonArray canales = doc.createNestedArray("canalesSensor");
+  for (int i = 0; i < sensoresGas->obtenerCantidadCanales(); i++) {
+    JsonObject canal = canales.createNestedObject();
+    canal["pin"] = sensoresGas->obtenerPin(i);
+    canal["tipo"] = sensoresGas->obtenerPerfil(i).nombre;
+  }
   doc["pinLED"] = configManager->obtenerPinLED();
   doc["pinBuzzer"] = configManager->obtenerPinBuzzer();
   doc["pinExtractor"] = configManager->obtenerPinExtractor();
@@ -417,24 +733,27 @@ void enviarMetadataInicial() {
   // Publicar metadata
   JsonObject obj = doc.as<JsonObject>();
   if (mqttManager->publicarMetadata(obj)) {
-    logger->info("MQTT", "Metadata inicial enviada exitosamente");
+    LOG_INFOF("MQTT", "Metadata inicial enviada exitosamente");
   } else {
-    logger->error("MQTT", "Error al enviar metadata inicial");
+    LOG_ERRORF("MQTT", "Error al enviar metadata inicial");
   }
 }
 
 void enviarMetadata() {
   if (!mqttManager) {
-    logger->error("MQTT", "MQTTManager no inicializado para metadata periódica");
+    LOG_ERRORF("MQTT", "MQTTManager no inicializado para metadata periódica");
     return;
   }
   
-  logger->debug("MQTT", "Preparando envío de metadata periódica");
+  LOG_DEBUGF("MQTT", "Preparando envío de metadata periódica");
   
   // Crear JSON con metadata periódica
-  DynamicJsonDocument doc(1024);
+  JsonDocument& doc = documentoEvento;
+  doc.clear();
+  char fecha[20];
+  wifiManager->obtenerHoraActual(fecha, sizeof(fecha));
   doc["timestamp"] = wifiManager->obtenerTimestamp();
-  doc["fecha"] = wifiManager->obtenerHoraActual();
+  doc["fecha"] = fecha;
   doc["tipo"] = "METADATA_PERIODICA";
   doc["idDispositivo"] = configManager->obtenerIdDispositivo();
   doc["uptime"] = millis() / 1000;
@@ -443,13 +762,206 @@ void enviarMetadata() {
   doc["estadoWifi"] = wifiManager->estaConectado();
   doc["estadoMQTT"] = mqttManager->estaConectado();
   doc["estadoAlarma"] = alarmaActiva;
-  doc["ultimaLectura"] = sensorGas->obtenerUltimaLectura();
+  doc["ultimaLectura"] = sensoresGas->obtenerConcentracion(sensoresGas->obtenerCanalCritico());
+  JsonArray r0 = doc.createNestedArray("r0");
+  for (int i = 0; i < sensoresGas->obtenerCantidadCanales(); i++) {
+    r0.add(sensoresGas->obtenerR0(i));
+  }
+  doc["muestreoAdaptativo"] = muestreo->estaActivo();
+  doc["intervaloMuestreo"] = muestreo->obtenerIntervaloMs() / 1000.0;
+  doc["arranque"] = configManager->obtenerContadorArranques();
+  doc["colaPendientes"] = colaPersistente->obtenerPendientes();
+  doc["colaDescartados"] = colaPersistente->obtenerDescartados();
+  doc["lecturasSuprimidas"] = publicacionExcepcion->obtenerSuprimidas();
+  doc["lecturasPublicadas"] = publicacionExcepcion->obtenerPublicadas();
   
   // Publicar metadata
   JsonObject obj = doc.as<JsonObject>();
   if (mqttManager->publicarMetadata(obj)) {
-    logger->info("MQTT", "Metadata periódica enviada exitosamente");
+    LOG_INFOF("MQTT", "Metadata periódica enviada exitosamente");
+  } else {
+    LOG_ERRORF("MQTT", "Error al enviar metadata periódica");
+  }
+}
+
+void enviarEstadoCalibracion() {
+  GasSensorArray::EstadoCalibracion estado = sensoresGas->obtenerEstadoCalibracion();
+  LOG_INFOF("SENSOR", "Calibración %s (%d%%)", sensoresGas->obtenerNombreEstadoCalibracion(),
+            sensoresGas->obtenerProgresoCalibracion());
+  
+  if (!wifiManager->estaConectado() || !mqttManager->estaConectado()) {
+    return;
+  }
+  
+  JsonDocument& doc = documentoEvento;
+  doc.clear();
+  doc["timestamp"] = wifiManager->obtenerTimestamp();
+  doc["idDispositivo"] = configManager->obtenerIdDispositivo();
+  doc["estado"] = sensoresGas->obtenerNombreEstadoCalibracion();
+  doc["progreso"] = sensoresGas->obtenerProgresoCalibracion();
+  doc["canal"] = sensoresGas->obtenerCanalCalibracion();
+  
+  if (estado == GasSensorArray::CALIBRACION_COMPLETADA) {
+    JsonArray r0 = doc.createNestedArray("r0");
+    for (int i = 0; i < sensoresGas->obtenerCantidadCanales(); i++) {
+      r0.add(sensoresGas->obtenerR0(i));
+    }
+  }
+  
+  JsonObject obj = doc.as<JsonObject>();
+  if (!mqttManager->publicarCalibracion(obj)) {
+    LOG_ERRORF("MQTT", "Error al enviar estado de calibración");
+  }
+}
+
+void guardarR0Sensores() {
+  float r0[GasSensorArray::MAX_CANALES];
+  float referencias[GasSensorArray::MAX_CANALES];
+  int cantidad = sensoresGas->obtenerCantidadCanales();
+  
+  for (int i = 0; i < cantidad; i++) {
+    r0[i] = sensoresGas->obtenerR0(i);
+    referencias[i] = sensoresGas->obtenerR0Referencia(i);
+  }
+  
+  if (configManager->establecerR0Canales(r0, referencias, cantidad)) {
+    LOG_INFOF("CONFIG", "R0 de los sensores guardado");
+  } else {
+    LOG_ERRORF("CONFIG", "Error al guardar R0 de los sensores");
+  }
+}
+
+void configurarPublicacionExcepcion() {
+  // Se relee en cada lectura para aplicar cambios de configuración remota
+  publicacionExcepcion->configurar(
+    configManager->esPublicacionExcepcion(),
+    configManager->obtenerBandaAbsoluta(),
+    configManager->obtenerBandaRelativa(),
+    configManager->obtenerIntervaloLatido()
+  );
+}
+
+void configurarMuestreo() {
+  // Se relee en cada medición para aplicar cambios de configuración remota
+  muestreo->configurar(
+    configManager->obtenerIntervaloMedicion(),
+    configManager->obtenerIntervaloMinimo(),
+    configManager->obtenerIntervaloMaximo(),
+    configManager->esMuestreoAdaptativo()
+  );
+}
+
+MQTTManager::ResultadoPublicacion publicarOEncolar(ColaPersistente::TipoMensaje tipo, const JsonObject& datos) {
+  // Las lecturas esperan detrás de las pendientes para llegar en orden;
+  // las alarmas salen en cuanto hay conexión. Lo que va a flash cuenta como rechazado
+  bool conectado = wifiManager->estaConectado() && mqttManager->estaConectado();
+  bool enOrden = tipo == ColaPersistente::MENSAJE_ALARMA || !colaPersistente->hayPendientes();
+  configurarFormato();
+  configurarVentanaQoS();
+  configurarTopics();
+  
+  if (conectado && enOrden) {
+    MQTTManager::ResultadoPublicacion resultado = (tipo == ColaPersistente::MENSAJE_LECTURA)
+                                                    ? mqttManager->publicarLectura(datos)
+                                                    : mqttManager->publicarAlarma(datos);
+    if (resultado != MQTTManager::PUBLICACION_RECHAZADA) {
+      return resultado;
+    }
+  }
+  
+  // Se guarda ya serializado en el formato vigente, anotado en la cabecera
+  static uint8_t payload[ColaPersistente::TAMANO_MAXIMO_MENSAJE];
+  size_t longitud = mqttManager->serializar(datos, payload, sizeof(payload));
+  ColaPersistente::FormatoRegistro formato = (mqttManager->obtenerFormato() == MQTTManager::FORMATO_MSGPACK)
+                                               ? ColaPersistente::FORMATO_MSGPACK
+                                               : ColaPersistente::FORMATO_JSON;
+  if (longitud > 0 && colaPersistente->encolar(tipo, formato, payload, longitud)) {
+    LOG_WARNINGF("MQTT", "Sin conexión o ventana QoS 1 llena, mensaje guardado en la cola persistente (%lu pendiente(s))",
+                 (unsigned long)colaPersistente->obtenerPendientes());
   } else {
-    logger->error("MQTT", "Error al enviar metadata periódica");
+    LOG_ERRORF("MQTT", "No se puede enviar ni encolar el mensaje - se pierde");
+  }
+  return MQTTManager::PUBLICACION_RECHAZADA;
+}
+
+void drenarColaPersistente() {
+  // De a un registro: el siguiente sale cuando el transporte confirma el anterior
+  if (registroEnEnvio != 0 && millis() - inicioEnvioRegistro < TIEMPO_MAXIMO_ENTREGA) {
+    return;
+  }
+  
+  ColaPersistente::TipoMensaje tipo;
+  ColaPersistente::FormatoRegistro formato;
+  const uint8_t* payload;
+  size_t longitud;
+  if (!colaPersistente->obtenerSiguiente(tipo, formato, payload, longitud)) {
+    registroEnEnvio = 0;
+    return;
+  }
+  
+  // Sale tal como se encoló, aunque formato_payload haya cambiado después.
+  // Los registros sin formato anotado se reconocen por el primer byte
+  if (formato == ColaPersistente::FORMATO_DESCONOCIDO) {
+    formato = (payload[0] == '{' || payload[0] == '[') ? ColaPersistente::FORMATO_JSON
+                                                       : ColaPersistente::FORMATO_MSGPACK;
+  }
+  LOG_DEBUGF("MQTT", "Reenviando registro pendiente en %s (%u bytes)",
+             formato == ColaPersistente::FORMATO_MSGPACK ? "MessagePack" : "JSON", (unsigned)longitud);
+  
+  // Antes de publicar: con QoS 0 la entrega se informa dentro de la llamada
+  registroEnEnvio = colaPersistente->obtenerIdentificadorActual();
+  inicioEnvioRegistro = millis();
+  MQTTManager::ResultadoPublicacion resultado = (tipo == ColaPersistente::MENSAJE_LECTURA)
+                                                  ? mqttManager->publicarLecturaSerializada(payload, longitud, registroEnEnvio)
+                                                  : mqttManager->publicarAlarmaSerializada(payload, longitud, registroEnEnvio);
+  if (resultado == MQTTManager::PUBLICACION_RECHAZADA) {
+    // Queda en la cola y se reintenta en el próximo ciclo
+    registroEnEnvio = 0;
   }
-}
\ No newline at end of file
+}
+
+void subirRegistroVuelo() {
+  if (fragmentoEnEnvio != 0 && millis() - inicioEnvioFragmento < TIEMPO_MAXIMO_ENTREGA) {
+    return;
+  }
+  
+  const uint8_t* fragmento;
+  size_t longitud;
+  if (!registroVuelo->obtenerFragmento(fragmento, longitud)) {
+    fragmentoEnEnvio = 0;
+    return;
+  }
+  
+  fragmentoEnEnvio = MARCA_FRAGMENTO | (++numeroFragmento & ~MARCA_FRAGMENTO);
+  inicioEnvioFragmento = millis();
+  if (mqttManager->publicarRegistroVuelo(fragmento, longitud, fragmentoEnEnvio) == MQTTManager::PUBLICACION_RECHAZADA) {
+    // Se vuelve a entregar el mismo fragmento en el próximo ciclo
+    fragmentoEnEnvio = 0;
+  }
+}
+
+void entregaConfirmada(uint32_t identificador, bool entregado) {
+  // Llega desde procesarMensajes() o desde la publicación, siempre en loop()
+  if (identificador == fragmentoEnEnvio) {
+    fragmentoEnEnvio = 0;
+    if (entregado && registroVuelo->confirmarFragmento() && !registroVuelo->haySubidaPendiente()) {
+      LOG_INFOF("SISTEMA", "Registro de vuelo subido");
+    }
+    return;
+  }
+  
+  if (identificador != registroEnEnvio) {
+    return;                                 // Copia repetida de un envío ya confirmado o reofrecido
+  }
+  registroEnEnvio = 0;
+  
+  // Descartado por la cola de salida: se vuelve a ofrecer en el próximo ciclo.
+  // Si la cola persistente se llenó y lo perdió, ya no es el registro actual
+  if (!entregado || colaPersistente->obtenerIdentificadorActual() != identificador) {
+    return;
+  }
+  colaPersistente->confirmarEnvio();
+  if (!colaPersistente->hayPendientes()) {
+    LOG_INFOF("MQTT", "Cola persistente vaciada");
+  }
+}
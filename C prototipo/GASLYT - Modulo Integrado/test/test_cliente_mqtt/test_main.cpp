@@ -0,0 +1,526 @@
+// Cliente MQTT de TransporteCliente sobre un canal simulado: paquetes,
+// ventana QoS 1, reenvío con DUP al reconectar, plazo del PUBACK y keep alive.
+// pio test -e native -f test_cliente_mqtt
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "SesionMQTT.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+// Canal en memoria: guarda lo escrito y entrega lo que la prueba agrega
+class CanalSimulado : public CanalMQTT {
+public:
+    Bytes escrito;
+    Bytes pendiente;
+    size_t trozo = 256;             // Bytes por lectura
+    bool cerrado = false;
+    bool fallarEscritura = false;
+
+    size_t escribir(const uint8_t* datos, size_t longitud) override {
+        if (fallarEscritura) {
+            return 0;
+        }
+        escrito.insert(escrito.end(), datos, datos + longitud);
+        return longitud;
+    }
+
+    int leer(uint8_t* destino, size_t capacidad) override {
+        if (pendiente.empty()) {
+            return cerrado ? -1 : 0;
+        }
+        size_t cantidad = pendiente.size();
+        if (cantidad > capacidad) {
+            cantidad = capacidad;
+        }
+        if (cantidad > trozo) {
+            cantidad = trozo;
+        }
+        memcpy(destino, pendiente.data(), cantidad);
+        pendiente.erase(pendiente.begin(), pendiente.begin() + cantidad);
+        return (int)cantidad;
+    }
+
+    void recibir(const Bytes& paquete) { pendiente.insert(pendiente.end(), paquete.begin(), paquete.end()); }
+
+    // Paquetes escritos desde la última llamada, separados por la cabecera fija
+    std::vector<Bytes> tomarPaquetes() {
+        std::vector<Bytes> paquetes;
+        size_t pos = 0;
+        while (pos < escrito.size()) {
+            size_t inicio = pos++;
+            uint32_t restante = 0;
+            uint32_t multiplicador = 1;
+            uint8_t byte;
+            do {
+                byte = escrito[pos++];
+                restante += (byte & 0x7F) * multiplicador;
+                multiplicador *= 128;
+            } while (byte & 0x80);
+            pos += restante;
+            paquetes.push_back(Bytes(escrito.begin() + inicio, escrito.begin() + pos));
+        }
+        escrito.clear();
+        return paquetes;
+    }
+};
+
+static Bytes connack(bool sesionPresente, uint8_t codigo) {
+    return Bytes{0x20, 0x02, (uint8_t)(sesionPresente ? 1 : 0), codigo};
+}
+
+static Bytes puback(uint16_t idPaquete) {
+    return Bytes{0x40, 0x02, (uint8_t)(idPaquete >> 8), (uint8_t)(idPaquete & 0xFF)};
+}
+
+// Identificador de paquete de un PUBLISH QoS 1 escrito
+static uint16_t idDePublish(const Bytes& paquete) {
+    size_t pos = 1;
+    while (paquete[pos] & 0x80) {
+        pos++;
+    }
+    pos++;
+    size_t longitudTopic = (paquete[pos] << 8) | paquete[pos + 1];
+    pos += 2 + longitudTopic;
+    return (paquete[pos] << 8) | paquete[pos + 1];
+}
+
+static uint8_t entrada[2048];
+static uint8_t salida[2048];
+static std::vector<uint32_t> entregas;
+static std::vector<std::string> recibidos;
+
+static void alEntregar(void* contexto, uint32_t identificador) {
+    entregas.push_back(identificador);
+}
+
+static void alRecibir(void* contexto, char* topic, uint8_t* datos, unsigned int longitud) {
+    recibidos.push_back(std::string(topic) + "=" + std::string((const char*)datos, longitud));
+}
+
+// Sesión conectada y sin paquetes escritos pendientes de revisar
+static void conectar(SesionMQTT& sesion, CanalSimulado& canal, bool sesionPresente, unsigned long ahora) {
+    TEST_ASSERT_TRUE(sesion.iniciar(canal, "GASLYT", ahora));
+    canal.recibir(connack(sesionPresente, 0));
+    sesion.procesar(ahora);
+    TEST_ASSERT_EQUAL(SesionMQTT::CONECTADA, sesion.obtenerEstado());
+}
+
+static const uint8_t DATOS[] = {'{', '"', 'p', 'p', 'm', '"', ':', '1', '}'};
+
+void setUp(void) {
+    entregas.clear();
+    recibidos.clear();
+}
+
+void tearDown(void) {}
+
+// Bytes exactos de los paquetes que se escriben (MQTT 3.1.1, capítulo 3)
+void test_codificacion_de_paquetes() {
+    uint8_t buffer[64];
+    const Bytes connect = {0x10, 0x12, 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x00, 0x00, 0x0F,
+                           0x00, 0x06, 'G', 'A', 'S', 'L', 'Y', 'T'};
+    size_t longitud = PaquetesMQTT::codificarConnect(buffer, sizeof(buffer), "GASLYT", 15, false);
+    TEST_ASSERT_EQUAL(connect.size(), longitud);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(connect.data(), buffer, longitud);
+
+    const Bytes publish = {0x33, 0x0B, 0x00, 0x03, 'a', '/', 'b', 0x12, 0x34, 'h', 'o', 'l', 'a'};
+    longitud = PaquetesMQTT::codificarPublish(buffer, sizeof(buffer), "a/b", (const uint8_t*)"hola", 4, 1, true,
+                                              false, 0x1234);
+    TEST_ASSERT_EQUAL(publish.size(), longitud);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(publish.data(), buffer, longitud);
+
+    // QoS 0 sin identificador; DUP solo con QoS 1
+    longitud = PaquetesMQTT::codificarPublish(buffer, sizeof(buffer), "a/b", (const uint8_t*)"hola", 4, 0, false,
+                                              true, 0);
+    TEST_ASSERT_EQUAL(11, longitud);
+    TEST_ASSERT_EQUAL_HEX8(0x30, buffer[0]);
+
+    const Bytes subscribe = {0x82, 0x08, 0x00, 0x07, 0x00, 0x03, 'c', '/', '#', 0x01};
+    longitud = PaquetesMQTT::codificarSubscribe(buffer, sizeof(buffer), 7, "c/#", 1);
+    TEST_ASSERT_EQUAL(subscribe.size(), longitud);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(subscribe.data(), buffer, longitud);
+
+    // Sin lugar no se escribe nada
+    TEST_ASSERT_EQUAL(0, PaquetesMQTT::codificarPublish(buffer, 12, "a/b", (const uint8_t*)"hola", 4, 1, false,
+                                                        false, 1));
+}
+
+// La longitud restante pasa de 1 a 2 bytes en 128 y de 2 a 3 en 16384
+void test_longitud_variable() {
+    TEST_ASSERT_EQUAL(1 + 1 + 127, PaquetesMQTT::longitudPublish(1, 124, 0));
+    TEST_ASSERT_EQUAL(1 + 2 + 128, PaquetesMQTT::longitudPublish(1, 125, 0));
+    TEST_ASSERT_EQUAL(1 + 2 + 16383, PaquetesMQTT::longitudPublish(1, 16378, 1));
+    TEST_ASSERT_EQUAL(1 + 3 + 16384, PaquetesMQTT::longitudPublish(1, 16379, 1));
+
+    static uint8_t grande[1 + 3 + 16384];
+    static uint8_t datos[16379];
+    size_t longitud = PaquetesMQTT::codificarPublish(grande, sizeof(grande), "t", datos, sizeof(datos), 1, false,
+                                                     false, 1);
+    TEST_ASSERT_EQUAL(sizeof(grande), longitud);
+    TEST_ASSERT_EQUAL_HEX8(0x80, grande[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, grande[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, grande[3]);
+}
+
+// Un PUBLISH entrante que llega byte a byte, otro que no entra en el buffer
+// y un tercero pegado al anterior
+void test_lector_por_trozos() {
+    uint8_t buffer[32];
+    PaquetesMQTT::Lector lector(buffer, sizeof(buffer));
+    const Bytes publish = {0x32, 0x0A, 0x00, 0x03, 'c', '/', 'x', 0x00, 0x05, 'h', 'o', 'l'};
+
+    PaquetesMQTT::Lector::Resultado resultado;
+    for (size_t i = 0; i < publish.size(); i++) {
+        TEST_ASSERT_EQUAL(1, lector.agregar(&publish[i], 1, resultado));
+        TEST_ASSERT_EQUAL(i + 1 < publish.size() ? PaquetesMQTT::Lector::INCOMPLETO : PaquetesMQTT::Lector::COMPLETO,
+                          resultado);
+    }
+    TEST_ASSERT_EQUAL(PaquetesMQTT::PUBLISH, lector.obtenerTipo());
+
+    PaquetesMQTT::Publicacion publicacion;
+    TEST_ASSERT_TRUE(PaquetesMQTT::leerPublish(lector.obtenerBanderas(), lector.obtenerCuerpo(),
+                                               lector.obtenerLongitud(), publicacion));
+    TEST_ASSERT_EQUAL_STRING("c/x", publicacion.topic);
+    TEST_ASSERT_EQUAL(3, publicacion.longitud);
+    TEST_ASSERT_EQUAL_STRING("hol", (const char*)publicacion.datos);
+    TEST_ASSERT_EQUAL(1, publicacion.qos);
+    TEST_ASSERT_EQUAL_UINT16(5, publicacion.idPaquete);
+
+    // 40 bytes de cuerpo no entran en 32: se consumen y se descartan
+    Bytes flujo = {0x30, 40};
+    flujo.resize(2 + 40, 'x');
+    flujo.insert(flujo.end(), {0xD0, 0x00});
+    size_t usados = lector.agregar(flujo.data(), flujo.size(), resultado);
+    TEST_ASSERT_EQUAL(42, usados);
+    TEST_ASSERT_EQUAL(PaquetesMQTT::Lector::DESCARTADO, resultado);
+    TEST_ASSERT_EQUAL(2, lector.agregar(flujo.data() + usados, flujo.size() - usados, resultado));
+    TEST_ASSERT_EQUAL(PaquetesMQTT::Lector::COMPLETO, resultado);
+    TEST_ASSERT_EQUAL(PaquetesMQTT::PINGRESP, lector.obtenerTipo());
+
+    // Cinco bytes de longitud no existen
+    const Bytes invalido = {0x30, 0xFF, 0xFF, 0xFF, 0xFF, 0x01};
+    lector.agregar(invalido.data(), invalido.size(), resultado);
+    TEST_ASSERT_EQUAL(PaquetesMQTT::Lector::ERROR_FORMATO, resultado);
+}
+
+void test_connect_y_connack() {
+    CanalSimulado canal;
+    SesionMQTT sesion(entrada, sizeof(entrada), salida, sizeof(salida));
+    TEST_ASSERT_TRUE(sesion.iniciar(canal, "GASLYT", 0));
+    TEST_ASSERT_EQUAL(SesionMQTT::ESPERANDO_CONNACK, sesion.obtenerEstado());
+
+    std::vector<Bytes> paquetes = canal.tomarPaquetes();
+    TEST_ASSERT_EQUAL(1, paquetes.size());
+    TEST_ASSERT_EQUAL_HEX8(0x10, paquetes[0][0]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, paquetes[0][9]);           // cleanSession = 0
+
+    // Sin publicar nada antes del CONNACK
+    TEST_ASSERT_FALSE(sesion.publicar("t", DATOS, sizeof(DATOS), 0, false, 0, 0));
+
+    canal.recibir(connack(false, 0));
+    sesion.procesar(10);
+    TEST_ASSERT_EQUAL(SesionMQTT::CONECTADA, sesion.obtenerEstado());
+    TEST_ASSERT_EQUAL(SesionMQTT::ESTADO_CONECTADO, sesion.obtenerCodigo());
+
+    // Rechazo del broker: el código del CONNACK queda como estado
+    CanalSimulado otro;
+    TEST_ASSERT_TRUE(sesion.iniciar(otro, "GASLYT", 100));
+    otro.recibir(connack(false, 5));
+    sesion.procesar(110);
+    TEST_ASSERT_EQUAL(SesionMQTT::DESCONECTADA, sesion.obtenerEstado());
+    TEST_ASSERT_EQUAL(5, sesion.obtenerCodigo());
+
+    // Sin CONNACK
+    TEST_ASSERT_TRUE(sesion.iniciar(otro, "GASLYT", 1000));
+    sesion.procesar(1000 + SesionMQTT::TIEMPO_MAXIMO_CONNACK_MS - 1);
+    TEST_ASSERT_EQUAL(SesionMQTT::ESPERANDO_CONNACK, sesion.obtenerEstado());
+    sesion.procesar(1000 + SesionMQTT::TIEMPO_MAXIMO_CONNACK_MS);
+    TEST_ASSERT_EQUAL(SesionMQTT::DESCONECTADA, sesion.obtenerEstado());
+    TEST_ASSERT_EQUAL(SesionMQTT::ESTADO_TIMEOUT_CONEXION, sesion.obtenerCodigo());
+}
+
+// QoS 0 se entrega al escribirse; QoS 1 ocupa la ventana hasta su PUBACK
+void test_ventana_qos1() {
+    CanalSimulado canal;
+    SesionMQTT sesion(entrada, sizeof(entrada), salida, sizeof(salida));
+    sesion.establecerCallbacks(alRecibir, alEntregar, nullptr);
+    TEST_ASSERT_TRUE(sesion.configurarVentana(2));
+    conectar(sesion, canal, false, 0);
+    canal.tomarPaquetes();
+
+    TEST_ASSERT_TRUE(sesion.publicar("g/l", DATOS, sizeof(DATOS), 0, false, 10, 1));
+    TEST_ASSERT_EQUAL(1, entregas.size());
+    TEST_ASSERT_EQUAL_UINT32(10, entregas[0]);
+
+    TEST_ASSERT_TRUE(sesion.publicar("g/l", DATOS, sizeof(DATOS), 1, false, 11, 2));
+    TEST_ASSERT_TRUE(sesion.publicar("g/l", DATOS, sizeof(DATOS), 1, false, 12, 3));
+    TEST_ASSERT_FALSE(sesion.puedePublicar("g/l", sizeof(DATOS), 1));
+    TEST_ASSERT_TRUE(sesion.puedePublicar("g/l", sizeof(DATOS), 0));
+    TEST_ASSERT_FALSE(sesion.publicar("g/l", DATOS, sizeof(DATOS), 1, false, 13, 4));
+    TEST_ASSERT_EQUAL(2, sesion.obtenerVentana().obtenerCantidad());
+    TEST_ASSERT_EQUAL_UINT32(1, sesion.obtenerVentana().obtenerRechazados());
+    TEST_ASSERT_EQUAL(1, entregas.size());
+
+    std::vector<Bytes> paquetes = canal.tomarPaquetes();
+    TEST_ASSERT_EQUAL(3, paquetes.size());
+    TEST_ASSERT_EQUAL_HEX8(0x30, paquetes[0][0]);
+    TEST_ASSERT_EQUAL_HEX8(0x32, paquetes[1][0]);
+    TEST_ASSERT_EQUAL_HEX8(0x32, paquetes[2][0]);
+    uint16_t primero = idDePublish(paquetes[1]);
+    uint16_t segundo = idDePublish(paquetes[2]);
+    TEST_ASSERT_NOT_EQUAL(primero, segundo);
+
+    // PUBACK adelantado: se informa enseguida, el lugar se libera en orden
+    canal.recibir(puback(segundo));
+    sesion.procesar(5);
+    TEST_ASSERT_EQUAL(2, entregas.size());
+    TEST_ASSERT_EQUAL_UINT32(12, entregas[1]);
+    TEST_ASSERT_EQUAL(2, sesion.obtenerVentana().obtenerCantidad());
+
+    // Un PUBACK repetido no se informa dos veces
+    canal.recibir(puback(segundo));
+    canal.recibir(puback(primero));
+    sesion.procesar(6);
+    TEST_ASSERT_EQUAL(3, entregas.size());
+    TEST_ASSERT_EQUAL_UINT32(11, entregas[2]);
+    TEST_ASSERT_EQUAL(0, sesion.obtenerVentana().obtenerCantidad());
+    TEST_ASSERT_EQUAL_UINT32(2, sesion.obtenerVentana().obtenerConfirmados());
+    TEST_ASSERT_TRUE(sesion.puedePublicar("g/l", sizeof(DATOS), 1));
+}
+
+// Con sesión en el broker se repite el identificador con DUP; sin sesión
+// es un envío nuevo, sin DUP
+void test_reenvio_al_reconectar() {
+    CanalSimulado canal;
+    SesionMQTT sesion(entrada, sizeof(entrada), salida, sizeof(salida));
+    sesion.establecerCallbacks(alRecibir, alEntregar, nullptr);
+    TEST_ASSERT_TRUE(sesion.configurarVentana(4));
+    conectar(sesion, canal, false, 0);
+
+    TEST_ASSERT_TRUE(sesion.publicar("g/a", DATOS, sizeof(DATOS), 1, false, 1, 1));
+    TEST_ASSERT_TRUE(sesion.publicar("g/b", DATOS, sizeof(DATOS), 1, true, 2, 2));
+    TEST_ASSERT_TRUE(sesion.publicar("g/c", DATOS, sizeof(DATOS), 1, false, 3, 3));
+    std::vector<Bytes> originales = canal.tomarPaquetes();
+    TEST_ASSERT_EQUAL(4, originales.size());                // CONNECT y tres PUBLISH
+
+    // El segundo se confirma; se corta antes de los otros PUBACK
+    canal.recibir(puback(idDePublish(originales[2])));
+    sesion.procesar(4);
+    canal.cerrado = true;
+    sesion.procesar(5);
+    TEST_ASSERT_EQUAL(SesionMQTT::DESCONECTADA, sesion.obtenerEstado());
+    TEST_ASSERT_EQUAL(SesionMQTT::ESTADO_CONEXION_PERDIDA, sesion.obtenerCodigo());
+    TEST_ASSERT_EQUAL(3, sesion.obtenerVentana().obtenerCantidad());
+    TEST_ASSERT_FALSE(sesion.publicar("g/d", DATOS, sizeof(DATOS), 1, false, 4, 6));
+
+    CanalSimulado nuevo;
+    conectar(sesion, nuevo, true, 100);
+    std::vector<Bytes> reenviados = nuevo.tomarPaquetes();
+    TEST_ASSERT_EQUAL(3, reenviados.size());                // CONNECT y los dos sin PUBACK
+    Bytes esperado = originales[1];
+    esperado[0] |= 0x08;
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(esperado.data(), reenviados[1].data(), esperado.size());
+    esperado = originales[3];
+    esperado[0] |= 0x08;
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(esperado.data(), reenviados[2].data(), esperado.size());
+    TEST_ASSERT_EQUAL_UINT32(2, sesion.obtenerVentana().obtenerReenviados());
+
+    // El broker perdió la sesión: identificadores nuevos y sin DUP
+    sesion.perderConexion();
+    CanalSimulado otro;
+    conectar(sesion, otro, false, 200);
+    std::vector<Bytes> nuevos = otro.tomarPaquetes();
+    TEST_ASSERT_EQUAL(3, nuevos.size());
+    TEST_ASSERT_EQUAL_HEX8(0x32, nuevos[1][0]);
+    TEST_ASSERT_EQUAL_HEX8(0x32, nuevos[2][0]);
+    TEST_ASSERT_NOT_EQUAL(idDePublish(originales[1]), idDePublish(nuevos[1]));
+    TEST_ASSERT_NOT_EQUAL(idDePublish(originales[3]), idDePublish(nuevos[2]));
+
+    // Los PUBACK de los identificadores nuevos confirman
+    otro.recibir(puback(idDePublish(nuevos[1])));
+    otro.recibir(puback(idDePublish(nuevos[2])));
+    sesion.procesar(201);
+    TEST_ASSERT_EQUAL(0, sesion.obtenerVentana().obtenerCantidad());
+    TEST_ASSERT_EQUAL(3, entregas.size());
+    TEST_ASSERT_EQUAL_UINT32(2, entregas[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, entregas[1]);
+    TEST_ASSERT_EQUAL_UINT32(3, entregas[2]);
+}
+
+// Sin PUBACK en TIEMPO_MAXIMO_PUBACK_MS la sesión se cierra; el mensaje se
+// conserva y vuelve a enviarse al reconectar
+void test_plazo_del_puback() {
+    CanalSimulado canal;
+    SesionMQTT sesion(entrada, sizeof(entrada), salida, sizeof(salida));
+    conectar(sesion, canal, false, 0);
+    TEST_ASSERT_TRUE(sesion.publicar("g/l", DATOS, sizeof(DATOS), 1, false, 7, 1000));
+
+    // El keep alive no interfiere: se responden los PINGREQ
+    for (unsigned long t = 1000; t < 1000 + SesionMQTT::TIEMPO_MAXIMO_PUBACK_MS; t += 1000) {
+        sesion.procesar(t);
+        canal.recibir(Bytes{0xD0, 0x00});
+    }
+    TEST_ASSERT_EQUAL(SesionMQTT::CONECTADA, sesion.obtenerEstado());
+    sesion.procesar(1000 + SesionMQTT::TIEMPO_MAXIMO_PUBACK_MS);
+    TEST_ASSERT_EQUAL(SesionMQTT::DESCONECTADA, sesion.obtenerEstado());
+    TEST_ASSERT_EQUAL(SesionMQTT::ESTADO_CONEXION_PERDIDA, sesion.obtenerCodigo());
+    TEST_ASSERT_EQUAL(1, sesion.obtenerVentana().obtenerCantidad());
+
+    CanalSimulado nuevo;
+    conectar(sesion, nuevo, true, 40000);
+    TEST_ASSERT_EQUAL(2, nuevo.tomarPaquetes().size());
+
+    // El plazo vuelve a contar desde el reenvío
+    sesion.procesar(40000 + SesionMQTT::TIEMPO_MAXIMO_PUBACK_MS - 1);
+    TEST_ASSERT_EQUAL(SesionMQTT::CONECTADA, sesion.obtenerEstado());
+    sesion.procesar(40000 + SesionMQTT::TIEMPO_MAXIMO_PUBACK_MS);
+    TEST_ASSERT_EQUAL(SesionMQTT::DESCONECTADA, sesion.obtenerEstado());
+}
+
+// PINGREQ tras KEEP_ALIVE_S sin enviar; sin PINGRESP la conexión se da por perdida
+void test_keep_alive() {
+    const unsigned long KEEP_ALIVE_MS = SesionMQTT::KEEP_ALIVE_S * 1000UL;
+    CanalSimulado canal;
+    SesionMQTT sesion(entrada, sizeof(entrada), salida, sizeof(salida));
+    conectar(sesion, canal, false, 0);
+    canal.tomarPaquetes();
+
+    sesion.procesar(KEEP_ALIVE_MS - 1);
+    TEST_ASSERT_EQUAL(0, canal.tomarPaquetes().size());
+    sesion.procesar(KEEP_ALIVE_MS);
+    std::vector<Bytes> paquetes = canal.tomarPaquetes();
+    TEST_ASSERT_EQUAL(1, paquetes.size());
+    TEST_ASSERT_EQUAL_HEX8(0xC0, paquetes[0][0]);
+
+    canal.recibir(Bytes{0xD0, 0x00});
+    sesion.procesar(KEEP_ALIVE_MS + 100);
+    sesion.procesar(2 * KEEP_ALIVE_MS + 100);
+    TEST_ASSERT_EQUAL(1, canal.tomarPaquetes().size());
+
+    // Este no tiene respuesta
+    sesion.procesar(3 * KEEP_ALIVE_MS + 99);
+    TEST_ASSERT_EQUAL(SesionMQTT::CONECTADA, sesion.obtenerEstado());
+    sesion.procesar(3 * KEEP_ALIVE_MS + 100);
+    TEST_ASSERT_EQUAL(SesionMQTT::DESCONECTADA, sesion.obtenerEstado());
+}
+
+// Mensajes entrantes en trozos de 3 bytes; los QoS 1 se confirman con PUBACK
+void test_mensajes_entrantes() {
+    CanalSimulado canal;
+    canal.trozo = 3;
+    SesionMQTT sesion(entrada, sizeof(entrada), salida, sizeof(salida));
+    sesion.establecerCallbacks(alRecibir, alEntregar, nullptr);
+    conectar(sesion, canal, false, 0);
+    canal.tomarPaquetes();
+
+    canal.recibir(Bytes{0x32, 0x0A, 0x00, 0x03, 'c', '/', 'x', 0x01, 0x02, 'o', 'n', '!'});
+    canal.recibir(Bytes{0x31, 0x06, 0x00, 0x03, 'c', '/', 'y', '1'});
+    sesion.procesar(1);
+
+    TEST_ASSERT_EQUAL(2, recibidos.size());
+    TEST_ASSERT_EQUAL_STRING("c/x=on!", recibidos[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("c/y=1", recibidos[1].c_str());
+
+    std::vector<Bytes> paquetes = canal.tomarPaquetes();
+    TEST_ASSERT_EQUAL(1, paquetes.size());
+    const Bytes esperado = puback(0x0102);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(esperado.data(), paquetes[0].data(), esperado.size());
+
+    // Uno más grande que el buffer de entrada se descarta sin cortar la sesión
+    Bytes grande = {0x30, 0x88, 0x10, 0x00, 0x01, 'z'};
+    grande.resize(3 + 0x808, 'x');
+    canal.trozo = 256;
+    canal.recibir(grande);
+    canal.recibir(Bytes{0x30, 0x06, 0x00, 0x03, 'c', '/', 'z', '2'});
+    sesion.procesar(2);
+    TEST_ASSERT_EQUAL(SesionMQTT::CONECTADA, sesion.obtenerEstado());
+    TEST_ASSERT_EQUAL_UINT32(1, sesion.obtenerEntrantesDescartados());
+    TEST_ASSERT_EQUAL(3, recibidos.size());
+    TEST_ASSERT_EQUAL_STRING("c/z=2", recibidos[2].c_str());
+}
+
+// Un error de escritura cierra la sesión y el mensaje no cuenta como enviado
+void test_error_de_escritura() {
+    CanalSimulado canal;
+    SesionMQTT sesion(entrada, sizeof(entrada), salida, sizeof(salida));
+    sesion.establecerCallbacks(alRecibir, alEntregar, nullptr);
+    conectar(sesion, canal, false, 0);
+
+    canal.fallarEscritura = true;
+    TEST_ASSERT_FALSE(sesion.publicar("g/l", DATOS, sizeof(DATOS), 1, false, 5, 1));
+    TEST_ASSERT_EQUAL(SesionMQTT::DESCONECTADA, sesion.obtenerEstado());
+    TEST_ASSERT_EQUAL(0, sesion.obtenerVentana().obtenerCantidad());
+    TEST_ASSERT_EQUAL(0, entregas.size());
+
+    // Más grande que el buffer de salida: no se puede publicar
+    canal.fallarEscritura = false;
+    conectar(sesion, canal, false, 10);
+    static uint8_t grande[sizeof(salida)];
+    TEST_ASSERT_FALSE(sesion.puedePublicar("g/l", sizeof(grande), 0));
+    TEST_ASSERT_FALSE(sesion.publicar("g/l", grande, sizeof(grande), 0, false, 6, 11));
+    TEST_ASSERT_EQUAL(SesionMQTT::CONECTADA, sesion.obtenerEstado());
+}
+
+// Memoria de la ventana: las copias dan la vuelta al anillo sin pisar las
+// que siguen sin confirmar
+void test_memoria_de_la_ventana() {
+    static uint8_t datos[6000];
+    VentanaQoS ventana;
+    TEST_ASSERT_TRUE(ventana.configurar(VentanaQoS::TAMANO_MAXIMO));
+    TEST_ASSERT_FALSE(ventana.configurar(0));
+    TEST_ASSERT_FALSE(ventana.configurar(VentanaQoS::TAMANO_MAXIMO + 1));
+
+    // Cada copia ocupa 4 + 6000 bytes: entran dos en 16384
+    for (size_t i = 0; i < sizeof(datos); i++) {
+        datos[i] = (uint8_t)i;
+    }
+    TEST_ASSERT_TRUE(ventana.agregar(1, 101, "g/a", datos, sizeof(datos), false, 0));
+    datos[0] = 0xB0;
+    TEST_ASSERT_TRUE(ventana.agregar(2, 102, "g/b", datos, sizeof(datos), false, 0));
+    TEST_ASSERT_FALSE(ventana.hayLugar(3, sizeof(datos)));
+    TEST_ASSERT_FALSE(ventana.agregar(3, 103, "g/c", datos, sizeof(datos), false, 0));
+
+    // Confirmado el primero, el tercero va al principio del anillo si deja
+    // un hueco antes del segundo
+    uint32_t identificador = 0;
+    TEST_ASSERT_TRUE(ventana.confirmar(1, identificador));
+    TEST_ASSERT_EQUAL_UINT32(101, identificador);
+    TEST_ASSERT_FALSE(ventana.confirmar(1, identificador));
+    TEST_ASSERT_FALSE(ventana.hayLugar(3, sizeof(datos)));
+    datos[0] = 0xC0;
+    TEST_ASSERT_TRUE(ventana.agregar(3, 103, "g/c", datos, 5000, false, 0));
+
+    VentanaQoS::Pendiente pendiente;
+    TEST_ASSERT_TRUE(ventana.obtenerPendiente(0, pendiente));
+    TEST_ASSERT_EQUAL_STRING("g/b", pendiente.topic);
+    TEST_ASSERT_EQUAL_HEX8(0xB0, pendiente.datos[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, pendiente.datos[1]);
+    TEST_ASSERT_TRUE(ventana.obtenerPendiente(1, pendiente));
+    TEST_ASSERT_EQUAL_STRING("g/c", pendiente.topic);
+    TEST_ASSERT_EQUAL_HEX8(0xC0, pendiente.datos[0]);
+    TEST_ASSERT_EQUAL(5000, pendiente.longitud);
+    TEST_ASSERT_EQUAL_UINT16(3, pendiente.idPaquete);
+
+    // El hueco entre el fin del tercero y el segundo no alcanza para otro
+    TEST_ASSERT_FALSE(ventana.hayLugar(3, 1000));
+    TEST_ASSERT_TRUE(ventana.hayLugar(3, 990));
+    TEST_ASSERT_EQUAL_UINT32(1, ventana.obtenerRechazados());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_codificacion_de_paquetes);
+    RUN_TEST(test_longitud_variable);
+    RUN_TEST(test_lector_por_trozos);
+    RUN_TEST(test_connect_y_connack);
+    RUN_TEST(test_ventana_qos1);
+    RUN_TEST(test_reenvio_al_reconectar);
+    RUN_TEST(test_plazo_del_puback);
+    RUN_TEST(test_keep_alive);
+    RUN_TEST(test_mensajes_entrantes);
+    RUN_TEST(test_error_de_escritura);
+    RUN_TEST(test_memoria_de_la_ventana);
+    return UNITY_END();
+}
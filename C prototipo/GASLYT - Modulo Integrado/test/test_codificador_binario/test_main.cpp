@@ -0,0 +1,378 @@
+// CodificadorBinario en el PC: bytes idénticos a herramientas/payload_binario.py,
+// ida y vuelta con un decodificador MessagePack, y tamaño y tiempo frente a
+// serializeJson.
+// pio test -e native -f test_codificador_binario
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "CodificadorBinario.h"
+
+static void armarCanal(JsonObject canal) {
+    canal["tipo"] = "MQ-2";
+    canal["gas"] = "LPG";
+    canal["concentracion"] = 150.5;
+    canal["ratio"] = 1.85;
+    canal["umbral"] = 1000.0;
+    canal["alarma"] = false;
+    canal["valida"] = true;
+    JsonObject estadisticas = canal.createNestedObject("estadisticas");
+    estadisticas["media"] = 142.3;
+    estadisticas["desviacion"] = 6.8;
+    estadisticas["ewma"] = 148.9;
+    estadisticas["minimo"] = 131.0;
+    estadisticas["maximo"] = 156.2;
+    estadisticas["muestras"] = 120;
+    canal["tendencia"] = 0.42;
+    canal["tiempoHastaUmbral"] = 2025.0;
+}
+
+// Lectura de ejemplo del manual, igual que la arma enviarLectura()
+static void armarLectura(JsonDocument& doc, int cantidadCanales = 1) {
+    doc["timestamp"] = 1640995200L;
+    doc["fecha"] = "2024-01-01 12:00:00";
+    doc["concentracion"] = 150.5;
+    doc["unidad"] = "ppm";
+    doc["umbral"] = 1000.0;
+    doc["alarma"] = false;
+    doc["idDispositivo"] = "ESP32-GASLYT-123456";
+    doc["rssi"] = -45;
+    doc["arranque"] = 12;
+    doc["secuencia"] = 348;
+    JsonArray canales = doc.createNestedArray("canales");
+    for (int i = 0; i < cantidadCanales; i++) {
+        armarCanal(canales.createNestedObject());
+    }
+}
+
+// payload_binario.py codificar con el mismo JSON
+static const uint8_t LECTURA_REFERENCIA[] = {
+    0x8c, 0x00, 0x01, 0x01, 0xce, 0x61, 0xcf, 0x99, 0x80, 0x02, 0xb3, 0x32, 0x30, 0x32, 0x34, 0x2d,
+    0x30, 0x31, 0x2d, 0x30, 0x31, 0x20, 0x31, 0x32, 0x3a, 0x30, 0x30, 0x3a, 0x30, 0x30, 0x03, 0xca,
+    0x43, 0x16, 0x80, 0x00, 0x04, 0xa3, 0x70, 0x70, 0x6d, 0x05, 0xca, 0x44, 0x7a, 0x00, 0x00, 0x06,
+    0xc2, 0x07, 0xb3, 0x45, 0x53, 0x50, 0x33, 0x32, 0x2d, 0x47, 0x41, 0x53, 0x4c, 0x59, 0x54, 0x2d,
+    0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x08, 0xd0, 0xd3, 0x09, 0x0c, 0x0a, 0xcd, 0x01, 0x5c, 0x0b,
+    0x91, 0x8a, 0x0c, 0xa4, 0x4d, 0x51, 0x2d, 0x32, 0x0d, 0xa3, 0x4c, 0x50, 0x47, 0x03, 0xca, 0x43,
+    0x16, 0x80, 0x00, 0x0e, 0xca, 0x3f, 0xec, 0xcc, 0xcd, 0x05, 0xca, 0x44, 0x7a, 0x00, 0x00, 0x06,
+    0xc2, 0x0f, 0xc3, 0x10, 0x86, 0x11, 0xca, 0x43, 0x0e, 0x4c, 0xcd, 0x12, 0xca, 0x40, 0xd9, 0x99,
+    0x9a, 0x13, 0xca, 0x43, 0x14, 0xe6, 0x66, 0x14, 0xca, 0x43, 0x03, 0x00, 0x00, 0x15, 0xca, 0x43,
+    0x1c, 0x33, 0x33, 0x16, 0x78, 0x17, 0xca, 0x3e, 0xd7, 0x0a, 0x3d, 0x18, 0xca, 0x44, 0xfd, 0x20,
+    0x00,
+};
+
+// ---------------------------------------------------------------------------
+// Decodificador MessagePack mínimo (lo que escribe CodificadorBinario, sin nil)
+// ---------------------------------------------------------------------------
+
+struct Lector {
+    const uint8_t* datos;
+    size_t longitud;
+    size_t posicion;
+    bool error;
+
+    uint8_t byte() {
+        if (posicion >= longitud) {
+            error = true;
+            return 0;
+        }
+        return datos[posicion++];
+    }
+
+    uint64_t grande(int bytes) {
+        uint64_t valor = 0;
+        for (int i = 0; i < bytes; i++) {
+            valor = (valor << 8) | byte();
+        }
+        return valor;
+    }
+
+    std::string texto(size_t cantidad) {
+        if (posicion + cantidad > longitud) {
+            error = true;
+            return std::string();
+        }
+        std::string resultado((const char*)datos + posicion, cantidad);
+        posicion += cantidad;
+        return resultado;
+    }
+};
+
+struct Escalar {
+    enum Tipo { BOOLEANO, ENTERO, FLOTANTE, TEXTO } tipo;
+    bool booleano;
+    int64_t entero;
+    float flotante;
+    std::string texto;
+};
+
+static bool esMapa(uint8_t tipo) {
+    return (tipo & 0xF0) == 0x80 || tipo == 0xde;
+}
+
+static bool esArreglo(uint8_t tipo) {
+    return (tipo & 0xF0) == 0x90 || tipo == 0xdc;
+}
+
+static size_t leerCantidad(Lector& lector, uint8_t tipo) {
+    return (tipo == 0xde || tipo == 0xdc) ? (size_t)lector.grande(2) : (size_t)(tipo & 0x0F);
+}
+
+static Escalar leerEscalar(Lector& lector, uint8_t tipo) {
+    Escalar escalar;
+    escalar.tipo = Escalar::ENTERO;
+    escalar.entero = 0;
+    if (tipo <= 0x7f) {
+        escalar.entero = tipo;
+    } else if (tipo >= 0xe0) {
+        escalar.entero = (int8_t)tipo;
+    } else if (tipo == 0xc2 || tipo == 0xc3) {
+        escalar.tipo = Escalar::BOOLEANO;
+        escalar.booleano = tipo == 0xc3;
+    } else if (tipo >= 0xcc && tipo <= 0xcf) {
+        escalar.entero = (int64_t)lector.grande(1 << (tipo - 0xcc));
+    } else if (tipo >= 0xd0 && tipo <= 0xd3) {
+        int bytes = 1 << (tipo - 0xd0);
+        uint64_t bits = lector.grande(bytes);
+        escalar.entero = bytes == 8 ? (int64_t)bits : (int64_t)(bits << (64 - 8 * bytes)) >> (64 - 8 * bytes);
+    } else if (tipo == 0xca) {
+        uint32_t bits = (uint32_t)lector.grande(4);
+        escalar.tipo = Escalar::FLOTANTE;
+        memcpy(&escalar.flotante, &bits, sizeof(bits));
+    } else if ((tipo & 0xE0) == 0xa0 || tipo == 0xd9 || tipo == 0xda) {
+        size_t cantidad = (tipo & 0xE0) == 0xa0 ? (tipo & 0x1F) : (size_t)lector.grande(tipo == 0xd9 ? 1 : 2);
+        escalar.tipo = Escalar::TEXTO;
+        escalar.texto = lector.texto(cantidad);
+    } else {
+        lector.error = true;
+    }
+    return escalar;
+}
+
+template <typename Destino>
+static void asignar(Destino destino, const Escalar& escalar) {
+    switch (escalar.tipo) {
+        case Escalar::BOOLEANO: destino.set(escalar.booleano); break;
+        case Escalar::ENTERO: destino.set((long long)escalar.entero); break;
+        case Escalar::FLOTANTE: destino.set(escalar.flotante); break;
+        case Escalar::TEXTO: destino.set(escalar.texto); break;
+    }
+}
+
+static void leerMapa(Lector& lector, JsonObject objeto, size_t cantidad, bool raiz);
+
+static void leerArreglo(Lector& lector, JsonArray arreglo, size_t cantidad) {
+    for (size_t i = 0; i < cantidad && !lector.error; i++) {
+        uint8_t tipo = lector.byte();
+        if (esMapa(tipo)) {
+            leerMapa(lector, arreglo.createNestedObject(), leerCantidad(lector, tipo), false);
+        } else if (esArreglo(tipo)) {
+            leerArreglo(lector, arreglo.createNestedArray(), leerCantidad(lector, tipo));
+        } else {
+            asignar(arreglo.add(), leerEscalar(lector, tipo));
+        }
+    }
+}
+
+static void leerMapa(Lector& lector, JsonObject objeto, size_t cantidad, bool raiz) {
+    for (size_t i = 0; i < cantidad && !lector.error; i++) {
+        Escalar clave = leerEscalar(lector, lector.byte());
+        std::string nombre;
+        if (clave.tipo == Escalar::TEXTO) {
+            nombre = clave.texto;
+        } else if (clave.tipo == Escalar::ENTERO && clave.entero == CodificadorBinario::CLAVE_VERSION && raiz) {
+            Escalar version = leerEscalar(lector, lector.byte());
+            TEST_ASSERT_EQUAL(CodificadorBinario::VERSION_ESQUEMA, version.entero);
+            continue;
+        } else if (clave.tipo == Escalar::ENTERO && CodificadorBinario::obtenerNombreCampo((int)clave.entero)) {
+            nombre = CodificadorBinario::obtenerNombreCampo((int)clave.entero);
+        } else {
+            lector.error = true;
+            return;
+        }
+
+        uint8_t tipo = lector.byte();
+        if (esMapa(tipo)) {
+            leerMapa(lector, objeto.createNestedObject(nombre), leerCantidad(lector, tipo), false);
+        } else if (esArreglo(tipo)) {
+            leerArreglo(lector, objeto.createNestedArray(nombre), leerCantidad(lector, tipo));
+        } else {
+            asignar(objeto[nombre], leerEscalar(lector, tipo));
+        }
+    }
+}
+
+// Mensaje binario -> documento con los nombres de campo
+static bool decodificar(const uint8_t* datos, size_t longitud, JsonDocument& doc) {
+    Lector lector = {datos, longitud, 0, false};
+    uint8_t tipo = lector.byte();
+    if (!esMapa(tipo)) {
+        return false;
+    }
+    leerMapa(lector, doc.to<JsonObject>(), leerCantidad(lector, tipo), true);
+    return !lector.error && lector.posicion == longitud;
+}
+
+// Los decimales viajan como float32
+static bool iguales(JsonVariantConst a, JsonVariantConst b) {
+    if (a.is<JsonObjectConst>()) {
+        JsonObjectConst objetoA = a.as<JsonObjectConst>();
+        JsonObjectConst objetoB = b.as<JsonObjectConst>();
+        if (!b.is<JsonObjectConst>() || objetoA.size() != objetoB.size()) {
+            return false;
+        }
+        for (JsonPairConst par : objetoA) {
+            if (!objetoB.containsKey(par.key().c_str()) || !iguales(par.value(), objetoB[par.key().c_str()])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (a.is<JsonArrayConst>()) {
+        JsonArrayConst arregloA = a.as<JsonArrayConst>();
+        JsonArrayConst arregloB = b.as<JsonArrayConst>();
+        if (!b.is<JsonArrayConst>() || arregloA.size() != arregloB.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < arregloA.size(); i++) {
+            if (!iguales(arregloA[i], arregloB[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (a.is<bool>()) {
+        return b.is<bool>() && a.as<bool>() == b.as<bool>();
+    }
+    if (a.is<long long>()) {
+        return b.is<long long>() && a.as<long long>() == b.as<long long>();
+    }
+    if (a.is<float>()) {
+        return b.is<float>() && (float)a.as<double>() == (float)b.as<double>();
+    }
+    if (a.is<const char*>()) {
+        return b.is<const char*>() && strcmp(a.as<const char*>(), b.as<const char*>()) == 0;
+    }
+    return a.isNull() && b.isNull();
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_igual_que_la_referencia() {
+    DynamicJsonDocument doc(4096);
+    armarLectura(doc);
+    uint8_t binario[512];
+
+    size_t longitud = CodificadorBinario::codificar(doc.as<JsonVariantConst>(), binario, sizeof(binario));
+    TEST_ASSERT_EQUAL(sizeof(LECTURA_REFERENCIA), longitud);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(LECTURA_REFERENCIA, binario, sizeof(LECTURA_REFERENCIA));
+}
+
+void test_ida_y_vuelta() {
+    DynamicJsonDocument doc(4096);
+    armarLectura(doc);
+    doc["campoNuevo"] = "sin identificador";     // Se escribe como texto
+    doc["contador"] = 4000000000UL;
+    uint8_t binario[512];
+
+    size_t longitud = CodificadorBinario::codificar(doc.as<JsonVariantConst>(), binario, sizeof(binario));
+    TEST_ASSERT_TRUE(longitud > 0);
+
+    DynamicJsonDocument decodificado(4096);
+    TEST_ASSERT_TRUE(decodificar(binario, longitud, decodificado));
+    TEST_ASSERT_TRUE(iguales(doc.as<JsonVariantConst>(), decodificado.as<JsonVariantConst>()));
+}
+
+// Cada entero con la codificación más corta
+void test_enteros() {
+    struct Caso { long long valor; uint8_t bytes; };
+    const Caso casos[] = {
+        { 0, 1 }, { 127, 1 }, { 128, 2 }, { 255, 2 }, { 256, 3 }, { 65535, 3 }, { 65536, 5 },
+        { 4294967295LL, 5 }, { 4294967296LL, 9 }, { -1, 1 }, { -32, 1 }, { -33, 2 }, { -128, 2 },
+        { -129, 3 }, { -32768, 3 }, { -32769, 5 }, { -2147483648LL, 5 }, { -2147483649LL, 9 },
+    };
+
+    for (const Caso& caso : casos) {
+        StaticJsonDocument<256> doc;
+        doc["secuencia"] = caso.valor;
+        uint8_t binario[32];
+        size_t longitud = CodificadorBinario::codificar(doc.as<JsonVariantConst>(), binario, sizeof(binario));
+        // Mapa, versión (0, 1), clave 10 y el valor
+        TEST_ASSERT_EQUAL(4 + caso.bytes, longitud);
+
+        StaticJsonDocument<256> decodificado;
+        TEST_ASSERT_TRUE(decodificar(binario, longitud, decodificado));
+        TEST_ASSERT_TRUE(decodificado["secuencia"].as<long long>() == caso.valor);
+    }
+}
+
+void test_destino_chico_y_lotes() {
+    DynamicJsonDocument doc(4096);
+    armarLectura(doc);
+    uint8_t binario[512];
+
+    TEST_ASSERT_EQUAL(0, CodificadorBinario::codificar(doc.as<JsonVariantConst>(), binario, 100));
+    TEST_ASSERT_EQUAL(0, CodificadorBinario::codificar(doc.as<JsonVariantConst>(), binario, sizeof(LECTURA_REFERENCIA) - 1));
+    TEST_ASSERT_EQUAL(0, CodificadorBinario::codificar(doc.as<JsonVariantConst>(), nullptr, sizeof(binario)));
+
+    TEST_ASSERT_EQUAL(CodificadorBinario::TAMANO_CABECERA_ARREGLO,
+                      CodificadorBinario::codificarCabeceraArreglo(300, binario, sizeof(binario)));
+    TEST_ASSERT_EQUAL_HEX8(0xdc, binario[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, binario[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x2c, binario[2]);
+    TEST_ASSERT_EQUAL(0, CodificadorBinario::codificarCabeceraArreglo(1, binario, 2));
+
+    TEST_ASSERT_EQUAL(11, CodificadorBinario::obtenerIdCampo("canales"));
+    TEST_ASSERT_EQUAL_STRING("canales", CodificadorBinario::obtenerNombreCampo(11));
+    TEST_ASSERT_NULL(CodificadorBinario::obtenerNombreCampo(0));
+    TEST_ASSERT_NULL(CodificadorBinario::obtenerNombreCampo(1000));
+}
+
+// Tamaño y tiempo de codificación frente a serializeJson, lectura de 4 canales
+void test_tamano_y_tiempo_frente_a_json() {
+    const int REPETICIONES = 20000;
+    DynamicJsonDocument doc(8192);
+    armarLectura(doc, 4);
+    static uint8_t binario[2048];
+    static char json[2048];
+
+    size_t bytesBinario = CodificadorBinario::codificar(doc.as<JsonVariantConst>(), binario, sizeof(binario));
+    size_t bytesJson = serializeJson(doc, json, sizeof(json));
+    TEST_ASSERT_TRUE(bytesBinario > 0);
+    TEST_ASSERT_EQUAL(measureJson(doc), bytesJson);
+
+    // Los nombres de campo son la mayor parte del JSON
+    TEST_ASSERT_LESS_THAN(bytesJson * 40 / 100, bytesBinario);
+
+    size_t total = 0;
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETICIONES; i++) {
+        total += CodificadorBinario::codificar(doc.as<JsonVariantConst>(), binario, sizeof(binario));
+    }
+    auto medio = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETICIONES; i++) {
+        total += serializeJson(doc, json, sizeof(json));
+    }
+    auto fin = std::chrono::steady_clock::now();
+    TEST_ASSERT_EQUAL((bytesBinario + bytesJson) * REPETICIONES, total);
+
+    double usBinario = std::chrono::duration<double, std::micro>(medio - inicio).count() / REPETICIONES;
+    double usJson = std::chrono::duration<double, std::micro>(fin - medio).count() / REPETICIONES;
+    char mensaje[128];
+    snprintf(mensaje, sizeof(mensaje), "Lectura de 4 canales: JSON %u bytes (%.2f us), MessagePack %u bytes "
+             "(%.2f us), %.0f%% menos", (unsigned)bytesJson, usJson, (unsigned)bytesBinario, usBinario,
+             100.0 - 100.0 * bytesBinario / bytesJson);
+    TEST_MESSAGE(mensaje);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_igual_que_la_referencia);
+    RUN_TEST(test_ida_y_vuelta);
+    RUN_TEST(test_enteros);
+    RUN_TEST(test_destino_chico_y_lotes);
+    RUN_TEST(test_tamano_y_tiempo_frente_a_json);
+    return UNITY_END();
+}
@@ -0,0 +1,114 @@
+// Validez, saturación, alarma y unidades de ConversionCanal con los perfiles reales.
+// pio test -e native -f test_conversion_canal
+#include <unity.h>
+#include <math.h>
+#include "ConversionCanal.h"
+
+// Mismo divisor que GasSensorArray
+static const float ALIMENTACION_V = 3.3f;
+static const float CARGA_KOHM = 10.0f;
+static const float R0_KOHM = 10.0f;
+
+// Tensión en la carga para una concentración dada: inversa de la curva
+static float milivoltiosPara(double a, double b, double ppm) {
+    double ratio = pow(ppm / a, 1.0 / b);
+    double rs = ratio * R0_KOHM;
+    return (float)(ALIMENTACION_V * CARGA_KOHM * 1000.0 / (rs + CARGA_KOHM));
+}
+
+static ConversionCanal::Resultado convertir(TipoSensorMQ tipo, float milivoltios, float umbral) {
+    return ConversionCanal::convertir(PerfilesSensor::obtener(tipo), milivoltios, R0_KOHM, umbral,
+                                      ALIMENTACION_V, CARGA_KOHM);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_dentro_del_rango() {
+    // MQ-7 a 100 ppm de CO, por debajo y por encima del umbral
+    float mv = milivoltiosPara(99.042, -1.518, 100.0);
+    ConversionCanal::Resultado resultado = convertir(SENSOR_MQ7, mv, 200.0f);
+    TEST_ASSERT_TRUE(resultado.valida);
+    TEST_ASSERT_FALSE(resultado.saturada);
+    TEST_ASSERT_FALSE(resultado.alarma);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 100.0f, resultado.ppm);
+
+    resultado = convertir(SENSOR_MQ7, mv, 50.0f);
+    TEST_ASSERT_TRUE(resultado.valida);
+    TEST_ASSERT_TRUE(resultado.alarma);
+}
+
+// Por encima del rango la lectura se recorta, sigue válida y dispara la alarma
+void test_sobre_el_rango() {
+    ConversionCanal::Resultado resultado = convertir(SENSOR_MQ7, milivoltiosPara(99.042, -1.518, 3000.0), 200.0f);
+    TEST_ASSERT_TRUE(resultado.valida);
+    TEST_ASSERT_TRUE(resultado.saturada);
+    TEST_ASSERT_TRUE(resultado.alarma);
+    TEST_ASSERT_EQUAL_FLOAT(2000.0f, resultado.ppm);
+
+    resultado = convertir(SENSOR_MQ9, milivoltiosPara(599.65, -2.244, 1500.0), 1000.0f);
+    TEST_ASSERT_TRUE(resultado.valida);
+    TEST_ASSERT_TRUE(resultado.saturada);
+    TEST_ASSERT_TRUE(resultado.alarma);
+    TEST_ASSERT_EQUAL_FLOAT(1000.0f, resultado.ppm);
+}
+
+// Sensor a fondo de escala (Rs = 0): todos los perfiles saturan en alarma
+void test_fondo_de_escala() {
+    const float FONDO_ESCALA_MV = ALIMENTACION_V * 1000.0f;
+    for (uint8_t i = 0; i < CANTIDAD_TIPOS_SENSOR; i++) {
+        const PerfilSensor& perfil = PerfilesSensor::obtener((TipoSensorMQ)i);
+        ConversionCanal::Resultado resultado = convertir((TipoSensorMQ)i, FONDO_ESCALA_MV, perfil.rangoMaximo);
+        TEST_ASSERT_EQUAL_FLOAT_MESSAGE(0.0f, resultado.rs, perfil.nombre);
+        TEST_ASSERT_TRUE_MESSAGE(resultado.valida, perfil.nombre);
+        TEST_ASSERT_TRUE_MESSAGE(resultado.saturada, perfil.nombre);
+        TEST_ASSERT_TRUE_MESSAGE(resultado.alarma, perfil.nombre);
+        TEST_ASSERT_EQUAL_FLOAT_MESSAGE(perfil.rangoMaximo, resultado.ppm, perfil.nombre);
+
+        // Por encima de la escala (ruido del ADC) tampoco se invalida
+        resultado = convertir((TipoSensorMQ)i, FONDO_ESCALA_MV + 50.0f, perfil.rangoMaximo);
+        TEST_ASSERT_TRUE_MESSAGE(resultado.alarma, perfil.nombre);
+    }
+}
+
+// La curva del MQ-3 da mg/L: el perfil la informa en ppm
+void test_mq3_en_ppm() {
+    const PerfilSensor& perfil = PerfilesSensor::obtener(SENSOR_MQ3);
+    ConversionCanal::Resultado resultado = convertir(SENSOR_MQ3, milivoltiosPara(0.39, -1.504, 1.0), 1000.0f);
+    TEST_ASSERT_TRUE(resultado.valida);
+    TEST_ASSERT_FALSE(resultado.saturada);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 530.7f, resultado.ppm);                 // 1 mg/L de etanol
+    TEST_ASSERT_FLOAT_WITHIN(4.0f, 1000.0f, PerfilesSensor::convertir(perfil, resultado.ppm, UNIDAD_MG_M3));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.61f, PerfilesSensor::convertir(perfil, resultado.ppm, UNIDAD_LEL));
+
+    // El rango del perfil (10 mg/L) también está en ppm
+    resultado = convertir(SENSOR_MQ3, milivoltiosPara(0.39, -1.504, 12.0), 1000.0f);
+    TEST_ASSERT_TRUE(resultado.saturada);
+    TEST_ASSERT_TRUE(resultado.alarma);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 5307.0f, resultado.ppm);
+}
+
+// Sin señal o por debajo del rango: inválida y sin alarma
+void test_invalidas() {
+    ConversionCanal::Resultado resultado = convertir(SENSOR_MQ7, 0.0f, 1.0f);
+    TEST_ASSERT_FALSE(resultado.valida);
+    TEST_ASSERT_FALSE(resultado.saturada);
+    TEST_ASSERT_FALSE(resultado.alarma);
+
+    PerfilSensor perfil = PerfilesSensor::obtener(SENSOR_MQ7);
+    perfil.rangoMinimo = 20.0f;
+    resultado = ConversionCanal::convertir(perfil, milivoltiosPara(99.042, -1.518, 10.0), R0_KOHM, 5.0f,
+                                           ALIMENTACION_V, CARGA_KOHM);
+    TEST_ASSERT_FALSE(resultado.valida);
+    TEST_ASSERT_FALSE(resultado.alarma);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_dentro_del_rango);
+    RUN_TEST(test_sobre_el_rango);
+    RUN_TEST(test_fondo_de_escala);
+    RUN_TEST(test_mq3_en_ppm);
+    RUN_TEST(test_invalidas);
+    return UNITY_END();
+}
@@ -0,0 +1,149 @@
+// Exactitud de ConversionGasQ frente a a*pow(ratio, b) en double.
+// pio test -e native -f test_conversion_gas_q
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "ConversionGasQ.h"
+
+using namespace ConversionGasQ;
+
+struct CasoCurva {
+    const char* nombre;
+    const CurvaQ* curva;
+    double a;
+    double b;
+};
+
+static const CasoCurva CASOS[] = {
+    { "MQ-2",   &CURVA_MQ2,   987.99, -2.162 },
+    { "MQ-3",   &CURVA_MQ3,   0.39,   -1.504 },
+    { "MQ-4",   &CURVA_MQ4,   1012.7, -2.786 },
+    { "MQ-5",   &CURVA_MQ5,   1163.8, -3.874 },
+    { "MQ-6",   &CURVA_MQ6,   2127.2, -2.526 },
+    { "MQ-7",   &CURVA_MQ7,   99.042, -1.518 },
+    { "MQ-8",   &CURVA_MQ8,   976.97, -0.688 },
+    { "MQ-9",   &CURVA_MQ9,   599.65, -2.244 },
+    { "MQ-135", &CURVA_MQ135, 110.47, -2.862 },
+};
+
+// Dominio documentado en ConversionGasQ.h
+static const uint16_t ESCALA = 1023;
+static const uint16_t MUESTRA_MIN = 10;         // 1% de la escala
+static const uint16_t MUESTRA_MAX = 1013;       // 99% de la escala
+static const double R0RL_MIN = 0.5;
+static const double R0RL_MAX = 10.0;
+static const int PASOS_R0RL = 200;
+static const double PPM_MIN = 0.01;
+static const double PPM_MAX = 10000.0;
+
+// Cotas documentadas; por debajo de 1 ppm pesa la resolución de salida (1/65536 ppm)
+static const double ERROR_PPM = 0.0018;
+static const double ERROR_PPM_DESDE_1 = 0.0006;
+static const double ERROR_RATIO = 0.0002;
+static const double RATIO_MIN_COTA = 0.05;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static double valorQ(int64_t q) {
+    return (double)q / UNO;
+}
+
+// Recorre muestra x R0/RL; R0/RL de referencia es el que representa el Q16.16 guardado
+template <typename Funcion>
+static void barrer(Funcion funcion) {
+    for (int paso = 0; paso <= PASOS_R0RL; paso++) {
+        double r0rl = R0RL_MIN * pow(R0RL_MAX / R0RL_MIN, (double)paso / PASOS_R0RL);
+        SensorQ sensor = { ESCALA, Q16(log2(r0rl)), nullptr };
+        double r0rlGuardado = pow(2.0, valorQ(sensor.log2R0RL));
+        for (uint16_t muestra = MUESTRA_MIN; muestra <= MUESTRA_MAX; muestra++) {
+            double ratio = ((double)(ESCALA - muestra) / muestra) / r0rlGuardado;
+            funcion(sensor, muestra, ratio);
+        }
+    }
+}
+
+void test_error_ppm_por_curva(void) {
+    double peor = 0.0;
+    double peorDesde1 = 0.0;
+    char mensaje[96];
+    for (const CasoCurva& caso : CASOS) {
+        double maximo = 0.0;
+        double maximoDesde1 = 0.0;
+        long puntos = 0;
+        barrer([&](SensorQ& sensor, uint16_t muestra, double ratio) {
+            double referencia = caso.a * pow(ratio, caso.b);
+            if (referencia < PPM_MIN || referencia > PPM_MAX) {
+                return;
+            }
+            sensor.curva = caso.curva;
+            double ppm = valorQ(convertir(sensor, muestra));
+            double error = fabs(ppm - referencia) / referencia;
+            if (error > maximo) {
+                maximo = error;
+            }
+            if (referencia >= 1.0 && error > maximoDesde1) {
+                maximoDesde1 = error;
+            }
+            puntos++;
+        });
+        snprintf(mensaje, sizeof(mensaje), "%s: error ppm máximo %.3f%%, %.3f%% desde 1 ppm (%ld puntos)",
+                 caso.nombre, maximo * 100.0, maximoDesde1 * 100.0, puntos);
+        TEST_MESSAGE(mensaje);
+        TEST_ASSERT_TRUE_MESSAGE(puntos > 0, caso.nombre);
+        if (maximo > peor) {
+            peor = maximo;
+        }
+        if (maximoDesde1 > peorDesde1) {
+            peorDesde1 = maximoDesde1;
+        }
+    }
+    TEST_ASSERT_LESS_THAN_FLOAT((float)ERROR_PPM, (float)peor);
+    TEST_ASSERT_LESS_THAN_FLOAT((float)ERROR_PPM_DESDE_1, (float)peorDesde1);
+}
+
+void test_error_ratio(void) {
+    double maximo = 0.0;
+    barrer([&](SensorQ& sensor, uint16_t muestra, double ratio) {
+        if (ratio <= RATIO_MIN_COTA) {
+            return;
+        }
+        double calculado = pow(2.0, valorQ(log2Ratio(sensor, muestra)));
+        double error = fabs(calculado - ratio) / ratio;
+        if (error > maximo) {
+            maximo = error;
+        }
+    });
+    char mensaje[64];
+    snprintf(mensaje, sizeof(mensaje), "ratio > %.2f: error máximo %.4f%%", RATIO_MIN_COTA, maximo * 100.0);
+    TEST_MESSAGE(mensaje);
+    TEST_ASSERT_LESS_THAN_FLOAT((float)ERROR_RATIO, (float)maximo);
+}
+
+void test_extremos(void) {
+    // Sin señal o a escala completa no se desborda ni se divide por cero
+    SensorQ sensor = { ESCALA, Q16(log2(2.0)), &CURVA_MQ2 };
+    TEST_ASSERT_TRUE(convertir(sensor, 0) < convertir(sensor, MUESTRA_MIN));
+    TEST_ASSERT_EQUAL_UINT32(SATURACION, convertir(sensor, ESCALA));
+    TEST_ASSERT_EQUAL_INT32(0, log2Entero(1));
+    TEST_ASSERT_EQUAL_UINT32(UNO, exp2Q(0));
+}
+
+void test_formatear(void) {
+    char texto[16];
+    TEST_ASSERT_EQUAL_UINT8(6, formatear(texto, sizeof(texto), Q16(12.345), 3));
+    TEST_ASSERT_EQUAL_STRING("12.345", texto);
+    formatear(texto, sizeof(texto), Q16(0.99996), 4);
+    TEST_ASSERT_EQUAL_STRING("1.0000", texto);
+    formatear(texto, sizeof(texto), 7 * UNO, 0);
+    TEST_ASSERT_EQUAL_STRING("7", texto);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_error_ppm_por_curva);
+    RUN_TEST(test_error_ratio);
+    RUN_TEST(test_extremos);
+    RUN_TEST(test_formatear);
+    return UNITY_END();
+}
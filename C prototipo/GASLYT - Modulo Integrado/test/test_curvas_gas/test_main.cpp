@@ -0,0 +1,102 @@
+// Exactitud y costo de CurvasGas frente a a*pow(ratio, b).
+// pio test -e native -f test_curvas_gas
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include "CurvasGas.h"
+
+struct CasoCurva {
+    const char* nombre;
+    const CurvasGas::TablaCurva* tabla;
+    double a;
+    double b;
+    double errorMaximo;     // El documentado en CurvasGas.h
+};
+
+// Mismos coeficientes que las tablas; MQ-5 es la curva más pronunciada
+static const CasoCurva CASOS[] = {
+    { "MQ-2",   &CurvasGas::MQ2,   987.99, -2.162, 0.0004 },
+    { "MQ-3",   &CurvasGas::MQ3,   0.39,   -1.504, 0.0004 },
+    { "MQ-4",   &CurvasGas::MQ4,   1012.7, -2.786, 0.0004 },
+    { "MQ-5",   &CurvasGas::MQ5,   1163.8, -3.874, 0.0006 },
+    { "MQ-6",   &CurvasGas::MQ6,   2127.2, -2.526, 0.0004 },
+    { "MQ-7",   &CurvasGas::MQ7,   99.042, -1.518, 0.0004 },
+    { "MQ-8",   &CurvasGas::MQ8,   976.97, -0.688, 0.0004 },
+    { "MQ-9",   &CurvasGas::MQ9,   599.65, -2.244, 0.0004 },
+    { "MQ-135", &CurvasGas::MQ135, 110.47, -2.862, 0.0004 },
+};
+static const int PUNTOS_BARRIDO = 200000;
+
+// Las tablas se generan al compilar
+static_assert(CurvasGas::MQ2.mantisa[0] == 1.0f, "m^b en m = 1");
+static_assert(CurvasGas::MQ5.escala[-CurvasGas::EXPONENTE_MIN] == 1163.8f, "a * 2^0");
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static double errorMaximoCurva(const CasoCurva& caso) {
+    // Barrido logarítmico de ratio en [0.01, 100]
+    double maximo = 0.0;
+    for (int i = 0; i <= PUNTOS_BARRIDO; i++) {
+        double ratio = pow(10.0, -2.0 + 4.0 * i / PUNTOS_BARRIDO);
+        double referencia = caso.a * pow((double)(float)ratio, caso.b);
+        double error = fabs(CurvasGas::evaluar(*caso.tabla, (float)ratio) - referencia) / referencia;
+        if (error > maximo) {
+            maximo = error;
+        }
+    }
+    return maximo;
+}
+
+void test_error_relativo_por_curva(void) {
+    char mensaje[96];
+    for (const CasoCurva& caso : CASOS) {
+        double error = errorMaximoCurva(caso);
+        snprintf(mensaje, sizeof(mensaje), "%s: error relativo máximo %.4f%% (límite %.2f%%)",
+                 caso.nombre, error * 100.0, caso.errorMaximo * 100.0);
+        TEST_MESSAGE(mensaje);
+        TEST_ASSERT_LESS_THAN_FLOAT((float)caso.errorMaximo, (float)error);
+    }
+}
+
+void test_saturacion_fuera_de_rango(void) {
+    // Fuera de [2^-8, 2^9) se usa el extremo de la tabla; 0 y negativos no dan NaN
+    const CurvasGas::TablaCurva& tabla = CurvasGas::MQ2;
+    TEST_ASSERT_EQUAL_FLOAT(CurvasGas::evaluar(tabla, 1.0f / 256.0f), CurvasGas::evaluar(tabla, 1e-6f));
+    TEST_ASSERT_EQUAL_FLOAT(CurvasGas::evaluar(tabla, 0.0f), CurvasGas::evaluar(tabla, -1.0f));
+    TEST_ASSERT_FALSE(isnan(CurvasGas::evaluar(tabla, NAN)));
+    TEST_ASSERT_TRUE(CurvasGas::evaluar(tabla, 1e6f) <= CurvasGas::evaluar(tabla, 511.0f));
+}
+
+void test_costo_frente_a_pow(void) {
+    // Solo informa: el tiempo depende de la máquina
+    const int REPETICIONES = 2000000;
+    volatile float sumidero = 0.0f;
+    float ratio = 0.05f;
+
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETICIONES; i++) {
+        sumidero = sumidero + CurvasGas::evaluar(CurvasGas::MQ2, ratio + i * 1e-6f);
+    }
+    auto medio = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETICIONES; i++) {
+        sumidero = sumidero + 987.99f * powf(ratio + i * 1e-6f, -2.162f);
+    }
+    auto fin = std::chrono::steady_clock::now();
+
+    double nsTabla = std::chrono::duration<double, std::nano>(medio - inicio).count() / REPETICIONES;
+    double nsPow = std::chrono::duration<double, std::nano>(fin - medio).count() / REPETICIONES;
+    char mensaje[96];
+    snprintf(mensaje, sizeof(mensaje), "tabla %.1f ns, powf %.1f ns por evaluación", nsTabla, nsPow);
+    TEST_MESSAGE(mensaje);
+    TEST_ASSERT_FALSE(isnan(sumidero));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_error_relativo_por_curva);
+    RUN_TEST(test_saturacion_fuera_de_rango);
+    RUN_TEST(test_costo_frente_a_pow);
+    return UNITY_END();
+}
@@ -0,0 +1,197 @@
+// El camino de publicación de una lectura no reserva memoria: armar el
+// documento, serializarlo en JSON o MessagePack y pasarlo por la cola de
+// salida, como publicarLectura() de main.cpp y MQTTManager.
+// pio test -e native -f test_payload_mqtt
+#include <unity.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "PayloadMQTT.h"
+#include "PlanificadorSalida.h"
+
+using namespace PayloadMQTT;
+
+// Cuenta las reservas de memoria dinámica de C++ (String, std::string, new)
+static volatile unsigned long reservas = 0;
+
+void* operator new(size_t tamano) {
+    reservas++;
+    void* memoria = malloc(tamano ? tamano : 1);
+    if (!memoria) {
+        throw std::bad_alloc();
+    }
+    return memoria;
+}
+
+void operator delete(void* memoria) noexcept {
+    free(memoria);
+}
+
+void operator delete(void* memoria, size_t) noexcept {
+    free(memoria);
+}
+
+// Transporte conectado y con lugar en la ventana: acepta todo
+class DestinoSimulado : public DestinoSalida {
+public:
+    unsigned long publicados = 0;
+    size_t ultimaLongitud = 0;
+
+    bool estaConectado() override {
+        return true;
+    }
+
+    bool publicar(const char* topic, const uint8_t* datos, size_t longitud, uint8_t qos, bool retener,
+                  uint32_t identificador) override {
+        publicados++;
+        ultimaLongitud = longitud;
+        return true;
+    }
+};
+
+static const int CANALES = 4;
+static const int LECTURAS = 1000;
+static const char* const TOPIC = "gaslyt/ESP32-GASLYT-A1B2C3/lecturas";
+
+// documentoLectura de main.cpp tiene 2048 bytes en el ESP32, donde un slot
+// de ArduinoJson ocupa 16 bytes; en el PC ocupa 32
+static StaticJsonDocument<2048 * sizeof(void*) / 4> documento;
+static uint8_t payload[2048];   // MQTTManager::TAMANO_MAXIMO_PAYLOAD
+static PlanificadorSalida planificador;
+static DestinoSimulado destino;
+
+static void datosLectura(DatosCanal* canales, DatosLectura& lectura, const char* fecha, uint32_t secuencia) {
+    static const char* const TIPOS[CANALES] = { "MQ-2", "MQ-3", "MQ-7", "MQ-135" };
+    static const char* const GASES[CANALES] = { "LPG", "Alcohol", "CO", "CO2" };
+
+    for (int i = 0; i < CANALES; i++) {
+        DatosCanal& canal = canales[i];
+        canal.tipo = TIPOS[i];
+        canal.gas = GASES[i];
+        canal.concentracion = 150.5f + i * 10 + secuencia % 7;
+        canal.ratio = 1.85f - i * 0.1f;
+        canal.umbral = 1000.0f;
+        canal.alarma = false;
+        canal.valida = true;
+        canal.saturada = false;
+        canal.media = 142.3f;
+        canal.desviacion = 6.8f;
+        canal.ewma = 148.9f;
+        canal.minimo = 131.0f;
+        canal.maximo = 156.2f;
+        canal.muestras = 120 + secuencia;
+        canal.tendencia = 0.42f;
+        canal.tiempoHastaUmbral = 2025.0f;
+    }
+
+    lectura.timestamp = 1640995200UL + secuencia;
+    lectura.fecha = fecha;
+    lectura.concentracion = canales[0].concentracion;
+    lectura.umbral = 1000.0f;
+    lectura.alarma = false;
+    lectura.idDispositivo = "ESP32-GASLYT-A1B2C3";
+    lectura.rssi = -45;
+    lectura.arranque = 12;
+    lectura.secuencia = secuencia;
+    lectura.canales = canales;
+    lectura.cantidadCanales = CANALES;
+}
+
+// Lo que hace el equipo con cada lectura; devuelve los bytes del payload
+static size_t publicarLectura(bool binario, uint32_t secuencia) {
+    DatosCanal canales[CANALES];
+    DatosLectura lectura;
+    char fecha[20];
+    snprintf(fecha, sizeof(fecha), "2024-01-01 12:%02u:%02u", (unsigned)(secuencia / 60 % 60),
+             (unsigned)(secuencia % 60));
+    datosLectura(canales, lectura, fecha, secuencia);
+
+    TEST_ASSERT_TRUE(armarLectura(documento, lectura));
+    size_t longitud = serializar(documento.as<JsonObject>(), binario, payload, sizeof(payload));
+    TEST_ASSERT_GREATER_THAN(0, longitud);
+    TEST_ASSERT_NOT_EQUAL(0, planificador.encolar(PlanificadorSalida::PRIORIDAD_LECTURA, TOPIC, payload, longitud,
+                                                  1, false));
+    planificador.despachar(&destino);
+    return longitud;
+}
+
+static void verificarSinReservas(bool binario) {
+    // La primera vuelta fuera de la cuenta
+    publicarLectura(binario, 0);
+    unsigned long publicadosAntes = destino.publicados;
+
+    reservas = 0;
+    size_t bytes = 0;
+    for (int i = 1; i <= LECTURAS; i++) {
+        bytes += publicarLectura(binario, i);
+    }
+    unsigned long contadas = reservas;
+
+    TEST_ASSERT_EQUAL(0, contadas);
+    TEST_ASSERT_EQUAL(LECTURAS, destino.publicados - publicadosAntes);
+    TEST_ASSERT_EQUAL(0, planificador.obtenerEnEspera());
+
+    char mensaje[96];
+    snprintf(mensaje, sizeof(mensaje), "%s: %d lecturas de %d canales, %u bytes promedio, %lu reservas",
+             binario ? "MessagePack" : "JSON", LECTURAS, CANALES, (unsigned)(bytes / LECTURAS), contadas);
+    TEST_MESSAGE(mensaje);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_lectura_json() {
+    size_t longitud = publicarLectura(false, 348);
+    const char* json = (const char*)payload;
+
+    TEST_ASSERT_EQUAL(longitud, strlen(json));
+    TEST_ASSERT_EQUAL(longitud, destino.ultimaLongitud);
+    TEST_ASSERT_EQUAL(0, strncmp(json, "{\"timestamp\":1640995548,\"fecha\":\"2024-01-01 12:05:48\"", 53));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"unidad\":\"ppm\""));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"idDispositivo\":\"ESP32-GASLYT-A1B2C3\""));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"secuencia\":348,\"canales\":[{\"tipo\":\"MQ-2\",\"gas\":\"LPG\""));
+    TEST_ASSERT_NOT_NULL(strstr(json, "{\"tipo\":\"MQ-135\",\"gas\":\"CO2\""));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"estadisticas\":{\"media\":"));
+}
+
+void test_lectura_msgpack() {
+    size_t longitudJson = publicarLectura(false, 348);
+    size_t longitud = publicarLectura(true, 348);
+
+    // Mapa de 12: la versión del esquema y los 11 campos de la lectura
+    TEST_ASSERT_EQUAL_HEX8(0x8c, payload[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, payload[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, payload[2]);
+    TEST_ASSERT_EQUAL(longitud, destino.ultimaLongitud);
+    TEST_ASSERT_LESS_THAN(longitudJson, longitud);
+}
+
+void test_sin_reservas_json() {
+    verificarSinReservas(false);
+}
+
+void test_sin_reservas_msgpack() {
+    verificarSinReservas(true);
+}
+
+// Un documento chico no publica una lectura recortada
+void test_documento_lleno() {
+    static StaticJsonDocument<256 * sizeof(void*) / 4> chico;
+    DatosCanal canales[CANALES];
+    DatosLectura lectura;
+    datosLectura(canales, lectura, "2024-01-01 12:00:00", 1);
+
+    TEST_ASSERT_FALSE(armarLectura(chico, lectura));
+    TEST_ASSERT_TRUE(armarLectura(documento, lectura));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_lectura_json);
+    RUN_TEST(test_lectura_msgpack);
+    RUN_TEST(test_sin_reservas_json);
+    RUN_TEST(test_sin_reservas_msgpack);
+    RUN_TEST(test_documento_lleno);
+    return UNITY_END();
+}
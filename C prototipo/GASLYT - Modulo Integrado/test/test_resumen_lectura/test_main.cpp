@@ -0,0 +1,145 @@
+// Las líneas de ResumenLectura no reservan memoria y entran en un registro
+// del logger.
+// pio test -e native -f test_resumen_lectura
+#include <unity.h>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include "ResumenLectura.h"
+
+using namespace ResumenLectura;
+
+// Cuenta las reservas de memoria dinámica de C++ (String, std::string, new)
+static volatile unsigned long reservas = 0;
+
+void* operator new(size_t tamano) {
+    reservas++;
+    void* memoria = malloc(tamano ? tamano : 1);
+    if (!memoria) {
+        throw std::bad_alloc();
+    }
+    return memoria;
+}
+
+void operator delete(void* memoria) noexcept {
+    free(memoria);
+}
+
+void operator delete(void* memoria, size_t) noexcept {
+    free(memoria);
+}
+
+static DatosCanal datosEjemplo() {
+    DatosCanal datos;
+    datos.canal = 3;
+    datos.nombre = "MQ-135";
+    datos.pin = 34;
+    datos.ppm = 412.5f;
+    datos.umbral = 1000.0f;
+    datos.ratio = 0.8124f;
+    datos.valida = true;
+    datos.saturada = false;
+    datos.alarma = false;
+    datos.media = 400.25f;
+    datos.desviacion = 12.5f;
+    datos.ewma = 405.0f;
+    datos.minimo = 380.0f;
+    datos.maximo = 430.75f;
+    datos.cantidad = 1200;
+    datos.pendiente = 0.125f;
+    datos.tiempoHastaUmbral = 4700.0f;
+    return datos;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_lineas() {
+    char linea[LONGITUD_LINEA];
+    DatosCanal datos = datosEjemplo();
+
+    size_t largo = formatearCanal(linea, sizeof(linea), datos);
+    TEST_ASSERT_EQUAL_STRING("Canal 3 [MQ-135] pin 34: 412.50 ppm (umbral 1000.00) Rs/R0=0.812", linea);
+    TEST_ASSERT_EQUAL(strlen(linea), largo);
+
+    formatearEstadisticas(linea, sizeof(linea), datos);
+    TEST_ASSERT_EQUAL_STRING("  media=400.25 desv=12.50 ewma=405.00 min=380.00 max=430.75 n=1200", linea);
+
+    formatearTendencia(linea, sizeof(linea), datos);
+    TEST_ASSERT_EQUAL_STRING("  tendencia=0.125 ppm/s umbral en 4700 s", linea);
+
+    datos.tiempoHastaUmbral = -1.0f;
+    datos.valida = false;
+    datos.alarma = true;
+    formatearTendencia(linea, sizeof(linea), datos);
+    TEST_ASSERT_EQUAL_STRING("  tendencia=0.125 ppm/s", linea);
+    formatearCanal(linea, sizeof(linea), datos);
+    TEST_ASSERT_EQUAL_STRING("Canal 3 [MQ-135] pin 34: 412.50 ppm (umbral 1000.00) Rs/R0=0.812 INVALIDA ALARMA", linea);
+
+    datos.valida = true;
+    datos.saturada = true;
+    formatearCanal(linea, sizeof(linea), datos);
+    TEST_ASSERT_EQUAL_STRING("Canal 3 [MQ-135] pin 34: 412.50 ppm (umbral 1000.00) Rs/R0=0.812 SATURADA ALARMA", linea);
+}
+
+// Valores extremos: las tres líneas siguen entrando en un registro
+void test_entran_en_un_registro() {
+    char linea[LONGITUD_LINEA + 64];
+    DatosCanal datos = datosEjemplo();
+    datos.canal = 7;
+    datos.pin = 39;
+    datos.ppm = datos.umbral = datos.media = datos.desviacion = -3.4e38f;
+    datos.ewma = datos.minimo = datos.maximo = 4294967296.0f;
+    datos.ratio = datos.pendiente = -1.0e6f;
+    datos.tiempoHastaUmbral = 1.0e9f;
+    datos.cantidad = 0xFFFFFFFFUL;
+    datos.valida = false;
+    datos.alarma = true;
+
+    // Con los mínimos de float la línea no entra: se recorta
+    TEST_ASSERT_EQUAL(LONGITUD_LINEA - 1, formatearCanal(linea, LONGITUD_LINEA, datos));
+    TEST_ASSERT_EQUAL(LONGITUD_LINEA - 1, strlen(linea));
+
+    // Con concentraciones de hasta 10^6 ppm, el peor caso realista, entran enteras
+    datos.ppm = datos.umbral = datos.media = datos.ewma = datos.minimo = datos.maximo = -999999.99f;
+    datos.desviacion = 999999.99f;
+    TEST_ASSERT_LESS_THAN(LONGITUD_LINEA, formatearCanal(linea, sizeof(linea), datos));
+    TEST_ASSERT_LESS_THAN(LONGITUD_LINEA, formatearEstadisticas(linea, sizeof(linea), datos));
+    TEST_ASSERT_LESS_THAN(LONGITUD_LINEA, formatearTendencia(linea, sizeof(linea), datos));
+
+    TEST_ASSERT_EQUAL(0, formatearCanal(nullptr, sizeof(linea), datos));
+    TEST_ASSERT_EQUAL(0, formatearCanal(linea, 0, datos));
+}
+
+// Lo mismo que hace imprimirLecturas() en cada medición, 1000 veces
+void test_sin_memoria_dinamica() {
+    char linea[LONGITUD_LINEA];
+    DatosCanal datos = datosEjemplo();
+    size_t total = 0;
+
+    unsigned long antes = reservas;
+    for (int i = 0; i < 1000; i++) {
+        datos.ppm = i * 0.5f;
+        total += formatearCanal(linea, sizeof(linea), datos);
+        total += formatearEstadisticas(linea, sizeof(linea), datos);
+        total += formatearTendencia(linea, sizeof(linea), datos);
+    }
+    unsigned long delta = reservas - antes;
+
+    TEST_ASSERT_TRUE(total > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, delta);
+
+    // El contador funciona: una reserva explícita sí se cuenta
+    antes = reservas;
+    char* prueba = new char[16];
+    delete[] prueba;
+    TEST_ASSERT_EQUAL_UINT32(1, reservas - antes);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_lineas);
+    RUN_TEST(test_entran_en_un_registro);
+    RUN_TEST(test_sin_memoria_dinamica);
+    return UNITY_END();
+}
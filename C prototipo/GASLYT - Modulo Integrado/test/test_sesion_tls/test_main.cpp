@@ -0,0 +1,90 @@
+// Lógica de reanudación de ClienteTLS: a qué servidor se ofrece la sesión y
+// cálculo de la aceleración. La duración real de los handshakes se mide en
+// el equipo (ClienteTLS::imprimirEstadisticas).
+// pio test -e native -f test_sesion_tls
+#include <unity.h>
+#include <string>
+#include "SesionTLS.h"
+
+static const char* BROKER = "a1b2c3d4e5f6g7-ats.iot.us-east-1.amazonaws.com";
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_se_ofrece_solo_al_mismo_servidor() {
+    DestinoSesion destino;
+    TEST_ASSERT_TRUE(destino.estaVacio());
+    TEST_ASSERT_FALSE(destino.coincide(BROKER, 8883));
+
+    TEST_ASSERT_TRUE(destino.establecer(BROKER, 8883));
+    TEST_ASSERT_TRUE(destino.coincide(BROKER, 8883));
+    TEST_ASSERT_FALSE(destino.coincide(BROKER, 443));
+    TEST_ASSERT_FALSE(destino.coincide("a1b2c3d4e5f6g7-ats.iot.us-east-2.amazonaws.com", 8883));
+    TEST_ASSERT_FALSE(destino.coincide("a1b2c3d4e5f6g7-ats.iot.us-east-1.amazonaws.co", 8883));
+    TEST_ASSERT_FALSE(destino.coincide(nullptr, 8883));
+    TEST_ASSERT_EQUAL_STRING(BROKER, destino.obtenerHost());
+    TEST_ASSERT_EQUAL_UINT16(8883, destino.obtenerPuerto());
+
+    destino.borrar();
+    TEST_ASSERT_TRUE(destino.estaVacio());
+    TEST_ASSERT_FALSE(destino.coincide(BROKER, 8883));
+}
+
+// Antes el host se recortaba a 63 caracteres: nunca volvía a coincidir
+void test_host_largo() {
+    DestinoSesion destino;
+    std::string justo(DestinoSesion::LONGITUD_HOST - 1, 'h');
+    std::string largo(DestinoSesion::LONGITUD_HOST, 'h');
+
+    TEST_ASSERT_TRUE(destino.establecer(justo.c_str(), 8883));
+    TEST_ASSERT_TRUE(destino.coincide(justo.c_str(), 8883));
+    TEST_ASSERT_FALSE(destino.coincide(largo.c_str(), 8883));
+
+    // No se guarda, y la sesión anterior tampoco queda
+    TEST_ASSERT_FALSE(destino.establecer(largo.c_str(), 8883));
+    TEST_ASSERT_TRUE(destino.estaVacio());
+    TEST_ASSERT_FALSE(destino.coincide(largo.c_str(), 8883));
+    TEST_ASSERT_FALSE(destino.coincide(justo.c_str(), 8883));
+
+    TEST_ASSERT_FALSE(destino.establecer("", 8883));
+    TEST_ASSERT_FALSE(destino.establecer(nullptr, 8883));
+}
+
+void test_promedios_y_aceleracion() {
+    EstadisticasHandshake estadisticas;
+    TEST_ASSERT_EQUAL_UINT32(0, estadisticas.obtenerPromedioCompletoMs());
+    TEST_ASSERT_EQUAL_UINT32(0, estadisticas.obtenerAceleracionCentesimas());
+
+    // Solo completos: todavía no hay con qué comparar
+    estadisticas.registrar(1800, false);
+    estadisticas.registrar(2201, false);
+    TEST_ASSERT_EQUAL_UINT32(2, estadisticas.obtenerCompletos());
+    TEST_ASSERT_EQUAL_UINT32(2000, estadisticas.obtenerPromedioCompletoMs());
+    TEST_ASSERT_EQUAL_UINT32(0, estadisticas.obtenerAceleracionCentesimas());
+
+    estadisticas.registrar(400, true);
+    estadisticas.registrar(501, true);
+    estadisticas.registrar(450, true);
+    TEST_ASSERT_EQUAL_UINT32(3, estadisticas.obtenerReanudados());
+    TEST_ASSERT_EQUAL_UINT32(450, estadisticas.obtenerPromedioReanudadoMs());
+
+    // Con los totales: (4001 / 2) / (1351 / 3) = 4.44
+    TEST_ASSERT_EQUAL_UINT32(444, estadisticas.obtenerAceleracionCentesimas());
+}
+
+void test_reanudado_instantaneo() {
+    EstadisticasHandshake estadisticas;
+    estadisticas.registrar(1500, false);
+    estadisticas.registrar(0, true);
+    TEST_ASSERT_EQUAL_UINT32(0, estadisticas.obtenerPromedioReanudadoMs());
+    TEST_ASSERT_EQUAL_UINT32(150000, estadisticas.obtenerAceleracionCentesimas());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_se_ofrece_solo_al_mismo_servidor);
+    RUN_TEST(test_host_largo);
+    RUN_TEST(test_promedios_y_aceleracion);
+    RUN_TEST(test_reanudado_instantaneo);
+    return UNITY_END();
+}
@@ -0,0 +1,192 @@
+// Identificador de los topics cortos: colisiones, longitud de los topics y
+// bytes por PUBLISH frente al esquema largo, medidos sobre los paquetes que
+// escribe el cliente MQTT del equipo (lib/ClienteMQTT).
+// pio test -e native -f test_topic_corto
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "SesionMQTT.h"
+#include "TopicCorto.h"
+
+using namespace TopicCorto;
+
+// Algunos prefijos (OUI) de Espressif
+static const uint8_t PREFIJOS[][3] = {
+    { 0x24, 0x6F, 0x28 }, { 0x30, 0xAE, 0xA4 }, { 0xA4, 0xCF, 0x12 }, { 0x7C, 0x9E, 0xBD },
+};
+
+static void armarMac(uint8_t mac[LONGITUD_MAC], const uint8_t prefijo[3], uint32_t resto) {
+    memcpy(mac, prefijo, 3);
+    mac[3] = (uint8_t)(resto >> 16);
+    mac[4] = (uint8_t)(resto >> 8);
+    mac[5] = (uint8_t)resto;
+}
+
+// Topics como los arma MQTTManager::construirTopics()
+static std::string topicLargo(const uint8_t mac[LONGITUD_MAC], const char* tipo) {
+    char id[32];
+    snprintf(id, sizeof(id), "/ESP32-GASLYT-%02X%02X%02X/", mac[3], mac[4], mac[5]);
+    return std::string(id) + tipo;
+}
+
+static std::string topicCorto(const uint8_t mac[LONGITUD_MAC], char letra) {
+    char id[LONGITUD_ID + 1];
+    formatearId(id, sizeof(id), mac);
+    return std::string("g/") + id + "/" + letra;
+}
+
+// Canal que guarda lo que escribe la sesión; responde el CONNACK
+class CanalCaptura : public CanalMQTT {
+public:
+    std::vector<uint8_t> escrito;
+    std::vector<uint8_t> respuesta;
+
+    size_t escribir(const uint8_t* datos, size_t longitud) override {
+        escrito.insert(escrito.end(), datos, datos + longitud);
+        return longitud;
+    }
+
+    int leer(uint8_t* destino, size_t capacidad) override {
+        size_t cantidad = respuesta.size() < capacidad ? respuesta.size() : capacidad;
+        memcpy(destino, respuesta.data(), cantidad);
+        respuesta.erase(respuesta.begin(), respuesta.begin() + cantidad);
+        return (int)cantidad;
+    }
+};
+
+// PUBLISH QoS 1 tal como TransporteCliente lo escribe en la red
+static std::vector<uint8_t> capturarPublish(const std::string& topic, const uint8_t* datos, size_t longitud) {
+    static uint8_t entrada[256];
+    static uint8_t salida[1024];
+    SesionMQTT sesion(entrada, sizeof(entrada), salida, sizeof(salida));
+    CanalCaptura canal;
+
+    TEST_ASSERT_TRUE(sesion.iniciar(canal, "ESP32-GASLYT-A1B2C3", 0));
+    canal.respuesta = { 0x20, 0x02, 0x00, 0x00 };
+    sesion.procesar(0);
+    TEST_ASSERT_EQUAL(SesionMQTT::CONECTADA, sesion.obtenerEstado());
+
+    canal.escrito.clear();
+    TEST_ASSERT_TRUE(sesion.publicar(topic.c_str(), datos, longitud, 1, false, 0, 1));
+    return canal.escrito;
+}
+
+// El paquete lleva el topic tras la cabecera y termina con el payload
+static void verificarPublish(const std::vector<uint8_t>& paquete, const std::string& topic, const uint8_t* datos,
+                             size_t longitud) {
+    TEST_ASSERT_EQUAL_HEX8(0x32, paquete[0]);
+    TEST_ASSERT_EQUAL(paquete.size() - 2, paquete[1]);
+    TEST_ASSERT_EQUAL(topic.length(), (paquete[2] << 8) | paquete[3]);
+    TEST_ASSERT_EQUAL_MEMORY(topic.data(), paquete.data() + 4, topic.length());
+    TEST_ASSERT_EQUAL_MEMORY(datos, paquete.data() + paquete.size() - longitud, longitud);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_valores_conocidos() {
+    const uint8_t mac[] = { 0x24, 0x6F, 0x28, 0xA1, 0xB2, 0xC3 };
+    const uint8_t ceros[LONGITUD_MAC] = { 0 };
+    const uint8_t unos[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    char id[LONGITUD_ID + 1];
+
+    TEST_ASSERT_TRUE(formatearId(id, sizeof(id), mac));
+    TEST_ASSERT_EQUAL_STRING("JG8oobLD", id);
+    TEST_ASSERT_TRUE(formatearId(id, sizeof(id), ceros));
+    TEST_ASSERT_EQUAL_STRING("AAAAAAAA", id);
+    TEST_ASSERT_TRUE(formatearId(id, sizeof(id), unos));
+    TEST_ASSERT_EQUAL_STRING("________", id);
+
+    TEST_ASSERT_FALSE(formatearId(id, LONGITUD_ID, mac));
+    TEST_ASSERT_FALSE(formatearId(nullptr, sizeof(id), mac));
+
+    uint8_t leida[LONGITUD_MAC];
+    TEST_ASSERT_FALSE(leerId("JG8oobL", leida));
+    TEST_ASSERT_FALSE(leerId("JG8oobLD9", leida));
+    TEST_ASSERT_FALSE(leerId("JG8o+bLD", leida));
+}
+
+// Las MAC que compartían el sufijo de 6 dígitos tienen topics distintos
+void test_sin_colisiones() {
+    const size_t cantidadPrefijos = sizeof(PREFIJOS) / sizeof(PREFIJOS[0]);
+    uint8_t mac[LONGITUD_MAC];
+    uint8_t leida[LONGITUD_MAC];
+    char id[LONGITUD_ID + 1];
+    char otro[LONGITUD_ID + 1];
+
+    // Mismo sufijo, distinto prefijo: antes el mismo topic
+    for (size_t i = 0; i < cantidadPrefijos; i++) {
+        armarMac(mac, PREFIJOS[i], 0xA1B2C3);
+        formatearId(id, sizeof(id), mac);
+        for (size_t j = i + 1; j < cantidadPrefijos; j++) {
+            armarMac(mac, PREFIJOS[j], 0xA1B2C3);
+            formatearId(otro, sizeof(otro), mac);
+            TEST_ASSERT_TRUE(strcmp(id, otro) != 0);
+        }
+    }
+
+    // Biyectivo: leerId recupera la MAC en todo el espacio de un prefijo
+    // (2^24 equipos) y en una muestra de los otros
+    unsigned long recorridas = 0;
+    for (size_t i = 0; i < cantidadPrefijos; i++) {
+        uint32_t paso = i == 0 ? 1 : 4099;
+        for (uint32_t resto = 0; resto < 0x1000000; resto += paso) {
+            armarMac(mac, PREFIJOS[i], resto);
+            formatearId(id, sizeof(id), mac);
+            if (!leerId(id, leida) || memcmp(mac, leida, LONGITUD_MAC) != 0) {
+                TEST_FAIL_MESSAGE(id);
+            }
+            recorridas++;
+        }
+    }
+    char mensaje[64];
+    snprintf(mensaje, sizeof(mensaje), "MAC recorridas: %lu, sin colisiones", recorridas);
+    TEST_MESSAGE(mensaje);
+}
+
+// PUBLISH QoS 1 de una lectura: el payload es fijo, de 60 bytes (el tamaño
+// de una lectura MessagePack de un canal); solo cambia el topic
+void test_longitud_y_bytes_por_mensaje() {
+    const uint8_t mac[] = { 0x24, 0x6F, 0x28, 0xA1, 0xB2, 0xC3 };
+    uint8_t payload[60];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(0x80 + i);
+    }
+    struct Caso { const char* tipo; char letra; size_t ahorro; };
+    const Caso casos[] = {
+        { "lecturas", 'l', 17 }, { "alarmas", 'a', 16 }, { "metadata", 'm', 17 }, { "calibracion", 'c', 20 },
+    };
+
+    for (const Caso& caso : casos) {
+        std::string largo = topicLargo(mac, caso.tipo);
+        std::string corto = topicCorto(mac, caso.letra);
+        TEST_ASSERT_EQUAL(2 + LONGITUD_ID + 2, corto.length());
+        TEST_ASSERT_TRUE(corto.find_first_of("+#") == std::string::npos);
+        TEST_ASSERT_EQUAL(caso.ahorro, largo.length() - corto.length());
+    }
+
+    std::vector<uint8_t> largo = capturarPublish(topicLargo(mac, "lecturas"), payload, sizeof(payload));
+    std::vector<uint8_t> corto = capturarPublish(topicCorto(mac, 'l'), payload, sizeof(payload));
+    verificarPublish(largo, topicLargo(mac, "lecturas"), payload, sizeof(payload));
+    verificarPublish(corto, topicCorto(mac, 'l'), payload, sizeof(payload));
+    TEST_ASSERT_EQUAL(95, largo.size());
+    TEST_ASSERT_EQUAL(78, corto.size());
+
+    // Con el mismo volumen de datos entran un 21% más de lecturas
+    double mensajes = (double)largo.size() / corto.size();
+    TEST_ASSERT_GREATER_THAN_FLOAT(1.2f, (float)mensajes);
+    char mensaje[128];
+    snprintf(mensaje, sizeof(mensaje), "PUBLISH de lectura: %u bytes con el topic largo, %u con el corto "
+             "(%.1f%% más mensajes por byte)", (unsigned)largo.size(), (unsigned)corto.size(), (mensajes - 1) * 100);
+    TEST_MESSAGE(mensaje);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_valores_conocidos);
+    RUN_TEST(test_sin_colisiones);
+    RUN_TEST(test_longitud_y_bytes_por_mensaje);
+    return UNITY_END();
+}
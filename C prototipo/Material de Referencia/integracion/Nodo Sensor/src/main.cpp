@@ -1,6 +1,9 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include <LoRa.h>
+#include <ConversionGasQ.h>
+
+using namespace ConversionGasQ;
 
 //=======================================
 // PINES LoRa para Arduino Nano
@@ -11,30 +14,36 @@
 
 //=======================================
 // CONFIGURACIÓN SENSOR MQ (CO2/GAS)
+// La conversión usa punto fijo Q16.16 (ConversionGasQ): el Nano no tiene FPU
 //=======================================
 #define GAS_PIN           A0    // Pin analógico para sensor MQ
-#define VCC               5.0   // Voltaje Arduino Nano (5V)
-#define RL_VALUE          10.0  // Resistencia de carga en kΩ
-#define ADC_RESOLUTION    1024  // Resolución ADC Arduino (10 bits = 1024)
-#define CLEAN_AIR_RATIO   9.8   // Rs/Ro en aire limpio (MQ-2)
+#define VCC_MV            5000  // Voltaje Arduino Nano (5V) en mV
+#define RL_VALUE          10    // Resistencia de carga en kΩ
+#define ADC_MAX           1023  // Valor máximo del ADC (10 bits)
 #define CALIB_SAMPLES     50    // Muestras para calibración
 #define CALIB_DELAY       500   // Delay entre muestras (ms)
+#define PPM_MAX           10000 // Límite de lectura en PPM
+
+const q16_t LOG2_CLEAN_AIR_RATIO = Q16(3.292781749);  // log2(9.8), Rs/Ro en aire limpio (MQ-2)
+const CurvaQ CURVA_NODO = {Q16(9.165535141), Q16(-2.222)}; // PPM = 574.25 * (Rs/Ro)^-2.222
 
 //=======================================
 // CONFIGURACIÓN
 //=======================================
 const unsigned long SEND_INTERVAL = 10000;  // Enviar datos cada 10 segundos
-const float GAS_THRESHOLD = 500.0;           // Umbral de gas en PPM
+const uint32_t GAS_THRESHOLD = 500;          // Umbral de gas en PPM
 
 //=======================================
 // VARIABLES GLOBALES
 //=======================================
-float Ro = 10.0;  // Resistencia en aire limpio (kΩ)
+SensorQ sensor = {ADC_MAX, 0, &CURVA_NODO};  // log2(Ro/RL) = 0 hasta calibrar (Ro = RL)
 unsigned long lastSendTime = 0;
-float calibrateSensor();
-float calculateResistance(int raw_adc);
-float readGasPPM();
-float readGasRatio();
+q16_t calibrateSensor();
+uint32_t calculateResistance(int raw_adc);
+uint32_t readGasPPM(int raw_adc);
+uint32_t readGasRatio(int raw_adc);
+uint32_t readRo();
+String formatQ16(uint32_t valueQ, uint8_t decimals);
 void readAndSendGasData();
 void sendLoRaMessage(String message);
 void checkIncomingMessages();
@@ -65,9 +74,9 @@ void setup() {
   Serial.println(F("Tiene que estar el aire limpio"));
   delay(2000);
   
-  Ro = calibrateSensor();
+  sensor.log2R0RL = calibrateSensor();
   Serial.print(F("Calibracion completa. Ro = "));
-  Serial.print(Ro, 2);
+  Serial.print(formatQ16(readRo(), 2));
   Serial.println(F(" kΩ"));
   
   Serial.println(F("=== NODO SENSOR LISTO ===\n"));
@@ -93,48 +102,51 @@ void loop() {
 // FUNCIONES DEL SENSOR MQ
 //=======================================
 
-float calibrateSensor() {
-  float val = 0;
+q16_t calibrateSensor() {
+  int32_t sum = 0;
   
-  // Tomar múltiples muestras para calibración
+  // Promedio de log2(Rs/RL) en aire limpio (media geométrica de Rs)
   for (int i = 0; i < CALIB_SAMPLES; i++) {
-    val += calculateResistance(analogRead(GAS_PIN));
+    sum += log2RsRL(analogRead(GAS_PIN), ADC_MAX);
     delay(CALIB_DELAY);
   }
   
-  val = val / CALIB_SAMPLES;                    // Promedio
-  val = val / CLEAN_AIR_RATIO;                  // Rs/Ro = CLEAN_AIR_RATIO
-  
-  return val;
+  // Rs/Ro = CLEAN_AIR_RATIO  ->  log2(Ro/RL) = log2(Rs/RL) - log2(CLEAN_AIR_RATIO)
+  return calibrarLog2R0RL(sum / CALIB_SAMPLES, LOG2_CLEAN_AIR_RATIO);
 }
 
-float calculateResistance(int raw_adc) {
+// Rs en kΩ, Q16.16
+uint32_t calculateResistance(int raw_adc) {
   if (raw_adc == 0) return 0;
   
-  float voltage = ((float)raw_adc / ADC_RESOLUTION) * VCC;
-  float rs = (VCC - voltage) / voltage * RL_VALUE;
-  
-  return rs;
+  return exp2Q(log2RsRL(raw_adc, ADC_MAX) + log2Entero(RL_VALUE));
 }
 
-float readGasPPM() {
-  float rs = calculateResistance(analogRead(GAS_PIN));
-  float ratio = rs / Ro;
-  
-  // Ecuación para MQ-2 (aproximada)
-  // PPM = A * (Rs/Ro)^B donde A=574.25, B=-2.222
-  float ppm = 574.25 * pow(ratio, -2.222);
+// PPM en Q16.16
+uint32_t readGasPPM(int raw_adc) {
+  // Ecuación para MQ-2 (aproximada): PPM = A * (Rs/Ro)^B donde A=574.25, B=-2.222
+  uint32_t ppm = convertir(sensor, raw_adc);
   
   // Limitar valores extremos
-  if (ppm < 0) ppm = 0;
-  if (ppm > 10000) ppm = 10000;
+  if (ppm > ((uint32_t)PPM_MAX << 16)) ppm = (uint32_t)PPM_MAX << 16;
   
   return ppm;
 }
 
-float readGasRatio() {
-  float rs = calculateResistance(analogRead(GAS_PIN));
-  return rs / Ro;
+// Rs/Ro en Q16.16
+uint32_t readGasRatio(int raw_adc) {
+  return exp2Q(log2Ratio(sensor, raw_adc));
+}
+
+// Ro en kΩ, Q16.16
+uint32_t readRo() {
+  return exp2Q(sensor.log2R0RL + log2Entero(RL_VALUE));
+}
+
+String formatQ16(uint32_t valueQ, uint8_t decimals) {
+  char buffer[16];
+  formatear(buffer, sizeof(buffer), valueQ, decimals);
+  return String(buffer);
 }
 
 //=======================================
@@ -144,28 +156,28 @@ float readGasRatio() {
 void readAndSendGasData() {
   Serial.println(F("--- Leyendo sensor de gas ---"));
   
-  // Leer sensor MQ
+  // Leer sensor MQ una sola vez: todas las magnitudes salen de la misma muestra
   int rawValue = analogRead(GAS_PIN);
-  float voltage = ((float)rawValue / ADC_RESOLUTION) * VCC;
-  float rs = calculateResistance(rawValue);
-  float ratio = readGasRatio();
-  float ppm = readGasPPM();
+  uint16_t millivolts = (uint32_t)rawValue * VCC_MV / ADC_MAX;
+  uint32_t rs = calculateResistance(rawValue);
+  uint32_t ratio = readGasRatio(rawValue);
+  uint32_t ppm = readGasPPM(rawValue);
   
   // Mostrar lecturas en Serial
   Serial.print(F("Raw: ")); Serial.print(rawValue);
-  Serial.print(F(" | V: ")); Serial.print(voltage, 2);
-  Serial.print(F("V | Rs: ")); Serial.print(rs, 2);
-  Serial.print(F("kΩ | Ratio: ")); Serial.print(ratio, 2);
-  Serial.print(F(" | PPM: ")); Serial.println(ppm, 1);
+  Serial.print(F(" | V: ")); Serial.print(millivolts);
+  Serial.print(F("mV | Rs: ")); Serial.print(formatQ16(rs, 2));
+  Serial.print(F("kΩ | Ratio: ")); Serial.print(formatQ16(ratio, 2));
+  Serial.print(F(" | PPM: ")); Serial.println(formatQ16(ppm, 1));
   
   // Evaluar umbral
-  String status = (ppm > GAS_THRESHOLD) ? F("ALERTA") : F("NORMAL");
+  String status = (ppm > (GAS_THRESHOLD << 16)) ? F("ALERTA") : F("NORMAL");
   
   // Crear mensaje
   String message = F("GAS_DATA|PPM:");
-  message += String(ppm, 1);
+  message += formatQ16(ppm, 1);
   message += F("|Ratio:");
-  message += String(ratio, 2);
+  message += formatQ16(ratio, 2);
   message += F("|Raw:");
   message += String(rawValue);
   message += F("|Status:");
@@ -215,18 +227,18 @@ void processMessage(String message) {
     Serial.println(F("Asegurate que este en aire limpio"));
     delay(3000);
     
-    Ro = calibrateSensor();
+    sensor.log2R0RL = calibrateSensor();
     Serial.print(F("Nueva calibracion: Ro = "));
-    Serial.print(Ro, 2);
+    Serial.print(formatQ16(readRo(), 2));
     Serial.println(F(" kΩ"));
     
     String response = F("CALIBRATION_OK|Ro:");
-    response += String(Ro, 2);
+    response += formatQ16(readRo(), 2);
     sendLoRaMessage(response);
     
   } else if (message.startsWith("THRESHOLD:")) {
     // Cambiar umbral (ejemplo: THRESHOLD:600)
-    float newThreshold = message.substring(10).toFloat();
+    long newThreshold = message.substring(10).toInt();
     if (newThreshold > 0 && newThreshold < 5000) {
       Serial.print(F("Solicitud cambio umbral a: "));
       Serial.println(newThreshold);
@@ -241,7 +253,7 @@ void processMessage(String message) {
   } else if (message == "INFO") {
     // Enviar información del nodo
     String info = F("NODE_INFO|TYPE:SENSOR|MCU:NANO|Ro:");
-    info += String(Ro, 2);
+    info += formatQ16(readRo(), 2);
     info += F("|THRESHOLD:");
     info += String(GAS_THRESHOLD);
     sendLoRaMessage(info);